@@ -0,0 +1,137 @@
+#include "arch/x86_64/ACPI/acpi.h"
+#include "arch/x86_64/boot/multiboot2.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct acpi_rsdp {
+    char signature[8];          // "RSD PTR "
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;           // 0 = ACPI 1.0 (RSDT only), 2+ = XSDT
+    uint32_t rsdt_address;
+    // revision >= 2
+    uint32_t length;
+    uint64_t xsdt_address;
+    uint8_t extended_checksum;
+    uint8_t reserved[3];
+} __attribute__((packed));
+
+#define RSDP_V1_SIZE   20
+
+#define BIOS_EBDA_PTR  0x40E
+#define BIOS_ROM_START 0xE0000
+#define BIOS_ROM_END   0x100000
+
+static const struct acpi_sdt_header* root;
+static int root_is_xsdt;
+
+// ===================== HELPERS =====================
+static int checksum_ok(const void* p, uint32_t len) {
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < len; i++) sum += ((const uint8_t*)p)[i];
+    return sum == 0;
+}
+
+// Tables usually sit in the identity mapped RAM below 1 GiB; above that
+// (large guests, some firmware) they get a read-only kernel mapping.
+static const void* map_table(uint64_t phys, uint32_t len) {
+    if (phys + len <= IDENTITY_END) return (const void*)(uintptr_t)phys;
+    return vm_map_phys(phys, len, VM_READ, "acpi");
+}
+
+static const struct acpi_sdt_header* map_sdt(uint64_t phys) {
+    const struct acpi_sdt_header* h = map_table(phys, sizeof(*h));
+    if (!h || phys + h->length <= IDENTITY_END) return h;
+
+    uint32_t len = h->length;
+    vm_release((void*)h);
+    return map_table(phys, len);
+}
+
+// ===================== RSDP =====================
+static const struct acpi_rsdp* rsdp_valid(const void* p) {
+    const struct acpi_rsdp* rsdp = p;
+    if (memcmp(rsdp->signature, "RSD PTR ", 8) != 0) return NULL;
+    if (!checksum_ok(rsdp, RSDP_V1_SIZE)) return NULL;
+    if (rsdp->revision >= 2 && !checksum_ok(rsdp, rsdp->length)) return NULL;
+    return rsdp;
+}
+
+// The RSDP sits on a 16-byte boundary in the first KiB of the EBDA or in
+// the BIOS ROM area
+__init static const struct acpi_rsdp* rsdp_scan(void) {
+    uintptr_t bda = BIOS_EBDA_PTR;
+    __asm__ ("" : "+r"(bda)); // GCC treats constant addresses below 4 KiB as NULL + offset
+    uint64_t ebda = (uint64_t)*(const uint16_t*)bda << 4;
+    if (ebda >= 0x80000 && ebda < 0xA0000) {
+        for (uint64_t p = ebda; p < ebda + 1024; p += 16) {
+            const struct acpi_rsdp* rsdp = rsdp_valid((const void*)(uintptr_t)p);
+            if (rsdp) return rsdp;
+        }
+    }
+    for (uint64_t p = BIOS_ROM_START; p < BIOS_ROM_END; p += 16) {
+        const struct acpi_rsdp* rsdp = rsdp_valid((const void*)(uintptr_t)p);
+        if (rsdp) return rsdp;
+    }
+    return NULL;
+}
+
+// GRUB copies the RSDP into the boot information (new = ACPI 2.0+ first)
+__init static const struct acpi_rsdp* rsdp_find(void) {
+    static const uint32_t tags[] = { MB2_TAG_ACPI_NEW, MB2_TAG_ACPI_OLD };
+    for (size_t i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+        const struct mb2_tag* tag = multiboot2_find(tags[i], NULL);
+        if (!tag) continue;
+        const struct acpi_rsdp* rsdp = rsdp_valid((const uint8_t*)tag + sizeof(struct mb2_tag));
+        if (rsdp) return rsdp;
+    }
+    return rsdp_scan();
+}
+
+// ===================== INIT =====================
+__init int acpi_init(void) {
+    const struct acpi_rsdp* rsdp = rsdp_find();
+    if (!rsdp) {
+        serial_write("[ACPI] no RSDP\n");
+        return -1;
+    }
+
+    root_is_xsdt = rsdp->revision >= 2 && rsdp->xsdt_address;
+    root = map_sdt(root_is_xsdt ? rsdp->xsdt_address : rsdp->rsdt_address);
+    if (!root || !checksum_ok(root, root->length)) {
+        serial_write("[ACPI] bad root table\n");
+        root = NULL;
+        return -1;
+    }
+
+    serial_write("[ACPI] revision ");
+    serial_write_dec(rsdp->revision);
+    serial_write(root_is_xsdt ? ", XSDT " : ", RSDT ");
+    serial_write_hex((uint64_t)(uintptr_t)root);
+    serial_write("\n");
+    return 0;
+}
+
+// ===================== LOOKUP =====================
+const struct acpi_sdt_header* acpi_find_table(const char* signature) {
+    if (!root) return NULL;
+
+    const uint8_t* entries = (const uint8_t*)root + sizeof(*root);
+    uint32_t entry_size = root_is_xsdt ? 8 : 4;
+    uint32_t count = (root->length - sizeof(*root)) / entry_size;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t phys = 0;
+        memcpy(&phys, entries + i * entry_size, entry_size); // XSDT entries are unaligned
+        const struct acpi_sdt_header* h = map_sdt(phys);
+        if (!h) continue;
+        if (memcmp(h->signature, signature, 4) == 0 && checksum_ok(h, h->length)) return h;
+        if (phys + h->length > IDENTITY_END) vm_release((void*)h);
+    }
+    return NULL;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+
+// ACPI table lookup. The RSDP comes from the multiboot2 ACPI tags, with the
+// BIOS area scan as fallback; only the XSDT/RSDT is walked, AML is not parsed.
+
+struct acpi_sdt_header {
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed));
+
+// Generic address structure
+struct acpi_gas {
+    uint8_t space_id;           // 0 = memory, 1 = I/O port
+    uint8_t bit_width;
+    uint8_t bit_offset;
+    uint8_t access_size;
+    uint64_t address;
+} __attribute__((packed));
+
+#define ACPI_SPACE_MEMORY  0
+
+struct acpi_hpet {
+    struct acpi_sdt_header header;
+    uint32_t event_timer_block_id;
+    struct acpi_gas address;
+    uint8_t hpet_number;
+    uint16_t min_tick;
+    uint8_t page_protection;
+} __attribute__((packed));
+
+// 0 when the RSDP and root table were found and valid
+int acpi_init(void);
+
+// First table with `signature` ("HPET", "APIC", "MCFG", ...), checksum
+// verified, or NULL
+const struct acpi_sdt_header* acpi_find_table(const char* signature);
@@ -0,0 +1,86 @@
+#include "arch/x86_64/APIC/lapic.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/IDT/idt.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define MSR_APIC_BASE       0x1B
+#define APIC_BASE_X2APIC    (1ull << 10)
+#define APIC_BASE_ENABLE    (1ull << 11)
+#define APIC_BASE_ADDR_MASK 0xFFFFFF000ull
+
+#define SVR_ENABLE          (1u << 8)
+
+extern void isr239();
+extern void isr255();
+
+static volatile uint8_t* lapic;
+static int x2apic;
+static int present;
+
+volatile uint32_t* lapic_eoi_reg;
+
+uint32_t lapic_read(uint32_t reg) {
+    if (x2apic) return (uint32_t)cpu_rdmsr(X2APIC_MSR(reg));
+    return *(volatile uint32_t*)(lapic + reg);
+}
+
+void lapic_write(uint32_t reg, uint32_t value) {
+    if (x2apic) cpu_wrmsr(X2APIC_MSR(reg), value);
+    else *(volatile uint32_t*)(lapic + reg) = value;
+}
+
+int lapic_present(void) {
+    return present;
+}
+
+// xAPIC keeps the ID in bits 31:24, x2APIC uses the whole register
+uint32_t lapic_id(void) {
+    uint32_t id = lapic_read(LAPIC_ID);
+    return x2apic ? id : id >> 24;
+}
+
+__init int lapic_init(void) {
+    if (!cpu_has(CPU_FEATURE_APIC)) {
+        serial_write("[LAPIC] not present\n");
+        return -1;
+    }
+
+    // x2APIC is entered from xAPIC by setting both bits; lapic_eoi() was
+    // patched for it already (alternatives_apply)
+    uint64_t base = cpu_rdmsr(MSR_APIC_BASE);
+    if (cpu_has(CPU_FEATURE_X2APIC)) {
+        cpu_wrmsr(MSR_APIC_BASE, base | APIC_BASE_ENABLE);
+        cpu_wrmsr(MSR_APIC_BASE, base | APIC_BASE_ENABLE | APIC_BASE_X2APIC);
+        x2apic = 1;
+    } else {
+        cpu_wrmsr(MSR_APIC_BASE, base | APIC_BASE_ENABLE);
+        lapic = vm_map_io(base & APIC_BASE_ADDR_MASK, PAGE_SIZE, "lapic");
+        if (!lapic) return -1;
+        lapic_eoi_reg = (volatile uint32_t*)(lapic + LAPIC_EOI);
+    }
+    present = 1;
+
+    set_idt_gate(LAPIC_TIMER_VECTOR, (uint64_t)isr239, 0x8E);
+    set_idt_gate(LAPIC_SPURIOUS_VECTOR, (uint64_t)isr255, 0x8E);
+
+    // timer quiet until a clockevent claims it
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, 0);
+    lapic_write(LAPIC_SVR, SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+
+    serial_write("[LAPIC] id ");
+    serial_write_dec(lapic_id());
+    if (x2apic) {
+        serial_write(" x2apic\n");
+        return 0;
+    }
+    serial_write(" at ");
+    serial_write_hex(base & APIC_BASE_ADDR_MASK);
+    serial_write("\n");
+    return 0;
+}
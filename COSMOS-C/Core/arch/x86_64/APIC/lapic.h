@@ -0,0 +1,52 @@
+#pragma once
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/CPU/features.h"
+#include <stdint.h>
+
+// Local APIC of the boot CPU: x2APIC (MSR) mode when the CPU has it, xAPIC
+// (MMIO) otherwise. The 8259 PIC still
+// delivers the legacy IRQs through LINT0 (virtual wire, as the BIOS set it up);
+// the LAPIC adds its own timer, NMIs (NMI/nmi.h) and, later, IPIs.
+
+// ===================== REGISTERS =====================
+#define LAPIC_ID            0x020
+#define LAPIC_EOI           0x0B0
+#define LAPIC_SVR           0x0F0   // spurious vector + software enable
+#define LAPIC_LVT_TIMER     0x320
+#define LAPIC_LVT_PERF      0x340   // performance counter overflow
+#define LAPIC_TIMER_INIT    0x380
+#define LAPIC_TIMER_COUNT   0x390
+#define LAPIC_TIMER_DIV     0x3E0
+
+// x2APIC: register `reg` is MSR X2APIC_MSR(reg)
+#define X2APIC_MSR(reg)     (0x800u + ((reg) >> 4))
+
+#define LAPIC_LVT_MASKED    (1u << 16)
+#define LAPIC_TIMER_PERIODIC (1u << 17)
+#define LAPIC_DM_NMI        (4u << 8)    // LVT / MSI delivery mode, vector ignored
+
+// MSI address of a LAPIC (HPET FSB, PCI MSI): destination ID in bits 19:12
+#define LAPIC_MSI_ADDR(id)  (0xFEE00000u | ((uint32_t)(id) << 12))
+
+// ===================== VECTORS =====================
+#define LAPIC_TIMER_VECTOR     0xEF
+#define LAPIC_SPURIOUS_VECTOR  0xFF
+
+// Maps and software-enables the LAPIC, 0 on success
+int lapic_init(void);
+int lapic_present(void);
+uint32_t lapic_id(void);
+
+uint32_t lapic_read(uint32_t reg);
+void lapic_write(uint32_t reg, uint32_t value);
+
+// EOI register of the xAPIC mapping (lapic.c)
+extern volatile uint32_t* lapic_eoi_reg;
+
+// One store in xAPIC mode, one wrmsr in x2APIC mode (patched at boot, the
+// mode follows the X2APIC feature)
+static inline void lapic_eoi(void) {
+    __asm__ volatile (ALTERNATIVE("movl $0, (%[reg])", "wrmsr", CPU_FEATURE_X2APIC)
+                      : : [reg] "r"(lapic_eoi_reg), "c"(X2APIC_MSR(LAPIC_EOI)), "a"(0), "d"(0)
+                      : "memory");
+}
@@ -0,0 +1,65 @@
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/CPU/features.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "Drivers/serial/serial.h"
+#include "compiler.h"
+#include <stdint.h>
+
+// targets/x86_64/linker.ld, inside .init
+extern const struct alt_entry __alt_start[], __alt_end[];
+
+#define NOP_MAX  8
+
+// Recommended multi-byte NOPs (Intel SDM, NOP), index = length
+static const uint8_t nops[NOP_MAX + 1][NOP_MAX] = {
+    [1] = { 0x90 },
+    [2] = { 0x66, 0x90 },
+    [3] = { 0x0F, 0x1F, 0x00 },
+    [4] = { 0x0F, 0x1F, 0x40, 0x00 },
+    [5] = { 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    [6] = { 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    [7] = { 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+    [8] = { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+};
+
+static __init void fill_nops(volatile uint8_t* p, uint32_t len) {
+    while (len) {
+        uint32_t n = len < NOP_MAX ? len : NOP_MAX;
+        for (uint32_t i = 0; i < n; i++) p[i] = nops[n][i];
+        p += n;
+        len -= n;
+    }
+}
+
+// Runs before sections_protect(): the boot mapping of .text is still
+// writable, and interrupts are off, so no handler runs a half-patched site.
+// Stores to code this CPU is about to run are picked up; the cpuid at the
+// end serializes anyway.
+__init void alternatives_apply(void) {
+    uint32_t sites = 0, patched = 0;
+    for (const struct alt_entry* e = __alt_start; e < __alt_end; e++) {
+        volatile uint8_t* site = (volatile uint8_t*)e->site;
+        sites++;
+        if (e->feature >= CPU_FEATURE_COUNT || !cpu_has(e->feature)) {
+            // keep the original, one long NOP instead of a run of 0x90
+            if (e->site_len - e->original_len > 1)
+                fill_nops(site + e->original_len, e->site_len - e->original_len);
+            continue;
+        }
+        if (e->replacement_len > e->site_len) continue;   // can't happen, .skip pads
+
+        const uint8_t* repl = (const uint8_t*)e->replacement;
+        for (uint32_t i = 0; i < e->replacement_len; i++) site[i] = repl[i];
+        fill_nops(site + e->replacement_len, e->site_len - e->replacement_len);
+        patched++;
+    }
+
+    uint32_t a, b, c, d;
+    cpu_cpuid(0, 0, &a, &b, &c, &d);
+
+    serial_write("[ALT] patched ");
+    serial_write_dec(patched);
+    serial_write(" of ");
+    serial_write_dec(sites);
+    serial_write(" sites\n");
+}
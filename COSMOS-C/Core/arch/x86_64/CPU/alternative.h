@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+
+// Boot-time code alternatives. A hot path written as
+//
+//   __asm__ volatile (ALTERNATIVE("rep movsq ...", "rep movsb", CPU_FEATURE_FSRM) : ...);
+//
+// assembles the first sequence in place and the second into
+// .altinstr_replacement, plus an entry in .altinstructions. Once the
+// features are known, alternatives_apply() copies the replacement over
+// every site whose feature the CPU has and pads the rest with NOPs, so the
+// choice costs nothing per call. The site is padded to the longer of the
+// two sequences at build time.
+//
+// Both sequences share the asm operands. The replacement is copied, not
+// relocated: no rip-relative operands and no relative jumps or calls in it.
+// The original stays where it was built and may use either.
+//
+// .altinstructions and .altinstr_replacement live in .init
+// (targets/x86_64/linker.ld) and are released after boot.
+
+struct alt_entry {
+    uint64_t site;
+    uint64_t replacement;
+    uint16_t feature;           // CPU_FEATURE_*
+    uint8_t site_len;           // padded
+    uint8_t replacement_len;
+    uint8_t original_len;       // without the padding
+    uint8_t reserved[3];
+};
+
+#define ALT_STR_(x)  #x
+#define ALT_STR(x)   ALT_STR_(x)
+
+// gas evaluates a true comparison to -1: the .skip pads by
+// max(0, replacement - original) bytes
+#define ALTERNATIVE(oldinstr, newinstr, feature)                                  \
+    "661:\n\t" oldinstr "\n662:\n\t"                                              \
+    ".skip -(((665f-664f)-(662b-661b)) > 0) * ((665f-664f)-(662b-661b)), 0x90\n"  \
+    "663:\n\t"                                                                    \
+    ".pushsection .altinstructions, \"a\"\n\t"                                    \
+    ".balign 8\n\t"                                                               \
+    ".quad 661b, 664f\n\t"                                                        \
+    ".word " ALT_STR(feature) "\n\t"                                              \
+    ".byte 663b-661b, 665f-664f, 662b-661b\n\t"                                   \
+    ".byte 0, 0, 0\n\t"                                                           \
+    ".popsection\n\t"                                                             \
+    ".pushsection .altinstr_replacement, \"ax\"\n"                                \
+    "664:\n\t" newinstr "\n665:\n\t"                                              \
+    ".popsection\n"
+
+// Patches every site whose feature cpu_features has. Boot only, right after
+// cpu_features_init(): interrupts off, one CPU, .text still writable.
+void alternatives_apply(void);
@@ -0,0 +1,123 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef COSMOS_HOSTED
+// Native (Linux) build: the stub in host/hal_stub.c advances simulated time
+void hal_halt(void);
+
+static inline void cpu_halt(void) {
+    hal_halt();
+}
+
+// No interrupts on the host, locks only have to order the threads
+static inline uint64_t cpu_irq_save(void) { return 0; }
+static inline void cpu_irq_restore(uint64_t flags) { (void)flags; }
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    __asm__ volatile ("" : : : "memory");
+#endif
+}
+#else
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/CPU/features.h"
+
+// Line armed by MONITOR in cpu_halt(); a store to it ends the wait like an
+// interrupt does (CPU/features.c)
+extern uint64_t cpu_idle_line;
+
+// Sleep until the next interrupt. With MONITOR/MWAIT: mwait in C1 (hint 0),
+// which also wakes on a store to cpu_idle_line (patched at boot).
+static inline void cpu_halt(void) {
+    uint64_t addr = (uint64_t)&cpu_idle_line;
+    __asm__ volatile (ALTERNATIVE("hlt", "monitor\n\txorl %%eax, %%eax\n\tmwait", CPU_FEATURE_MWAIT)
+                      : "+a"(addr) : "c"(0), "d"(0) : "memory");
+}
+
+// Spin-wait hint: saves power and avoids the memory-order flush on exit
+static inline void cpu_relax(void) {
+    __asm__ volatile ("pause" : : : "memory");
+}
+
+// ===================== INTERRUPT FLAG =====================
+#define RFLAGS_IF      (1ull << 9)
+
+#ifdef IRQSOFF
+// Core/trace/irqsoff.h: times the sections these two open and close
+void irqsoff_begin(void);
+void irqsoff_end(void);
+#endif
+
+// Disables interrupts and returns the previous RFLAGS for cpu_irq_restore()
+static inline uint64_t cpu_irq_save(void) {
+    uint64_t flags;
+    __asm__ volatile ("pushfq; popq %0; cli" : "=r"(flags) : : "memory");
+#ifdef IRQSOFF
+    if (flags & RFLAGS_IF) irqsoff_begin();
+#endif
+    return flags;
+}
+
+static inline void cpu_irq_restore(uint64_t flags) {
+    if (flags & RFLAGS_IF) {
+#ifdef IRQSOFF
+        irqsoff_end();
+#endif
+        __asm__ volatile ("sti" : : : "memory");
+    }
+}
+
+// ===================== CPUID / MSR =====================
+static inline void cpu_cpuid(uint32_t leaf, uint32_t subleaf,
+                             uint32_t* a, uint32_t* b, uint32_t* c, uint32_t* d) {
+    __asm__ volatile ("cpuid" : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d) : "a"(leaf), "c"(subleaf));
+}
+
+static inline uint64_t cpu_rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void cpu_wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile ("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+#define MSR_EFER       0xC0000080
+#define EFER_NXE       (1ull << 11)
+
+// ===================== CONTROL REGISTERS =====================
+#define CR0_WP         (1ull << 16)
+
+static inline uint64_t cpu_read_cr0(void) {
+    uint64_t v;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(v));
+    return v;
+}
+
+static inline void cpu_write_cr0(uint64_t v) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(v) : "memory");
+}
+
+static inline uint64_t cpu_read_cr2(void) {
+    uint64_t v;
+    __asm__ volatile ("mov %%cr2, %0" : "=r"(v));
+    return v;
+}
+
+static inline uint64_t cpu_read_cr3(void) {
+    uint64_t v;
+    __asm__ volatile ("mov %%cr3, %0" : "=r"(v));
+    return v;
+}
+
+static inline void cpu_write_cr3(uint64_t v) {
+    __asm__ volatile ("mov %0, %%cr3" : : "r"(v) : "memory");
+}
+
+static inline void cpu_invlpg(const void* addr) {
+    __asm__ volatile ("invlpg (%0)" : : "r"(addr) : "memory");
+}
+#endif
@@ -0,0 +1,164 @@
+#include "arch/x86_64/CPU/features.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "Drivers/serial/serial.h"
+#include "compiler.h"
+#include <stdint.h>
+
+#define CPUID_VENDOR          0x00
+#define CPUID_BASIC           0x01
+#define CPUID_EXTENDED        0x07
+#define CPUID_EXT_MAX         0x80000000
+#define CPUID_EXT_BASIC       0x80000001
+#define CPUID_EXT_POWER       0x80000007
+
+// leaf 1
+#define ECX_SSE4_2            (1u << 20)
+#define ECX_MWAIT             (1u << 3)
+#define ECX_PCID              (1u << 17)
+#define ECX_X2APIC            (1u << 21)
+#define ECX_TSC_DEADLINE      (1u << 24)
+#define ECX_XSAVE             (1u << 26)
+#define ECX_OSXSAVE           (1u << 27)
+#define ECX_AVX               (1u << 28)
+#define ECX_RDRAND            (1u << 30)
+#define EDX_APIC              (1u << 9)
+// leaf 7, subleaf 0
+#define EBX7_AVX2             (1u << 5)
+#define EBX7_ERMS             (1u << 9)
+#define EBX7_INVPCID          (1u << 10)
+#define EBX7_AVX512F          (1u << 16)
+#define EDX7_FSRM             (1u << 4)
+// 0x80000001 / 0x80000007
+#define EDX_EXT_NX            (1u << 20)
+#define EDX_EXT_PAGE1GB       (1u << 26)
+#define EDX_EXT_RDTSCP        (1u << 27)
+#define EDX_POWER_INVARIANT   (1u << 8)
+
+// XCR0 state components
+#define XCR0_SSE              (1ull << 1)
+#define XCR0_AVX              (1ull << 2)
+#define XCR0_AVX512           (7ull << 5)    // opmask, ZMM_Hi256, Hi16_ZMM
+
+struct cpu_features cpu_features;
+uint64_t cpu_idle_line;
+
+static const char* const feature_names[CPU_FEATURE_COUNT] = {
+    [CPU_FEATURE_APIC]          = "apic",
+    [CPU_FEATURE_NX]            = "nx",
+    [CPU_FEATURE_PAGE1GB]       = "page1gb",
+    [CPU_FEATURE_RDTSCP]        = "rdtscp",
+    [CPU_FEATURE_INVARIANT_TSC] = "invariant_tsc",
+    [CPU_FEATURE_TSC_DEADLINE]  = "tsc_deadline",
+    [CPU_FEATURE_X2APIC]        = "x2apic",
+    [CPU_FEATURE_PCID]          = "pcid",
+    [CPU_FEATURE_INVPCID]       = "invpcid",
+    [CPU_FEATURE_MWAIT]         = "mwait",
+    [CPU_FEATURE_RDRAND]        = "rdrand",
+    [CPU_FEATURE_SSE4_2]        = "sse4_2",
+    [CPU_FEATURE_XSAVE]         = "xsave",
+    [CPU_FEATURE_OSXSAVE]       = "osxsave",
+    [CPU_FEATURE_AVX]           = "avx",
+    [CPU_FEATURE_AVX2]          = "avx2",
+    [CPU_FEATURE_AVX512F]       = "avx512f",
+    [CPU_FEATURE_ERMS]          = "erms",
+    [CPU_FEATURE_FSRM]          = "fsrm",
+};
+
+const char* cpu_feature_name(uint32_t feature) {
+    return feature < CPU_FEATURE_COUNT ? feature_names[feature] : "?";
+}
+
+// ===================== DETECTION =====================
+static inline uint64_t xgetbv(uint32_t index) {
+    uint32_t lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(index));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void set_if(uint64_t* flags, uint32_t reg, uint32_t bit, uint32_t feature) {
+    if (reg & bit) *flags |= 1ull << feature;
+}
+
+static __init void read_vendor(struct cpu_features* f) {
+    uint32_t a, b, c, d;
+    cpu_cpuid(CPUID_VENDOR, 0, &a, &b, &c, &d);
+    f->max_leaf = a;
+    // ebx, edx, ecx spell the vendor string
+    const uint32_t regs[3] = { b, d, c };
+    for (int i = 0; i < 12; i++) f->vendor[i] = (char)(regs[i / 4] >> (8 * (i % 4)));
+    f->vendor[12] = '\0';
+
+    cpu_cpuid(CPUID_BASIC, 0, &a, &b, &c, &d);
+    f->stepping = a & 0xF;
+    f->model = (a >> 4) & 0xF;
+    f->family = (a >> 8) & 0xF;
+    if (f->family == 0xF) f->family += (a >> 20) & 0xFF;
+    if (f->family == 0x6 || f->family >= 0xF) f->model |= ((a >> 16) & 0xF) << 4;
+}
+
+__init void cpu_features_init(void) {
+    struct cpu_features* f = &cpu_features;
+    uint64_t flags = 0;
+    uint32_t a, b, c, d;
+
+    read_vendor(f);
+
+    cpu_cpuid(CPUID_BASIC, 0, &a, &b, &c, &d);
+    set_if(&flags, d, EDX_APIC, CPU_FEATURE_APIC);
+    set_if(&flags, c, ECX_SSE4_2, CPU_FEATURE_SSE4_2);
+    set_if(&flags, c, ECX_MWAIT, CPU_FEATURE_MWAIT);
+    set_if(&flags, c, ECX_PCID, CPU_FEATURE_PCID);
+    set_if(&flags, c, ECX_X2APIC, CPU_FEATURE_X2APIC);
+    set_if(&flags, c, ECX_TSC_DEADLINE, CPU_FEATURE_TSC_DEADLINE);
+    set_if(&flags, c, ECX_XSAVE, CPU_FEATURE_XSAVE);
+    set_if(&flags, c, ECX_OSXSAVE, CPU_FEATURE_OSXSAVE);
+    set_if(&flags, c, ECX_RDRAND, CPU_FEATURE_RDRAND);
+    uint32_t avx = c & ECX_AVX;
+
+    // xgetbv faults unless CR4.OSXSAVE is set, which OSXSAVE mirrors
+    if (c & ECX_OSXSAVE) f->xcr0 = xgetbv(0);
+    int avx_state = (f->xcr0 & (XCR0_SSE | XCR0_AVX)) == (XCR0_SSE | XCR0_AVX);
+    if (avx && avx_state) flags |= 1ull << CPU_FEATURE_AVX;
+
+    if (f->max_leaf >= CPUID_EXTENDED) {
+        cpu_cpuid(CPUID_EXTENDED, 0, &a, &b, &c, &d);
+        set_if(&flags, b, EBX7_ERMS, CPU_FEATURE_ERMS);
+        set_if(&flags, b, EBX7_INVPCID, CPU_FEATURE_INVPCID);
+        set_if(&flags, d, EDX7_FSRM, CPU_FEATURE_FSRM);
+        if (avx && avx_state) set_if(&flags, b, EBX7_AVX2, CPU_FEATURE_AVX2);
+        if (avx && avx_state && (f->xcr0 & XCR0_AVX512) == XCR0_AVX512)
+            set_if(&flags, b, EBX7_AVX512F, CPU_FEATURE_AVX512F);
+    }
+
+    cpu_cpuid(CPUID_EXT_MAX, 0, &a, &b, &c, &d);
+    f->max_ext_leaf = a;
+    if (f->max_ext_leaf >= CPUID_EXT_BASIC) {
+        cpu_cpuid(CPUID_EXT_BASIC, 0, &a, &b, &c, &d);
+        set_if(&flags, d, EDX_EXT_NX, CPU_FEATURE_NX);
+        set_if(&flags, d, EDX_EXT_PAGE1GB, CPU_FEATURE_PAGE1GB);
+        set_if(&flags, d, EDX_EXT_RDTSCP, CPU_FEATURE_RDTSCP);
+    }
+    if (f->max_ext_leaf >= CPUID_EXT_POWER) {
+        cpu_cpuid(CPUID_EXT_POWER, 0, &a, &b, &c, &d);
+        set_if(&flags, d, EDX_POWER_INVARIANT, CPU_FEATURE_INVARIANT_TSC);
+    }
+    f->flags = flags;
+
+    serial_write("[CPU] ");
+    serial_write(f->vendor);
+    serial_write(" family ");
+    serial_write_dec(f->family);
+    serial_write(" model ");
+    serial_write_dec(f->model);
+    serial_write(" stepping ");
+    serial_write_dec(f->stepping);
+    serial_write(" xcr0 ");
+    serial_write_hex(f->xcr0);
+    serial_write("\n[CPU]");
+    for (uint32_t i = 0; i < CPU_FEATURE_COUNT; i++) {
+        if (!cpu_has(i)) continue;
+        serial_putc(' ');
+        serial_write(feature_names[i]);
+    }
+    serial_putc('\n');
+}
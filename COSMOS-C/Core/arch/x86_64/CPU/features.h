@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+// CPU features, read once at boot from CPUID and XCR0 (cpu_features_init).
+// Flags that need OS-enabled register state (AVX, AVX2, AVX-512) are only
+// set when XCR0 enables that state; the kernel leaves CR4.OSXSAVE off, so
+// they stay clear and `xcr0` is 0 until something turns XSAVE on.
+
+// Bit numbers in cpu_features.flags. Plain literals: ALTERNATIVE() pastes
+// them into assembler directives (CPU/alternative.h).
+#define CPU_FEATURE_APIC           0
+#define CPU_FEATURE_NX             1
+#define CPU_FEATURE_PAGE1GB        2
+#define CPU_FEATURE_RDTSCP         3
+#define CPU_FEATURE_INVARIANT_TSC  4
+#define CPU_FEATURE_TSC_DEADLINE   5
+#define CPU_FEATURE_X2APIC         6
+#define CPU_FEATURE_PCID           7
+#define CPU_FEATURE_INVPCID        8
+#define CPU_FEATURE_MWAIT          9
+#define CPU_FEATURE_RDRAND         10
+#define CPU_FEATURE_SSE4_2         11
+#define CPU_FEATURE_XSAVE          12
+#define CPU_FEATURE_OSXSAVE        13
+#define CPU_FEATURE_AVX            14
+#define CPU_FEATURE_AVX2           15
+#define CPU_FEATURE_AVX512F        16
+#define CPU_FEATURE_ERMS           17    // enhanced rep movsb/stosb
+#define CPU_FEATURE_FSRM           18    // fast short rep movsb
+#define CPU_FEATURE_COUNT          19
+
+struct cpu_features {
+    char vendor[13];            // "GenuineIntel", "AuthenticAMD", ...
+    uint32_t family;
+    uint32_t model;
+    uint32_t stepping;
+    uint32_t max_leaf;
+    uint32_t max_ext_leaf;
+    uint64_t xcr0;              // enabled XSAVE state, 0 without OSXSAVE
+    uint64_t flags;             // 1 << CPU_FEATURE_*
+};
+
+extern struct cpu_features cpu_features;
+
+// Fills cpu_features and writes them to COM1. First thing after serial_init().
+void cpu_features_init(void);
+
+static inline int cpu_has(uint32_t feature) {
+    return (int)((cpu_features.flags >> feature) & 1);
+}
+
+const char* cpu_feature_name(uint32_t feature);
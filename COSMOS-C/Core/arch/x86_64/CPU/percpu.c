@@ -0,0 +1,16 @@
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "compiler.h"
+#include <stdint.h>
+
+// single CPU for now
+static struct percpu boot_cpu;
+
+// GS base points at the block while running in the kernel; KERNEL_GS_BASE
+// holds the user value (0) until `swapgs` exchanges the two.
+__init void percpu_init(void) {
+    boot_cpu.self = &boot_cpu;
+    boot_cpu.cpu_id = 0;
+    cpu_wrmsr(MSR_GS_BASE, (uint64_t)&boot_cpu);
+    cpu_wrmsr(MSR_KERNEL_GS_BASE, 0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+struct interrupt_frame;
+struct prof_ring;
+struct ftrace_ring;
+struct irqsoff_cpu;
+
+// Per-CPU block, reached through the GS base while in the kernel. Entry code
+// coming from ring 3 runs `swapgs` first (see SYSCALL/syscall.asm).
+struct percpu {
+    struct percpu* self;       // lets C read the block address with one gs load
+    uint64_t kernel_rsp;       // stack for SYSCALL entry (same as TSS.RSP0)
+    uint64_t user_rsp;         // user rsp, parked during SYSCALL entry
+    uint64_t user_enter_rsp;   // kernel rsp saved by user_enter(), 0 while no program runs
+    uint64_t irq_rsp;          // top of the IRQ stack (MM/stack.h)
+    uint64_t irq_depth;        // interrupts on it, isr.asm switches at 0 -> 1
+    uint32_t cpu_id;
+    struct interrupt_frame* irq_frame;  // IRQ being handled (irq_frame())
+    struct prof_ring* prof_ring;        // profiler samples (Core/prof)
+    struct ftrace_ring* ftrace_ring;    // function trace events (Core/trace)
+    struct irqsoff_cpu* irqsoff;        // interrupts-off sections (Core/trace)
+    uint64_t main_rsp;                  // main loop stack, kernel_main() moves to it
+};
+
+// offsets used by the assembly entry code
+#define PERCPU_SELF            0
+#define PERCPU_KERNEL_RSP      8
+#define PERCPU_USER_RSP        16
+#define PERCPU_USER_ENTER_RSP  24
+#define PERCPU_IRQ_RSP         32
+#define PERCPU_IRQ_DEPTH       40
+
+_Static_assert(offsetof(struct percpu, kernel_rsp) == PERCPU_KERNEL_RSP, "percpu layout");
+_Static_assert(offsetof(struct percpu, user_rsp) == PERCPU_USER_RSP, "percpu layout");
+_Static_assert(offsetof(struct percpu, user_enter_rsp) == PERCPU_USER_ENTER_RSP, "percpu layout");
+_Static_assert(offsetof(struct percpu, irq_rsp) == PERCPU_IRQ_RSP, "percpu layout");
+_Static_assert(offsetof(struct percpu, irq_depth) == PERCPU_IRQ_DEPTH, "percpu layout");
+
+#define MSR_GS_BASE        0xC0000101
+#define MSR_KERNEL_GS_BASE 0xC0000102
+
+void percpu_init(void);
+
+static inline struct percpu* this_cpu(void) {
+    struct percpu* p;
+    __asm__ ("movq %%gs:0, %0" : "=r"(p));
+    return p;
+}
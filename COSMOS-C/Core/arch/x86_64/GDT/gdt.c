@@ -0,0 +1,75 @@
+#include "arch/x86_64/GDT/gdt.h"
+#include "compiler.h"
+#include <stdint.h>
+
+// ===================== DESCRIPTORS =====================
+// In long mode base/limit are ignored for code and data; only the access
+// byte (P, DPL, type) and the L/D flags matter.
+#define GDT_NULL         0
+#define GDT_CODE64(dpl)  (0x00AF9A000000FFFFull | ((uint64_t)(dpl) << 45))
+#define GDT_DATA(dpl)    (0x00CF92000000FFFFull | ((uint64_t)(dpl) << 45))
+
+#define TSS_TYPE_AVAIL   0x89 // present, 64-bit TSS (available)
+
+#define GDT_ENTRIES      7    // null, 4 segments, TSS (2 slots)
+
+struct gdt_ptr {
+    uint16_t limit;
+    uint64_t base;
+} __attribute__((packed));
+
+static uint64_t gdt[GDT_ENTRIES] __attribute__((aligned(16)));
+static struct gdt_ptr gdtp;
+
+struct tss tss __attribute__((aligned(16)));
+
+static void gdt_set_tss(int n, uint64_t base, uint32_t limit) {
+    gdt[n] = (limit & 0xFFFF)
+           | ((base & 0xFFFFFF) << 16)
+           | ((uint64_t)TSS_TYPE_AVAIL << 40)
+           | ((uint64_t)((limit >> 16) & 0xF) << 48)
+           | (((base >> 24) & 0xFF) << 56);
+    gdt[n + 1] = base >> 32;
+}
+
+// ===================== INIT =====================
+// Replaces the minimal boot GDT from main.asm (null + code) with kernel and
+// user segments plus the TSS.
+__init void gdt_init(void) {
+    gdt[0] = GDT_NULL;
+    gdt[GDT_KERNEL_CS >> 3] = GDT_CODE64(0);
+    gdt[GDT_KERNEL_DS >> 3] = GDT_DATA(0);
+    gdt[GDT_USER_DS >> 3]   = GDT_DATA(3);
+    gdt[GDT_USER_CS >> 3]   = GDT_CODE64(3);
+
+    tss.iomap_base = sizeof(tss); // no I/O permission bitmap; stacks: stack_init()
+    gdt_set_tss(GDT_TSS >> 3, (uint64_t)&tss, sizeof(tss) - 1);
+
+    gdtp.limit = sizeof(gdt) - 1;
+    gdtp.base  = (uint64_t)&gdt;
+    __asm__ volatile ("lgdt %0" : : "m"(gdtp));
+
+    // reload CS with a far return, then the data segments. fs/gs stay null:
+    // writing them would clear the GS base that percpu_init() sets up.
+    __asm__ volatile (
+        "pushq %0\n\t"
+        "leaq 1f(%%rip), %%rax\n\t"
+        "pushq %%rax\n\t"
+        "lretq\n"
+        "1:\n\t"
+        "movw %w1, %%ax\n\t"
+        "movw %%ax, %%ds\n\t"
+        "movw %%ax, %%es\n\t"
+        "movw %%ax, %%ss\n\t"
+        "xorw %%ax, %%ax\n\t"
+        "movw %%ax, %%fs\n\t"
+        "movw %%ax, %%gs"
+        : : "i"(GDT_KERNEL_CS), "i"(GDT_KERNEL_DS) : "rax", "memory");
+
+    __asm__ volatile ("ltr %w0" : : "r"((uint16_t)GDT_TSS));
+}
+
+// Stack the CPU switches to when an interrupt or exception arrives in ring 3
+void tss_set_rsp0(uint64_t rsp) {
+    tss.rsp[0] = rsp;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== SELECTORS =====================
+// Layout is fixed by SYSCALL/SYSRET (see STAR in SYSCALL/syscall.c):
+// SYSCALL loads CS=KERNEL_CS, SS=KERNEL_CS+8; SYSRET loads SS=STAR[63:48]+8
+// and CS=STAR[63:48]+16, so user data has to come right before user code.
+#define GDT_KERNEL_CS   0x08
+#define GDT_KERNEL_DS   0x10
+#define GDT_USER_DS     (0x18 | 3)
+#define GDT_USER_CS     (0x20 | 3)
+#define GDT_TSS         0x28
+
+// ===================== IST =====================
+// Interrupt stack table slots (1-based, 0 = no stack switch), filled by
+// stack_init() (MM/stack.h). Faults that must not nest on the interrupted
+// stack: it may be the one that overflowed, or be in an unknown state.
+#define IST_DOUBLE_FAULT  1
+#define IST_NMI           2
+#define IST_MACHINE_CHECK 3
+
+struct tss {
+    uint32_t reserved0;
+    uint64_t rsp[3];        // stack loaded on a switch to ring 0..2
+    uint64_t reserved1;
+    uint64_t ist[7];        // IST1..IST7
+    uint64_t reserved2;
+    uint16_t reserved3;
+    uint16_t iomap_base;
+} __attribute__((packed));
+
+extern struct tss tss;
+
+void gdt_init(void);
+void tss_set_rsp0(uint64_t rsp);
@@ -1,4 +1,6 @@
 #include "arch/x86_64/IDT/idt.h"
+#include "arch/x86_64/GDT/gdt.h"
+#include "compiler.h"
 #include <stdint.h>
 
 struct idt_entry {
@@ -16,7 +18,7 @@ struct idt_ptr {
     uint64_t base;
 } __attribute__((packed));
 
-#define KERNEL_CS 0x08
+#define KERNEL_CS GDT_KERNEL_CS
 
 static struct idt_entry idt[IDT_ENTRIES];
 static struct idt_ptr idtp;
@@ -31,6 +33,11 @@ void set_idt_gate(int n, uint64_t handler, uint8_t flags) {
     idt[n].zero        = 0;
 }
 
+// Run the handler for vector n on TSS interrupt stack `ist` (1..7, 0 = off)
+void idt_set_ist(int n, uint8_t ist) {
+    idt[n].ist = ist;
+}
+
 /* Extern stubs defined in isr.asm (we will create them explicitly there) */
 extern void isr0();
 extern void isr1();
@@ -82,7 +89,7 @@ extern void irq45();
 extern void irq46();
 extern void irq47();
 
-void idt_init(void) {
+__init void idt_init(void) {
     /* zero out IDT */
     for (int i = 0; i < IDT_ENTRIES; i++) {
         set_idt_gate(i, 0, 0);
@@ -122,6 +129,9 @@ void idt_init(void) {
     set_idt_gate(29, (uint64_t)isr29, int_gate);
     set_idt_gate(30, (uint64_t)isr30, int_gate);
     set_idt_gate(31, (uint64_t)isr31, int_gate);
+    idt_set_ist(2, IST_NMI);
+    idt_set_ist(8, IST_DOUBLE_FAULT);
+    idt_set_ist(18, IST_MACHINE_CHECK);
 
     /* IRQs — map to 32..47 */
     set_idt_gate(32, (uint64_t)irq32, int_gate);
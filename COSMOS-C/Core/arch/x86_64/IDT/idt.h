@@ -7,5 +7,6 @@
 
 void idt_init(void);
 void set_idt_gate(int n, uint64_t handler, uint8_t flags);
+void idt_set_ist(int n, uint8_t ist);
 
 #endif
\ No newline at end of file
@@ -1,50 +1,313 @@
 #include <stdint.h>
+#include "compiler.h"
 #include "HAL/console/print.h"
 #include "arch/x86_64/PIC/pic.h"
+#include "arch/x86_64/APIC/lapic.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "Core/arch/x86_64/TIMER/LAPIC/lapic_timer.h"
 #include "Drivers/PS2/keyboard/ps2.h"
-#include "Core/arch/x86_64/TIMER/PIT/pit.h"
 #include "Core/arch/x86_64/TIMER/timer.h"
+#include "arch/x86_64/IRQ/isr.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "arch/x86_64/IDT/idt.h"
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include "arch/x86_64/MM/page_fault.h"
+#include "arch/x86_64/MM/stack.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "Drivers/serial/serial.h"
+#include "sync/atomic.h"
+#include "sync/spinlock.h"
+#include "lib/errno.h"
+#include "prof/ksyms.h"
+#include "arch/x86_64/NMI/nmi.h"
+#ifdef IRQSOFF
+#include "trace/irqsoff.h"
+#endif
+#ifdef KBENCH
+#include "kbench/kbench.h"
+#endif
 
 // Forward declare PIC send EOI and keyboard handler
 extern void pic_send_eoi(unsigned char irq);
 extern void keyboard_irq_handler(void);
 
-// C handler called from assembly with vector in rdi
-void isr_handler(uint64_t vector) {
+static const char* const exception_names[32] = {
+    "Divide error", "Debug", "NMI", "Breakpoint", "Overflow", "Bound range",
+    "Invalid opcode", "Device not available", "Double fault", "Coprocessor overrun",
+    "Invalid TSS", "Segment not present", "Stack fault", "General protection",
+    "Page fault", "Reserved", "x87 FPU error", "Alignment check", "Machine check",
+    "SIMD error", "Virtualization", "Control protection", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Reserved", "Hypervisor injection",
+    "VMM communication", "Security", "Reserved",
+};
+
+// ===================== HANDLER TABLE =====================
+struct irq_action {
+    irq_handler_t handler;
+    void* ctx;
+};
+
+static struct irq_action irq_actions[IRQ_LINES][IRQ_MAX_SHARED];
+
+// No locking against isr_handler(): the handler pointer is published last,
+// so an interrupt in between sees either no slot or a complete one. Lines
+// that are already live (IRQ0 for the profiler's clockevent) work too.
+int irq_register(uint8_t irq, irq_handler_t handler, void* ctx) {
+    if (irq >= IRQ_LINES) return -1;
+    for (int i = 0; i < IRQ_MAX_SHARED; i++) {
+        if (irq_actions[irq][i].handler) continue;
+        irq_actions[irq][i].ctx = ctx;
+        atomic_write(&irq_actions[irq][i].handler, handler, MO_RELEASE);
+        pic_unmask(irq);
+        return 0;
+    }
+    return -1;
+}
+
+// ===================== MSI VECTORS =====================
+#define IRQ_VECTORS      (IRQ_VECTOR_END - IRQ_VECTOR_BASE)
+#define MSI_MAX_BLOCK    32
+
+struct vector_action {
+    irq_handler_t handler;
+    void* ctx;
+    uint32_t apic_id;       // destination, fixed at allocation
+    uint8_t used;
+};
+
+extern const uint64_t irq_vector_stubs[IRQ_VECTORS];     // isr.asm
+
+static struct vector_action vector_actions[IRQ_VECTORS];
+static spinlock_t vector_lock = SPINLOCK_INIT("irq vectors");
+
+// single CPU for now (CPU/percpu.c): CPU 0 is the boot CPU's LAPIC
+static int cpu_apic_id(uint32_t cpu, uint32_t* apic_id) {
+    if (cpu != 0) return -EINVAL;
+    if (!lapic_present()) return -ENODEV;
+    *apic_id = lapic_id();
+    return 0;
+}
+
+static int block_free(uint32_t first, uint32_t count) {
+    for (uint32_t v = first; v < first + count; v++)
+        if (v == SYSCALL_VECTOR || vector_actions[v - IRQ_VECTOR_BASE].used) return 0;
+    return 1;
+}
+
+int irq_vector_alloc(uint32_t count, uint32_t cpu) {
+    if (count == 0 || count > MSI_MAX_BLOCK || (count & (count - 1))) return -EINVAL;
+    uint32_t apic_id;
+    int err = cpu_apic_id(cpu, &apic_id);
+    if (err < 0) return err;
+
+    int first = -ENOSPC;
+    uint64_t flags = spin_lock_irqsave(&vector_lock);
+    for (uint32_t v = (IRQ_VECTOR_BASE + count - 1) & ~(count - 1); v + count <= IRQ_VECTOR_END; v += count) {
+        if (!block_free(v, count)) continue;
+        for (uint32_t i = v; i < v + count; i++) {
+            struct vector_action* a = &vector_actions[i - IRQ_VECTOR_BASE];
+            a->used = 1;
+            a->apic_id = apic_id;
+            set_idt_gate((int)i, irq_vector_stubs[i - IRQ_VECTOR_BASE], 0x8E);
+        }
+        first = (int)v;
+        break;
+    }
+    spin_unlock_irqrestore(&vector_lock, flags);
+    return first;
+}
+
+// Same publication order as irq_register()
+int irq_vector_set_handler(uint8_t vector, irq_handler_t handler, void* ctx) {
+    if (vector < IRQ_VECTOR_BASE || vector >= IRQ_VECTOR_END) return -EINVAL;
+    struct vector_action* a = &vector_actions[vector - IRQ_VECTOR_BASE];
+    if (!a->used) return -EINVAL;
+    a->ctx = ctx;
+    atomic_write(&a->handler, handler, MO_RELEASE);
+    return 0;
+}
+
+void irq_vector_msi(uint8_t vector, uint64_t* addr, uint32_t* data) {
+    *addr = LAPIC_MSI_ADDR(vector_actions[vector - IRQ_VECTOR_BASE].apic_id);
+    *data = vector;
+}
+
+struct interrupt_frame* irq_frame(void) {
+    return this_cpu()->irq_frame;
+}
+
+// ===================== PANIC =====================
+static void panic_reg(const char* name, uint64_t value) {
+    serial_write(name);
+    serial_write_hex(value);
+    serial_write("\n");
+}
+
+// Faults are restartable: returning would run the faulting instruction again,
+// so anything we can't fix ends here.
+void isr_panic(struct interrupt_frame* frame, const char* reason) {
+    __asm__ volatile ("cli");
+
+    // COM1 first: it has no lock, the screen does and may be what faulted
+    serial_write("\nKERNEL PANIC: ");
+    serial_write(reason);
+    serial_write("\n");
+    panic_reg("  vector ", frame->vector);
+    panic_reg("  error  ", frame->error_code);
+    panic_reg("  rip    ", frame->rip);
+    uint64_t offset;
+    const char* sym = ksym_lookup(frame->rip, &offset);
+    if (sym) {
+        serial_write("          ");
+        serial_write(sym);
+        serial_write("+");
+        serial_write_hex(offset);
+        serial_write("\n");
+    }
+    panic_reg("  cs     ", frame->cs);
+    panic_reg("  rflags ", frame->rflags);
+    panic_reg("  rsp    ", frame->rsp);
+    panic_reg("  rax    ", frame->rax);
+    panic_reg("  rbx    ", frame->rbx);
+    panic_reg("  rcx    ", frame->rcx);
+    panic_reg("  rdx    ", frame->rdx);
+    panic_reg("  rsi    ", frame->rsi);
+    panic_reg("  rdi    ", frame->rdi);
+    panic_reg("  rbp    ", frame->rbp);
+
+    // one string, so the console lock is tried once
+    char msg[96];
+    size_t n = 0;
+    const char* parts[] = { "\nKERNEL PANIC: ", reason, " (vector " };
+    for (size_t p = 0; p < sizeof(parts) / sizeof(parts[0]); p++)
+        for (const char* c = parts[p]; *c && n < sizeof(msg) - 8; c++) msg[n++] = *c;
+    uint64_t v = frame->vector;
+    if (v >= 100) msg[n++] = (char)('0' + v / 100);
+    if (v >= 10) msg[n++] = (char)('0' + v / 10 % 10);
+    msg[n++] = (char)('0' + v % 10);
+    msg[n++] = ')';
+    msg[n++] = '\n';
+    msg[n] = '\0';
+    if (print_panic(msg) < 0) serial_write("(console busy, screen message dropped)\n");
+
+    for (;;) __asm__ volatile ("cli; hlt");
+}
+
+// The #PF on the guard page could not push its frame on the overflowed
+// stack either; CR2 still holds the guard address
+static void double_fault_handler(struct interrupt_frame* frame) {
+    const struct kstack* s = stack_guard_hit(cpu_read_cr2());
+    if (!s) s = stack_guard_hit(frame->rsp);
+    if (s) {
+        serial_write("[STACK] ");
+        serial_write(s->name);
+        serial_write(" overflowed, size=");
+        serial_write_dec(s->top - s->base);
+        serial_write("\n");
+    }
+    isr_panic(frame, s ? "Kernel stack overflow" : exception_names[8]);
+}
+
+// A program in ring 3 that raises an exception ends with -EFAULT out of
+// exec_run() instead of taking the kernel down. #PF goes through
+// page_fault_handler() first (demand paging); NMI and machine check are
+// not the program's doing and a double fault is the kernel's own stack.
+static int user_exception(uint64_t vector) {
+    return vector != 2 && vector != 8 && vector != 14 && vector != 18;
+}
+
+static void user_fault(struct interrupt_frame* frame) {
+    serial_write("[USER] ");
+    serial_write(exception_names[frame->vector]);
+    serial_write(" at rip ");
+    serial_write_hex(frame->rip);
+    serial_write(", program ended (-EFAULT)\n");
+    sys_exit((uint64_t)-EFAULT, 0, 0, 0, 0, 0);
+}
+
+#ifdef IRQSOFF
+// Handler an interrupts-off section is charged to: the first one on a shared line
+static const void* irq_site(uint64_t vector) {
+    if (vector == 33) return keyboard_irq_handler;
+    if (vector >= 32 && vector <= 47 && irq_actions[vector - 32][0].handler)
+        return irq_actions[vector - 32][0].handler;
+    if (vector == LAPIC_TIMER_VECTOR) return lapic_timer_interrupt;
+    if (vector >= IRQ_VECTOR_BASE && vector < IRQ_VECTOR_END && vector_actions[vector - IRQ_VECTOR_BASE].handler)
+        return vector_actions[vector - IRQ_VECTOR_BASE].handler;
+    return isr_handler;
+}
+#endif
+
+// C handler called from assembly with the frame in rdi
+__hot void isr_handler(struct interrupt_frame* frame) {
+    uint64_t vector = frame->vector;
+#ifdef KBENCH
+    // empty round trip for the interrupt latency benchmark
+    if (vector == KBENCH_VECTOR) return;
+#endif
+
     if (vector <= 31) {
         // CPU exception
-        print_str("Exception vector: ");
-        print_int((int)vector);
-        print_str("\n");
-        // For now: just return (or halt) - in dev you might halt
-        // __asm__ volatile ("cli; hlt");
-        return;
+        if ((frame->cs & 3) && user_exception(vector)) user_fault(frame);
+        switch (vector) {
+            case 2:  // NMI: the watchdog's, or hardware trouble
+                nmi_handler(frame);
+                return;
+            case 8:  // on its own IST stack: a fault that hit a stack guard ends up here
+                double_fault_handler(frame);
+                return;
+            case 14: // page fault
+                page_fault_handler(frame);
+                return;
+            case 3:  // breakpoint is a trap, execution continues after int3
+                print_str("Exception vector: 3\n");
+                return;
+            default:
+                isr_panic(frame, exception_names[vector]);
+        }
     }
 
+    struct percpu* cpu = this_cpu();
+    struct interrupt_frame* outer = cpu->irq_frame;
+    cpu->irq_frame = frame;
+#ifdef IRQSOFF
+    irqsoff_irq_enter();
+#endif
+
     if (vector >= 32 && vector <= 47) {
         unsigned char irq = (unsigned char)(vector - 32);
         // dispatch common IRQs here
         switch (irq) {
-            case 0:  // PIT timer IRQ0
-                timer_tick();
-                break;
             case 1: // keyboard
                 keyboard_irq_handler();
                 break;
             default:
-                // other IRQs we don't handle yet
+                // registered drivers, every handler on a shared line runs
+                for (int i = 0; i < IRQ_MAX_SHARED && irq_actions[irq][i].handler; i++)
+                    irq_actions[irq][i].handler(irq_actions[irq][i].ctx);
                 break;
         }
 
         // send EOI to PICs
         pic_send_eoi(irq);
-        return;
+    } else if (vector >= IRQ_VECTOR_BASE && vector < IRQ_VECTOR_END) {
+        // MSI: one handler per vector, edge triggered, EOI to the LAPIC
+        struct vector_action* a = &vector_actions[vector - IRQ_VECTOR_BASE];
+        irq_handler_t handler = atomic_read(&a->handler, MO_ACQUIRE);
+        if (handler) handler(a->ctx);
+        lapic_eoi();
+    } else if (vector == LAPIC_TIMER_VECTOR) {
+        lapic_timer_interrupt();
+    } else if (vector != LAPIC_SPURIOUS_VECTOR) { // no EOI for spurious interrupts
+        print_str("Unhandled vector: ");
+        print_int((int)vector);
+        print_str("\n");
     }
 
-    // unexpected vector
-    print_str("Unhandled vector: ");
-    print_int((int)vector);
-    print_str("\n");
+#ifdef IRQSOFF
+    irqsoff_irq_exit((uint32_t)vector, irq_site(vector));
+#endif
+    cpu->irq_frame = outer;
 }
 
 // enable interrupts (wrapper)
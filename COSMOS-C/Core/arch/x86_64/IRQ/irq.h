@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+// Handlers for the legacy lines that isr_handler() does not dispatch itself
+// (everything but the keyboard; the PIT and HPET tick come through here). PCI INTx lines are shared, so
+// a line can have several handlers; each one checks its own device.
+
+#define IRQ_LINES       16
+#define IRQ_MAX_SHARED  4
+
+typedef void (*irq_handler_t)(void* ctx);
+
+struct interrupt_frame;
+
+// Adds the handler and unmasks the line, -1 when the line is full
+int irq_register(uint8_t irq, irq_handler_t handler, void* ctx);
+
+// ===================== MSI VECTORS =====================
+// Message signalled interrupts (PCI MSI/MSI-X) get IDT vectors of their
+// own instead of a legacy line: one handler per vector, nothing shared,
+// EOI to the LAPIC. A device queue with its own vector never has to ask
+// the device whose interrupt it was.
+#define IRQ_VECTOR_BASE  0x30   // right after the legacy lines, keep in sync with isr.asm
+#define IRQ_VECTOR_END   0xE0   // exclusive, below LAPIC_TIMER_VECTOR; int 0x80 is never handed out
+
+// `count` consecutive vectors, the first one a multiple of `count` (a power
+// of two, 32 at most: MSI puts the message number in the low bits),
+// delivered to `cpu`. First vector, -EINVAL for a bad count or CPU,
+// -ENODEV without a LAPIC, -ENOSPC when no such block is free.
+int irq_vector_alloc(uint32_t count, uint32_t cpu);
+// The IDT gate is live from allocation on; until a handler is set an
+// interrupt on it is only acknowledged
+int irq_vector_set_handler(uint8_t vector, irq_handler_t handler, void* ctx);
+// MSI address/data that raise `vector` on its CPU: fixed delivery, edge
+void irq_vector_msi(uint8_t vector, uint64_t* addr, uint32_t* data);
+
+// Frame of the interrupt being handled on this CPU, NULL outside of one.
+// Lets handlers that only get a ctx (profiler sample) see the interrupted
+// registers.
+struct interrupt_frame* irq_frame(void);
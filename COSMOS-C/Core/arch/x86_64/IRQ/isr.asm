@@ -1,17 +1,21 @@
 ; isr.asm - explicit ISR/IRQ stubs (Intel/NASM syntax) for x86_64
-; Each stub saves registers, pushes vector, then jumps to a common handler.
+; Each stub pushes a dummy error code if the CPU did not push one, saves the
+; registers, pushes the vector and jumps to the common handler. The result is
+; one frame layout for every vector, see struct interrupt_frame in isr.h.
 extern isr_handler
 
-section .text
+section .text.hot progbits alloc exec nowrite align=16
 global isr0,isr1,isr2,isr3,isr4,isr5,isr6,isr7
 global isr8,isr9,isr10,isr11,isr12,isr13,isr14,isr15
 global isr16,isr17,isr18,isr19,isr20,isr21,isr22,isr23
 global isr24,isr25,isr26,isr27,isr28,isr29,isr30,isr31
 global irq32,irq33,irq34,irq35,irq36,irq37,irq38,irq39
 global irq40,irq41,irq42,irq43,irq44,irq45,irq46,irq47
+global isr239,isr240,isr255
+global irq_vector_stubs
 global isr_common_stub
 
-%macro ISR_STUB 1
+%macro SAVE_REGS_AND_DISPATCH 1
     push r15
     push r14
     push r13
@@ -31,6 +35,17 @@ global isr_common_stub
     jmp isr_common_stub
 %endmacro
 
+; vectors without a CPU error code: push 0 so the frame has the same shape
+%macro ISR_STUB 1
+    push 0
+    SAVE_REGS_AND_DISPATCH %1
+%endmacro
+
+; vectors where the CPU already pushed an error code (8, 10-14, 17, 21, 29, 30)
+%macro ISR_STUB_ERR 1
+    SAVE_REGS_AND_DISPATCH %1
+%endmacro
+
 isr0:  ISR_STUB 0
 isr1:  ISR_STUB 1
 isr2:  ISR_STUB 2
@@ -39,20 +54,20 @@ isr4:  ISR_STUB 4
 isr5:  ISR_STUB 5
 isr6:  ISR_STUB 6
 isr7:  ISR_STUB 7
-isr8:  ISR_STUB 8
+isr8:  ISR_STUB_ERR 8
 isr9:  ISR_STUB 9
-isr10: ISR_STUB 10
-isr11: ISR_STUB 11
-isr12: ISR_STUB 12
-isr13: ISR_STUB 13
-isr14: ISR_STUB 14
+isr10: ISR_STUB_ERR 10
+isr11: ISR_STUB_ERR 11
+isr12: ISR_STUB_ERR 12
+isr13: ISR_STUB_ERR 13
+isr14: ISR_STUB_ERR 14
 isr15: ISR_STUB 15
 isr16: ISR_STUB 16
-isr17: ISR_STUB 17
+isr17: ISR_STUB_ERR 17
 isr18: ISR_STUB 18
 isr19: ISR_STUB 19
 isr20: ISR_STUB 20
-isr21: ISR_STUB 21
+isr21: ISR_STUB_ERR 21
 isr22: ISR_STUB 22
 isr23: ISR_STUB 23
 isr24: ISR_STUB 24
@@ -60,8 +75,8 @@ isr25: ISR_STUB 25
 isr26: ISR_STUB 26
 isr27: ISR_STUB 27
 isr28: ISR_STUB 28
-isr29: ISR_STUB 29
-isr30: ISR_STUB 30
+isr29: ISR_STUB_ERR 29
+isr30: ISR_STUB_ERR 30
 isr31: ISR_STUB 31
 
 irq32: ISR_STUB 32
@@ -81,10 +96,95 @@ irq45: ISR_STUB 45
 irq46: ISR_STUB 46
 irq47: ISR_STUB 47
 
-; common stub: vector is on top of stack
+; local APIC timer and spurious vectors (APIC/lapic.h)
+isr239: ISR_STUB 239
+isr255: ISR_STUB 255
+
+; software vector used by the kbench interrupt round-trip benchmark
+isr240: ISR_STUB 240
+
+; MSI/MSI-X vectors handed out by irq_vector_alloc(), IRQ_VECTOR_BASE up
+; to IRQ_VECTOR_END (irq.h); idt gates are set as they are allocated
+%define IRQ_VECTOR_BASE 0x30
+%define IRQ_VECTOR_END  0xE0
+
+%assign v IRQ_VECTOR_BASE
+%rep IRQ_VECTOR_END - IRQ_VECTOR_BASE
+vec%+v: ISR_STUB v
+%assign v v + 1
+%endrep
+
+section .rodata
+align 8
+irq_vector_stubs:
+%assign v IRQ_VECTOR_BASE
+%rep IRQ_VECTOR_END - IRQ_VECTOR_BASE
+    dq vec%+v
+%assign v v + 1
+%endrep
+
+section .text.hot
+
+; common stub: rsp points at the frame (vector on top)
+; 22 qwords are on the stack after the CPU aligned rsp, so the call is aligned.
+%define FRAME_CS 144    ; offsetof(struct interrupt_frame, cs)
+
+; keep in sync with CPU/percpu.h
+%define PERCPU_IRQ_RSP    32
+%define PERCPU_IRQ_DEPTH  40
+%define MSR_GS_BASE       0xC0000101
+
+; r12 (saved in the frame, callee-saved across isr_handler) is 1 when an
+; NMI or #MC swapped GS in ring 0 and has to swap it back
 isr_common_stub:
-    mov rdi, [rsp]      ; vector -> rdi (first arg)
+    xor r12d, r12d
+    test byte [rsp + FRAME_CS], 3
+    jz .kernel_entry
+    swapgs              ; from ring 3: gs -> per-CPU block
+    jmp .gs_ready
+.kernel_entry:
+    cmp qword [rsp], 2
+    je .paranoid
+    cmp qword [rsp], 18
+    jne .gs_ready
+.paranoid:
+    ; NMI/#MC in ring 0: they can land in the swapgs windows of syscall.asm
+    ; (SYSCALL entry, SYSRET/IRETQ exits), where the GS base is the user
+    ; one (0). Only the MSR tells; rax/rcx/rdx are in the frame.
+    mov ecx, MSR_GS_BASE
+    rdmsr
+    or eax, edx
+    jnz .gs_ready
+    swapgs
+    mov r12d, 1
+.gs_ready:
+    mov rdi, rsp        ; struct interrupt_frame* -> rdi (first arg)
+    cmp qword [rsp], 32
+    jb .exception       ; exceptions stay where they happened (or on their IST)
+
+    ; interrupts: the outermost one moves to the IRQ stack, nested ones are
+    ; on it already. rbx was saved in the frame and survives the call.
+    mov rbx, rsp
+    inc qword [gs:PERCPU_IRQ_DEPTH]
+    cmp qword [gs:PERCPU_IRQ_DEPTH], 1
+    jne .irq_call
+    mov rsp, [gs:PERCPU_IRQ_RSP]
+.irq_call:
+    call isr_handler
+    mov rsp, rbx
+    dec qword [gs:PERCPU_IRQ_DEPTH]
+    jmp .exit
+
+.exception:
     call isr_handler
+.exit:
+    test r12d, r12d
+    jnz .swap_exit
+    test byte [rsp + FRAME_CS], 3
+    jz .kernel_exit
+.swap_exit:
+    swapgs
+.kernel_exit:
     add rsp, 8           ; pop vector
     pop rax
     pop rcx
@@ -101,4 +201,5 @@ isr_common_stub:
     pop r13
     pop r14
     pop r15
+    add rsp, 8           ; pop error code
     iretq
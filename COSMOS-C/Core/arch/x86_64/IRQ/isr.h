@@ -3,6 +3,20 @@
 
 #include <stdint.h>
 
-void isr_handler(uint64_t vector);
+// Stack frame built by isr.asm, lowest address first
+struct interrupt_frame {
+    uint64_t vector;
+    uint64_t rax, rcx, rdx, rbx, rbp, rsi, rdi;
+    uint64_t r8, r9, r10, r11, r12, r13, r14, r15;
+    uint64_t error_code;     // 0 for vectors without one
+    uint64_t rip, cs, rflags, rsp, ss; // pushed by the CPU
+};
 
-#endif
\ No newline at end of file
+_Static_assert(sizeof(struct interrupt_frame) == 176, "isr.asm frame layout");
+
+void isr_handler(struct interrupt_frame* frame);
+
+// Prints the exception and the saved registers, then halts the CPU
+void isr_panic(struct interrupt_frame* frame, const char* reason);
+
+#endif
@@ -3,6 +3,22 @@
 
 #include <stdint.h>
 
+#ifdef COSMOS_HOSTED
+// Native (Linux) build: port I/O is routed to the stubs in host/hal_stub.c
+uint8_t hal_inb(uint16_t port);
+void hal_outb(uint16_t port, uint8_t val);
+uint16_t hal_inw(uint16_t port);
+void hal_outw(uint16_t port, uint16_t val);
+uint32_t hal_inl(uint16_t port);
+void hal_outl(uint16_t port, uint32_t val);
+
+static inline uint8_t inb(uint16_t port) { return hal_inb(port); }
+static inline void outb(uint16_t port, uint8_t val) { hal_outb(port, val); }
+static inline uint16_t inw(uint16_t port) { return hal_inw(port); }
+static inline void outw(uint16_t port, uint16_t val) { hal_outw(port, val); }
+static inline uint32_t inl(uint16_t port) { return hal_inl(port); }
+static inline void outl(uint16_t port, uint32_t val) { hal_outl(port, val); }
+#else
 static inline uint8_t inb(uint16_t port) {
     uint8_t ret;
     __asm__ volatile ("inb %1, %0" : "=a"(ret) : "Nd"(port));
@@ -23,4 +39,16 @@ static inline void outw(uint16_t port, uint16_t val) {
     __asm__ volatile ("outw %0, %1" : : "a"(val), "Nd"(port));
 }
 
+static inline uint32_t inl(uint16_t port) {
+    uint32_t ret;
+    __asm__ volatile ("inl %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
+}
+
+static inline void outl(uint16_t port, uint32_t val) {
+    __asm__ volatile ("outl %0, %1" : : "a"(val), "Nd"(port));
+}
+
+#endif
+
 #endif
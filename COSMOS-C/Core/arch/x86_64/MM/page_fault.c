@@ -0,0 +1,78 @@
+#include "arch/x86_64/MM/page_fault.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Drivers/serial/serial.h"
+#include "compiler.h"
+#include <stdint.h>
+
+struct pf_stats pf_stats;
+
+static const char* const fault_kind_names[VM_FAULT_KINDS] = {
+    "demand_zero", "zero_page", "cow_copy", "cow_reuse", "spurious", "bad", "oom",
+};
+
+// ===================== REPORT =====================
+static void report_bad_fault(struct interrupt_frame* frame, uintptr_t addr,
+                             enum vm_fault_result result) {
+    uint64_t err = frame->error_code;
+    const struct vm_region* r = vm_find(addr);
+
+    serial_write("[PF] unresolved fault at ");
+    serial_write_hex(addr);
+    serial_write(" rip ");
+    serial_write_hex(frame->rip);
+    serial_write(err & PF_PRESENT ? " protection" : " not-present");
+    serial_write(err & PF_WRITE ? " write" : " read");
+    if (err & PF_INSTR) serial_write(" exec");
+    serial_write(err & PF_USER ? " user" : " kernel");
+    if (err & PF_RSVD) serial_write(" reserved-bit");
+    serial_write(result == VM_FAULT_OOM ? " (out of memory)" : "");
+    serial_write(" region ");
+    serial_write(r ? r->name : "none");
+    serial_write("\n");
+}
+
+// ===================== HANDLER =====================
+// #PF: CR2 holds the address, the error code says what kind of access failed
+__hot void page_fault_handler(struct interrupt_frame* frame) {
+    uint64_t t0 = rdtsc();
+    uintptr_t addr = cpu_read_cr2();
+    enum vm_fault_result result = vm_handle_fault(addr, frame->error_code);
+
+    uint64_t cycles = rdtsc() - t0;
+    pf_stats.count[result]++;
+    pf_stats.cycles += cycles;
+    if (cycles > pf_stats.cycles_max) pf_stats.cycles_max = cycles;
+
+    if (result != VM_FAULT_BAD && result != VM_FAULT_OOM) return;
+
+    report_bad_fault(frame, addr, result);
+    // ring 3, or the kernel on a user pointer during one of the program's
+    // system calls: end the program, user_enter() returns -EFAULT
+    int in_program = this_cpu()->user_enter_rsp != 0;
+    if ((frame->cs & 3) || (in_program && addr >= USER_BASE && addr < USER_END)) {
+        sys_exit((uint64_t)-EFAULT, 0, 0, 0, 0, 0);
+    }
+    isr_panic(frame, "Page fault");
+}
+
+void pf_stats_report(void) {
+    uint64_t total = 0;
+    serial_write("[PF]");
+    for (int i = 0; i < VM_FAULT_KINDS; i++) {
+        serial_write(" ");
+        serial_write(fault_kind_names[i]);
+        serial_write("=");
+        serial_write_dec(pf_stats.count[i]);
+        total += pf_stats.count[i];
+    }
+    serial_write(" avg_ns=");
+    serial_write_dec(total ? tsc_cycles_to_ns(pf_stats.cycles / total) : 0);
+    serial_write(" max_ns=");
+    serial_write_dec(tsc_cycles_to_ns(pf_stats.cycles_max));
+    serial_write("\n");
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "arch/x86_64/IRQ/isr.h"
+#include "arch/x86_64/MM/vm.h"
+#include <stdint.h>
+
+// ===================== ERROR CODE =====================
+#define PF_PRESENT  (1u << 0)  // protection violation (0 = page not present)
+#define PF_WRITE    (1u << 1)
+#define PF_USER     (1u << 2)
+#define PF_RSVD     (1u << 3)  // reserved bit set in a paging entry
+#define PF_INSTR    (1u << 4)  // instruction fetch
+
+struct pf_stats {
+    uint64_t count[VM_FAULT_KINDS];
+    uint64_t cycles;           // total handler time (rdtsc), all kinds
+    uint64_t cycles_max;
+};
+
+extern struct pf_stats pf_stats;
+
+void page_fault_handler(struct interrupt_frame* frame);
+void pf_stats_report(void);
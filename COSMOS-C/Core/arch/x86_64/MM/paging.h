@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== SIZES =====================
+#define PAGE_SIZE       0x1000ull
+#define PAGE_SHIFT      12
+#define HUGE_PAGE_SIZE  0x200000ull
+#define PT_ENTRIES      512
+
+#define PAGE_ALIGN_DOWN(x) ((x) & ~(PAGE_SIZE - 1))
+#define PAGE_ALIGN_UP(x)   (((x) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+
+// ===================== ENTRY BITS =====================
+#define PTE_PRESENT     (1ull << 0)
+#define PTE_WRITE       (1ull << 1)
+#define PTE_USER        (1ull << 2)
+#define PTE_PWT         (1ull << 3)   // write-through
+#define PTE_PCD         (1ull << 4)   // cache disable (device memory)
+#define PTE_ACCESSED    (1ull << 5)
+#define PTE_DIRTY       (1ull << 6)
+#define PTE_HUGE        (1ull << 7)
+#define PTE_COW         (1ull << 9)   // software bit: read-only until copied
+#define PTE_NX          (1ull << 63)
+#define PTE_ADDR_MASK   0x000FFFFFFFFFF000ull
+
+// ===================== ADDRESS SPACE =====================
+// 0 .. 1 GiB          identity map from boot (2 MiB pages), kernel + RAM
+// 1 GiB .. 512 GiB    user space (rest of L4[0]), vm_map_phys() above 448 GiB
+// 0xFFFF8000_00000000 kernel virtual area (L4[256]), vm_reserve()
+#define IDENTITY_END    0x40000000ull
+#define USER_BASE       0x40000000ull
+#define USER_END        0x8000000000ull
+#define USER_MMAP_BASE  0x7000000000ull
+#define KERNEL_VM_BASE  0xFFFF800000000000ull
+#define KERNEL_VM_END   0xFFFF808000000000ull
+
+#define L4_INDEX(v) (((v) >> 39) & 0x1FF)
+#define L3_INDEX(v) (((v) >> 30) & 0x1FF)
+#define L2_INDEX(v) (((v) >> 21) & 0x1FF)
+#define L1_INDEX(v) (((v) >> 12) & 0x1FF)
@@ -0,0 +1,198 @@
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/boot/multiboot2.h"
+#include "arch/x86_64/boot/sections.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "sync/spinlock.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_RANGES     32
+#define MAX_RESERVED   16
+#define LOW_MEMORY_END 0x100000ull   // BIOS data, VGA, option ROMs
+
+struct phys_range {
+    uint64_t start;
+    uint64_t end;
+};
+
+// Usable RAM from the memory map minus everything in use at boot. Frames
+// are handed out from `next` upwards and only touched when allocated, so
+// boot time does not depend on the amount of RAM.
+static struct phys_range ranges[MAX_RANGES];
+static int range_count;
+static int range_cur;
+static uint64_t range_next;
+
+static struct phys_range reserved[MAX_RESERVED];
+static int reserved_count;
+
+// freed frames, linked through their first 8 bytes
+static uint64_t free_list;
+
+static uint16_t* frame_refs;     // indexed by frame number
+static uint64_t max_frame;
+static uint64_t total_pages;
+static uint64_t free_pages;
+
+static spinlock_t pmm_lock = SPINLOCK_INIT("pmm");
+
+// ===================== INIT =====================
+static __init void reserve(uint64_t start, uint64_t end) {
+    if (reserved_count < MAX_RESERVED && start < end)
+        reserved[reserved_count++] = (struct phys_range){ PAGE_ALIGN_DOWN(start), PAGE_ALIGN_UP(end) };
+}
+
+// Adds [start, end) without the reserved spans
+static __init void add_usable(uint64_t start, uint64_t end) {
+    start = PAGE_ALIGN_UP(start);
+    end = PAGE_ALIGN_DOWN(end);
+    if (start < LOW_MEMORY_END) start = LOW_MEMORY_END;
+    if (end > IDENTITY_END) end = IDENTITY_END;
+    if (start >= end) return;
+
+    for (int i = 0; i < reserved_count; i++) {
+        if (reserved[i].start < end && reserved[i].end > start) {
+            add_usable(start, reserved[i].start);
+            add_usable(reserved[i].end, end);
+            return;
+        }
+    }
+    if (range_count == MAX_RANGES) return;
+    ranges[range_count++] = (struct phys_range){ start, end };
+    total_pages += (end - start) >> PAGE_SHIFT;
+    if ((end >> PAGE_SHIFT) > max_frame) max_frame = end >> PAGE_SHIFT;
+}
+
+// Carves `size` bytes off the front of the first range that is big enough
+static __init void* early_alloc(uint64_t size) {
+    size = PAGE_ALIGN_UP(size);
+    for (int i = 0; i < range_count; i++) {
+        if (ranges[i].end - ranges[i].start >= size) {
+            void* p = (void*)(uintptr_t)ranges[i].start;
+            ranges[i].start += size;
+            total_pages -= size >> PAGE_SHIFT;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+__init void pmm_init(void) {
+    reserve((uintptr_t)__kernel_start, (uintptr_t)__kernel_end);
+    reserve(multiboot2_info_start(), multiboot2_info_end());
+    for (const struct mb2_tag* t = multiboot2_find(MB2_TAG_MODULE, NULL); t;
+         t = multiboot2_find(MB2_TAG_MODULE, t)) {
+        const struct mb2_tag_module* mod = (const struct mb2_tag_module*)t;
+        reserve(mod->mod_start, mod->mod_end);
+    }
+
+    const struct mb2_tag_mmap* mmap = (const struct mb2_tag_mmap*)multiboot2_find(MB2_TAG_MMAP, NULL);
+    if (!mmap) {
+        serial_write("[PMM] no memory map from the bootloader\n");
+        return;
+    }
+    for (uintptr_t p = (uintptr_t)mmap->entries; p + mmap->entry_size <= (uintptr_t)mmap + mmap->size;
+         p += mmap->entry_size) {
+        const struct mb2_mmap_entry* e = (const struct mb2_mmap_entry*)p;
+        if (e->type == MB2_MEMORY_AVAILABLE) add_usable(e->addr, e->addr + e->len);
+    }
+
+    frame_refs = early_alloc(max_frame * sizeof(uint16_t));
+    if (!frame_refs) {
+        range_count = 0;
+        total_pages = 0;
+        return;
+    }
+    memset(frame_refs, 0, max_frame * sizeof(uint16_t));
+
+    range_cur = 0;
+    range_next = range_count ? ranges[0].start : 0;
+    free_pages = total_pages;
+}
+
+// ===================== ALLOC / FREE =====================
+static uint64_t alloc_locked(void) {
+    if (free_list) {
+        uint64_t phys = free_list;
+        free_list = *(uint64_t*)(uintptr_t)phys;
+        return phys;
+    }
+    while (range_cur < range_count) {
+        if (range_next < ranges[range_cur].end) {
+            uint64_t phys = range_next;
+            range_next += PAGE_SIZE;
+            return phys;
+        }
+        if (++range_cur < range_count) range_next = ranges[range_cur].start;
+    }
+    return 0;
+}
+
+uint64_t pmm_alloc(void) {
+    uint64_t flags = spin_lock_irqsave(&pmm_lock);
+    uint64_t phys = alloc_locked();
+    if (phys) {
+        frame_refs[phys >> PAGE_SHIFT] = 1;
+        free_pages--;
+    }
+    spin_unlock_irqrestore(&pmm_lock, flags);
+    return phys;
+}
+
+uint64_t pmm_alloc_zeroed(void) {
+    uint64_t phys = pmm_alloc();
+    if (phys) memset((void*)(uintptr_t)phys, 0, PAGE_SIZE);
+    return phys;
+}
+
+void pmm_ref(uint64_t phys) {
+    uint64_t flags = spin_lock_irqsave(&pmm_lock);
+    frame_refs[phys >> PAGE_SHIFT]++;
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
+void pmm_free(uint64_t phys) {
+    uint64_t frame = phys >> PAGE_SHIFT;
+    if (frame >= max_frame) return;
+
+    uint64_t flags = spin_lock_irqsave(&pmm_lock);
+    if (frame_refs[frame] && --frame_refs[frame] == 0) {
+        *(uint64_t*)(uintptr_t)phys = free_list;
+        free_list = phys;
+        free_pages++;
+    }
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
+uint16_t pmm_refcount(uint64_t phys) {
+    uint64_t frame = phys >> PAGE_SHIFT;
+    return frame < max_frame ? atomic_read(&frame_refs[frame], MO_RELAXED) : 0;
+}
+
+void pmm_free_range(uint64_t start, uint64_t end) {
+    for (uint64_t p = PAGE_ALIGN_UP(start); p + PAGE_SIZE <= end; p += PAGE_SIZE) {
+        if ((p >> PAGE_SHIFT) >= max_frame) break;
+        uint64_t flags = spin_lock_irqsave(&pmm_lock);
+        frame_refs[p >> PAGE_SHIFT] = 1;
+        total_pages++;
+        spin_unlock_irqrestore(&pmm_lock, flags);
+        pmm_free(p);
+    }
+}
+
+// ===================== STATS =====================
+uint64_t pmm_total_pages(void) { return total_pages; }
+uint64_t pmm_free_pages(void) { return free_pages; }
+
+void pmm_report(void) {
+    serial_write("[PMM] ");
+    serial_write_dec(total_pages * 4);
+    serial_write(" KiB usable, ");
+    serial_write_dec(free_pages * 4);
+    serial_write(" KiB free, ");
+    serial_write_dec((uint64_t)range_count);
+    serial_write(" ranges\n");
+}
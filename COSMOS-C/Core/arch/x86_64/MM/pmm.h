@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+
+// Physical page allocator for 4 KiB frames below IDENTITY_END (reachable
+// through the boot identity map). Every frame has a 16-bit reference count
+// so copy-on-write mappings can share it.
+
+void pmm_init(void);
+
+uint64_t pmm_alloc(void);          // refcount 1, contents undefined, 0 = out of memory
+uint64_t pmm_alloc_zeroed(void);
+void pmm_ref(uint64_t phys);       // one more mapping
+void pmm_free(uint64_t phys);      // one mapping less, freed at 0
+uint16_t pmm_refcount(uint64_t phys);
+
+// Hands a range of the kernel image back (init memory), page aligned inward
+void pmm_free_range(uint64_t start, uint64_t end);
+
+uint64_t pmm_total_pages(void);
+uint64_t pmm_free_pages(void);
+void pmm_report(void);
@@ -0,0 +1,106 @@
+#include "arch/x86_64/MM/stack.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/GDT/gdt.h"
+#include "Drivers/serial/serial.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+static struct kstack stacks[STACK_MAX];
+static int stack_count;
+
+// ===================== ALLOCATION =====================
+uintptr_t stack_alloc(size_t size, const char* name) {
+    if (stack_count == STACK_MAX) return 0;
+    size = PAGE_ALIGN_UP(size);
+    uint64_t* base = vm_reserve(size, VM_READ | VM_WRITE, name);
+    if (!base) return 0;
+
+    // every page faults in here, with a stack to handle it on
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) base[i] = STACK_PAINT;
+
+    struct kstack* s = &stacks[stack_count++];
+    s->base = (uintptr_t)base;
+    s->top = (uintptr_t)base + size;
+    s->name = name;
+    return s->top;
+}
+
+static __init uintptr_t must_alloc(size_t size, const char* name) {
+    uintptr_t top = stack_alloc(size, name);
+    if (!top) {
+        serial_write("[STACK] no memory for ");
+        serial_write(name);
+        serial_write("\n");
+        for (;;) __asm__ volatile ("cli; hlt");
+    }
+    return top;
+}
+
+__init void stack_init(void) {
+    struct percpu* cpu = this_cpu();
+    cpu->main_rsp = must_alloc(MAIN_STACK_SIZE, "main");
+    cpu->kernel_rsp = must_alloc(SYSCALL_STACK_SIZE, "syscall");
+    tss_set_rsp0(cpu->kernel_rsp);
+    cpu->irq_rsp = must_alloc(IRQ_STACK_SIZE, "irq");
+    cpu->irq_depth = 0;
+
+    tss.ist[IST_DOUBLE_FAULT - 1] = must_alloc(IST_STACK_SIZE, "ist_df");
+    tss.ist[IST_NMI - 1] = must_alloc(IST_STACK_SIZE, "ist_nmi");
+    tss.ist[IST_MACHINE_CHECK - 1] = must_alloc(IST_STACK_SIZE, "ist_mc");
+}
+
+// rbp cleared: frame pointer walks (profiler, panics) end at fn
+void stack_switch(uintptr_t top, void (*fn)(void)) {
+    __asm__ volatile (
+        "movq %0, %%rsp\n\t"
+        "xorl %%ebp, %%ebp\n\t"
+        "callq *%1\n\t"
+        "ud2"
+        : : "r"(top), "r"(fn) : "memory");
+    __builtin_unreachable();
+}
+
+// ===================== LOOKUP =====================
+// Read from interrupt context (profiler, #DF): the registry only grows at boot
+const struct kstack* stack_find(uintptr_t addr) {
+    for (int i = 0; i < stack_count; i++) {
+        if (addr >= stacks[i].base && addr < stacks[i].top) return &stacks[i];
+    }
+    return NULL;
+}
+
+const struct kstack* stack_guard_hit(uintptr_t addr) {
+    for (int i = 0; i < stack_count; i++) {
+        if (addr >= stacks[i].base - PAGE_SIZE && addr < stacks[i].base) return &stacks[i];
+    }
+    return NULL;
+}
+
+// ===================== HIGH WATER =====================
+// Stacks grow down: the first word from the bottom that lost its paint
+size_t stack_high_water(const struct kstack* s) {
+    const uint64_t* p = (const uint64_t*)s->base;
+    const uint64_t* end = (const uint64_t*)s->top;
+    while (p < end && *p == STACK_PAINT) p++;
+    return (size_t)(s->top - (uintptr_t)p);
+}
+
+void stack_report(void) {
+    for (int i = 0; i < stack_count; i++) {
+        const struct kstack* s = &stacks[i];
+        size_t size = s->top - s->base;
+        size_t peak = stack_high_water(s);
+        serial_write("[STACK] ");
+        serial_write(s->name);
+        serial_write(" peak=");
+        serial_write_dec(peak);
+        serial_write(" size=");
+        serial_write_dec(size);
+        serial_write(" (");
+        serial_write_dec(peak * 100 / size);
+        serial_write("%)\n");
+    }
+}
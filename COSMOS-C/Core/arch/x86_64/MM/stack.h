@@ -0,0 +1,54 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernel stacks in vm regions. Every kernel reservation has an unmapped
+// page below it (the guard behind the previous reservation, or the
+// non-canonical hole under KERNEL_VM_BASE), so running off the bottom of a
+// stack faults instead of overwriting whatever came before. The fault can't
+// push its frame on that stack either and becomes a #DF, which runs on its
+// own IST stack and names the stack (stack_guard_hit()).
+//
+// Stacks are painted with STACK_PAINT when they are created. That also
+// backs every page up front: a stack must never demand fault, the #PF
+// handler would need the stack it is faulting on. stack_high_water()
+// finds the deepest word that was ever overwritten.
+
+#define STACK_PAINT         0x57ac57ac57ac57acull
+#define STACK_MAX           16
+
+// per CPU, see stack_init()
+#define MAIN_STACK_SIZE     (4096 * 4)   // main loop, after the boot stack
+#define SYSCALL_STACK_SIZE  (4096 * 4)   // TSS.RSP0: SYSCALL and ring 3 interrupts
+#define IRQ_STACK_SIZE      (4096 * 4)   // hardware interrupts, switched in isr.asm
+#define IST_STACK_SIZE      (4096 * 2)   // #DF, NMI, #MC
+
+struct kstack {
+    uintptr_t base;             // lowest address, the guard page is below
+    uintptr_t top;              // initial rsp
+    const char* name;
+};
+
+// Guarded, painted stack of `size` bytes (page granular). Returns its top,
+// 16-byte aligned, or 0 when out of address space, frames or slots.
+// Boot only: the registry is not locked.
+uintptr_t stack_alloc(size_t size, const char* name);
+
+// This CPU's stacks: main loop, RSP0, IRQ and the IST slots (GDT/gdt.h).
+// After gdt_init(), percpu_init() and idt_init(): painting demand faults
+// the pages in, still on the boot stack. Interrupts are off until the IST
+// slots are filled.
+void stack_init(void);
+
+// Moves the caller onto `top` and runs `fn`, which must not return. The
+// old stack is abandoned as is.
+__attribute__((noreturn)) void stack_switch(uintptr_t top, void (*fn)(void));
+
+const struct kstack* stack_find(uintptr_t addr);       // stack containing addr
+const struct kstack* stack_guard_hit(uintptr_t addr);  // stack whose guard holds addr
+
+// Deepest use since creation, in bytes from the top
+size_t stack_high_water(const struct kstack* s);
+
+// `[STACK] name peak=... size=...` per stack on COM1
+void stack_report(void);
@@ -0,0 +1,270 @@
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/MM/vmm.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/page_fault.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "lib/string.h"
+#include "sync/spinlock.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+static struct vm_region regions[MAX_VM_REGIONS];
+static int region_count;
+static uintptr_t kernel_vm_next = KERNEL_VM_BASE;
+static uintptr_t user_mmap_next = USER_MMAP_BASE;
+static uint64_t zero_frame;
+static uint64_t resident_pages;
+
+// regions and page tables; the fault path takes it too
+static spinlock_t vm_lock = SPINLOCK_INIT("vm");
+
+__init void vm_init(void) {
+    zero_frame = pmm_alloc_zeroed();
+}
+
+// ===================== REGIONS =====================
+static struct vm_region* find_locked(uintptr_t addr) {
+    for (int i = 0; i < region_count; i++) {
+        if (addr >= regions[i].start && addr < regions[i].end) return &regions[i];
+    }
+    return NULL;
+}
+
+static int overlaps_locked(uintptr_t start, uintptr_t end) {
+    for (int i = 0; i < region_count; i++) {
+        if (start < regions[i].end && end > regions[i].start) return 1;
+    }
+    return 0;
+}
+
+static int add_locked(uintptr_t start, uintptr_t end, uint32_t flags, const char* name) {
+    if (region_count == MAX_VM_REGIONS || overlaps_locked(start, end)) return -1;
+    regions[region_count++] = (struct vm_region){ start, end, flags, name };
+    return 0;
+}
+
+// Next free span of a bump-allocated window, followed by a guard page
+static void* reserve_locked(uintptr_t* next, uintptr_t limit, size_t size,
+                            uint32_t flags, const char* name) {
+    uintptr_t start = *next;
+    if (!size || start + size + PAGE_SIZE > limit) return NULL;
+    if (add_locked(start, start + size, flags, name) < 0) return NULL;
+    *next = start + size + PAGE_SIZE;
+    return (void*)start;
+}
+
+void* vm_reserve(size_t size, uint32_t flags, const char* name) {
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    void* result = reserve_locked(&kernel_vm_next, KERNEL_VM_END, PAGE_ALIGN_UP(size),
+                                  flags & ~VM_USER, name);
+    spin_unlock_irqrestore(&vm_lock, irq);
+    return result;
+}
+
+int vm_reserve_at(uintptr_t start, size_t size, uint32_t flags, const char* name) {
+    uintptr_t end = PAGE_ALIGN_UP(start + size);
+    start = PAGE_ALIGN_DOWN(start);
+    if (start < USER_BASE || end > USER_END || start >= end) return -1;
+
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    int ret = add_locked(start, end, flags | VM_USER, name);
+    spin_unlock_irqrestore(&vm_lock, irq);
+    return ret;
+}
+
+static void drop_page_locked(uintptr_t virt, uint32_t flags) {
+    uint64_t old = vmm_unmap(virt);
+    if (!(old & PTE_PRESENT) || (flags & VM_PHYS)) return;
+    uint64_t frame = old & PTE_ADDR_MASK;
+    if (frame != zero_frame) {
+        pmm_free(frame);
+        resident_pages--;
+    }
+}
+
+void vm_release(void* addr) {
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    struct vm_region* r = find_locked((uintptr_t)addr);
+    if (r) {
+        for (uintptr_t v = r->start; v < r->end; v += PAGE_SIZE) drop_page_locked(v, r->flags);
+        *r = regions[--region_count];
+    }
+    spin_unlock_irqrestore(&vm_lock, irq);
+}
+
+const struct vm_region* vm_find(uintptr_t addr) {
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    const struct vm_region* r = find_locked(addr);
+    spin_unlock_irqrestore(&vm_lock, irq);
+    return r;
+}
+
+uint64_t vm_resident_pages(void) {
+    return resident_pages;
+}
+
+// ===================== PAGE FLAGS =====================
+static uint64_t region_pte_flags(const struct vm_region* r) {
+    uint64_t f = PTE_PRESENT;
+    if (r->flags & VM_WRITE) f |= PTE_WRITE;
+    if (r->flags & VM_USER) f |= PTE_USER;
+    if (!(r->flags & VM_EXEC)) f |= vmm_nx;
+    return f;
+}
+
+// read-only view of a shared frame; writable regions get the COW mark
+static uint64_t shared_pte_flags(const struct vm_region* r) {
+    uint64_t f = region_pte_flags(r) & ~PTE_WRITE;
+    if (r->flags & VM_WRITE) f |= PTE_COW;
+    return f;
+}
+
+// ===================== FIXED FRAMES =====================
+static void* map_frames(uint64_t phys, size_t size, uint32_t flags, uint64_t pte_extra,
+                        const char* name) {
+    uint64_t base = PAGE_ALIGN_DOWN(phys);
+    size = PAGE_ALIGN_UP(phys + size) - base;
+    flags |= VM_PHYS;
+
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    uint8_t* virt = flags & VM_USER
+        ? reserve_locked(&user_mmap_next, USER_END, size, flags, name)
+        : reserve_locked(&kernel_vm_next, KERNEL_VM_END, size, flags, name);
+    int ret = virt ? 0 : -1;
+    if (virt) {
+        uint64_t pte = region_pte_flags(&(struct vm_region){ .flags = flags }) | pte_extra;
+        for (size_t off = 0; off < size && ret == 0; off += PAGE_SIZE)
+            ret = vmm_map((uintptr_t)virt + off, base + off, pte);
+    }
+    spin_unlock_irqrestore(&vm_lock, irq);
+
+    if (ret < 0) {
+        if (virt) vm_release(virt);
+        return NULL;
+    }
+    return virt + (phys - base);
+}
+
+void* vm_map_io(uint64_t phys, size_t size, const char* name) {
+    return map_frames(phys, size, VM_READ | VM_WRITE | VM_IO, PTE_PCD | PTE_PWT, name);
+}
+
+void* vm_map_phys(uint64_t phys, size_t size, uint32_t flags, const char* name) {
+    return map_frames(phys, size, flags, 0, name);
+}
+
+int vm_map_phys_at(uintptr_t virt, uint64_t phys, size_t size, uint32_t flags, const char* name) {
+    size = PAGE_ALIGN_UP(size);
+    if ((virt | phys) & (PAGE_SIZE - 1) || !size) return -1;
+    if (virt < USER_BASE || virt + size > USER_END || virt + size < virt) return -1;
+    flags |= VM_PHYS | VM_USER;
+
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    int added = add_locked(virt, virt + size, flags, name) == 0;
+    int ret = added ? 0 : -1;
+    uint64_t pte = region_pte_flags(&(struct vm_region){ .flags = flags });
+    for (size_t off = 0; off < size && ret == 0; off += PAGE_SIZE)
+        ret = vmm_map(virt + off, phys + off, pte);
+    spin_unlock_irqrestore(&vm_lock, irq);
+
+    if (ret < 0 && added) vm_release((void*)virt);
+    return ret;
+}
+
+// ===================== COPY-ON-WRITE =====================
+int vm_map_cow(uintptr_t dst, uintptr_t src, size_t size) {
+    int ret = 0;
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+
+    for (size_t off = 0; off < size; off += PAGE_SIZE) {
+        struct vm_region* sr = find_locked(src + off);
+        struct vm_region* dr = find_locked(dst + off);
+        if (!sr || !dr || ((sr->flags | dr->flags) & VM_PHYS)) { ret = -1; break; }
+
+        uint64_t* spte = vmm_pte(src + off, 0);
+        if (!spte || !(*spte & PTE_PRESENT)) continue; // stays demand-zero in dst
+
+        uint64_t frame = *spte & PTE_ADDR_MASK;
+        *spte = frame | shared_pte_flags(sr);
+        cpu_invlpg((void*)(src + off));
+
+        drop_page_locked(dst + off, dr->flags);
+        if (frame != zero_frame) {
+            pmm_ref(frame);
+            resident_pages++;
+        }
+        if (vmm_map(dst + off, frame, shared_pte_flags(dr)) < 0) { ret = -1; break; }
+    }
+
+    spin_unlock_irqrestore(&vm_lock, irq);
+    return ret;
+}
+
+// ===================== FAULTS =====================
+static enum vm_fault_result fault_locked(uintptr_t addr, uint64_t err) {
+    struct vm_region* r = find_locked(addr);
+    if (!r || (r->flags & VM_PHYS)) return VM_FAULT_BAD; // mapped up front
+    if ((err & PF_WRITE) && !(r->flags & VM_WRITE)) return VM_FAULT_BAD;
+    if ((err & PF_INSTR) && !(r->flags & VM_EXEC)) return VM_FAULT_BAD;
+    if ((err & PF_USER) && !(r->flags & VM_USER)) return VM_FAULT_BAD;
+    if (err & PF_RSVD) return VM_FAULT_BAD;
+
+    uintptr_t page = PAGE_ALIGN_DOWN(addr);
+    uint64_t* pte = vmm_pte(page, 1);
+    if (!pte) return VM_FAULT_OOM;
+
+    // untouched page
+    if (!(*pte & PTE_PRESENT)) {
+        if (!(err & PF_WRITE) && zero_frame) {
+            *pte = zero_frame | shared_pte_flags(r);
+            return VM_FAULT_ZERO_PAGE;
+        }
+        uint64_t frame = pmm_alloc_zeroed();
+        if (!frame) return VM_FAULT_OOM;
+        *pte = frame | region_pte_flags(r);
+        resident_pages++;
+        return VM_FAULT_DEMAND_ZERO;
+    }
+
+    // write to a shared frame
+    if ((err & PF_WRITE) && (*pte & PTE_COW)) {
+        uint64_t old = *pte & PTE_ADDR_MASK;
+        enum vm_fault_result result;
+
+        if (old == zero_frame) {
+            uint64_t frame = pmm_alloc_zeroed();
+            if (!frame) return VM_FAULT_OOM;
+            *pte = frame | region_pte_flags(r);
+            resident_pages++;
+            result = VM_FAULT_DEMAND_ZERO;
+        } else if (pmm_refcount(old) == 1) {
+            *pte = old | region_pte_flags(r);
+            result = VM_FAULT_COW_REUSE;
+        } else {
+            uint64_t frame = pmm_alloc();
+            if (!frame) return VM_FAULT_OOM;
+            memcpy((void*)(uintptr_t)frame, (void*)(uintptr_t)old, PAGE_SIZE);
+            *pte = frame | region_pte_flags(r);
+            pmm_free(old);
+            result = VM_FAULT_COW_COPY;
+        }
+        cpu_invlpg((void*)page);
+        return result;
+    }
+
+    // present and allowed: another path fixed it up, drop the stale TLB entry
+    if (!(err & PF_WRITE) || (*pte & PTE_WRITE)) {
+        cpu_invlpg((void*)page);
+        return VM_FAULT_SPURIOUS;
+    }
+    return VM_FAULT_BAD;
+}
+
+enum vm_fault_result vm_handle_fault(uintptr_t addr, uint64_t err) {
+    uint64_t irq = spin_lock_irqsave(&vm_lock);
+    enum vm_fault_result result = fault_locked(addr, err);
+    spin_unlock_irqrestore(&vm_lock, irq);
+    return result;
+}
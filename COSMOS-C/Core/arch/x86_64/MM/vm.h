@@ -0,0 +1,74 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Virtual memory regions. Reserving a region maps nothing; pages are
+// backed on first touch by the page fault handler:
+//   read  -> the shared zero page, read-only + copy-on-write
+//   write -> a fresh zeroed frame
+// so memory that is never touched never costs a physical page.
+
+#define VM_READ   (1u << 0)
+#define VM_WRITE  (1u << 1)
+#define VM_EXEC   (1u << 2)
+#define VM_USER   (1u << 3)
+#define VM_IO     (1u << 4)   // device memory, see vm_map_io()
+#define VM_PHYS   (1u << 5)   // existing frames, mapped up front and not owned
+
+#define MAX_VM_REGIONS 64
+
+struct vm_region {
+    uintptr_t start;
+    uintptr_t end;
+    uint32_t flags;
+    const char* name;
+};
+
+// fault resolution results
+enum vm_fault_result {
+    VM_FAULT_DEMAND_ZERO,   // new zeroed frame
+    VM_FAULT_ZERO_PAGE,     // read of untouched memory, zero page mapped
+    VM_FAULT_COW_COPY,      // shared frame copied
+    VM_FAULT_COW_REUSE,     // last sharer, made writable in place
+    VM_FAULT_SPURIOUS,      // already resolved (stale TLB entry)
+    VM_FAULT_BAD,           // no region or access not allowed
+    VM_FAULT_OOM,
+    VM_FAULT_KINDS
+};
+
+void vm_init(void);
+
+// Kernel virtual area, page granular, with an unmapped guard page behind
+// every reservation. NULL when out of address space or region slots.
+void* vm_reserve(size_t size, uint32_t flags, const char* name);
+
+// Fixed address (user space, 046), 0 on success
+int vm_reserve_at(uintptr_t start, size_t size, uint32_t flags, const char* name);
+
+// Device registers (PCI BARs) at `phys`: mapped uncached right away, never
+// demand paged. Returns the virtual address of `phys` (not page aligned).
+void* vm_map_io(uint64_t phys, size_t size, const char* name);
+
+// Existing frames the region doesn't own (boot modules), mapped right away
+// with the protection from `flags`. With VM_USER the address is picked in
+// the user mmap window, else in the kernel area. Returns the address of
+// `phys` (not page aligned).
+void* vm_map_phys(uint64_t phys, size_t size, uint32_t flags, const char* name);
+
+// Existing frames at a fixed, page aligned user address (ELF text and
+// rodata, Core/exec): the same frames can back any number of mappings.
+// 0 on success, -1 on overlap or a bad range.
+int vm_map_phys_at(uintptr_t virt, uint64_t phys, size_t size, uint32_t flags, const char* name);
+
+// Unmaps the region containing `addr` and drops its frames
+void vm_release(void* addr);
+
+// Maps every resident page of [src, src+size) into [dst, dst+size) sharing
+// the frames copy-on-write. Both ranges must lie in reserved regions.
+int vm_map_cow(uintptr_t dst, uintptr_t src, size_t size);
+
+const struct vm_region* vm_find(uintptr_t addr);
+enum vm_fault_result vm_handle_fault(uintptr_t addr, uint64_t error_code);
+
+// resident pages of all regions (not counting the zero page)
+uint64_t vm_resident_pages(void);
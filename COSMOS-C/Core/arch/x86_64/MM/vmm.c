@@ -0,0 +1,72 @@
+#include "arch/x86_64/MM/vmm.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/CPU/features.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+uint64_t vmm_nx = 0;
+
+// NX for data mappings, and CR0.WP so ring 0 writes to read-only pages fault
+// too (copy-on-write depends on it)
+__init void vmm_init(void) {
+    if (cpu_has(CPU_FEATURE_NX)) {
+        cpu_wrmsr(MSR_EFER, cpu_rdmsr(MSR_EFER) | EFER_NXE);
+        vmm_nx = PTE_NX;
+    }
+    cpu_write_cr0(cpu_read_cr0() | CR0_WP);
+}
+
+// ===================== WALK =====================
+static uint64_t* next_table(uint64_t* entry, int create, uint64_t user) {
+    if (!(*entry & PTE_PRESENT)) {
+        if (!create) return NULL;
+        uint64_t table = pmm_alloc_zeroed();
+        if (!table) return NULL;
+        *entry = table | PTE_PRESENT | PTE_WRITE | user;
+    } else if (*entry & PTE_HUGE) {
+        return NULL;
+    }
+    // leaf entries decide the permissions, upper levels only need U for user pages
+    *entry |= user;
+    return (uint64_t*)(uintptr_t)(*entry & PTE_ADDR_MASK);
+}
+
+uint64_t* vmm_pte(uintptr_t virt, int create) {
+    uint64_t user = virt < USER_END && virt >= USER_BASE ? PTE_USER : 0;
+    uint64_t* l4 = (uint64_t*)(uintptr_t)(cpu_read_cr3() & PTE_ADDR_MASK);
+    uint64_t* l3 = next_table(&l4[L4_INDEX(virt)], create, user);
+    if (!l3) return NULL;
+    uint64_t* l2 = next_table(&l3[L3_INDEX(virt)], create, user);
+    if (!l2) return NULL;
+    uint64_t* l1 = next_table(&l2[L2_INDEX(virt)], create, user);
+    if (!l1) return NULL;
+    return &l1[L1_INDEX(virt)];
+}
+
+// ===================== MAP / UNMAP =====================
+int vmm_map(uintptr_t virt, uint64_t phys, uint64_t flags) {
+    uint64_t* pte = vmm_pte(virt, 1);
+    if (!pte) return -1;
+    *pte = (phys & PTE_ADDR_MASK) | flags | PTE_PRESENT;
+    cpu_invlpg((void*)virt);
+    return 0;
+}
+
+uint64_t vmm_unmap(uintptr_t virt) {
+    uint64_t* pte = vmm_pte(virt, 0);
+    if (!pte) return 0;
+    uint64_t old = *pte;
+    *pte = 0;
+    cpu_invlpg((void*)virt);
+    return old;
+}
+
+uint64_t vmm_translate(uintptr_t virt) {
+    if (virt < IDENTITY_END) return virt;
+    uint64_t* pte = vmm_pte(virt, 0);
+    if (!pte || !(*pte & PTE_PRESENT)) return 0;
+    return (*pte & PTE_ADDR_MASK) | (virt & (PAGE_SIZE - 1));
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// 4 KiB mappings in the (single) kernel address space. Intermediate tables
+// come from the PMM; the boot identity map (2 MiB pages) is left alone.
+
+// PTE_NX if the CPU supports it (EFER.NXE enabled by vmm_init), else 0
+extern uint64_t vmm_nx;
+
+void vmm_init(void);
+
+// Leaf entry for `virt`, creating missing tables when `create` is set.
+// NULL if a table is missing (and !create) or `virt` is inside a huge page.
+uint64_t* vmm_pte(uintptr_t virt, int create);
+
+int vmm_map(uintptr_t virt, uint64_t phys, uint64_t flags);
+uint64_t vmm_unmap(uintptr_t virt); // returns the old entry
+
+// Physical address behind `virt` (identity map or 4 KiB page), 0 if unmapped
+uint64_t vmm_translate(uintptr_t virt);
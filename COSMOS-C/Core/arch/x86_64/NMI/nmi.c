@@ -0,0 +1,149 @@
+#include "arch/x86_64/NMI/nmi.h"
+#include "arch/x86_64/APIC/lapic.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/IRQ/isr.h"
+#include "Core/arch/x86_64/TIMER/HPET/hpet.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Drivers/serial/serial.h"
+#include "prof/ksyms.h"
+#include "lib/errno.h"
+#include "sync/atomic.h"
+#include "compiler.h"
+#ifdef IRQSOFF
+#include "trace/irqsoff.h"
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+// Architectural performance monitoring (CPUID leaf 0xA)
+#define CPUID_PERFMON          0x0A
+#define PERFMON_VERSION(a)     ((a) & 0xFF)
+#define PERFMON_COUNTERS(a)    (((a) >> 8) & 0xFF)
+#define PERFMON_NO_CYCLES      (1u << 0)    // ebx: core cycles event unavailable
+
+#define MSR_PMC0               0xC1
+#define MSR_PERFEVTSEL0        0x186
+#define EVTSEL_CYCLES          0x3C          // unhalted core cycles, umask 0
+#define EVTSEL_USR             (1u << 16)
+#define EVTSEL_OS              (1u << 17)
+#define EVTSEL_INT             (1u << 20)
+#define EVTSEL_EN              (1u << 22)
+#define PMC_MAX_PERIOD         0x7FFFFFFFull // PMC0 writes are 32 bits, sign extended
+
+enum { SRC_NONE, SRC_HPET, SRC_PERF };
+
+struct nmi_stats nmi_stats;
+
+static int wd_source = SRC_NONE;
+static uint64_t wd_thresh;      // TSC cycles without a tick
+static uint64_t wd_period;      // PMC0 cycles between NMIs
+static uint64_t wd_ticks;       // `ticks` at the last NMI that saw it move
+static uint64_t wd_progress;    // TSC of that NMI
+static int wd_reported;
+
+// ===================== SOURCES =====================
+// Counter 0 preloaded to -period overflows into an NMI. Unhalted cycles:
+// an idle CPU in hlt gets none, and has interrupts on anyway.
+static int perf_start(uint32_t hz) {
+    uint32_t a, b, c, d;
+    cpu_cpuid(0, 0, &a, &b, &c, &d);
+    if (a < CPUID_PERFMON || !lapic_present()) return -ENODEV;
+    cpu_cpuid(CPUID_PERFMON, 0, &a, &b, &c, &d);
+    if (PERFMON_VERSION(a) == 0 || PERFMON_COUNTERS(a) == 0 || (b & PERFMON_NO_CYCLES)) return -ENODEV;
+
+    wd_period = tsc_khz * 1000 / hz;
+    if (wd_period > PMC_MAX_PERIOD) wd_period = PMC_MAX_PERIOD;
+    cpu_wrmsr(MSR_PERFEVTSEL0, 0);
+    cpu_wrmsr(MSR_PMC0, -wd_period);
+    lapic_write(LAPIC_LVT_PERF, LAPIC_DM_NMI);
+    cpu_wrmsr(MSR_PERFEVTSEL0, EVTSEL_CYCLES | EVTSEL_USR | EVTSEL_OS | EVTSEL_INT | EVTSEL_EN);
+    return 0;
+}
+
+// The LVT entry masks itself on every overflow interrupt
+static inline void perf_rearm(void) {
+    cpu_wrmsr(MSR_PMC0, -wd_period);
+    lapic_write(LAPIC_LVT_PERF, LAPIC_DM_NMI);
+}
+
+int nmi_watchdog_start(uint32_t thresh_ms) {
+    if (wd_source != SRC_NONE) return -EBUSY;
+    if (tsc_khz == 0 || thresh_ms == 0) return -EINVAL;
+
+    wd_thresh = (uint64_t)thresh_ms * tsc_khz;
+    wd_ticks = atomic_read(&ticks, MO_RELAXED);
+    wd_progress = rdtsc();
+
+    int source;
+    if (lapic_present() && hpet_nmi_start(NMI_WATCHDOG_HZ, lapic_id()) == 0) source = SRC_HPET;
+    else if (perf_start(NMI_WATCHDOG_HZ) == 0) source = SRC_PERF;
+    else return -ENODEV;
+    // an NMI may arrive as soon as the source is armed
+    atomic_write(&wd_source, source, MO_RELEASE);
+    return 0;
+}
+
+const char* nmi_watchdog_source(void) {
+    switch (wd_source) {
+        case SRC_HPET: return "hpet";
+        case SRC_PERF: return "perf";
+        default:       return "none";
+    }
+}
+
+// ===================== NMI =====================
+static void dump_reg(const char* name, uint64_t value) {
+    serial_write(name);
+    serial_write_hex(value);
+    serial_putc('\n');
+}
+
+static void lockup_report(const struct interrupt_frame* frame, uint64_t stalled) {
+    serial_write("\nNMI watchdog: hard lockup, no timer tick for ");
+    serial_write_dec(tsc_cycles_to_ns(stalled) / 1000000);
+    serial_write(" ms\n  rip    ");
+    ksym_write(frame->rip);
+    serial_putc('\n');
+    dump_reg("  cs     ", frame->cs);
+    dump_reg("  rflags ", frame->rflags);
+    dump_reg("  rsp    ", frame->rsp);
+    dump_reg("  rbp    ", frame->rbp);
+#ifdef IRQSOFF
+    const struct irqsoff_cpu* s = this_cpu()->irqsoff;
+    if (s && s->start) {
+        serial_write("  irqs off since ");
+        if (s->begin_ip) ksym_write(s->begin_ip);
+        else serial_write("irq entry");
+        serial_write(", ");
+        serial_write_dec(tsc_cycles_to_ns(rdtsc() - s->start) / 1000000);
+        serial_write(" ms\n");
+    }
+#endif
+}
+
+// Runs with interrupts off on any stack, possibly inside a locked section:
+// no locks, only serial output (which has none)
+void nmi_handler(struct interrupt_frame* frame) {
+    int source = atomic_read(&wd_source, MO_ACQUIRE);
+    if (source == SRC_NONE) isr_panic(frame, "NMI");
+
+    nmi_stats.nmis++;
+    if (source == SRC_HPET) hpet_nmi_rearm();
+    else perf_rearm();
+
+    uint64_t now = rdtsc();
+    uint64_t t = atomic_read(&ticks, MO_RELAXED);
+    if (t != wd_ticks) {
+        wd_ticks = t;
+        wd_progress = now;
+        wd_reported = 0;
+        return;
+    }
+    if (wd_reported || now - wd_progress < wd_thresh) return;
+
+    wd_reported = 1;
+    nmi_stats.lockups++;
+    lockup_report(frame, now - wd_progress);
+}
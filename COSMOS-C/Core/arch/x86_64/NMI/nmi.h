@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+struct interrupt_frame;
+
+// Hard-lockup watchdog. An NMI source independent of the tick interrupts
+// the CPU NMI_WATCHDOG_HZ times a second, interrupts off or not:
+//   1. a free HPET timer with FSB (MSI) delivery, NMI delivery mode
+//   2. otherwise performance counter 0 counting unhalted cycles, its
+//      overflow delivered through LAPIC_LVT_PERF as an NMI
+// Each NMI checks whether `ticks` moved. When it has not for the threshold,
+// the CPU stopped taking timer interrupts: the interrupted rip, its
+// registers and (IRQSOFF builds) the site that turned interrupts off go to
+// COM1, once per lockup:
+//
+//   NMI watchdog: hard lockup, no timer tick for 2004 ms
+//     rip    kb_update_leds+0x2a
+//     ...
+
+#define NMI_WATCHDOG_HZ      4
+#define NMI_WATCHDOG_MS      2000    // default threshold
+
+struct nmi_stats {
+    uint64_t nmis;
+    uint64_t lockups;
+};
+
+extern struct nmi_stats nmi_stats;
+
+// Starts the watchdog with a threshold of `thresh_ms`. Interrupts must be
+// on and the tick running. 0, -ENODEV without an NMI source.
+int nmi_watchdog_start(uint32_t thresh_ms);
+// "hpet", "perf" or "none"
+const char* nmi_watchdog_source(void);
+
+// isr_handler(), vector 2. Without the watchdog an NMI is a hardware
+// error and panics, as before.
+void nmi_handler(struct interrupt_frame* frame);
@@ -1,12 +1,13 @@
 #include "arch/x86_64/PIC/pic.h"
 #include "arch/x86_64/IRQ/port.h"
+#include "compiler.h"
 
 #define PIC1_CMD 0x20
 #define PIC1_DATA 0x21
 #define PIC2_CMD 0xA0
 #define PIC2_DATA 0xA1
 
-void pic_remap(int offset1, int offset2) {
+__init void pic_remap(int offset1, int offset2) {
     uint8_t a1 = inb(PIC1_DATA);
     uint8_t a2 = inb(PIC2_DATA);
 
@@ -27,7 +28,16 @@ void pic_remap(int offset1, int offset2) {
 }
 
 
-void pic_send_eoi(unsigned char irq) {
+__hot void pic_send_eoi(unsigned char irq) {
     if (irq >= 8) outb(PIC2_CMD, 0x20);
     outb(PIC1_CMD, 0x20);
-}
\ No newline at end of file
+}
+
+// Lets `irq` through; lines on the slave also need the cascade (IRQ2) open
+void pic_unmask(unsigned char irq) {
+    if (irq >= 8) {
+        outb(PIC2_DATA, inb(PIC2_DATA) & ~(1 << (irq - 8)));
+        irq = 2;
+    }
+    outb(PIC1_DATA, inb(PIC1_DATA) & ~(1 << irq));
+}
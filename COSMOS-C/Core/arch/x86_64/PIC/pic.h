@@ -3,5 +3,6 @@
 
 void pic_remap(int offset1, int offset2);
 void pic_send_eoi(unsigned char irq);
+void pic_unmask(unsigned char irq);
 
 #endif
\ No newline at end of file
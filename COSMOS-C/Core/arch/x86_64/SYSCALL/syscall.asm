@@ -0,0 +1,180 @@
+; syscall.asm - SYSCALL/SYSRET and int 0x80 entry, user_enter()/sys_exit()
+; Both entries index syscall_table with rax and call the handler with the
+; System V argument registers (the 4th argument arrives in r10).
+extern syscall_table
+extern syscall_count
+
+; keep in sync with CPU/percpu.h
+%define PERCPU_KERNEL_RSP      8
+%define PERCPU_USER_RSP        16
+%define PERCPU_USER_ENTER_RSP  24
+
+%define ENOSYS 38
+
+section .text.hot progbits alloc exec nowrite align=16
+global syscall_entry
+global syscall_int80
+global user_enter
+global sys_exit
+
+; registers the handler may clobber but the user must get back unchanged
+%macro SAVE_ARGS 0
+    push rdi
+    push rsi
+    push rdx
+    push r8
+    push r9
+    push r10
+%endmacro
+
+%macro RESTORE_ARGS 0
+    pop r10
+    pop r9
+    pop r8
+    pop rdx
+    pop rsi
+    pop rdi
+%endmacro
+
+; rax = handler for the number in rax, or 0 if there is none
+%macro LOOKUP 0
+    cmp rax, [rel syscall_count]
+    jae %%bad
+    mov rax, [syscall_table + rax * 8]
+    jmp %%done
+%%bad:
+    xor eax, eax
+%%done:
+%endmacro
+
+; ===================== SYSCALL =====================
+; entry: rcx = user rip, r11 = user rflags, IF already masked by SFMASK
+syscall_entry:
+    swapgs
+    mov [gs:PERCPU_USER_RSP], rsp
+    mov rsp, [gs:PERCPU_KERNEL_RSP]
+    push qword [gs:PERCPU_USER_RSP]
+    push r11
+    push rcx
+    SAVE_ARGS
+    sub rsp, 8              ; 9 pushes -> realign to 16 for the call
+
+    LOOKUP
+    test rax, rax
+    jz .enosys
+    mov rcx, r10
+    sti
+    call rax
+    cli
+.ret:
+    ; sysret with a non-canonical rcx faults in ring 0: use iretq instead
+    mov rdi, [rsp + 56]     ; saved rcx (user rip), rdi is restored below
+    shr rdi, 47
+    jnz .iret
+    add rsp, 8
+    RESTORE_ARGS
+    pop rcx
+    pop r11
+    pop rsp
+    swapgs
+    o64 sysret
+
+.enosys:
+    mov rax, -ENOSYS
+    jmp .ret
+
+.iret:
+    add rsp, 8
+    RESTORE_ARGS
+    pop rcx
+    pop r11
+    pop qword [gs:PERCPU_USER_RSP]
+    push qword 0x1B         ; user ss
+    push qword [gs:PERCPU_USER_RSP]
+    push r11
+    push qword 0x23         ; user cs
+    push rcx
+    swapgs
+    iretq
+
+; ===================== INT 0x80 =====================
+; same table through an interrupt gate (DPL 3), kept for comparison and for
+; code that wants to trap from ring 0 as well
+syscall_int80:
+    test byte [rsp + 8], 3  ; CS of the interrupted code
+    jz .from_kernel
+    swapgs
+.from_kernel:
+    push rcx
+    push r11
+    SAVE_ARGS
+    sub rsp, 8              ; CPU frame (5) + 8 pushes -> realign to 16
+
+    LOOKUP
+    test rax, rax
+    jz .enosys
+    mov rcx, r10
+    sti
+    call rax
+    cli
+.ret:
+    add rsp, 8
+    RESTORE_ARGS
+    pop r11
+    pop rcx
+    test byte [rsp + 8], 3
+    jz .to_kernel
+    swapgs
+.to_kernel:
+    iretq
+
+.enosys:
+    mov rax, -ENOSYS
+    jmp .ret
+
+; ===================== USER MODE =====================
+; int64_t user_enter(uint64_t rip, uint64_t rsp, uint64_t arg)
+; Saves the callee-saved registers and the kernel rsp in the per-CPU block,
+; then sysrets to ring 3. SYS_EXIT unwinds back here.
+user_enter:
+    push rbx
+    push rbp
+    push r12
+    push r13
+    push r14
+    push r15
+    cli
+    mov [gs:PERCPU_USER_ENTER_RSP], rsp
+    mov rcx, rdi            ; user rip
+    mov rdi, rdx            ; first argument for the user code
+    mov r11, 0x202          ; user rflags: IF
+    mov rsp, rsi
+    xor eax, eax            ; don't hand kernel values to ring 3
+    xor ebx, ebx
+    xor edx, edx
+    xor esi, esi
+    xor ebp, ebp
+    xor r8d, r8d
+    xor r9d, r9d
+    xor r10d, r10d
+    xor r12d, r12d
+    xor r13d, r13d
+    xor r14d, r14d
+    xor r15d, r15d
+    swapgs
+    o64 sysret
+
+; int64_t sys_exit(code): entry in syscall_table, never returns to the caller
+sys_exit:
+    cli
+    mov rax, rdi
+    mov rsp, [gs:PERCPU_USER_ENTER_RSP]
+    mov qword [gs:PERCPU_USER_ENTER_RSP], 0 ; no program running (page_fault.c)
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop rbp
+    pop rbx
+    sti
+    ret
@@ -0,0 +1,136 @@
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include "arch/x86_64/GDT/gdt.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/IDT/idt.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "HAL/console/print.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vm.h"
+#include "fs/file.h"
+#include "compiler.h"
+#include <stdint.h>
+
+#define MSR_STAR          0xC0000081
+#define MSR_LSTAR         0xC0000082
+#define MSR_SFMASK        0xC0000084
+#define EFER_SCE          (1ull << 0)
+
+// RFLAGS cleared on SYSCALL entry: TF, IF, DF, IOPL, NT, AC
+#define SYSCALL_RFLAGS_MASK 0x47700
+
+#define PATH_MAX          256
+#define WRITE_MAX         4096      // bytes per SYS_WRITE, the rest is left to the caller
+
+// assembly entry points (syscall.asm)
+extern void syscall_entry(void);
+extern void syscall_int80(void);
+
+// ===================== HANDLERS =====================
+// User pointers must lie in user space and, since a kernel access has no
+// fault fixup, in VM_USER regions that allow `access` (VM_READ / VM_WRITE)
+// all the way through
+static int user_range_ok(uint64_t addr, uint64_t len, uint32_t access) {
+    if (addr < USER_BASE || addr + len < addr || addr + len > USER_END) return 0;
+    for (uint64_t p = addr; p < addr + len;) {
+        const struct vm_region* r = vm_find(p);
+        if (!r || (r->flags & (VM_USER | access)) != (VM_USER | access)) return 0;
+        p = r->end;
+    }
+    return 1;
+}
+
+static int64_t sys_nop(SYSCALL_ARGS) {
+    return 0;
+}
+
+// Short write past WRITE_MAX, like write(2): returns the bytes taken
+static int64_t sys_write(SYSCALL_ARGS) {
+    uint64_t len = a1 < WRITE_MAX ? a1 : WRITE_MAX;
+    if (!user_range_ok(a0, len, VM_READ)) return -EFAULT;
+    const char* buf = (const char*)a0;
+    for (uint64_t i = 0; i < len; i++) print_char(buf[i]);
+    return (int64_t)len;
+}
+
+static int64_t sys_uptime_ms(SYSCALL_ARGS) {
+    return (int64_t)timer_uptime_ms();
+}
+
+static int64_t sys_sleep_ms(SYSCALL_ARGS) {
+    sleep_ms(a0);
+    return 0;
+}
+
+static int64_t sys_clock_gettime(SYSCALL_ARGS) {
+    struct timer_timespec ts;
+    if (!user_range_ok(a1, sizeof(ts), VM_WRITE)) return -EFAULT;
+    int err = timer_clock_gettime((uint32_t)a0, &ts);
+    if (err < 0) return err;
+    *(struct timer_timespec*)a1 = ts;
+    return 0;
+}
+
+// ===================== FILES =====================
+static int64_t sys_open(SYSCALL_ARGS) {
+    char path[PATH_MAX];
+    const char* upath = (const char*)a0;
+    for (int i = 0; ; i++) {
+        if (i == PATH_MAX) return -EFAULT;
+        // once per page the string reaches into
+        if ((i == 0 || ((a0 + i) & (PAGE_SIZE - 1)) == 0) && !user_range_ok(a0 + i, 1, VM_READ)) return -EFAULT;
+        path[i] = upath[i];
+        if (!path[i]) break;
+    }
+    return fs_open(path);
+}
+
+static int64_t sys_read(SYSCALL_ARGS) {
+    if (!user_range_ok(a1, a2, VM_WRITE)) return -EFAULT;
+    return fs_read((int)a0, (void*)a1, a2);
+}
+
+static int64_t sys_close(SYSCALL_ARGS) {
+    return fs_close((int)a0);
+}
+
+static int64_t sys_mmap(SYSCALL_ARGS) {
+    return fs_mmap_user((int)a0, a1, a2);
+}
+
+static int64_t sys_munmap(SYSCALL_ARGS) {
+    return fs_munmap_user(a0);
+}
+
+// ===================== TABLE =====================
+// Indexed by rax straight from the entry stubs; numbers past the end and
+// NULL holes return -ENOSYS
+const syscall_fn_t syscall_table[] = {
+    [SYS_NOP]       = sys_nop,
+    [SYS_EXIT]      = sys_exit,
+    [SYS_WRITE]     = sys_write,
+    [SYS_UPTIME_MS] = sys_uptime_ms,
+    [SYS_SLEEP_MS]  = sys_sleep_ms,
+    [SYS_OPEN]      = sys_open,
+    [SYS_READ]      = sys_read,
+    [SYS_CLOSE]     = sys_close,
+    [SYS_MMAP]      = sys_mmap,
+    [SYS_MUNMAP]    = sys_munmap,
+    [SYS_CLOCK_GETTIME] = sys_clock_gettime,
+};
+
+const uint64_t syscall_count = sizeof(syscall_table) / sizeof(syscall_table[0]);
+
+// ===================== INIT =====================
+// Needs gdt_init(), percpu_init(), idt_init() and stack_init() (the ring 0
+// stack for SYSCALL and for interrupts taken in ring 3) first
+__init void syscall_init(void) {
+    // STAR[47:32] = SYSCALL CS (SS = +8), STAR[63:48] = SYSRET base (SS = +8, CS = +16)
+    uint64_t star = ((uint64_t)GDT_KERNEL_CS << 32) | ((uint64_t)(GDT_USER_DS - 8) << 48);
+    cpu_wrmsr(MSR_STAR, star);
+    cpu_wrmsr(MSR_LSTAR, (uint64_t)syscall_entry);
+    cpu_wrmsr(MSR_SFMASK, SYSCALL_RFLAGS_MASK);
+    cpu_wrmsr(MSR_EFER, cpu_rdmsr(MSR_EFER) | EFER_SCE);
+
+    // legacy gate, callable from ring 3
+    set_idt_gate(SYSCALL_VECTOR, (uint64_t)syscall_int80, 0xEE);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "lib/errno.h"
+#include <stdint.h>
+
+// ===================== ABI =====================
+// rax = number, args in rdi, rsi, rdx, r10, r8, r9, result in rax.
+// Entry through `syscall` (fast path) or `int 0x80` (same table).
+// Every register except rax, rcx and r11 is preserved.
+#define SYSCALL_VECTOR   0x80
+
+#define SYS_NOP          0  // ()                      -> 0
+#define SYS_EXIT         1  // (code)                  -> returns from user_enter()
+#define SYS_WRITE        2  // (buf, len)              -> chars written, 4096 at most
+#define SYS_UPTIME_MS    3  // ()                      -> ms since boot
+#define SYS_SLEEP_MS     4  // (ms)                    -> 0
+#define SYS_OPEN         5  // (path)                  -> fd
+#define SYS_READ         6  // (fd, buf, len)          -> bytes read, 0 at the end
+#define SYS_CLOSE        7  // (fd)                    -> 0
+#define SYS_MMAP         8  // (fd, offset, len)       -> address of the read-only mapping
+#define SYS_MUNMAP       9  // (addr)                  -> 0
+#define SYS_CLOCK_GETTIME 10 // (clock, ts)             -> 0, struct timer_timespec in ts
+
+typedef int64_t (*syscall_fn_t)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t);
+
+// handler signature for entries in syscall_table
+#define SYSCALL_ARGS uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3, uint64_t a4, uint64_t a5
+
+extern const syscall_fn_t syscall_table[];
+extern const uint64_t syscall_count;
+
+void syscall_init(void);
+
+// Drops to ring 3 at `rip` with stack `rsp` and `arg` in rdi. Returns the
+// code the user code passes to SYS_EXIT. Not reentrant.
+int64_t user_enter(uint64_t rip, uint64_t rsp, uint64_t arg);
+
+// SYS_EXIT handler: unwinds to user_enter() from any kernel entry of the
+// user program (system call or exception), never returns
+int64_t sys_exit(SYSCALL_ARGS);
+
+// ===================== CALLERS =====================
+static inline int64_t syscall0(uint64_t n) {
+    int64_t ret;
+    __asm__ volatile ("syscall" : "=a"(ret) : "a"(n) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline int64_t syscall1(uint64_t n, uint64_t a0) {
+    int64_t ret;
+    __asm__ volatile ("syscall" : "=a"(ret) : "a"(n), "D"(a0) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline int64_t syscall2(uint64_t n, uint64_t a0, uint64_t a1) {
+    int64_t ret;
+    __asm__ volatile ("syscall" : "=a"(ret) : "a"(n), "D"(a0), "S"(a1) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline int64_t syscall3(uint64_t n, uint64_t a0, uint64_t a1, uint64_t a2) {
+    int64_t ret;
+    __asm__ volatile ("syscall" : "=a"(ret) : "a"(n), "D"(a0), "S"(a1), "d"(a2) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline int64_t int80_syscall0(uint64_t n) {
+    int64_t ret;
+    __asm__ volatile ("int $0x80" : "=a"(ret) : "a"(n) : "memory");
+    return ret;
+}
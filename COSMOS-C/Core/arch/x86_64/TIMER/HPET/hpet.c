@@ -0,0 +1,172 @@
+#include "Core/arch/x86_64/TIMER/HPET/hpet.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "arch/x86_64/ACPI/acpi.h"
+#include "arch/x86_64/APIC/lapic.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================== REGISTERS =====================
+#define HPET_CAP            0x000
+#define HPET_CONF           0x010
+#define HPET_COUNTER        0x0F0
+#define HPET_TN_CONF(n)     (0x100 + 0x20 * (n))
+#define HPET_TN_CMP(n)      (0x108 + 0x20 * (n))
+#define HPET_TN_FSB(n)      (0x110 + 0x20 * (n))   // MSI data (low), address (high)
+
+#define CAP_TIMERS(cap)     ((((cap) >> 8) & 0x1F) + 1)
+#define CAP_COUNT_64        (1ull << 13)
+#define CAP_LEGACY_ROUTE    (1ull << 15)
+#define CAP_PERIOD_FS(cap)  ((cap) >> 32)       // counter period in femtoseconds
+#define MAX_PERIOD_FS       100000000ull        // spec: at most 100 ns
+
+#define CONF_ENABLE         (1ull << 0)
+#define CONF_LEGACY         (1ull << 1)         // timer 0 -> IRQ0, timer 1 -> IRQ8
+
+#define TN_INT_ENABLE       (1ull << 2)
+#define TN_PERIODIC         (1ull << 3)
+#define TN_PERIODIC_CAP     (1ull << 4)
+#define TN_LEVEL            (1ull << 1)
+#define TN_VAL_SET          (1ull << 6)         // next comparator write sets the period
+#define TN_FSB_EN           (1ull << 14)        // deliver as an MSI write, not an IRQ line
+#define TN_FSB_CAP          (1ull << 15)
+
+#define FS_PER_SEC          1000000000000000ull
+
+static volatile uint8_t* hpet;
+static uint64_t hpet_cap;
+
+static inline uint64_t hpet_read64(uint32_t reg) {
+    return *(volatile uint64_t*)(hpet + reg);
+}
+
+static inline void hpet_write64(uint32_t reg, uint64_t v) {
+    *(volatile uint64_t*)(hpet + reg) = v;
+}
+
+// ===================== CLOCKSOURCE =====================
+// One uncached MMIO load; a VM exit under most hypervisors, still far
+// cheaper than the PIT's port sequence
+static uint64_t hpet_read(void) {
+    return hpet_read64(HPET_COUNTER);
+}
+
+static struct clocksource hpet_source = {
+    .name = "hpet",
+    .read = hpet_read,
+    .flags = CLOCK_STABLE,
+};
+
+// ===================== CLOCKEVENT =====================
+static struct clockevent hpet_event;
+
+static void hpet_irq(void* ctx) {
+    (void)ctx;
+    if (hpet_event.handler) hpet_event.handler();
+}
+
+// The main counter stops while timer 0 is reprogrammed, the spec leaves
+// the comparator undefined otherwise. A few cycles, and the clocksource
+// only sees the counter pause.
+static int hpet_set_periodic(uint32_t hz) {
+    static int irq_hooked;
+    if (hz == 0) return -EINVAL;
+    uint64_t conf0 = hpet_read64(HPET_TN_CONF(0));
+    if (!(conf0 & TN_PERIODIC_CAP) || !(hpet_cap & CAP_LEGACY_ROUTE)) return -EINVAL;
+    if (!irq_hooked && irq_register(0, hpet_irq, NULL) < 0) return -EBUSY;
+    irq_hooked = 1;
+
+    uint64_t period = hpet_source.freq_hz / hz;
+    uint64_t conf = hpet_read64(HPET_CONF);
+    hpet_write64(HPET_CONF, conf & ~CONF_ENABLE);
+
+    hpet_write64(HPET_TN_CONF(0), conf0 | TN_INT_ENABLE | TN_PERIODIC | TN_VAL_SET);
+    hpet_write64(HPET_TN_CMP(0), hpet_read64(HPET_COUNTER) + period); // first expiry
+    hpet_write64(HPET_TN_CMP(0), period);                             // accumulator
+
+    hpet_write64(HPET_CONF, conf | CONF_ENABLE | CONF_LEGACY);
+    return 0;
+}
+
+static void hpet_stop(void) {
+    hpet_write64(HPET_TN_CONF(0), hpet_read64(HPET_TN_CONF(0)) & ~(TN_INT_ENABLE | TN_PERIODIC));
+    hpet_write64(HPET_CONF, hpet_read64(HPET_CONF) & ~CONF_LEGACY);
+}
+
+static struct clockevent hpet_event = {
+    .name = "hpet",
+    .rating = 200,
+    .flags = CLOCK_EVT_IRQ0,
+    .set_periodic = hpet_set_periodic,
+    .stop = hpet_stop,
+};
+
+// ===================== NMI TIMER =====================
+// A comparator next to the tick's, delivered as an MSI write with NMI
+// delivery mode straight to the LAPIC, so it fires while interrupts are
+// off. One-shot (only timer 0 has to support periodic mode), re-armed by
+// hpet_nmi_rearm() from the NMI handler.
+static int nmi_timer = -1;
+static uint64_t nmi_period;
+
+int hpet_nmi_start(uint32_t hz, uint32_t apic_id) {
+    if (!hpet || !hpet_source.freq_hz || hz == 0) return -ENODEV;
+    if (nmi_timer >= 0) return -EBUSY;
+
+    for (uint32_t n = 1; n < CAP_TIMERS(hpet_cap); n++) {
+        uint64_t conf = hpet_read64(HPET_TN_CONF(n));
+        if (!(conf & TN_FSB_CAP) || (conf & TN_INT_ENABLE)) continue;
+
+        nmi_period = hpet_source.freq_hz / hz;
+        hpet_write64(HPET_TN_FSB(n), (uint64_t)LAPIC_MSI_ADDR(apic_id) << 32 | LAPIC_DM_NMI);
+        hpet_write64(HPET_TN_CMP(n), hpet_read64(HPET_COUNTER) + nmi_period);
+        hpet_write64(HPET_TN_CONF(n), (conf & ~(TN_PERIODIC | TN_LEVEL)) | TN_FSB_EN | TN_INT_ENABLE);
+        nmi_timer = (int)n;
+        return 0;
+    }
+    return -ENODEV;
+}
+
+__hot void hpet_nmi_rearm(void) {
+    if (nmi_timer < 0) return;
+    hpet_write64(HPET_TN_CMP(nmi_timer), hpet_read64(HPET_COUNTER) + nmi_period);
+}
+
+// ===================== INIT =====================
+__init void hpet_init(void) {
+    const struct acpi_hpet* table = (const struct acpi_hpet*)acpi_find_table("HPET");
+    if (!table || table->address.space_id != ACPI_SPACE_MEMORY) {
+        serial_write("[HPET] not present\n");
+        return;
+    }
+
+    hpet = vm_map_io(table->address.address, 0x400, "hpet");
+    if (!hpet) return;
+
+    hpet_cap = hpet_read64(HPET_CAP);
+    uint64_t period_fs = CAP_PERIOD_FS(hpet_cap);
+    if (period_fs == 0 || period_fs > MAX_PERIOD_FS) {
+        serial_write("[HPET] bad counter period\n");
+        return;
+    }
+
+    hpet_source.freq_hz = FS_PER_SEC / period_fs;
+    hpet_source.mask = hpet_cap & CAP_COUNT_64 ? UINT64_MAX : UINT32_MAX;
+
+    // counter running, no timer routed yet
+    hpet_write64(HPET_CONF, hpet_read64(HPET_CONF) & ~CONF_LEGACY);
+    hpet_write64(HPET_CONF, hpet_read64(HPET_CONF) | CONF_ENABLE);
+
+    serial_write("[HPET] ");
+    serial_write_hex(table->address.address);
+    serial_write(" freq_hz=");
+    serial_write_dec(hpet_source.freq_hz);
+    serial_write(hpet_source.mask == UINT64_MAX ? " 64-bit\n" : " 32-bit\n");
+
+    clocksource_register(&hpet_source);
+    clockevent_register(&hpet_event);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+
+// HPET from the ACPI "HPET" table: the main counter as a clocksource, timer 0
+// in legacy replacement mode (routed to IRQ0) as the tick clockevent.
+// Registers nothing when ACPI has no HPET.
+void hpet_init(void);
+
+// NMI source for the watchdog (NMI/nmi.h): a free timer with FSB delivery
+// sends an NMI to the LAPIC `apic_id` at `hz`. 0, -ENODEV without an HPET or
+// an FSB capable timer (QEMU: -global hpet.msi=on), -EBUSY when running.
+int hpet_nmi_start(uint32_t hz, uint32_t apic_id);
+// From the NMI handler: schedules the next expiry
+void hpet_nmi_rearm(void);
@@ -0,0 +1,62 @@
+#include "Core/arch/x86_64/TIMER/LAPIC/lapic_timer.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "arch/x86_64/APIC/lapic.h"
+#include "Drivers/serial/serial.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stdint.h>
+
+#define TIMER_DIV_16        0x3
+#define TIMER_DIVISOR       16
+#define CALIBRATE_MS        10
+
+static uint64_t timer_hz;   // counter rate after the divider
+
+// ===================== CLOCKEVENT =====================
+static int lapic_timer_set_periodic(uint32_t hz) {
+    if (hz == 0 || timer_hz / hz == 0 || timer_hz / hz > UINT32_MAX) return -EINVAL;
+    lapic_write(LAPIC_TIMER_DIV, TIMER_DIV_16);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_TIMER_PERIODIC | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, (uint32_t)(timer_hz / hz));
+    return 0;
+}
+
+static void lapic_timer_stop(void) {
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, 0);
+}
+
+static struct clockevent lapic_event = {
+    .name = "lapic",
+    .rating = 300,
+    .set_periodic = lapic_timer_set_periodic,
+    .stop = lapic_timer_stop,
+};
+
+__hot void lapic_timer_interrupt(void) {
+    if (lapic_event.handler) lapic_event.handler();
+    lapic_eoi();
+}
+
+// ===================== CALIBRATION =====================
+// One-shot from the top, masked: the count only goes down, so the elapsed
+// count is the distance from the start value
+static uint64_t lapic_timer_elapsed(void) {
+    return UINT32_MAX - lapic_read(LAPIC_TIMER_COUNT);
+}
+
+__init void lapic_timer_init(void) {
+    if (!lapic_present()) return;
+
+    lapic_write(LAPIC_TIMER_DIV, TIMER_DIV_16);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, UINT32_MAX);
+    timer_hz = clocksource_calibrate(lapic_timer_elapsed, CALIBRATE_MS);
+    lapic_timer_stop();
+    if (timer_hz == 0) return;
+
+    serial_write("[LAPIC] timer ");
+    serial_write_dec(timer_hz * TIMER_DIVISOR);
+    serial_write(" Hz bus clock\n");
+    clockevent_register(&lapic_event);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// LAPIC timer as the tick clockevent: no port I/O and no trip through the
+// PIC, EOI is one MMIO write. Calibrated against the best clocksource.
+void lapic_timer_init(void);
+
+// LAPIC_TIMER_VECTOR, from isr_handler(); sends the EOI
+void lapic_timer_interrupt(void);
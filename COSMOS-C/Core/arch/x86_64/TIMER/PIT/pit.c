@@ -1,19 +1,82 @@
-#include "pit.h"
-#include "arch/x86_64/IRQ/port.h"
-#include "HAL/console/print.h"
-
-#define PIT_CHANNEL0 0x40
-#define PIT_COMMAND  0x43
-#define PIT_FREQUENCY 1193182 // Hz
-
-// inicjalizacja PIT na określoną częstotliwość
-void pit_init(uint32_t frequency) {
-    uint16_t divisor = (uint16_t)(PIT_FREQUENCY / frequency);
-    outb(PIT_COMMAND, 0x36);            // channel 0, lo/hi byte, mode 3 (square wave)
-    outb(PIT_CHANNEL0, divisor & 0xFF); // low byte
-    outb(PIT_CHANNEL0, divisor >> 8);   // high byte
-
-    print_str("[PIT] Initialized at ");
-    print_int(frequency);
-    print_str(" Hz\n");
-}
\ No newline at end of file
+#include "pit.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stddef.h>
+
+#define PIT_CHANNEL0 0x40
+#define PIT_CHANNEL2 0x42
+#define PIT_COMMAND  0x43
+#define PIT_GATE     0x61     // bit 0: channel 2 gate, bit 1: speaker
+
+#define PIT_MAX_DIVISOR 65536 // written as 0
+
+// ===================== CLOCKEVENT (CHANNEL 0) =====================
+static struct clockevent pit_event;
+
+static void pit_irq(void* ctx) {
+    (void)ctx;
+    if (pit_event.handler) pit_event.handler();
+}
+
+int pit_set_periodic(uint32_t freq) {
+    static int irq_hooked;
+    if (freq == 0) return -EINVAL;
+    uint32_t divisor = (PIT_FREQUENCY + freq / 2) / freq;
+    if (divisor < 2 || divisor > PIT_MAX_DIVISOR) return -EINVAL;
+    if (!irq_hooked && irq_register(0, pit_irq, NULL) < 0) return -EBUSY;
+    irq_hooked = 1;
+
+    outb(PIT_COMMAND, 0x36);                   // channel 0, lo/hi byte, mode 3 (square wave)
+    outb(PIT_CHANNEL0, divisor & 0xFF);        // low byte
+    outb(PIT_CHANNEL0, (divisor >> 8) & 0xFF); // high byte, 65536 -> 0
+    return 0;
+}
+
+// Mode 0 without a count: the output stays low, no more IRQ0
+static void pit_stop(void) {
+    outb(PIT_COMMAND, 0x30);
+}
+
+static struct clockevent pit_event = {
+    .name = "pit",
+    .rating = 100,
+    .flags = CLOCK_EVT_IRQ0,
+    .set_periodic = pit_set_periodic,
+    .stop = pit_stop,
+};
+
+// ===================== CLOCKSOURCE (CHANNEL 2) =====================
+// Latch + two port reads, microseconds under virtualization; the last
+// resort when there is neither an HPET nor a usable TSC. The counter wraps
+// every 55 ms, the tick folds it in well before that.
+static uint64_t pit_read(void) {
+    uint64_t flags = cpu_irq_save();  // latch and both reads are one sequence
+    outb(PIT_COMMAND, 0x80);          // latch channel 2
+    uint8_t lo = inb(PIT_CHANNEL2);
+    uint8_t hi = inb(PIT_CHANNEL2);
+    cpu_irq_restore(flags);
+    return (uint16_t)-(uint16_t)(lo | (hi << 8)); // counts down, make it count up
+}
+
+static struct clocksource pit_source = {
+    .name = "pit",
+    .read = pit_read,
+    .mask = 0xFFFF,
+    .freq_hz = PIT_FREQUENCY,
+    .flags = CLOCK_STABLE,
+};
+
+// ===================== INIT =====================
+__init void pit_init(void) {
+    outb(PIT_GATE, (inb(PIT_GATE) & ~0x02) | 0x01); // gate on, speaker off
+    outb(PIT_COMMAND, 0xB4);                       // channel 2, lo/hi byte, mode 2 (rate generator)
+    outb(PIT_CHANNEL2, 0);                         // divisor 65536: full 16-bit range
+    outb(PIT_CHANNEL2, 0);
+
+    clocksource_register(&pit_source);
+    clockevent_register(&pit_event);
+}
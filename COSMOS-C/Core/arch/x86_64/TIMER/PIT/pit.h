@@ -1,4 +1,10 @@
-#pragma once
-#include <stdint.h>
-
-void pit_init(uint32_t freq);
\ No newline at end of file
+#pragma once
+#include <stdint.h>
+
+#define PIT_FREQUENCY 1193182 // Hz
+
+// Channel 0 as the tick clockevent, channel 2 free running as a clocksource
+void pit_init(void);
+
+// Channel 0 at `freq` Hz, -EINVAL when the divisor does not fit in 16 bits
+int pit_set_periodic(uint32_t freq);
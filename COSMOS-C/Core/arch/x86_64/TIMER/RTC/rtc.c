@@ -0,0 +1,190 @@
+#include "Core/arch/x86_64/TIMER/RTC/rtc.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "arch/x86_64/ACPI/acpi.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "Drivers/serial/serial.h"
+#include "sync/spinlock.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stdint.h>
+
+#define CMOS_INDEX        0x70
+#define CMOS_DATA         0x71
+
+#define RTC_SECONDS       0x00
+#define RTC_MINUTES       0x02
+#define RTC_HOURS         0x04
+#define RTC_DAY           0x07
+#define RTC_MONTH         0x08
+#define RTC_YEAR          0x09
+#define RTC_STATUS_A      0x0A
+#define RTC_STATUS_B      0x0B
+
+#define STATUS_A_UIP      (1u << 7)   // update in progress, registers unstable
+#define STATUS_B_24H      (1u << 1)
+#define STATUS_B_BINARY   (1u << 2)
+#define HOURS_PM          (1u << 7)   // 12-hour mode
+
+#define FADT_CENTURY      108         // FADT byte: CMOS index of the century, 0 = none
+#define UIP_POLLS         10000       // ~1 us per port read: 10 ms, an update takes < 2
+#define READ_ATTEMPTS     8
+
+#define NSEC_PER_SEC      1000000000ull
+
+// The index/data pair is one shared cursor
+static spinlock_t cmos_lock = SPINLOCK_INIT("cmos");
+static uint8_t century_reg;
+
+// ===================== CMOS =====================
+// Bit 7 of the index is the NMI mask; it stays clear
+static uint8_t cmos_read(uint8_t reg) {
+    outb(CMOS_INDEX, reg & 0x7F);
+    return inb(CMOS_DATA);
+}
+
+struct rtc_regs {
+    uint8_t second, minute, hour, day, month, year, century;
+};
+
+static int wait_update(void) {
+    for (int i = 0; i < UIP_POLLS; i++)
+        if (!(cmos_read(RTC_STATUS_A) & STATUS_A_UIP)) return 0;
+    return -EBUSY;
+}
+
+static int read_regs(struct rtc_regs* r) {
+    if (wait_update() < 0) return -EBUSY;
+    r->second = cmos_read(RTC_SECONDS);
+    r->minute = cmos_read(RTC_MINUTES);
+    r->hour = cmos_read(RTC_HOURS);
+    r->day = cmos_read(RTC_DAY);
+    r->month = cmos_read(RTC_MONTH);
+    r->year = cmos_read(RTC_YEAR);
+    r->century = century_reg ? cmos_read(century_reg) : 0;
+    return 0;
+}
+
+static int regs_equal(const struct rtc_regs* a, const struct rtc_regs* b) {
+    return a->second == b->second && a->minute == b->minute && a->hour == b->hour &&
+           a->day == b->day && a->month == b->month && a->year == b->year &&
+           a->century == b->century;
+}
+
+// ===================== DECODING =====================
+static inline uint8_t bcd(uint8_t v) {
+    return (uint8_t)((v >> 4) * 10 + (v & 0x0F));
+}
+
+// An update can start right after UIP was seen clear: read until two
+// passes give the same registers
+int rtc_read(struct rtc_time* t) {
+    struct rtc_regs a, b;
+    uint8_t status;
+    int ok = 0;
+
+    uint64_t flags = spin_lock_irqsave(&cmos_lock);
+    if (read_regs(&a) == 0) {
+        for (int i = 0; i < READ_ATTEMPTS && !ok; i++) {
+            if (read_regs(&b) < 0) break;
+            ok = regs_equal(&a, &b);
+            a = b;
+        }
+    }
+    status = cmos_read(RTC_STATUS_B);
+    spin_unlock_irqrestore(&cmos_lock, flags);
+    if (!ok) return -EBUSY;
+
+    // the PM flag sits on top of the hour in either encoding
+    int pm = a.hour & HOURS_PM;
+    a.hour &= (uint8_t)~HOURS_PM;
+    if (!(status & STATUS_B_BINARY)) {
+        a.second = bcd(a.second);
+        a.minute = bcd(a.minute);
+        a.hour = bcd(a.hour);
+        a.day = bcd(a.day);
+        a.month = bcd(a.month);
+        a.year = bcd(a.year);
+        a.century = bcd(a.century);
+    }
+    if (!(status & STATUS_B_24H)) {
+        a.hour %= 12;                   // 12 AM is 0, 12 PM is 12
+        if (pm) a.hour += 12;
+    }
+
+    t->year = (uint16_t)((a.century ? a.century : 20) * 100 + a.year);
+    t->month = a.month;
+    t->day = a.day;
+    t->hour = a.hour;
+    t->minute = a.minute;
+    t->second = a.second;
+
+    if (t->month < 1 || t->month > 12 || t->day < 1 || t->day > 31 ||
+        t->hour > 23 || t->minute > 59 || t->second > 59 || a.year > 99) return -EINVAL;
+    return 0;
+}
+
+// ===================== CALENDAR =====================
+// Days since 1970-01-01 for a civil date (Hinnant's days_from_civil)
+uint64_t rtc_to_unix(const struct rtc_time* t) {
+    int64_t y = (int64_t)t->year - (t->month <= 2);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t mp = (t->month + 9) % 12;                       // March = 0
+    int64_t doy = (153 * mp + 2) / 5 + t->day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    return (uint64_t)days * 86400 + (uint64_t)t->hour * 3600 + (uint64_t)t->minute * 60 + t->second;
+}
+
+void rtc_from_unix(uint64_t secs, struct rtc_time* t) {
+    uint64_t rem = secs % 86400;
+    int64_t z = (int64_t)(secs / 86400) + 719468;
+    int64_t era = z / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+
+    t->year = (uint16_t)(yoe + era * 400 + (month <= 2));
+    t->month = (uint8_t)month;
+    t->day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    t->hour = (uint8_t)(rem / 3600);
+    t->minute = (uint8_t)(rem / 60 % 60);
+    t->second = (uint8_t)(rem % 60);
+}
+
+// ===================== BOOT =====================
+static void write2(uint32_t v) {
+    serial_putc((char)('0' + v / 10 % 10));
+    serial_putc((char)('0' + v % 10));
+}
+
+// Second resolution: the wall clock is off by up to a second from boot on,
+// the clocksource keeps it moving smoothly from there
+__init void rtc_init(void) {
+    const struct acpi_sdt_header* fadt = acpi_find_table("FACP");
+    if (fadt && fadt->length > FADT_CENTURY) century_reg = ((const uint8_t*)fadt)[FADT_CENTURY];
+
+    struct rtc_time t;
+    int err = rtc_read(&t);
+    if (err < 0) {
+        serial_write("[RTC] unreadable, CLOCK_REALTIME counts from boot\n");
+        return;
+    }
+    timer_set_realtime(rtc_to_unix(&t) * NSEC_PER_SEC);
+
+    serial_write("[RTC] ");
+    serial_write_dec(t.year);
+    serial_putc('-');
+    write2(t.month);
+    serial_putc('-');
+    write2(t.day);
+    serial_putc(' ');
+    write2(t.hour);
+    serial_putc(':');
+    write2(t.minute);
+    serial_putc(':');
+    write2(t.second);
+    serial_write(" UTC\n");
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+// CMOS real-time clock (MC146818 and compatibles). Read once at boot to set
+// CLOCK_REALTIME (timer.h); the readers never touch it again. The RTC keeps
+// whatever the firmware set, taken as UTC.
+
+struct rtc_time {
+    uint16_t year;              // 4 digits
+    uint8_t month;              // 1..12
+    uint8_t day;                // 1..31
+    uint8_t hour;               // 0..23
+    uint8_t minute;
+    uint8_t second;
+};
+
+// Sets CLOCK_REALTIME from the RTC. After timer_init() (the clocksource
+// interpolates between RTC seconds) and acpi_init() (century register).
+void rtc_init(void);
+
+// Current RTC time: waits out an update in progress and reads until two
+// passes agree, then decodes BCD/binary and 12/24-hour. 0, -EBUSY when the
+// update never ends, -EINVAL for out of range values.
+int rtc_read(struct rtc_time* t);
+
+// Seconds since 1970-01-01 00:00:00 UTC, and back (proleptic Gregorian)
+uint64_t rtc_to_unix(const struct rtc_time* t);
+void rtc_from_unix(uint64_t secs, struct rtc_time* t);
@@ -0,0 +1,56 @@
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#include "compiler.h"
+#include <stdint.h>
+
+#define TSC_CALIBRATE_MS 100
+#define TSC_INIT_MS      50
+
+uint64_t tsc_khz = 0;
+
+// ===================== CLOCKSOURCE =====================
+static uint64_t tsc_read(void) {
+    return rdtsc();
+}
+
+// Without the invariant bit the rate follows frequency scaling and may stop
+// in deep C-states: still the cheapest read, but ranked behind stable sources
+static struct clocksource tsc_source = {
+    .name = "tsc",
+    .read = tsc_read,
+    .mask = UINT64_MAX,
+};
+
+__init void tsc_init(void) {
+    uint64_t hz = clocksource_calibrate(tsc_read, TSC_INIT_MS);
+    if (hz == 0) return;
+
+    tsc_khz = hz / 1000;
+    tsc_source.freq_hz = hz;
+    tsc_source.flags = cpu_has(CPU_FEATURE_INVARIANT_TSC) ? CLOCK_STABLE : 0;
+    clocksource_register(&tsc_source);
+}
+
+// ===================== TICK CALIBRATION =====================
+// Count TSC cycles across TSC_CALIBRATE_MS worth of ticks. Interrupts must be on.
+void tsc_calibrate(void) {
+    uint64_t n = (uint64_t)TSC_CALIBRATE_MS * timer_hz() / 1000;
+    if (n == 0) n = 1;
+    uint64_t start_tick = ticks;
+    while (ticks == start_tick) cpu_halt(); // align to a tick edge
+
+    uint64_t t0 = rdtsc();
+    uint64_t edge = ticks;
+    while ((ticks - edge) < n) cpu_halt();
+    uint64_t t1 = rdtsc();
+
+    tsc_khz = (t1 - t0) * timer_hz() / (n * 1000);
+}
+
+uint64_t tsc_cycles_to_ns(uint64_t cycles) {
+    if (tsc_khz == 0) return 0;
+    // split to avoid overflowing cycles * 1000000 for long intervals
+    return (cycles / tsc_khz) * 1000000 + ((cycles % tsc_khz) * 1000000) / tsc_khz;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/CPU/features.h"
+#include <stdint.h>
+
+// TSC frequency in kHz, filled by tsc_init() at boot or tsc_calibrate()
+// (0 = not calibrated)
+extern uint64_t tsc_khz;
+
+// Ordered timestamp read: earlier instructions complete first. lfence does
+// that on Intel but is not dispatch serializing on every AMD part; rdtscp
+// waits on both and is one instruction (patched at boot).
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi, aux;
+    __asm__ volatile (ALTERNATIVE("lfence; rdtsc", "rdtscp", CPU_FEATURE_RDTSCP)
+                      : "=a"(lo), "=d"(hi), "=c"(aux) : : "memory");
+    (void)aux;
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Calibrates against the best registered clocksource and registers the TSC
+// as one (stable when CPUID reports an invariant TSC)
+void tsc_init(void);
+
+// Fallback calibration against the tick, interrupts must be on
+void tsc_calibrate(void);
+uint64_t tsc_cycles_to_ns(uint64_t cycles);
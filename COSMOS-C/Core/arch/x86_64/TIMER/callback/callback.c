@@ -1,5 +1,13 @@
 #include "callback.h"
 #include "Core/arch/x86_64/TIMER/timer.h"
+#include "arch/x86_64/MM/vm.h"
+#include "sync/spinlock.h"
+#include "param/param.h"
+#include "lib/string.h"
+#include "compiler.h"
+
+// due callbacks collected per lock hold in timer_callbacks_update()
+#define CALLBACKS_BATCH 16
 
 typedef struct {
     timer_callback_t cb;
@@ -7,31 +15,74 @@ typedef struct {
     uint8_t active;
 } callback_entry_t;
 
-static callback_entry_t callbacks[MAX_CALLBACKS];
+// callbacks.max slots from timer_callbacks_init(); none before, so an early
+// set_timeout() is dropped like one into a full table
+static callback_entry_t* callbacks;
+static uint32_t slots;
+
+// timer_callbacks_update() runs in IRQ0, so the other paths take it with irqsave
+static spinlock_t callbacks_lock = SPINLOCK_INIT("callbacks");
+
+// Backed now: IRQ0 scans the slots, and a demand fault there would need vm_lock
+__init void timer_callbacks_init(void) {
+    if (callbacks) return;
+    uint32_t n = param_get(PARAM_CALLBACKS_MAX);
+    callback_entry_t* mem = vm_reserve(n * sizeof(*mem), VM_READ | VM_WRITE, "callbacks");
+    if (!mem) return;
+    memset(mem, 0, n * sizeof(*mem));
+
+    uint64_t flags = spin_lock_irqsave(&callbacks_lock);
+    callbacks = mem;
+    slots = n;
+    spin_unlock_irqrestore(&callbacks_lock, flags);
+}
 
 // add new timer
 void set_timeout(timer_callback_t cb, uint64_t ms) {
-    for (int i = 0; i < MAX_CALLBACKS; i++) {
+    uint64_t target = timer_uptime_ms() + ms;
+    uint64_t flags = spin_lock_irqsave(&callbacks_lock);
+    for (uint32_t i = 0; i < slots; i++) {
         if (!callbacks[i].active) {
             callbacks[i].cb = cb;
-            callbacks[i].target_tick = timer_uptime_ms() + ms;
+            callbacks[i].target_tick = target;
             callbacks[i].active = 1;
             break;
         }
     }
+    spin_unlock_irqrestore(&callbacks_lock, flags);
 }
 
-// checks whether any timer has reached its target
-void timer_callbacks_update(void) {
-    uint64_t now = timer_uptime_ms();
-    for (int i = 0; i < MAX_CALLBACKS; i++) {
-        if (callbacks[i].active && now >= callbacks[i].target_tick) {
-            callbacks[i].active = 0; // deactivation
-            if (callbacks[i].cb) callbacks[i].cb();
+// removes every pending timer that would call cb
+void cancel_timeout(timer_callback_t cb) {
+    uint64_t flags = spin_lock_irqsave(&callbacks_lock);
+    for (uint32_t i = 0; i < slots; i++) {
+        if (callbacks[i].active && callbacks[i].cb == cb) {
+            callbacks[i].active = 0;
         }
     }
-<<<<<<< HEAD
+    spin_unlock_irqrestore(&callbacks_lock, flags);
 }
-=======
+
+// checks whether any timer has reached its target
+// Due callbacks run after the lock is dropped, so they may re-arm themselves;
+// a re-armed one takes a free slot at or before its old one, so it can't run
+// twice in one update.
+__hot void timer_callbacks_update(void) {
+    timer_callback_t due[CALLBACKS_BATCH];
+    uint64_t now = timer_uptime_ms();
+    uint32_t i = 0;
+
+    do {
+        int n = 0;
+        spin_lock(&callbacks_lock);
+        for (; i < slots && n < CALLBACKS_BATCH; i++) {
+            if (callbacks[i].active && now >= callbacks[i].target_tick) {
+                callbacks[i].active = 0; // deactivation
+                if (callbacks[i].cb) due[n++] = callbacks[i].cb;
+            }
+        }
+        spin_unlock(&callbacks_lock);
+
+        for (int j = 0; j < n; j++) due[j]();
+    } while (i < slots);
 }
->>>>>>> 24522878a6beab94af9c35dce3e21874168045e6
@@ -1,8 +1,13 @@
 #pragma once
 #include <stdint.h>
 
-#define MAX_CALLBACKS 16
+// Pending timeouts: `callbacks.max=` slots (Core/param), up to CALLBACKS_MAX,
+// allocated by timer_init()
+#define CALLBACKS_DEFAULT 16
+#define CALLBACKS_MAX     64
 
 typedef void (*timer_callback_t)(void);
+void timer_callbacks_init(void);
 void set_timeout(timer_callback_t cb, uint64_t ms);
+void cancel_timeout(timer_callback_t cb);
 void timer_callbacks_update(void);
\ No newline at end of file
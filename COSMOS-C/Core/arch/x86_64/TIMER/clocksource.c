@@ -0,0 +1,223 @@
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/PIT/pit.h"
+#include "Core/arch/x86_64/TIMER/HPET/hpet.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Core/arch/x86_64/TIMER/LAPIC/lapic_timer.h"
+#include "Core/arch/x86_64/TIMER/RTC/rtc.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Drivers/serial/serial.h"
+#include "param/param.h"
+#include "HAL/console/print.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define NSEC_PER_SEC        1000000000ull
+#define MAX_DELTA_SEC       600     // longest interval a single delta may cover
+#define READ_COST_LOOPS     256
+#define READ_COST_ROUNDS    8
+
+static struct clocksource* sources[CLOCK_MAX_SOURCES];
+static struct clockevent* events[CLOCK_MAX_EVENTS];
+static uint32_t source_count;
+static uint32_t event_count;
+
+static const struct clocksource* current_source;
+static const struct clockevent* current_event;
+
+// ===================== REGISTRATION =====================
+// Largest shift whose mult still fits in 32 bits and keeps delta * mult in
+// 64 bits for deltas up to MAX_DELTA_SEC (or the counter width)
+static void calc_mult_shift(struct clocksource* cs) {
+    uint64_t max_delta = cs->freq_hz * MAX_DELTA_SEC;
+    if (max_delta > cs->mask) max_delta = cs->mask;
+
+    for (uint32_t shift = 32; shift > 0; shift--) {
+        uint64_t mult = (NSEC_PER_SEC << shift) / cs->freq_hz;
+        if (mult > UINT32_MAX || (mult && max_delta > UINT64_MAX / mult)) continue;
+        cs->mult = (uint32_t)mult;
+        cs->shift = shift;
+        return;
+    }
+    cs->mult = (uint32_t)(NSEC_PER_SEC / cs->freq_hz);
+    cs->shift = 0;
+}
+
+void clocksource_register(struct clocksource* cs) {
+    if (source_count == CLOCK_MAX_SOURCES || cs->freq_hz == 0) return;
+    calc_mult_shift(cs);
+    sources[source_count++] = cs;
+}
+
+void clockevent_register(struct clockevent* ce) {
+    if (event_count < CLOCK_MAX_EVENTS) events[event_count++] = ce;
+}
+
+const struct clocksource* clocksource_current(void) { return current_source; }
+const struct clockevent* clockevent_current(void) { return current_event; }
+uint32_t clocksource_count(void) { return source_count; }
+
+const struct clocksource* clocksource_at(uint32_t index) {
+    return index < source_count ? sources[index] : NULL;
+}
+
+// ===================== CALIBRATION =====================
+// Reference for calibrating the others: stable and highest resolution,
+// read cost does not matter here
+static const struct clocksource* reference(void) {
+    const struct clocksource* best = NULL;
+    for (uint32_t i = 0; i < source_count; i++) {
+        const struct clocksource* cs = sources[i];
+        if (!(cs->flags & CLOCK_STABLE)) continue;
+        if (!best || cs->freq_hz > best->freq_hz) best = cs;
+    }
+    return best;
+}
+
+__init uint64_t clocksource_calibrate(uint64_t (*counter)(void), uint32_t ms) {
+    const struct clocksource* ref = reference();
+    if (!ref || ms == 0) return 0;
+
+    uint64_t target = ref->freq_hz * ms / 1000;
+    uint64_t elapsed = 0;
+    uint64_t last = ref->read();
+    uint64_t c0 = counter();
+    while (elapsed < target) {
+        uint64_t now = ref->read();
+        elapsed += (now - last) & ref->mask;
+        last = now;
+    }
+    uint64_t c1 = counter();
+
+    // scale by the reference time that actually passed, not the target
+    return (c1 - c0) * ref->freq_hz / elapsed;
+}
+
+// ===================== SELECTION =====================
+// Best of READ_COST_ROUNDS, so an interrupt or a VM exit in one round
+// doesn't count
+__init static void measure_read_cost(struct clocksource* cs) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < READ_COST_ROUNDS; r++) {
+        uint64_t t0 = rdtsc();
+        for (int i = 0; i < READ_COST_LOOPS; i++) cs->read();
+        uint64_t t1 = rdtsc();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    cs->read_cycles = (uint32_t)(best / READ_COST_LOOPS);
+}
+
+// stability, then read cost, then resolution
+static int source_better(const struct clocksource* a, const struct clocksource* b) {
+    if ((a->flags ^ b->flags) & CLOCK_STABLE) return a->flags & CLOCK_STABLE;
+    if (a->read_cycles != b->read_cycles) return a->read_cycles < b->read_cycles;
+    return a->freq_hz > b->freq_hz;
+}
+
+__init static void select_source(void) {
+    for (uint32_t i = 0; i < source_count; i++) {
+        measure_read_cost(sources[i]);
+        if (!current_source || source_better(sources[i], current_source)) current_source = sources[i];
+    }
+}
+
+// Highest rating whose set_periodic() succeeds; the rest are stopped so
+// only one device raises the tick
+__init static void select_event(uint32_t hz) {
+    while (!current_event) {
+        struct clockevent* best = NULL;
+        for (uint32_t i = 0; i < event_count; i++) {
+            if (events[i]->rating < 0) continue;
+            if (!best || events[i]->rating > best->rating) best = events[i];
+        }
+        if (!best) break;
+        best->handler = timer_tick;
+        if (best->set_periodic(hz) == 0) {
+            current_event = best;
+        } else {
+            best->handler = NULL;
+            best->rating = -1;  // failed, don't try again
+        }
+    }
+
+    for (uint32_t i = 0; i < event_count; i++)
+        if (events[i] != current_event && events[i]->stop) events[i]->stop();
+}
+
+// Two IRQ0 events can't run together: the HPET legacy route takes IRQ0
+// away from the PIT
+static int event_compatible(const struct clockevent* ce) {
+    if (ce->handler || ce->rating < 0) return 0;
+    for (uint32_t i = 0; i < event_count; i++)
+        if (events[i]->handler && (events[i]->flags & ce->flags & CLOCK_EVT_IRQ0)) return 0;
+    return 1;
+}
+
+struct clockevent* clockevent_claim(uint32_t hz, void (*handler)(void)) {
+    struct clockevent* best = NULL;
+    for (uint32_t i = 0; i < event_count; i++) {
+        if (!event_compatible(events[i])) continue;
+        if (!best || events[i]->rating > best->rating) best = events[i];
+    }
+    if (!best) return NULL;
+
+    best->handler = handler;
+    if (best->set_periodic(hz) < 0) {
+        best->handler = NULL;
+        return NULL;
+    }
+    return best;
+}
+
+void clockevent_release(struct clockevent* ce) {
+    if (ce->stop) ce->stop();
+    ce->handler = NULL;
+}
+
+// ===================== BOOT =====================
+// Drivers register first; TSC and LAPIC timer calibrate against the best
+// source already registered, so they come last. The RTC only sets the wall
+// clock, once the source it is interpolated with is in place.
+__init void timer_init(void) {
+    timer_callbacks_init();     // before the first tick scans them
+    pit_init();
+    hpet_init();
+    tsc_init();
+    lapic_timer_init();
+
+    timer_set_hz(param_get(PARAM_TIMER_HZ));
+    select_event(timer_hz());
+    select_source();
+    if (current_source) timer_set_clocksource(current_source);
+    rtc_init();
+    clocksource_report();
+}
+
+// ===================== REPORT =====================
+__init void clocksource_report(void) {
+    for (uint32_t i = 0; i < source_count; i++) {
+        const struct clocksource* cs = sources[i];
+        serial_write("[CLOCK] source ");
+        serial_write(cs->name);
+        serial_write(" freq_hz=");
+        serial_write_dec(cs->freq_hz);
+        serial_write(" read_cycles=");
+        serial_write_dec(cs->read_cycles);
+        serial_write(cs->flags & CLOCK_STABLE ? " stable" : " unstable");
+        serial_write(cs == current_source ? " (selected)\n" : "\n");
+    }
+    for (uint32_t i = 0; i < event_count; i++) {
+        serial_write("[CLOCK] event ");
+        serial_write(events[i]->name);
+        serial_write(events[i] == current_event ? " (selected)\n" : "\n");
+    }
+
+    print_str("[CLOCK] tick: ");
+    print_str(current_event ? (char*)current_event->name : "none");
+    print_str(" at ");
+    print_int((int)timer_hz());
+    print_str(" Hz, time: ");
+    print_str(current_source ? (char*)current_source->name : "ticks");
+    print_str("\n");
+}
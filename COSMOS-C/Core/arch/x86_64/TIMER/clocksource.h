@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+
+// Clock sources (free running counters the time is read from) and clock
+// events (the device that raises the periodic tick). Every driver registers
+// what it has during timer_init(); the best of each is picked once at boot.
+//
+//   source  PIT ch2   HPET main counter   TSC
+//   event   PIT ch0   HPET timer 0        LAPIC timer
+
+#define CLOCK_STABLE       (1u << 0)   // constant rate, shared by all CPUs
+#define CLOCK_EVT_IRQ0     (1u << 1)   // event raised on IRQ0 (PIT, HPET legacy route)
+
+#define CLOCK_MAX_SOURCES  4
+#define CLOCK_MAX_EVENTS   4
+
+struct clocksource {
+    const char* name;
+    uint64_t (*read)(void);
+    uint64_t mask;              // counter width, deltas are taken modulo mask + 1
+    uint64_t freq_hz;
+    uint32_t flags;
+    // filled by clocksource_register() / timer_init()
+    uint32_t mult;              // ns = (delta * mult) >> shift
+    uint32_t shift;
+    uint32_t read_cycles;       // TSC cycles per read(), measured at boot
+};
+
+struct clockevent {
+    const char* name;
+    int rating;                 // higher wins
+    uint32_t flags;
+    int (*set_periodic)(uint32_t hz);   // 0 on success
+    void (*stop)(void);
+    void (*handler)(void);      // run on every expiry, set by the owner
+};
+
+void clocksource_register(struct clocksource* cs);
+void clockevent_register(struct clockevent* ce);
+
+// Ranking: stable first, then cheapest read, then highest resolution
+const struct clocksource* clocksource_current(void);
+const struct clockevent* clockevent_current(void);
+
+uint32_t clocksource_count(void);
+const struct clocksource* clocksource_at(uint32_t index);
+
+// A second periodic interrupt next to the tick (profiler): the best
+// registered event that can run alongside the tick device. Started with
+// `handler` at `hz`; NULL when there is none or it is taken.
+struct clockevent* clockevent_claim(uint32_t hz, void (*handler)(void));
+void clockevent_release(struct clockevent* ce);
+
+// Frequency in Hz of `counter`, polled against the best registered source
+// for `ms` milliseconds (no interrupts needed). 0 without a reference.
+uint64_t clocksource_calibrate(uint64_t (*counter)(void), uint32_t ms);
+
+// Read cost table and the choice, on the console and COM1 (boot only)
+void clocksource_report(void);
@@ -1,30 +1,132 @@
 #include "Core/arch/x86_64/TIMER/timer.h"
-#include "Core/arch/x86_64/TIMER/PIT/pit.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
 #include "Core/arch/x86_64/TIMER/callback/callback.h"
 #include "HAL/console/print.h"
+#include "sync/seqlock.h"
+#include "lib/errno.h"
+#include "compiler.h"
 #include <stdint.h>
 
 volatile uint64_t ticks = 0;
 
-void timer_init(void) {
-    pit_init(1000); // 1000 Hz = 1ms tick    
+// Written only by timer_tick() (IRQ0). The busy-wait loops may read `ticks`
+// directly, anything that wants a consistent clock goes through the seqlock.
+static seqlock_t clock_lock = SEQLOCK_INIT("clock");
+
+#define NSEC_PER_SEC  1000000000ull
+
+static uint32_t tick_hz = TIMER_HZ;
+static uint64_t nsec_per_tick = NSEC_PER_SEC / TIMER_HZ;
+
+// Clocksource time, folded in on every tick so deltas stay short.
+// `frac` keeps the sub-nanosecond remainder (<< shift) so nothing drifts.
+static const struct clocksource* tk_source; // set once at boot
+static uint64_t tk_cycle_last;
+static uint64_t tk_ns;
+static uint64_t tk_frac;
+// CLOCK_REALTIME - CLOCK_MONOTONIC: Unix time of timer_init(), in ns
+static uint64_t tk_wall_ns;
+
+static inline uint64_t tk_delta_scaled(uint64_t now) {
+    return ((now - tk_cycle_last) & tk_source->mask) * tk_source->mult + tk_frac;
 }
 
-void timer_tick(void) {
-    ticks++;
+__hot void timer_tick(void) {
+    write_seqlock(&clock_lock);
+    atomic_write(&ticks, ticks + 1, MO_RELAXED);
+    if (tk_source) {
+        uint64_t now = tk_source->read();
+        uint64_t scaled = tk_delta_scaled(now);
+        tk_ns += scaled >> tk_source->shift;
+        tk_frac = scaled & ((1ull << tk_source->shift) - 1);
+        tk_cycle_last = now;
+    } else {
+        tk_ns += nsec_per_tick;
+    }
+    write_sequnlock(&clock_lock);
     timer_callbacks_update();
 }
 
+uint32_t timer_hz(void) { return tick_hz; }
+
+// Boot, before the tick device is programmed
+void timer_set_hz(uint32_t hz) {
+    if (hz < TIMER_HZ_MIN || hz > TIMER_HZ_MAX) return;
+    tick_hz = hz;
+    nsec_per_tick = NSEC_PER_SEC / hz;
+}
+
+// Boot, before interrupts are on
+void timer_set_clocksource(const struct clocksource* cs) {
+    write_seqlock(&clock_lock);
+    tk_source = cs;
+    tk_cycle_last = cs->read();
+    tk_frac = 0;
+    write_sequnlock(&clock_lock);
+}
+
+// One snapshot: monotonic ns (base + scaled cycle delta) and the wall
+// offset that goes with it. No lock, no port, no interrupt needed.
+static inline uint64_t tk_now(uint64_t* wall) {
+    uint64_t ns, offset;
+    uint32_t seq;
+    do {
+        seq = read_seqbegin(&clock_lock);
+        ns = tk_ns;
+        offset = tk_wall_ns;
+        if (tk_source) ns += tk_delta_scaled(tk_source->read()) >> tk_source->shift;
+    } while (read_seqretry(&clock_lock, seq));
+    *wall = offset;
+    return ns;
+}
+
+uint64_t timer_uptime_ns(void) {
+    uint64_t wall;
+    return tk_now(&wall);
+}
+
+uint64_t timer_realtime_ns(void) {
+    uint64_t wall;
+    uint64_t ns = tk_now(&wall);
+    return ns + wall;
+}
+
+int timer_clock_gettime(uint32_t clock, struct timer_timespec* ts) {
+    uint64_t wall;
+    uint64_t ns = tk_now(&wall);
+    if (clock == TIMER_CLOCK_REALTIME) ns += wall;
+    else if (clock != TIMER_CLOCK_MONOTONIC) return -EINVAL;
+    ts->tv_sec = (int64_t)(ns / NSEC_PER_SEC);
+    ts->tv_nsec = (int64_t)(ns % NSEC_PER_SEC);
+    return 0;
+}
+
+// Steps CLOCK_REALTIME; CLOCK_MONOTONIC doesn't move
+void timer_set_realtime(uint64_t unix_ns) {
+    uint64_t flags = write_seqlock_irqsave(&clock_lock);
+    uint64_t now = tk_ns;
+    if (tk_source) now += tk_delta_scaled(tk_source->read()) >> tk_source->shift;
+    tk_wall_ns = unix_ns - now;
+    write_sequnlock_irqrestore(&clock_lock, flags);
+}
+
 void sleep_ms(uint64_t ms) {
-    uint64_t start = ticks;
+    uint64_t start = timer_uptime_ms();
     print_char(' ');
-    while ((ticks - start) < ms) {
-        __asm__ volatile("hlt");
+    while ((timer_uptime_ms() - start) < ms) {
+        cpu_halt();
     }
 }
 
 uint64_t timer_uptime_ms(void) {
-    return ticks;
+    uint64_t now;
+    uint32_t seq;
+    do {
+        seq = read_seqbegin(&clock_lock);
+        now = atomic_read(&ticks, MO_RELAXED);
+    } while (read_seqretry(&clock_lock, seq));
+    return now * 1000 / tick_hz;
 }
 
 // ================= TIME CONVERSION =================
@@ -41,7 +143,7 @@ timer_time_t timer_convert_ms(uint64_t ms) {
 
 // Prints uptime in HH:MM:SS.ms format
 void timer_print_uptime(void) {
-    timer_time_t t = timer_convert_ms(ticks);
+    timer_time_t t = timer_convert_ms(timer_uptime_ms());
     print_int(t.hours);   print_str(":");
     print_int(t.minutes); print_str(":");
     print_int(t.seconds); print_str(".");
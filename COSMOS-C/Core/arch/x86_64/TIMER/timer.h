@@ -1,11 +1,48 @@
 #pragma once
 #include <stdint.h>
 
+struct clocksource;
+
+// Default tick rate; `timer.hz=` on the command line (Core/param) picks
+// another in MIN..MAX. `ticks` counts ticks, timer_uptime_ms() converts.
+#define TIMER_HZ      1000
+#define TIMER_HZ_MIN  19      // PIT divisor limit (65536)
+#define TIMER_HZ_MAX  10000
+
+// Picks and starts the clock sources (clocksource.c) at the timer.hz rate
 void timer_init(void);
 void timer_tick(void);
 void sleep_ms(uint64_t ms);
 uint64_t timer_uptime_ms(void);
 
+// Tick rate. timer_set_hz() only before the tick starts (timer_init).
+uint32_t timer_hz(void);
+void timer_set_hz(uint32_t hz);
+
+// Nanoseconds since timer_init(), interpolated between ticks with the
+// selected clocksource (tick resolution without one)
+uint64_t timer_uptime_ns(void);
+void timer_set_clocksource(const struct clocksource* cs);
+
+// ===================== WALL CLOCK =====================
+// clock_gettime() style readers. MONOTONIC is timer_uptime_ns(); REALTIME
+// adds the Unix time of boot, set from the CMOS RTC (TIMER/RTC) and stepped
+// by timer_set_realtime(). Both read one seqlock'd snapshot: no lock, no
+// port access, any context. Numbers as on Linux.
+#define TIMER_CLOCK_REALTIME   0
+#define TIMER_CLOCK_MONOTONIC  1
+
+struct timer_timespec {
+    int64_t tv_sec;
+    int64_t tv_nsec;
+};
+
+// 0, or -EINVAL for an unknown clock
+int timer_clock_gettime(uint32_t clock, struct timer_timespec* ts);
+// ns since 1970-01-01 00:00:00 UTC (since boot until the RTC was read)
+uint64_t timer_realtime_ns(void);
+void timer_set_realtime(uint64_t unix_ns);
+
 extern volatile uint64_t ticks;
 
 typedef struct {
@@ -16,4 +53,4 @@ typedef struct {
 } timer_time_t;
 
 timer_time_t timer_convert_ms(uint64_t ms);
-void timer_print_uptime(void);
\ No newline at end of file
+void timer_print_uptime(void);
@@ -0,0 +1,38 @@
+; fentry.asm - function entry hook of the tracer (Core/trace/ftrace.h)
+; Trace builds compile C with -pg -mfentry -mnop-mcount: every function
+; starts with a 5-byte NOP, recorded in __mcount_loc. Enabling a function
+; patches its NOP into `call __fentry__`, so only traced functions get here.
+; Runs before the traced function's prologue: the argument registers are
+; live and must survive.
+extern ftrace_entry
+
+section .text.hot progbits alloc exec nowrite align=16
+global __fentry__
+
+; [rsp] = call site + 5 in the traced function, [rsp + 8] = its caller
+__fentry__:
+    push rax            ; varargs count
+    push rdi
+    push rsi
+    push rdx
+    push rcx
+    push r8
+    push r9
+    push r10
+    push r11
+    mov rdi, [rsp + 72]
+    sub rdi, 5          ; ip: the patched call site
+    mov rsi, [rsp + 80] ; parent ip
+    sub rsp, 8          ; 16-aligned on entry, 9 pushes leave it 8 off
+    call ftrace_entry
+    add rsp, 8
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rcx
+    pop rdx
+    pop rsi
+    pop rdi
+    pop rax
+    ret
@@ -9,8 +9,23 @@ header_start:
     ; checksum
     dd 0x100000000 - (0xe85250d6 + 0 + (header_end - header_start))
 
+    ; information request: memory map, modules, command line
+    align 8
+    dw 1
+    dw 0
+    dd 20
+    dd 6, 3, 1
+
+    ; module alignment: modules start on a page boundary, so file data
+    ; can be mapped straight from the module (initrd)
+    align 8
+    dw 6
+    dw 0
+    dd 8
+
     ; end tag
+    align 8
     dw 0
     dw 0
     dd 8
-header_end:
\ No newline at end of file
+header_end:
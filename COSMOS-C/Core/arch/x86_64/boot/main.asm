@@ -1,10 +1,12 @@
 global start 
+global multiboot_info
 extern long_mode_start
 
-section .text
+section .text.cold progbits alloc exec nowrite align=16 ; boot only, see linker.ld
 bits 32
 start:
     mov esp, stack_top
+    mov [multiboot_info], ebx ; physical address of the multiboot2 info structure
 
     call check_multiboot
     call check_cpuid
@@ -117,6 +119,8 @@ error:
 	hlt
 
 section .bss
+multiboot_info:
+	resd 1
 align 4096
 page_table_l4:
 	resb 4096
@@ -129,6 +133,7 @@ stack_bottom:
 stack_top:
 
 section .rodata
+; just enough to reach long mode, gdt_init() (GDT/gdt.c) loads the real one
 gdt64:
 	dq 0 ; zero entry
 .code_segment: equ $ - gdt64
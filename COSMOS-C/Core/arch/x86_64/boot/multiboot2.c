@@ -0,0 +1,37 @@
+#include "arch/x86_64/boot/multiboot2.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// The info structure stays where GRUB left it (below 1 GiB, identity mapped);
+// pmm_init() keeps its pages out of the allocator.
+
+static uint64_t info_start;
+static uint64_t info_end;
+
+// fixed part: total_size, reserved, then 8-byte aligned tags
+__init void multiboot2_init(void) {
+    info_start = multiboot_info;
+    info_end = info_start + *(const uint32_t*)(uintptr_t)info_start;
+}
+
+uint64_t multiboot2_info_start(void) { return info_start; }
+uint64_t multiboot2_info_end(void) { return info_end; }
+
+const struct mb2_tag* multiboot2_find(uint32_t type, const struct mb2_tag* prev) {
+    if (!info_start) return NULL;
+
+    uintptr_t p = prev ? (uintptr_t)prev + ((prev->size + 7) & ~7u) : (uintptr_t)info_start + 8;
+    while (p + sizeof(struct mb2_tag) <= info_end) {
+        const struct mb2_tag* tag = (const struct mb2_tag*)p;
+        if (tag->type == MB2_TAG_END || tag->size < sizeof(struct mb2_tag)) return NULL;
+        if (tag->type == type) return tag;
+        p += (tag->size + 7) & ~7u;
+    }
+    return NULL;
+}
+
+const char* multiboot2_cmdline(void) {
+    const struct mb2_tag_string* tag = (const struct mb2_tag_string*)multiboot2_find(MB2_TAG_CMDLINE, NULL);
+    return tag ? tag->string : "";
+}
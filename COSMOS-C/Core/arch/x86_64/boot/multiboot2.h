@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== TAG TYPES =====================
+#define MB2_TAG_END        0
+#define MB2_TAG_CMDLINE    1
+#define MB2_TAG_MODULE     3
+#define MB2_TAG_MMAP       6
+#define MB2_TAG_ACPI_OLD   14   // copy of the ACPI 1.0 RSDP
+#define MB2_TAG_ACPI_NEW   15   // copy of the ACPI 2.0+ RSDP
+
+#define MB2_MEMORY_AVAILABLE 1
+
+struct mb2_tag {
+    uint32_t type;
+    uint32_t size;
+} __attribute__((packed));
+
+struct mb2_mmap_entry {
+    uint64_t addr;
+    uint64_t len;
+    uint32_t type;
+    uint32_t reserved;
+} __attribute__((packed));
+
+struct mb2_tag_mmap {
+    uint32_t type;
+    uint32_t size;
+    uint32_t entry_size;
+    uint32_t entry_version;
+    struct mb2_mmap_entry entries[];
+} __attribute__((packed));
+
+struct mb2_tag_module {
+    uint32_t type;
+    uint32_t size;
+    uint32_t mod_start;
+    uint32_t mod_end;
+    char cmdline[];
+} __attribute__((packed));
+
+struct mb2_tag_string {
+    uint32_t type;
+    uint32_t size;
+    char string[];
+} __attribute__((packed));
+
+// ===================== API =====================
+// Physical address saved from ebx by boot/main.asm
+extern uint32_t multiboot_info;
+
+void multiboot2_init(void);
+uint64_t multiboot2_info_start(void);
+uint64_t multiboot2_info_end(void);
+
+// Next tag of `type` after `prev` (NULL = from the start), NULL when done
+const struct mb2_tag* multiboot2_find(uint32_t type, const struct mb2_tag* prev);
+
+// Kernel command line from the bootloader, "" without one
+const char* multiboot2_cmdline(void);
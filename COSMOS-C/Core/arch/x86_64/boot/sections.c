@@ -0,0 +1,127 @@
+#include "arch/x86_64/boot/sections.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/MM/vmm.h"
+#include "Drivers/serial/serial.h"
+#include "HAL/console/print.h"
+#include "lib/string.h"
+#include <stdint.h>
+
+// 2 MiB regions that hold code or read-only data get split into 4K pages
+#define SPLIT_TABLES    4
+
+static uint64_t split_tables[SPLIT_TABLES][PT_ENTRIES] __attribute__((aligned(PAGE_SIZE)));
+
+#define IN(addr, sec) ((addr) >= (uintptr_t)__##sec##_start && (addr) < (uintptr_t)__##sec##_end)
+
+// ===================== INIT MEMORY =====================
+// The .init region is only used during boot. Fill it with int3 so a stray
+// call into it traps until the page is reused, then give it to the PMM.
+void free_init_memory(void) {
+    size_t size = (size_t)(__init_end - __init_start);
+    memset(__init_start, 0xCC, size);
+    pmm_free_range((uintptr_t)__init_start, (uintptr_t)__init_end);
+
+    print_str("[MEM] freed ");
+    print_int((int)(size / 1024));
+    print_str(" KiB of init code\n");
+}
+
+// ===================== PROTECTION =====================
+// Permissions for one 4K page of the identity map:
+// text R-X, rodata R--, everything else RW- (NX only when the CPU has it)
+static uint64_t page_flags(uintptr_t addr, uint64_t nx) {
+    if (IN(addr, text)) return PTE_PRESENT;
+    if (IN(addr, rodata)) return PTE_PRESENT | nx;
+    return PTE_PRESENT | PTE_WRITE | nx;
+}
+
+static int region_needs_split(uintptr_t base) {
+    uintptr_t end = base + HUGE_PAGE_SIZE;
+    return (base < (uintptr_t)__text_end && end > (uintptr_t)__text_start)
+        || (base < (uintptr_t)__rodata_end && end > (uintptr_t)__rodata_start);
+}
+
+// Replaces the boot-time RWX 2 MiB mappings of the first GiB with W^X
+// mappings that follow the section layout. Call after free_init_memory().
+// NXE and CR0.WP are already on (vmm_init).
+void sections_protect(void) {
+    uint64_t nx = vmm_nx;
+
+    // boot page tables: L4[0] -> L3[0] -> L2 with 512 huge pages (identity)
+    uint64_t* l4 = (uint64_t*)(cpu_read_cr3() & PTE_ADDR_MASK);
+    uint64_t* l3 = (uint64_t*)(l4[0] & PTE_ADDR_MASK);
+    uint64_t* l2 = (uint64_t*)(l3[0] & PTE_ADDR_MASK);
+    int used = 0;
+
+    for (int i = 0; i < PT_ENTRIES; i++) {
+        uintptr_t base = (uintptr_t)i * HUGE_PAGE_SIZE;
+
+        if (!region_needs_split(base)) {
+            l2[i] |= nx;
+            continue;
+        }
+        if (used == SPLIT_TABLES) {
+            print_str("[MEM] sections_protect: out of page tables\n");
+            continue;
+        }
+
+        uint64_t* pt = split_tables[used++];
+        for (int j = 0; j < PT_ENTRIES; j++) {
+            uintptr_t addr = base + (uintptr_t)j * PAGE_SIZE;
+            pt[j] = addr | page_flags(addr, nx);
+        }
+        l2[i] = (uint64_t)pt | PTE_PRESENT | PTE_WRITE;
+    }
+
+    cpu_write_cr3(cpu_read_cr3());                // flush the TLB
+}
+
+// ===================== USER ACCESS =====================
+// There is no user address space yet, so ring 3 code (the syscall benchmark)
+// runs straight out of the kernel image. This sets or clears the U bit on
+// every level of the identity map that covers the image.
+void sections_user_access(int allow) {
+    uint64_t* l4 = (uint64_t*)(cpu_read_cr3() & PTE_ADDR_MASK);
+    uint64_t* l3 = (uint64_t*)(l4[0] & PTE_ADDR_MASK);
+    uint64_t* l2 = (uint64_t*)(l3[0] & PTE_ADDR_MASK);
+    uint64_t user = allow ? PTE_USER : 0;
+
+    // L4[0] also covers user space (USER_BASE), so its U bit stays set
+    l4[0] |= PTE_USER;
+    l3[0] = (l3[0] & ~PTE_USER) | user;
+
+    for (uintptr_t base = (uintptr_t)__kernel_start & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+         base < (uintptr_t)__kernel_end; base += HUGE_PAGE_SIZE) {
+        int i = (int)(base / HUGE_PAGE_SIZE);
+        l2[i] = (l2[i] & ~PTE_USER) | user;
+        if (l2[i] & PTE_HUGE) continue;
+
+        uint64_t* pt = (uint64_t*)(l2[i] & PTE_ADDR_MASK);
+        for (int j = 0; j < PT_ENTRIES; j++) pt[j] = (pt[j] & ~PTE_USER) | user;
+    }
+
+    cpu_write_cr3(cpu_read_cr3());
+}
+
+// ===================== REPORT =====================
+static void report_section(const char* name, const char* start, const char* end) {
+    serial_write("[MEM] ");
+    serial_write(name);
+    serial_write(" ");
+    serial_write_hex((uintptr_t)start);
+    serial_write(" ");
+    serial_write_dec((uint64_t)(end - start));
+    serial_write(" bytes\n");
+}
+
+void sections_report(void) {
+    report_section(".init    ", __init_start, __init_end);
+    report_section(".text    ", __text_start, __text_end);
+    report_section(".text.hot", __text_hot_start, __text_hot_end);
+    report_section(".rodata  ", __rodata_start, __rodata_end);
+    report_section(".data    ", __data_start, __data_end);
+    report_section(".bss     ", __bss_start, __bss_end);
+    report_section("kernel   ", __kernel_start, __kernel_end);
+}
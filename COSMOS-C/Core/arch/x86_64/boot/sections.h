@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+// Section boundaries exported by targets/x86_64/linker.ld
+extern char __kernel_start[], __kernel_end[];
+extern char __init_start[], __init_end[];
+extern char __text_start[], __text_end[];
+extern char __text_hot_start[], __text_hot_end[];
+extern char __rodata_start[], __rodata_end[];
+extern char __data_start[], __data_end[];
+extern char __bss_start[], __bss_end[];
+
+void free_init_memory(void);
+void sections_protect(void);
+void sections_report(void);
+void sections_user_access(int allow);
@@ -0,0 +1,290 @@
+#include "async/async.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "Drivers/virtio/virtio_blk.h"
+#include "sync/atomic.h"
+#include "sync/spinlock.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define TASK_QUEUED    (1u << 0)   // on the run queue or in async_run()'s batch
+#define TASK_WAITING   (1u << 1)
+#define TASK_DONE      (1u << 2)
+#define TASK_CANCELED  (1u << 3)   // still queued, dropped instead of run
+
+#define WAIT_SLEEP     1
+#define WAIT_EVENT     2
+#define WAIT_IO        3
+
+#define HEAP_NONE      UINT32_MAX
+
+struct async_event async_key_event = ASYNC_EVENT_INIT;
+
+// Run queue, event wait lists, completions and task flags. Wakeups come
+// from interrupts, so thread context takes it with irqsave.
+static spinlock_t async_lock = SPINLOCK_INIT("async");
+static struct async_task* run_head;
+static struct async_task* run_tail;
+
+// Min-heap of tasks by deadline. Only thread context (async_run() and the
+// tasks it runs) touches it, so it needs no lock and may demand fault.
+static struct async_task** timer_heap;
+static uint32_t timer_count;
+
+// ===================== TIMER HEAP =====================
+static inline void heap_set(uint32_t i, struct async_task* t) {
+    timer_heap[i] = t;
+    t->heap_index = i;
+}
+
+static void heap_up(uint32_t i) {
+    struct async_task* t = timer_heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (timer_heap[parent]->deadline <= t->deadline) break;
+        heap_set(i, timer_heap[parent]);
+        i = parent;
+    }
+    heap_set(i, t);
+}
+
+static void heap_down(uint32_t i) {
+    struct async_task* t = timer_heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= timer_count) break;
+        if (child + 1 < timer_count && timer_heap[child + 1]->deadline < timer_heap[child]->deadline) child++;
+        if (t->deadline <= timer_heap[child]->deadline) break;
+        heap_set(i, timer_heap[child]);
+        i = child;
+    }
+    heap_set(i, t);
+}
+
+static int heap_push(struct async_task* t) {
+    if (!timer_heap || timer_count == ASYNC_MAX_TIMERS) return 0;
+    heap_set(timer_count, t);
+    heap_up(timer_count++);
+    return 1;
+}
+
+static void heap_remove(struct async_task* t) {
+    uint32_t i = t->heap_index;
+    t->heap_index = HEAP_NONE;
+    if (--timer_count == i) return;
+    heap_set(i, timer_heap[timer_count]);
+    if (i > 0 && timer_heap[(i - 1) / 2]->deadline > timer_heap[i]->deadline) heap_up(i);
+    else heap_down(i);
+}
+
+// ===================== QUEUEING =====================
+static void enqueue_locked(struct async_task* t) {
+    if (t->flags & TASK_QUEUED) return;
+    t->flags |= TASK_QUEUED;
+    t->next = NULL;
+    if (run_tail) run_tail->next = t;
+    else run_head = t;
+    run_tail = t;
+}
+
+// Detaches the task from what it waits on; the timer side is left to
+// thread context (async_run() drops the heap entry before running it)
+static void unwait_locked(struct async_task* t) {
+    if (t->wait_kind == WAIT_EVENT) {
+        struct async_event* ev = t->wait_on;
+        if (t->wait_prev) t->wait_prev->wait_next = t->wait_next;
+        else ev->waiters = t->wait_next;
+        if (t->wait_next) t->wait_next->wait_prev = t->wait_prev;
+    } else if (t->wait_kind == WAIT_IO) {
+        ((struct async_completion*)t->wait_on)->waiter = NULL;
+    }
+    t->flags &= ~TASK_WAITING;
+    t->wait_kind = 0;
+    t->wait_on = NULL;
+}
+
+// First of event, completion and timeout wins, the others find the task
+// no longer waiting
+static __hot void wake_locked(struct async_task* t, uint8_t reason, int64_t value) {
+    if (!(t->flags & TASK_WAITING)) return;
+    unwait_locked(t);
+    t->wake = reason;
+    t->value = value;
+    enqueue_locked(t);
+}
+
+// ===================== WAITS =====================
+static void wait_begin_locked(struct async_task* t, uint8_t kind, void* on) {
+    t->flags |= TASK_WAITING;
+    t->wait_kind = kind;
+    t->wait_on = on;
+    t->wake = ASYNC_WAKE_NONE;
+}
+
+// Arms the timeout of a registered wait. With the heap full the wait ends
+// at once as a timeout rather than possibly never.
+static int wait_timeout(struct async_task* t, uint64_t ms) {
+    if (ms == ASYNC_FOREVER) return 1;
+    t->deadline = timer_uptime_ms() + ms;
+    if (heap_push(t)) return 1;
+
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    int waiting = (t->flags & TASK_WAITING) != 0;
+    if (waiting) {
+        unwait_locked(t);
+        t->wake = ASYNC_WAKE_TIMEOUT;
+        t->value = 0;
+    }
+    spin_unlock_irqrestore(&async_lock, flags);
+    // woken between registering and here: it is queued, report the wait
+    return !waiting;
+}
+
+int async_arm_sleep(struct async_task* t, uint64_t ms) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    wait_begin_locked(t, WAIT_SLEEP, NULL);
+    spin_unlock_irqrestore(&async_lock, flags);
+    return wait_timeout(t, ms);
+}
+
+int async_arm_event(struct async_task* t, struct async_event* ev, uint64_t ms) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    wait_begin_locked(t, WAIT_EVENT, ev);
+    t->wait_prev = NULL;
+    t->wait_next = ev->waiters;
+    if (ev->waiters) ev->waiters->wait_prev = t;
+    atomic_write(&ev->waiters, t, MO_RELAXED);
+    spin_unlock_irqrestore(&async_lock, flags);
+    return wait_timeout(t, ms);
+}
+
+int async_arm_io(struct async_task* t, struct async_completion* c, uint64_t ms) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    if (c->done) {
+        t->wake = ASYNC_WAKE_EVENT;
+        t->value = c->status;
+        spin_unlock_irqrestore(&async_lock, flags);
+        return 0;
+    }
+    wait_begin_locked(t, WAIT_IO, c);
+    c->waiter = t;
+    spin_unlock_irqrestore(&async_lock, flags);
+    return wait_timeout(t, ms);
+}
+
+// ===================== WAKEUPS =====================
+__hot void async_event_signal(struct async_event* ev, int64_t value) {
+    // every key press lands here: nobody waiting costs one load
+    if (!atomic_read(&ev->waiters, MO_RELAXED)) return;
+
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    while (ev->waiters) wake_locked(ev->waiters, ASYNC_WAKE_EVENT, value);
+    spin_unlock_irqrestore(&async_lock, flags);
+}
+
+void async_complete(struct async_completion* c, int status) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    c->status = status;
+    c->done = 1;
+    if (c->waiter) wake_locked(c->waiter, ASYNC_WAKE_EVENT, status);
+    spin_unlock_irqrestore(&async_lock, flags);
+}
+
+void async_blk_done(struct blk_request* req, int status) {
+    async_complete(req->ctx, status);
+}
+
+static __hot void async_key_listener(uint8_t key) {
+    async_event_signal(&async_key_event, key);
+}
+
+// ===================== TASKS =====================
+void async_task_init(struct async_task* t, async_fn_t fn, void* ctx) {
+    t->fn = fn;
+    t->ctx = ctx;
+    t->value = 0;
+    t->next = t->wait_prev = t->wait_next = NULL;
+    t->wait_on = NULL;
+    t->deadline = 0;
+    t->heap_index = HEAP_NONE;
+    t->state = 0;
+    t->flags = 0;
+    t->wake = ASYNC_WAKE_NONE;
+    t->wait_kind = 0;
+}
+
+void async_spawn(struct async_task* t) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    t->flags &= ~(TASK_DONE | TASK_CANCELED);
+    enqueue_locked(t);
+    spin_unlock_irqrestore(&async_lock, flags);
+}
+
+void async_cancel(struct async_task* t) {
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    if (t->flags & TASK_WAITING) unwait_locked(t);
+    if (t->flags & TASK_QUEUED) t->flags |= TASK_CANCELED;
+    t->state = 0;
+    spin_unlock_irqrestore(&async_lock, flags);
+    if (t->heap_index != HEAP_NONE) heap_remove(t);
+}
+
+int async_task_done(const struct async_task* t) {
+    return (atomic_read(&t->flags, MO_RELAXED) & TASK_DONE) != 0;
+}
+
+// ===================== EXECUTOR =====================
+__hot uint32_t async_run(void) {
+    if (timer_count) {
+        uint64_t now = timer_uptime_ms();
+        while (timer_count && timer_heap[0]->deadline <= now) {
+            struct async_task* t = timer_heap[0];
+            heap_remove(t);
+            uint64_t flags = spin_lock_irqsave(&async_lock);
+            wake_locked(t, ASYNC_WAKE_TIMEOUT, 0);
+            spin_unlock_irqrestore(&async_lock, flags);
+        }
+    }
+
+    if (!atomic_read(&run_head, MO_RELAXED)) return 0;
+
+    // take the whole queue: wakeups during the batch start a new one
+    uint64_t flags = spin_lock_irqsave(&async_lock);
+    struct async_task* t = run_head;
+    run_head = run_tail = NULL;
+    spin_unlock_irqrestore(&async_lock, flags);
+
+    uint32_t ran = 0;
+    while (t) {
+        struct async_task* next = t->next;
+
+        flags = spin_lock_irqsave(&async_lock);
+        t->flags &= ~TASK_QUEUED;
+        int canceled = (t->flags & TASK_CANCELED) != 0;
+        t->flags &= ~TASK_CANCELED;
+        spin_unlock_irqrestore(&async_lock, flags);
+
+        if (!canceled) {
+            // woken by an event before its timeout
+            if (t->heap_index != HEAP_NONE) heap_remove(t);
+
+            int r = t->fn(t);
+            ran++;
+            if (r != ASYNC_PENDING) {
+                flags = spin_lock_irqsave(&async_lock);
+                if (r == ASYNC_YIELDED) enqueue_locked(t);
+                else t->flags |= TASK_DONE;
+                spin_unlock_irqrestore(&async_lock, flags);
+            }
+        }
+        t = next;
+    }
+    return ran;
+}
+
+__init void async_init(void) {
+    timer_heap = vm_reserve(ASYNC_MAX_TIMERS * sizeof(*timer_heap), VM_READ | VM_WRITE, "async timers");
+    keyboard_set_listener(async_key_listener);
+}
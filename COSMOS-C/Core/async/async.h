@@ -0,0 +1,135 @@
+#pragma once
+#include <stdint.h>
+
+// Cooperative executor for stackless tasks. A task is a function plus a
+// small struct: it runs until it has to wait, records where it stopped in
+// `state` and returns; the next run jumps back there. Locals do not survive
+// a wait, keep them in whatever `ctx` points to.
+//
+//   static int blinker(struct async_task* t) {
+//       struct blink* b = t->ctx;
+//       ASYNC_BEGIN(t);
+//       for (;;) {
+//           blink_toggle(b);
+//           ASYNC_SLEEP(t, 500);
+//       }
+//       ASYNC_END(t);
+//   }
+//
+// Woken tasks go on a FIFO run queue that async_run() drains from the main
+// loop. Wakeups may come from interrupt context (key events, I/O
+// completions); timeouts are kept in a heap that async_run() expires.
+// Tasks themselves only run from async_run(), never in an interrupt.
+
+#define ASYNC_MAX_TIMERS  (1u << 20)       // pending timeouts, demand paged
+#define ASYNC_FOREVER     UINT64_MAX       // wait without a timeout
+
+// task function results
+#define ASYNC_PENDING     0                // waiting, a wakeup queues it again
+#define ASYNC_YIELDED     1                // queued again behind the others
+#define ASYNC_DONE        2
+
+// why the last wait ended (async_task.wake)
+#define ASYNC_WAKE_NONE     0
+#define ASYNC_WAKE_EVENT    1              // event signalled / I/O completed
+#define ASYNC_WAKE_TIMEOUT  2
+
+struct async_task;
+typedef int (*async_fn_t)(struct async_task* t);
+
+struct async_task {
+    async_fn_t fn;
+    void* ctx;
+    int64_t value;                  // event payload (key code) or I/O status
+    // executor private
+    struct async_task* next;        // run queue
+    struct async_task* wait_prev;   // event wait list
+    struct async_task* wait_next;
+    void* wait_on;                  // struct async_event / async_completion
+    uint64_t deadline;              // ms uptime, while on the timer heap
+    uint32_t heap_index;
+    uint16_t state;                 // resume point (source line), 0 = start
+    uint8_t flags;
+    uint8_t wake;                   // ASYNC_WAKE_*
+    uint8_t wait_kind;
+};
+
+// Broadcast: a signal wakes every task waiting at that moment, it is not
+// remembered for tasks that start waiting later
+struct async_event {
+    struct async_task* waiters;
+};
+
+// One-shot: completing before the wait starts is not lost
+struct async_completion {
+    struct async_task* waiter;
+    int status;
+    uint8_t done;
+};
+
+#define ASYNC_EVENT_INIT       { 0 }
+#define ASYNC_COMPLETION_INIT  { 0, 0, 0 }
+
+// Signalled from IRQ1 with the decoded key as value. The key is still
+// queued for keyboard_getchar(): waiters observe keys, they don't consume.
+extern struct async_event async_key_event;
+
+// ===================== TASK BODY =====================
+// Duff's device over `state`: a wait stores its line number, returns, and
+// the next run resumes at the matching case label. So: one wait per source
+// line, and no switch statement around a wait inside the body.
+#define ASYNC_BEGIN(t)   switch ((t)->state) { case 0:
+#define ASYNC_END(t)     } (t)->state = 0; return ASYNC_DONE
+
+// Suspends when `arm` (an async_arm_* call) returns nonzero
+#define ASYNC_AWAIT(t, arm)                                          \
+    do {                                                             \
+        (t)->state = __LINE__;                                       \
+        if (arm) return ASYNC_PENDING;                               \
+        case __LINE__:;                                              \
+    } while (0)
+
+#define ASYNC_YIELD(t)                                               \
+    do {                                                             \
+        (t)->state = __LINE__;                                       \
+        return ASYNC_YIELDED;                                        \
+        case __LINE__:;                                              \
+    } while (0)
+
+// After each wait (t)->wake says how it ended and (t)->value carries the
+// key code or I/O status.
+#define ASYNC_SLEEP(t, ms)            ASYNC_AWAIT(t, async_arm_sleep(t, ms))
+#define ASYNC_WAIT_EVENT(t, ev, ms)   ASYNC_AWAIT(t, async_arm_event(t, ev, ms))
+#define ASYNC_WAIT_KEY(t, ms)         ASYNC_WAIT_EVENT(t, &async_key_event, ms)
+#define ASYNC_WAIT_IO(t, c, ms)       ASYNC_AWAIT(t, async_arm_io(t, c, ms))
+
+// ===================== API =====================
+void async_init(void);
+
+void async_task_init(struct async_task* t, async_fn_t fn, void* ctx);
+// Queues the task to run from its current state; any context
+void async_spawn(struct async_task* t);
+// Ends a wait or pending run without running the task (thread context).
+// A canceled task starts over on the next async_spawn().
+void async_cancel(struct async_task* t);
+int async_task_done(const struct async_task* t);
+
+// Main loop: expires timeouts and runs the tasks queued so far (a task
+// that yields or gets woken meanwhile runs on the next call). Returns the
+// number of tasks run. Not reentrant: tasks must not call it.
+uint32_t async_run(void);
+
+// Wakeups, any context
+void async_event_signal(struct async_event* ev, int64_t value);
+void async_complete(struct async_completion* c, int status);
+
+struct blk_request;
+// virtio_blk `done` callback for requests whose ctx is an async_completion
+void async_blk_done(struct blk_request* req, int status);
+
+// Wait registration for the ASYNC_* macros, from a running task only.
+// Return 1 if the task has to wait, 0 if the wait already ended (completion
+// done; timer heap full, reported as a timeout).
+int async_arm_sleep(struct async_task* t, uint64_t ms);
+int async_arm_event(struct async_task* t, struct async_event* ev, uint64_t ms);
+int async_arm_io(struct async_task* t, struct async_completion* c, uint64_t ms);
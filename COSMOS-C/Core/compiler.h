@@ -0,0 +1,16 @@
+#pragma once
+
+// ===================== SECTION PLACEMENT =====================
+// See targets/x86_64/linker.ld for where these end up.
+
+// Interrupt entry and IRQ handling: packed together at the start of .text
+// so the interrupt path touches as few i-cache lines and iTLB pages as possible.
+#define __hot  __attribute__((section(".text.hot")))
+
+// Not instrumented in trace builds (-pg, Core/trace/ftrace.h)
+#define notrace __attribute__((no_instrument_function))
+
+// Runs only during boot. The whole .init region is poisoned and released by
+// free_init_memory(), so nothing here may be called after kernel_main()'s
+// setup phase. Never traced: the tracer could patch it after it is gone.
+#define __init __attribute__((section(".text.cold"), cold, noinline)) notrace
@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+
+// ELF64 file format, the parts a static executable needs (System V gABI,
+// x86-64 psABI)
+
+#define ELF_MAGIC        0x464C457Fu   // "\x7FELF", little endian
+#define ELFCLASS64       2
+#define ELFDATA2LSB      1
+#define EV_CURRENT       1
+#define ET_EXEC          2
+#define EM_X86_64        62
+
+#define PT_LOAD          1
+
+#define PF_X             (1u << 0)
+#define PF_W             (1u << 1)
+#define PF_R             (1u << 2)
+
+struct elf64_ehdr {
+    uint32_t magic;
+    uint8_t class_;             // ELFCLASS64
+    uint8_t data;               // ELFDATA2LSB
+    uint8_t ident_version;
+    uint8_t osabi;
+    uint8_t pad[8];
+    uint16_t type;              // ET_EXEC
+    uint16_t machine;           // EM_X86_64
+    uint32_t version;
+    uint64_t entry;
+    uint64_t phoff;
+    uint64_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} __attribute__((packed));
+
+struct elf64_phdr {
+    uint32_t type;
+    uint32_t flags;             // PF_*
+    uint64_t offset;
+    uint64_t vaddr;
+    uint64_t paddr;
+    uint64_t filesz;
+    uint64_t memsz;
+    uint64_t align;
+} __attribute__((packed));
+
+_Static_assert(sizeof(struct elf64_ehdr) == 64, "ELF header layout");
+_Static_assert(sizeof(struct elf64_phdr) == 56, "ELF program header layout");
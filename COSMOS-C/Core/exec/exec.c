@@ -0,0 +1,195 @@
+#include "exec/exec.h"
+#include "exec/elf.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/boot/multiboot2.h"
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Drivers/serial/serial.h"
+#include "lib/errno.h"
+#include "lib/string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// lowest address of the stack region; segments have to end below its guard
+#define STACK_BASE  (EXEC_STACK_TOP - EXEC_STACK_SIZE)
+
+// ===================== IMAGE =====================
+static const struct mb2_tag_module* find_module(const char* name) {
+    for (const struct mb2_tag* t = multiboot2_find(MB2_TAG_MODULE, NULL); t;
+         t = multiboot2_find(MB2_TAG_MODULE, t)) {
+        const struct mb2_tag_module* m = (const struct mb2_tag_module*)t;
+        if (strcmp(m->cmdline, name) == 0) return m;
+    }
+    return NULL;
+}
+
+static int check_header(const struct elf64_ehdr* eh, uint64_t size) {
+    if (size < sizeof(*eh) || eh->magic != ELF_MAGIC) return -ENOEXEC;
+    if (eh->class_ != ELFCLASS64 || eh->data != ELFDATA2LSB || eh->ident_version != EV_CURRENT ||
+        eh->version != EV_CURRENT)
+        return -ENOEXEC;
+    if (eh->type != ET_EXEC || eh->machine != EM_X86_64) return -ENOEXEC;
+    if (eh->phentsize != sizeof(struct elf64_phdr) || eh->phnum == 0) return -ENOEXEC;
+    if (eh->phoff > size || (size - eh->phoff) / sizeof(struct elf64_phdr) < eh->phnum)
+        return -ENOEXEC;
+    return 0;
+}
+
+static int add_segment(struct exec_image* img, const struct elf64_phdr* ph) {
+    if (img->nsegs == EXEC_MAX_SEGMENTS) return -ENOEXEC;
+    if (ph->filesz > ph->memsz || ph->offset > img->size || img->size - ph->offset < ph->filesz)
+        return -ENOEXEC;
+    if (ph->vaddr < USER_BASE || ph->vaddr > STACK_BASE - PAGE_SIZE ||
+        ph->memsz > STACK_BASE - PAGE_SIZE - ph->vaddr) return -ENOEXEC;     // guard below the stack
+    if ((ph->flags & (PF_W | PF_X)) == (PF_W | PF_X)) return -ENOEXEC;    // W^X
+    // shared pages are the module's pages: file offset and address must agree
+    if ((ph->vaddr - ph->offset) & (PAGE_SIZE - 1)) return -ENOEXEC;
+    // a shared page can't be zero filled, the module has other bytes there
+    if (!(ph->flags & PF_W) && ph->memsz != ph->filesz) return -ENOEXEC;
+
+    struct exec_segment s = {
+        .start = PAGE_ALIGN_DOWN(ph->vaddr),
+        .end = PAGE_ALIGN_UP(ph->vaddr + ph->memsz),
+        .vaddr = ph->vaddr,
+        .offset = ph->offset,
+        .filesz = ph->filesz,
+        .flags = ph->flags,
+    };
+    if (s.start == s.end) return 0;
+    for (uint32_t i = 0; i < img->nsegs; i++) {
+        if (s.start < img->segs[i].end && s.end > img->segs[i].start) return -ENOEXEC;
+    }
+    img->segs[img->nsegs++] = s;
+    if (!(s.flags & PF_W)) img->shared_pages += (s.end - s.start) / PAGE_SIZE;
+    return 0;
+}
+
+int exec_image_load(const char* name, struct exec_image* img) {
+    const struct mb2_tag_module* m = find_module(name);
+    if (!m) return -ENOENT;
+    if (m->mod_end > IDENTITY_END || m->mod_end <= m->mod_start) return -ENOEXEC;
+    if (m->mod_start & (PAGE_SIZE - 1)) return -ENOEXEC;   // header.asm asks for alignment
+
+    memset(img, 0, sizeof(*img));
+    img->name = name;
+    img->data = (const uint8_t*)(uintptr_t)m->mod_start;
+    img->size = m->mod_end - m->mod_start;
+
+    const struct elf64_ehdr* eh = (const struct elf64_ehdr*)img->data;
+    int err = check_header(eh, img->size);
+    if (err < 0) return err;
+
+    const struct elf64_phdr* ph = (const struct elf64_phdr*)(img->data + eh->phoff);
+    for (uint16_t i = 0; i < eh->phnum; i++) {
+        if (ph[i].type != PT_LOAD) continue;
+        err = add_segment(img, &ph[i]);
+        if (err < 0) return err;
+    }
+
+    // the entry point has to be in an executable segment
+    for (uint32_t i = 0; i < img->nsegs; i++) {
+        const struct exec_segment* s = &img->segs[i];
+        if ((s->flags & PF_X) && eh->entry >= s->vaddr && eh->entry < s->vaddr + s->filesz) {
+            img->entry = eh->entry;
+            return 0;
+        }
+    }
+    return -ENOEXEC;
+}
+
+// ===================== INSTANCES =====================
+// the instance owning the user window; user_enter() runs one at a time
+static struct exec_proc* mapped;
+
+static uint32_t region_flags(uint32_t pf) {
+    uint32_t f = VM_USER;
+    if (pf & PF_R) f |= VM_READ;
+    if (pf & PF_W) f |= VM_WRITE;
+    if (pf & PF_X) f |= VM_EXEC;
+    return f;
+}
+
+static int map_segment(const struct exec_image* img, const struct exec_segment* s) {
+    size_t size = s->end - s->start;
+    if (!(s->flags & PF_W)) {
+        uint64_t phys = (uint64_t)(uintptr_t)img->data + s->offset - (s->vaddr - s->start);
+        return vm_map_phys_at(s->start, phys, size, region_flags(s->flags), img->name);
+    }
+    // the copy faults in the pages with file data; the rest (.bss) stays
+    // unbacked until the program touches it
+    if (vm_reserve_at(s->start, size, region_flags(s->flags), img->name) < 0) return -1;
+    memcpy((void*)s->vaddr, img->data + s->offset, s->filesz);
+    return 0;
+}
+
+int exec_spawn(const struct exec_image* img, struct exec_proc* p) {
+    if (mapped) return -EBUSY;
+    mapped = p;
+    p->image = img;
+    p->nregions = 0;
+    p->resident_base = vm_resident_pages();
+
+    for (uint32_t i = 0; i < img->nsegs; i++) {
+        if (map_segment(img, &img->segs[i]) < 0) goto fail;
+        p->regions[p->nregions++] = img->segs[i].start;
+    }
+    if (vm_reserve_at(STACK_BASE, EXEC_STACK_SIZE, VM_READ | VM_WRITE | VM_USER, "user-stack") < 0)
+        goto fail;
+    p->regions[p->nregions++] = STACK_BASE;
+    return 0;
+
+fail:
+    exec_teardown(p);       // out of region slots or frames
+    return -ENOMEM;
+}
+
+// _start (user/start.asm) gets a 16-byte aligned rsp, as after exec
+int64_t exec_run(struct exec_proc* p, uint64_t arg) {
+    return user_enter(p->image->entry, EXEC_STACK_TOP, arg);
+}
+
+uint64_t exec_resident_pages(const struct exec_proc* p) {
+    return vm_resident_pages() - p->resident_base;
+}
+
+void exec_teardown(struct exec_proc* p) {
+    for (uint32_t i = 0; i < p->nregions; i++) vm_release((void*)p->regions[i]);
+    p->nregions = 0;
+    if (mapped == p) mapped = NULL;
+}
+
+// ===================== ONE SHOT =====================
+int64_t exec_module(const char* name, uint64_t arg) {
+    struct exec_image img;
+    struct exec_proc p;
+    int err = exec_image_load(name, &img);
+    if (err == -ENOENT) return err;
+    if (err < 0) {
+        serial_write("[EXEC] ");
+        serial_write(name);
+        serial_write(": not a static x86-64 executable\n");
+        return err;
+    }
+
+    uint64_t t0 = rdtsc();
+    err = exec_spawn(&img, &p);
+    uint64_t t1 = rdtsc();
+    if (err < 0) return err;
+    int64_t code = exec_run(&p, arg);
+    uint64_t private_pages = exec_resident_pages(&p);
+    exec_teardown(&p);
+
+    serial_write("[EXEC] ");
+    serial_write(name);
+    serial_write(" exit=");
+    if (code < 0) serial_write("-");
+    serial_write_dec(code < 0 ? (uint64_t)-code : (uint64_t)code);
+    serial_write(" spawn_ns=");
+    serial_write_dec(tsc_cycles_to_ns(t1 - t0));
+    serial_write(" shared_pages=");
+    serial_write_dec(img.shared_pages);
+    serial_write(" private_pages=");
+    serial_write_dec(private_pages);
+    serial_write("\n");
+    return code;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "arch/x86_64/MM/paging.h"
+#include <stdint.h>
+
+// Static ELF64 executables from multiboot2 modules (`module2 /boot/bin/worker
+// worker` in grub.cfg, built from user/). An image is parsed and checked
+// once; every spawn of it then only builds page tables:
+//
+//   read-only segments    the module's own frames, mapped read-only and
+//                         never copied: every instance shares them
+//   writable segments     private, the file bytes copied in, .bss left
+//                         untouched until the program faults it in
+//   stack                 EXEC_STACK_SIZE private, demand paged
+//
+// There is one address space and user_enter() is not reentrant, so one
+// instance runs at a time; spawning while another is mapped fails with
+// -EBUSY. Errors are negative errno values.
+
+#define EXEC_MAX_SEGMENTS  8
+#define EXEC_STACK_SIZE    (64 * 1024)
+#define EXEC_STACK_TOP     USER_MMAP_BASE    // the mmap window is above
+
+struct exec_segment {
+    uintptr_t start;            // page aligned span in user space
+    uintptr_t end;
+    uint64_t vaddr;             // first byte of the file data
+    uint64_t offset;            // in the file
+    uint64_t filesz;
+    uint32_t flags;             // PF_*
+};
+
+struct exec_image {
+    const char* name;
+    const uint8_t* data;        // the module, identity mapped, page aligned
+    uint64_t size;
+    uint64_t entry;
+    uint32_t nsegs;
+    struct exec_segment segs[EXEC_MAX_SEGMENTS];
+    uint64_t shared_pages;      // mapped from the module in every instance
+};
+
+struct exec_proc {
+    const struct exec_image* image;
+    uintptr_t regions[EXEC_MAX_SEGMENTS + 1];   // one per segment + the stack
+    uint32_t nregions;
+    uint64_t resident_base;     // vm_resident_pages() before the spawn
+};
+
+// Finds the module named `name` (its command line) and checks it: 64-bit
+// little endian x86-64 ET_EXEC, PT_LOAD segments inside user space below
+// the stack, not overlapping, none both writable and executable, file data
+// page congruent with the address, read-only ones without zero fill.
+// -ENOENT, -ENOEXEC.
+int exec_image_load(const char* name, struct exec_image* img);
+
+// Maps an instance. 0, -EBUSY (another instance mapped), -ENOMEM.
+int exec_spawn(const struct exec_image* img, struct exec_proc* p);
+
+// Runs it in ring 3 with `arg` in rdi until SYS_EXIT or a fault (-EFAULT)
+int64_t exec_run(struct exec_proc* p, uint64_t arg);
+
+// Private pages the instance has touched so far (copies, .bss, stack)
+uint64_t exec_resident_pages(const struct exec_proc* p);
+
+// Unmaps the instance and frees its private pages
+void exec_teardown(struct exec_proc* p);
+
+// Load, spawn, run and tear down, with a `[EXEC] ...` line on COM1:
+// exit code, spawn time and shared/private pages. -ENOENT without the module.
+int64_t exec_module(const char* name, uint64_t arg);
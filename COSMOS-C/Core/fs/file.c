@@ -0,0 +1,99 @@
+#include "fs/file.h"
+#include "fs/initrd.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vm.h"
+#include "lib/errno.h"
+#include "lib/string.h"
+#include "sync/spinlock.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct open_file {
+    const struct initrd_file* file;
+    uint64_t pos;
+};
+
+static struct open_file open_files[FS_MAX_OPEN];
+static spinlock_t files_lock = SPINLOCK_INIT("files");
+
+static struct open_file* get(int fd) {
+    if (fd < 0 || fd >= FS_MAX_OPEN || !open_files[fd].file) return NULL;
+    return &open_files[fd];
+}
+
+// ===================== OPEN / CLOSE =====================
+int fs_open(const char* path) {
+    const struct initrd_file* f = initrd_lookup(path);
+    if (!f) return -ENOENT;
+
+    int fd = -EMFILE;
+    uint64_t flags = spin_lock_irqsave(&files_lock);
+    for (int i = 0; i < FS_MAX_OPEN; i++) {
+        if (!open_files[i].file) {
+            open_files[i] = (struct open_file){ f, 0 };
+            fd = i;
+            break;
+        }
+    }
+    spin_unlock_irqrestore(&files_lock, flags);
+    return fd;
+}
+
+int fs_close(int fd) {
+    uint64_t flags = spin_lock_irqsave(&files_lock);
+    struct open_file* of = get(fd);
+    if (of) of->file = NULL;
+    spin_unlock_irqrestore(&files_lock, flags);
+    return of ? 0 : -EBADF;
+}
+
+// ===================== READ =====================
+int64_t fs_read(int fd, void* buf, uint64_t len) {
+    struct open_file* of = get(fd);
+    if (!of) return -EBADF;
+
+    uint64_t size = of->file->size;
+    if (of->pos >= size) return 0;
+    if (len > size - of->pos) len = size - of->pos;
+    memcpy(buf, of->file->data + of->pos, len);
+    of->pos += len;
+    return (int64_t)len;
+}
+
+int64_t fs_size(int fd) {
+    struct open_file* of = get(fd);
+    return of ? (int64_t)of->file->size : -EBADF;
+}
+
+// ===================== MAP =====================
+const void* fs_map(int fd, uint64_t offset) {
+    struct open_file* of = get(fd);
+    if (!of || offset > of->file->size) return NULL;
+    return of->file->data + offset;
+}
+
+// Region name of fs_mmap_user() mappings; fs_munmap_user() compares the
+// pointer, so only these regions can be released from user space.
+static const char mmap_region[] = "initrd-mmap";
+
+// File data in the archive is 512 (tar) or 4 (cpio) byte aligned, not page
+// aligned: the mapping covers whole module pages and the returned address
+// points at the file's first byte inside it.
+int64_t fs_mmap_user(int fd, uint64_t offset, uint64_t len) {
+    struct open_file* of = get(fd);
+    if (!of) return -EBADF;
+    uint64_t size = of->file->size;
+    if (offset & (PAGE_SIZE - 1) || offset >= size || len == 0) return -EINVAL;
+    if (len > size - offset) len = size - offset;
+
+    uint64_t phys = (uint64_t)(uintptr_t)(of->file->data + offset);
+    void* addr = vm_map_phys(phys, len, VM_READ | VM_USER, mmap_region);
+    return addr ? (int64_t)(uintptr_t)addr : -ENOMEM;
+}
+
+int fs_munmap_user(uint64_t addr) {
+    const struct vm_region* r = vm_find(addr);
+    if (!r || r->name != mmap_region) return -EINVAL;
+    vm_release((void*)(uintptr_t)addr);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+
+// File descriptors over the initrd. There is one address space, so the
+// table is global; errors are negative errno values (lib/errno.h).
+
+#define FS_MAX_OPEN  64
+
+int fs_open(const char* path);
+int fs_close(int fd);
+
+// Copies from the current position, 0 at end of file
+int64_t fs_read(int fd, void* buf, uint64_t len);
+int64_t fs_size(int fd);
+
+// Zero-copy views of the file from `offset` on. fs_map() returns the data
+// inside the module itself (kernel only); fs_mmap_user() maps the module
+// pages read-only into the user mmap window, `len` clipped to the file size
+// and `offset` page aligned.
+const void* fs_map(int fd, uint64_t offset);
+int64_t fs_mmap_user(int fd, uint64_t offset, uint64_t len);
+int fs_munmap_user(uint64_t addr);
@@ -0,0 +1,267 @@
+#include "fs/initrd.h"
+#include "arch/x86_64/boot/multiboot2.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAR_BLOCK        512
+#define CPIO_HEADER      110
+#define CPIO_S_IFMT      0170000
+#define CPIO_S_IFREG     0100000
+
+#define FNV_OFFSET       0xcbf29ce484222325ull
+#define FNV_PRIME        0x100000001b3ull
+
+// hash slot: upper hash bits as a tag, so a probe only touches the entry
+// when the tags match
+struct slot {
+    uint32_t tag;
+    uint32_t index;             // entry + 1, 0 = empty
+};
+
+static const uint8_t* archive;
+static uint64_t archive_size;
+static struct initrd_file* files;
+static uint32_t file_count;
+static struct slot* slots;
+static uint32_t slot_mask;
+
+// ===================== PATHS =====================
+// "/a", "./a" and "a" are the same file
+static const char* skip_root(const char* p, uint16_t* len) {
+    for (;;) {
+        if (*len >= 1 && p[0] == '/') { p++; (*len)--; }
+        else if (*len >= 2 && p[0] == '.' && p[1] == '/') { p += 2; *len -= 2; }
+        else return p;
+    }
+}
+
+static uint64_t fnv1a(uint64_t h, const char* p, size_t len) {
+    for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)p[i]) * FNV_PRIME;
+    return h;
+}
+
+static uint64_t file_hash(const struct initrd_file* f) {
+    uint64_t h = FNV_OFFSET;
+    if (f->prefix_len) {
+        h = fnv1a(h, f->prefix, f->prefix_len);
+        h = fnv1a(h, "/", 1);
+    }
+    return fnv1a(h, f->name, f->name_len);
+}
+
+static int file_matches(const struct initrd_file* f, const char* path, size_t len) {
+    if (f->prefix_len) {
+        if (len != (size_t)f->prefix_len + 1 + f->name_len) return 0;
+        if (memcmp(path, f->prefix, f->prefix_len) != 0 || path[f->prefix_len] != '/') return 0;
+        path += f->prefix_len + 1;
+    } else if (len != f->name_len) {
+        return 0;
+    }
+    return memcmp(path, f->name, f->name_len) == 0;
+}
+
+int initrd_path(const struct initrd_file* f, char* buf, size_t size) {
+    size_t len = f->prefix_len ? (size_t)f->prefix_len + 1 + f->name_len : f->name_len;
+    if (len + 1 > size) return -1;
+    size_t n = 0;
+    if (f->prefix_len) {
+        memcpy(buf, f->prefix, f->prefix_len);
+        buf[f->prefix_len] = '/';
+        n = f->prefix_len + 1;
+    }
+    memcpy(buf + n, f->name, f->name_len);
+    buf[len] = '\0';
+    return (int)len;
+}
+
+// ===================== FORMATS =====================
+static uint64_t parse_octal(const char* p, size_t len) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < len && p[i] >= '0' && p[i] <= '7'; i++) v = v * 8 + (p[i] - '0');
+    return v;
+}
+
+static uint64_t parse_hex(const char* p, size_t len) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = p[i];
+        if (c >= '0' && c <= '9') v = v * 16 + (c - '0');
+        else if (c >= 'a' && c <= 'f') v = v * 16 + (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v = v * 16 + (c - 'A' + 10);
+        else break;
+    }
+    return v;
+}
+
+static uint16_t field_len(const char* p, size_t max) {
+    uint16_t n = 0;
+    while (n < max && p[n]) n++;
+    return n;
+}
+
+// Fills `out` with every regular file and returns the count, -1 on a
+// malformed archive. `out` is NULL for the counting pass.
+static int64_t walk_tar(struct initrd_file* out) {
+    int64_t count = 0;
+    for (uint64_t off = 0; off + TAR_BLOCK <= archive_size; ) {
+        const char* h = (const char*)archive + off;
+        if (h[0] == '\0') break; // end-of-archive block
+        if (memcmp(h + 257, "ustar", 5) != 0) return -1;
+
+        uint64_t size = parse_octal(h + 124, 12);
+        uint64_t data = off + TAR_BLOCK;
+        if (data + size > archive_size) return -1;
+
+        char type = h[156];
+        if (type == '0' || type == '\0') {
+            if (out) {
+                struct initrd_file* f = &out[count];
+                f->prefix_len = field_len(h + 345, 155);
+                f->prefix = skip_root(h + 345, &f->prefix_len);
+                f->name_len = field_len(h, 100);
+                f->name = f->prefix_len ? h : skip_root(h, &f->name_len);
+                f->data = archive + data;
+                f->size = size;
+            }
+            count++;
+        }
+        off = data + ((size + TAR_BLOCK - 1) & ~(uint64_t)(TAR_BLOCK - 1));
+    }
+    return count;
+}
+
+static int64_t walk_cpio(struct initrd_file* out) {
+    int64_t count = 0;
+    for (uint64_t off = 0; off + CPIO_HEADER <= archive_size; ) {
+        const char* h = (const char*)archive + off;
+        if (memcmp(h, "070701", 6) != 0) return -1;
+
+        uint64_t mode = parse_hex(h + 14, 8);
+        uint64_t size = parse_hex(h + 54, 8);
+        uint64_t name_size = parse_hex(h + 94, 8); // includes the NUL
+        uint64_t data = (off + CPIO_HEADER + name_size + 3) & ~3ull;
+        if (name_size == 0 || data + size > archive_size) return -1;
+
+        const char* name = h + CPIO_HEADER;
+        uint16_t name_len = (uint16_t)(name_size - 1);
+        if (name_len == 10 && memcmp(name, "TRAILER!!!", 10) == 0) break;
+
+        if ((mode & CPIO_S_IFMT) == CPIO_S_IFREG) {
+            if (out) {
+                struct initrd_file* f = &out[count];
+                f->prefix = NULL;
+                f->prefix_len = 0;
+                f->name = skip_root(name, &name_len);
+                f->name_len = name_len;
+                f->data = archive + data;
+                f->size = size;
+            }
+            count++;
+        }
+        off = (data + size + 3) & ~3ull;
+    }
+    return count;
+}
+
+static int64_t walk(struct initrd_file* out) {
+    if (archive_size >= CPIO_HEADER && memcmp(archive, "070701", 6) == 0) return walk_cpio(out);
+    return walk_tar(out);
+}
+
+// ===================== INDEX =====================
+static void insert(uint32_t index) {
+    uint64_t h = files[index].hash;
+    for (uint32_t i = (uint32_t)h & slot_mask; ; i = (i + 1) & slot_mask) {
+        if (!slots[i].index) {
+            slots[i] = (struct slot){ (uint32_t)(h >> 32), index + 1 };
+            return;
+        }
+    }
+}
+
+const struct initrd_file* initrd_lookup(const char* path) {
+    if (!slots) return NULL;
+    uint16_t len = field_len(path, 0xFFFF);
+    path = skip_root(path, &len);
+    uint64_t h = fnv1a(FNV_OFFSET, path, len);
+
+    for (uint32_t i = (uint32_t)h & slot_mask; slots[i].index; i = (i + 1) & slot_mask) {
+        if (slots[i].tag != (uint32_t)(h >> 32)) continue;
+        const struct initrd_file* f = &files[slots[i].index - 1];
+        if (f->hash == h && file_matches(f, path, len)) return f;
+    }
+    return NULL;
+}
+
+// Only the module named "initrd": the others are ELF programs (Core/exec)
+static const struct mb2_tag_module* find_module(void) {
+    for (const struct mb2_tag* t = multiboot2_find(MB2_TAG_MODULE, NULL); t; t = multiboot2_find(MB2_TAG_MODULE, t)) {
+        const struct mb2_tag_module* m = (const struct mb2_tag_module*)t;
+        if (strcmp(m->cmdline, "initrd") == 0) return m;
+    }
+    return NULL;
+}
+
+__init int initrd_init(void) {
+    const struct mb2_tag_module* m = find_module();
+    if (!m) {
+        serial_write("[INITRD] no module named initrd\n");
+        return -1;
+    }
+    if (m->mod_end > IDENTITY_END || m->mod_end <= m->mod_start) return -1;
+
+    uint64_t t0 = rdtsc();
+    archive = (const uint8_t*)(uintptr_t)m->mod_start;
+    archive_size = m->mod_end - m->mod_start;
+
+    int64_t count = walk(NULL);
+    if (count <= 0 || count >= 0x7FFFFFFF) {
+        serial_write("[INITRD] not a ustar/cpio archive or empty\n");
+        return -1;
+    }
+
+    // load factor <= 1/2 keeps probe sequences short
+    uint32_t slot_count = 16;
+    while (slot_count < 2 * (uint64_t)count) slot_count <<= 1;
+    files = vm_reserve(count * sizeof(struct initrd_file), VM_READ | VM_WRITE, "initrd-files");
+    slots = vm_reserve(slot_count * sizeof(struct slot), VM_READ | VM_WRITE, "initrd-index");
+    if (!files || !slots) {
+        slots = NULL;
+        return -1;
+    }
+    slot_mask = slot_count - 1;
+    file_count = (uint32_t)count;
+
+    walk(files);
+    for (uint32_t i = 0; i < file_count; i++) {
+        files[i].hash = file_hash(&files[i]);
+        insert(i);
+    }
+
+    serial_write("[INITRD] ");
+    serial_write_dec(file_count);
+    serial_write(" files, ");
+    serial_write_dec(archive_size / 1024);
+    serial_write(" KiB, indexed in ");
+    serial_write_dec((rdtsc() - t0) / 1000);
+    serial_write(" kcycles\n");
+    return 0;
+}
+
+int initrd_present(void) {
+    return slots != NULL;
+}
+
+uint32_t initrd_file_count(void) {
+    return file_count;
+}
+
+const struct initrd_file* initrd_file_at(uint32_t index) {
+    return index < file_count ? &files[index] : NULL;
+}
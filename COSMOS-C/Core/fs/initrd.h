@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Read-only filesystem on the initrd multiboot2 module (ustar or cpio newc).
+// The archive is indexed once at boot into an open-addressed hash table of
+// full paths; file data is never copied, entries point into the module.
+
+struct initrd_file {
+    uint64_t hash;
+    const uint8_t* data;        // inside the module, identity mapped: virt == phys
+    uint64_t size;
+    const char* prefix;         // ustar prefix field, joined with '/'
+    const char* name;
+    uint16_t prefix_len;
+    uint16_t name_len;
+};
+
+// Finds the "initrd" module (or the first one) and indexes it; 0 on success
+int initrd_init(void);
+int initrd_present(void);
+
+// Path with or without a leading '/', NULL when not found
+const struct initrd_file* initrd_lookup(const char* path);
+
+uint32_t initrd_file_count(void);
+const struct initrd_file* initrd_file_at(uint32_t index);
+
+// Full path of `f` into buf (NUL-terminated), returns the length or -1
+int initrd_path(const struct initrd_file* f, char* buf, size_t size);
@@ -0,0 +1,126 @@
+#include "ipc/chan.h"
+#include "async/async.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "sync/atomic.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHAN_MAX_ORDER  16
+
+// Ring of 1 << order slots, position p uses slot p & mask in lap p >> order.
+// A slot's turn says whose move it is, so neither side reads the other's
+// index: producers claim positions with a CAS on tail, the consumer owns
+// head. A zeroed ring is an empty one.
+
+static inline uint64_t lap_turn(const struct chan* ch, uint64_t pos) {
+    return 2 * (pos >> ch->order);
+}
+
+static inline struct chan_slot* slot_at(const struct chan* ch, uint64_t pos) {
+    return &ch->slots[pos & ((1ull << ch->order) - 1)];
+}
+
+int chan_init(struct chan* ch, struct chan_slot* slots, uint32_t order, uint32_t type, const char* name) {
+    if (order > CHAN_MAX_ORDER) return -EINVAL;
+    *ch = (struct chan)CHAN_INIT(name, slots, order, type);
+    for (uint64_t i = 0; i < (1ull << order); i++) slots[i].turn = 0;
+    return 0;
+}
+
+// ===================== SEND =====================
+__hot int chan_send(struct chan* ch, const struct chan_msg* m) {
+    if (m->type != ch->type) return -EINVAL;
+
+    uint64_t pos = atomic_read(&ch->tail, MO_RELAXED);
+    struct chan_slot* s;
+    for (;;) {
+        s = slot_at(ch, pos);
+        int64_t diff = (int64_t)(atomic_read(&s->turn, MO_ACQUIRE) - lap_turn(ch, pos));
+        if (diff == 0) {
+            if (atomic_cmpxchg(&ch->tail, &pos, pos + 1, MO_RELAXED)) break;
+        } else if (diff < 0) {
+            return -EAGAIN;                         // last lap's message is still there
+        } else {
+            pos = atomic_read(&ch->tail, MO_RELAXED);   // claimed by another producer
+        }
+    }
+    // A producer interrupted here holds up the consumer at this slot until
+    // it returns; later slots can still be claimed, nothing spins on it
+    s->msg = *m;
+    atomic_write(&s->turn, lap_turn(ch, pos) + 1, MO_RELEASE);
+
+    // pairs with the fence in chan_arm_recv(): either the waiter is seen
+    // here or the message there. Nobody waiting costs one load.
+    atomic_fence(MO_SEQ_CST);
+    async_event_signal(&ch->readable, 0);
+    return 0;
+}
+
+// ===================== RECEIVE =====================
+static inline int recv_ready(const struct chan* ch) {
+    return atomic_read(&slot_at(ch, ch->head)->turn, MO_ACQUIRE) == lap_turn(ch, ch->head) + 1;
+}
+
+static inline int send_ready(const struct chan* ch) {
+    uint64_t pos = atomic_read(&ch->tail, MO_RELAXED);
+    return (int64_t)(atomic_read(&slot_at(ch, pos)->turn, MO_ACQUIRE) - lap_turn(ch, pos)) >= 0;
+}
+
+__hot uint32_t chan_recv_batch(struct chan* ch, struct chan_msg* m, uint32_t max) {
+    uint64_t pos = ch->head;
+    uint32_t n = 0;
+    for (; n < max; n++, pos++) {
+        struct chan_slot* s = slot_at(ch, pos);
+        uint64_t turn = lap_turn(ch, pos);
+        if (atomic_read(&s->turn, MO_ACQUIRE) != turn + 1) break;
+        m[n] = s->msg;
+        atomic_write(&s->turn, turn + 2, MO_RELEASE);   // free for the next lap
+    }
+    if (!n) return 0;
+    ch->head = pos;
+
+    // one fence per batch, pairs with chan_arm_send()
+    atomic_fence(MO_SEQ_CST);
+    async_event_signal(&ch->writable, 0);
+    return n;
+}
+
+__hot int chan_recv(struct chan* ch, struct chan_msg* m) {
+    return chan_recv_batch(ch, m, 1) ? 0 : -EAGAIN;
+}
+
+// ===================== PAGES =====================
+// PMM frames are all inside the identity map, the frame is the pointer
+void* chan_page_alloc(void) {
+    return (void*)(uintptr_t)pmm_alloc();
+}
+
+void chan_page_free(void* page) {
+    if (page) pmm_free((uint64_t)(uintptr_t)page);
+}
+
+// ===================== WAITS =====================
+// The event is a broadcast that nobody remembers: register first, then
+// look again, and wake ourselves if the other side got in between.
+static int arm(struct async_task* t, struct chan* ch, struct async_event* ev,
+               int (*ready)(const struct chan*), uint64_t ms) {
+    if (ready(ch)) {
+        t->wake = ASYNC_WAKE_EVENT;
+        t->value = 0;
+        return 0;
+    }
+    int wait = async_arm_event(t, ev, ms);
+    atomic_fence(MO_SEQ_CST);
+    if (wait && ready(ch)) async_event_signal(ev, 0);
+    return wait;
+}
+
+int chan_arm_recv(struct async_task* t, struct chan* ch, uint64_t ms) {
+    return arm(t, ch, &ch->readable, recv_ready, ms);
+}
+
+int chan_arm_send(struct async_task* t, struct chan* ch, uint64_t ms) {
+    return arm(t, ch, &ch->writable, send_ready, ms);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "async/async.h"
+#include <stdint.h>
+
+// Bounded message channels between kernel tasks. Any number of producers
+// (tasks, IRQ handlers) send fixed 32-byte descriptors into a ring; one
+// consumer, an async task, takes them out:
+//
+//   static struct chan_slot log_slots[1u << 8];
+//   static struct chan log_chan = CHAN_INIT("log", log_slots, 8, CHAN_MSG_CONSOLE);
+//
+//   static int log_task(struct async_task* t) {
+//       struct chan_msg m;
+//       ASYNC_BEGIN(t);
+//       for (;;) {
+//           while (chan_recv(&log_chan, &m) == 0) handle(&m);
+//           ASYNC_WAIT_RECV(t, &log_chan, ASYNC_FOREVER);
+//       }
+//       ASYNC_END(t);
+//   }
+//
+// Small payloads ride in the descriptor. A large one is a page: the sender
+// fills it and sends its address, and from then on it belongs to the
+// receiver, which frees it or passes it on. The data itself is never
+// copied.
+//
+// Sending never blocks, so it works in interrupt handlers: a full ring
+// fails with -EAGAIN. It is lock-free unless a task is waiting on the
+// channel; then the wakeup takes async_lock (irqsave). Producer tasks that
+// can wait use ASYNC_WAIT_SEND.
+
+#define CHAN_INLINE        16              // payload bytes in the descriptor
+
+// message types, one per kind of channel (chan.type)
+#define CHAN_MSG_CONSOLE   1               // page of text for console_write()
+#define CHAN_MSG_BENCH     2               // kbench_chan.c
+
+struct chan_msg {
+    uint32_t type;              // CHAN_MSG_*, must match the channel
+    uint32_t len;               // bytes used in `page`, 0 without one
+    union {
+        uint8_t bytes[CHAN_INLINE];
+        uint64_t words[CHAN_INLINE / 8];
+    };
+    void* page;                 // 4 KiB from chan_page_alloc(), owned by the receiver
+};
+
+// turn = 2 * lap while free, 2 * lap + 1 while it holds the message of that lap
+struct chan_slot {
+    uint64_t turn;
+    struct chan_msg msg;
+};
+
+// Producers and the consumer write different cache lines
+struct chan {
+    uint64_t tail __attribute__((aligned(64)));   // next position to claim
+    uint64_t head __attribute__((aligned(64)));   // next position to receive, consumer only
+    struct async_event writable;                  // producer tasks waiting for a slot
+    struct chan_slot* slots __attribute__((aligned(64)));
+    uint32_t order;             // 1 << order slots
+    uint32_t type;
+    const char* name;
+    struct async_event readable;                  // the consumer task
+};
+
+#define CHAN_INIT(n, s, ord, t) { .slots = (s), .order = (ord), .type = (t), .name = (n) }
+
+_Static_assert(sizeof(struct chan_msg) == 32, "chan_msg layout");
+
+// ===================== API =====================
+// Runtime variant of CHAN_INIT, before the first send. -EINVAL for an
+// order above 16.
+int chan_init(struct chan* ch, struct chan_slot* slots, uint32_t order, uint32_t type, const char* name);
+
+// Any context. 0, -EAGAIN when the ring is full, -EINVAL for a message of
+// another type. The page only changes hands on success.
+int chan_send(struct chan* ch, const struct chan_msg* m);
+
+// Consumer only. 0, -EAGAIN when empty.
+int chan_recv(struct chan* ch, struct chan_msg* m);
+// Up to `max` messages at once, returns how many
+uint32_t chan_recv_batch(struct chan* ch, struct chan_msg* m, uint32_t max);
+
+// Payload pages: identity mapped PMM frames. NULL when out of memory.
+void* chan_page_alloc(void);
+void chan_page_free(void* page);
+
+// Wait registration for the ASYNC_* macros, from a running task only:
+// 1 if the task has to wait, 0 if a message (a free slot) is already there
+int chan_arm_recv(struct async_task* t, struct chan* ch, uint64_t ms);
+int chan_arm_send(struct async_task* t, struct chan* ch, uint64_t ms);
+
+// The consumer waiting for a message / a producer task for a free slot.
+// t->wake says whether one arrived (ASYNC_WAKE_EVENT) or the time ran out.
+#define ASYNC_WAIT_RECV(t, ch, ms)    ASYNC_AWAIT(t, chan_arm_recv(t, ch, ms))
+#define ASYNC_WAIT_SEND(t, ch, ms)    ASYNC_AWAIT(t, chan_arm_send(t, ch, ms))
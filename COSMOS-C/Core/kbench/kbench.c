@@ -0,0 +1,113 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Drivers/serial/serial.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "sync/lock_stats.h"
+#include "arch/x86_64/MM/stack.h"
+#ifdef PROF_HZ
+#include "prof/profiler.h"
+#endif
+#ifdef FTRACE
+#include "trace/ftrace.h"
+#endif
+#ifdef IRQSOFF
+#include "trace/irqsoff.h"
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef KBENCH_PROFILE
+#define KBENCH_PROFILE "debug"
+#endif
+
+// ===================== REPORTING =====================
+// Prints value/100 with two decimals
+static void kbench_write_centi(uint64_t centi) {
+    serial_write_dec(centi / 100);
+    serial_putc('.');
+    serial_putc('0' + (centi / 10) % 10);
+    serial_putc('0' + centi % 10);
+}
+
+static void kbench_write_line(const char* name, uint64_t iters, uint64_t cycles) {
+    if (iters == 0) iters = 1;
+    uint64_t centi_cycles = (cycles * 100) / iters;
+
+    serial_write("KBENCH name=");
+    serial_write(name);
+    serial_write(" iters=");
+    serial_write_dec(iters);
+    serial_write(" cycles=");
+    kbench_write_centi(centi_cycles);
+    serial_write(" ns=");
+    kbench_write_centi(tsc_khz ? (centi_cycles * 1000000) / tsc_khz : 0);
+}
+
+// cycles is the total for all iterations; per-op values are printed
+void kbench_report(const char* name, uint64_t iters, uint64_t cycles) {
+    kbench_write_line(name, iters, cycles);
+    serial_write("\n");
+}
+
+// Same as kbench_report() plus a throughput of `units` per second
+void kbench_report_rate(const char* name, uint64_t iters, uint64_t cycles,
+                        uint64_t units, const char* unit) {
+    kbench_write_line(name, iters, cycles);
+    serial_write(" rate=");
+    serial_write_dec(cycles ? (units * tsc_khz * 1000) / cycles : 0);
+    serial_write(" unit=");
+    serial_write(unit);
+    serial_write("/s\n");
+}
+
+void kbench_report_percentile(const char* name, const char* suffix, uint64_t cycles) {
+    char full[48];
+    size_t n = 0;
+    for (const char* s = name; *s && n < sizeof(full) - 8; s++) full[n++] = *s;
+    for (const char* s = suffix; *s && n < sizeof(full) - 1; s++) full[n++] = *s;
+    full[n] = '\0';
+    kbench_report(full, 1, cycles);
+}
+
+// ===================== QEMU EXIT =====================
+// isa-debug-exit makes QEMU exit with status (code << 1) | 1
+void kbench_exit(uint32_t code) {
+    outl(QEMU_EXIT_PORT, code);
+    // not running under the harness: just stop here
+    for (;;) __asm__ volatile ("cli; hlt");
+}
+
+// ===================== RUNNER =====================
+void kbench_run(void) {
+    if (tsc_khz == 0) tsc_calibrate();
+
+    serial_write("KBENCH begin profile=" KBENCH_PROFILE " tsc_khz=");
+    serial_write_dec(tsc_khz);
+    serial_write("\n");
+
+    kbench_core_run();
+    kbench_syscall_run();
+    kbench_sync_run();
+    kbench_mm_run();
+    kbench_blk_run();
+    kbench_fs_run();
+    kbench_async_run();
+    kbench_chan_run();
+    kbench_exec_run();
+    kbench_input_run();
+
+    serial_write("KBENCH end\n");
+    stack_report();      // peak depth of every stack over the suite
+#ifdef LOCK_STATS
+    lock_stats_report();
+#endif
+#ifdef PROF_HZ
+    profiler_report();   // started at boot, covers the whole suite
+#endif
+#ifdef IRQSOFF
+    irqsoff_report();    // scripts/kbench-run.sh fails the run when over budget
+#endif
+#ifdef FTRACE
+    if (ftrace_enabled_count()) ftrace_dump();
+#endif
+}
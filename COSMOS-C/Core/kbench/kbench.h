@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+// Software interrupt vector used for the IRQ round-trip benchmark
+#define KBENCH_VECTOR 0xF0
+
+// QEMU `-device isa-debug-exit,iobase=0xf4,iosize=0x04`
+#define QEMU_EXIT_PORT 0xF4
+
+// Every result is one line on COM1:
+//   KBENCH name=<name> iters=<n> cycles=<per op> ns=<per op> [rate=<n> unit=<unit>/s]
+// scripts/kbench-compare.sh diffs these lines against a stored baseline.
+
+// ===================== RUNNER =====================
+void kbench_run(void);
+void kbench_exit(uint32_t code);
+
+// ===================== REPORTING =====================
+void kbench_report(const char* name, uint64_t iters, uint64_t cycles);
+void kbench_report_rate(const char* name, uint64_t iters, uint64_t cycles,
+                        uint64_t units, const char* unit);
+// One latency as its own line, named <name><suffix> (e.g. "_p99"), iters=1
+void kbench_report_percentile(const char* name, const char* suffix, uint64_t cycles);
+
+// ===================== SUITES =====================
+void kbench_core_run(void);
+void kbench_syscall_run(void);
+void kbench_sync_run(void);
+void kbench_mm_run(void);
+void kbench_blk_run(void);
+void kbench_fs_run(void);
+void kbench_async_run(void);
+void kbench_exec_run(void);
+void kbench_chan_run(void);
+void kbench_input_run(void);
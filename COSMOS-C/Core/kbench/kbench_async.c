@@ -0,0 +1,103 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "async/async.h"
+#include "lib/sort.h"
+#include <stdint.h>
+
+// Executor overhead with thousands of tasks: a resume through the run
+// queue, arming a timeout (heap insert), an event waking every waiter, and
+// cancelling a pending timeout (heap removal).
+
+#define ASYNC_TASKS    16384
+#define ASYNC_YIELDS   64
+#define ASYNC_FAR_MS   (3600 * 1000ull)   // never expires during the suite
+
+static struct async_task tasks[ASYNC_TASKS];
+static uint32_t yields_left[ASYNC_TASKS];
+static struct async_event bench_event = ASYNC_EVENT_INIT;
+
+static int yield_task(struct async_task* t) {
+    uint32_t* left = t->ctx;
+    ASYNC_BEGIN(t);
+    while (*left) {
+        (*left)--;
+        ASYNC_YIELD(t);
+    }
+    ASYNC_END(t);
+}
+
+// deadline spread from ctx so the heap does real sift work
+static int sleep_task(struct async_task* t) {
+    ASYNC_BEGIN(t);
+    ASYNC_SLEEP(t, ASYNC_FAR_MS + (uintptr_t)t->ctx);
+    ASYNC_END(t);
+}
+
+static int event_task(struct async_task* t) {
+    ASYNC_BEGIN(t);
+    ASYNC_WAIT_EVENT(t, &bench_event, ASYNC_FAR_MS + (uintptr_t)t->ctx);
+    ASYNC_END(t);
+}
+
+static void drain(void) {
+    while (async_run());
+}
+
+// ===================== RESUME =====================
+static void bench_resume(void) {
+    for (int i = 0; i < ASYNC_TASKS; i++) {
+        yields_left[i] = ASYNC_YIELDS;
+        async_task_init(&tasks[i], yield_task, &yields_left[i]);
+        async_spawn(&tasks[i]);
+    }
+    uint64_t runs = 0;
+    uint64_t t0 = rdtsc();
+    for (uint32_t n; (n = async_run()) != 0;) runs += n;
+    uint64_t t1 = rdtsc();
+    kbench_report("async_resume", runs, t1 - t0);
+}
+
+// ===================== TIMEOUTS =====================
+static void bench_timeouts(void) {
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < ASYNC_TASKS; i++) {
+        async_task_init(&tasks[i], sleep_task, (void*)(uintptr_t)(xorshift64(&seed) % 60000));
+        async_spawn(&tasks[i]);
+    }
+    // first run: every task arms its sleep
+    uint64_t t0 = rdtsc();
+    async_run();
+    uint64_t t1 = rdtsc();
+    kbench_report("async_sleep_arm", ASYNC_TASKS, t1 - t0);
+
+    t0 = rdtsc();
+    for (int i = 0; i < ASYNC_TASKS; i++) async_cancel(&tasks[i]);
+    t1 = rdtsc();
+    kbench_report("async_cancel", ASYNC_TASKS, t1 - t0);
+    drain();
+}
+
+// ===================== EVENTS =====================
+static void bench_event_wake(void) {
+    uint64_t seed = 0x2545F4914F6CDD1Dull;
+    for (int i = 0; i < ASYNC_TASKS; i++) {
+        async_task_init(&tasks[i], event_task, (void*)(uintptr_t)(xorshift64(&seed) % 60000));
+        async_spawn(&tasks[i]);
+    }
+    async_run();
+
+    // signal + run: wake, drop the timeout, resume to completion
+    uint64_t t0 = rdtsc();
+    async_event_signal(&bench_event, 1);
+    async_run();
+    uint64_t t1 = rdtsc();
+    kbench_report("async_event_wake", ASYNC_TASKS, t1 - t0);
+    drain();
+}
+
+// ===================== SUITE =====================
+void kbench_async_run(void) {
+    bench_resume();
+    bench_timeouts();
+    bench_event_wake();
+}
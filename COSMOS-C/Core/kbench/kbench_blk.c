@@ -0,0 +1,114 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "Drivers/virtio/virtio_blk.h"
+#include "Drivers/serial/serial.h"
+#include "lib/sort.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// fio-like jobs against the virtio-blk disk (scripts/kbench-run.sh attaches
+// a scratch image): a fixed number of 4 KiB I/Os with `depth` of them
+// always in flight. Completions resubmit from the interrupt, so the driver
+// batches them into one doorbell per interrupt.
+//
+// Reported per job: <job> (rate = IOPS) and <job>_p50/_p99/_p999 latency.
+
+#define BLK_IO_SIZE   4096
+#define BLK_IOS       8192
+#define BLK_MAX_DEPTH 32
+
+struct blk_job {
+    const char* name;
+    uint32_t op;
+    int depth;
+    int sequential;
+};
+
+static const struct blk_job jobs[] = {
+    { "blk_randread_qd1",   BLK_READ,  1,  0 },
+    { "blk_randread_qd4",   BLK_READ,  4,  0 },
+    { "blk_randread_qd16",  BLK_READ,  16, 0 },
+    { "blk_randread_qd32",  BLK_READ,  32, 0 },
+    { "blk_randwrite_qd16", BLK_WRITE, 16, 0 },
+    { "blk_seqread_qd32",   BLK_READ,  32, 1 },  // adjacent requests get merged
+};
+
+static uint8_t io_buf[BLK_MAX_DEPTH][BLK_IO_SIZE] __attribute__((aligned(4096)));
+static struct blk_request io_req[BLK_MAX_DEPTH];
+static uint64_t io_start[BLK_MAX_DEPTH];
+static uint64_t latency[BLK_IOS];
+
+static const struct blk_job* job;
+static uint64_t io_slots;           // 4 KiB slots on the disk
+static uint64_t next_slot;          // sequential jobs
+static uint64_t seed = 0x9E3779B97F4A7C15ull;
+static volatile uint32_t issued, completed, failed;
+
+// ===================== I/O =====================
+static void io_done(struct blk_request* req, int status);
+
+static void io_issue(int i) {
+    struct blk_request* req = &io_req[i];
+    uint64_t slot = job->sequential ? next_slot++ % io_slots : xorshift64(&seed) % io_slots;
+
+    req->op = job->op;
+    req->sector = slot * (BLK_IO_SIZE / BLK_SECTOR_SIZE);
+    req->segs[0] = (struct blk_segment){ io_buf[i], BLK_IO_SIZE };
+    req->seg_count = 1;
+    req->done = io_done;
+    req->ctx = (void*)(uintptr_t)i;
+    issued++;
+    io_start[i] = rdtsc();
+    if (virtio_blk_submit(req) < 0) failed++;
+}
+
+// IRQ context; virtio_blk kicks once all completions of the interrupt ran
+static void io_done(struct blk_request* req, int status) {
+    int i = (int)(uintptr_t)req->ctx;
+    if (completed < BLK_IOS) latency[completed] = rdtsc() - io_start[i];
+    completed++;
+    if (status != BLK_STATUS_OK) failed++;
+    if (issued < BLK_IOS) io_issue(i);
+}
+
+// ===================== JOBS =====================
+static void run_job(const struct blk_job* j) {
+    job = j;
+    issued = completed = failed = 0;
+    next_slot = 0;
+    virtio_blk_stats = (struct virtio_blk_stats){ 0 };
+
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < j->depth; i++) io_issue(i);
+    virtio_blk_kick();
+    while (completed < BLK_IOS && !failed) cpu_halt(); // the timer tick bounds a missed wakeup
+    uint64_t t1 = rdtsc();
+
+    if (failed) {
+        serial_write("[BLK] ");
+        serial_write(j->name);
+        serial_write(" failed\n");
+        return;
+    }
+    kbench_report_rate(j->name, BLK_IOS, t1 - t0, BLK_IOS, "iops");
+    sort_u64(latency, BLK_IOS);
+    kbench_report_percentile(j->name, "_p50", percentile_u64(latency, BLK_IOS, 500));
+    kbench_report_percentile(j->name, "_p99", percentile_u64(latency, BLK_IOS, 990));
+    kbench_report_percentile(j->name, "_p999", percentile_u64(latency, BLK_IOS, 999));
+    virtio_blk_report();
+}
+
+// ===================== SUITE =====================
+void kbench_blk_run(void) {
+    if (!virtio_blk_present()) {
+        serial_write("[BLK] no virtio-blk device, skipping\n");
+        return;
+    }
+    io_slots = virtio_blk_capacity() / (BLK_IO_SIZE / BLK_SECTOR_SIZE);
+    if (io_slots < BLK_MAX_DEPTH) {
+        serial_write("[BLK] disk too small, skipping\n");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(jobs) / sizeof(jobs[0]); i++) run_job(&jobs[i]);
+}
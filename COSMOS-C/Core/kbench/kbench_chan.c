@@ -0,0 +1,150 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "ipc/chan.h"
+#include "async/async.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "lib/sort.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Message channels (Core/ipc): small descriptors one at a time and in
+// batches, 4 KiB payloads handed over as pages against copying them through
+// a byte buffer, and the latency from chan_send() to the consumer task
+// running (wakeup + one async_run()).
+
+#define CHAN_ORDER       10
+#define CHAN_SLOTS       (1u << CHAN_ORDER)
+#define CHAN_ITERS       1000000
+#define CHAN_PAGE_ITERS  65536
+#define CHAN_WAKES       4096
+#define PAGE_BYTES       4096
+
+static struct chan_slot slots[CHAN_SLOTS];
+static struct chan bench_chan = CHAN_INIT("bench", slots, CHAN_ORDER, CHAN_MSG_BENCH);
+static struct chan_msg batch[CHAN_SLOTS];
+
+static uint8_t copy_src[PAGE_BYTES] __attribute__((aligned(4096)));
+static uint8_t copy_ring[PAGE_BYTES] __attribute__((aligned(4096)));
+static uint8_t copy_dst[PAGE_BYTES] __attribute__((aligned(4096)));
+
+static struct async_task consumer;
+static uint64_t latency[CHAN_WAKES];
+static uint32_t received;
+
+// ===================== SMALL MESSAGES =====================
+static void bench_small(void) {
+    struct chan_msg m = { .type = CHAN_MSG_BENCH }, out;
+    uint64_t sum = 0;
+
+    uint64_t t0 = rdtsc();
+    for (uint64_t i = 0; i < CHAN_ITERS; i++) {
+        m.words[0] = i;
+        chan_send(&bench_chan, &m);
+        chan_recv(&bench_chan, &out);
+        sum += out.words[0];
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report_rate("chan_send_recv", CHAN_ITERS, t1 - t0, CHAN_ITERS, "msgs");
+
+    // a full ring per round, drained with one chan_recv_batch()
+    uint64_t rounds = CHAN_ITERS / CHAN_SLOTS;
+    t0 = rdtsc();
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < CHAN_SLOTS; i++) {
+            m.words[0] = i;
+            chan_send(&bench_chan, &m);
+        }
+        for (uint32_t n = 0; n < CHAN_SLOTS;) n += chan_recv_batch(&bench_chan, batch + n, CHAN_SLOTS - n);
+        sum += batch[CHAN_SLOTS - 1].words[0];
+    }
+    t1 = rdtsc();
+    kbench_report_rate("chan_batch", rounds * CHAN_SLOTS, t1 - t0, rounds * CHAN_SLOTS, "msgs");
+
+    if (sum == 0) serial_write("[CHAN] no messages arrived\n");
+}
+
+// ===================== PAGES =====================
+// Both sides touch the payload once: the producer fills its first line,
+// the consumer reads it back. What differs is whether the other 4 KiB move.
+static void bench_pages(void) {
+    struct chan_msg m = { .type = CHAN_MSG_BENCH, .len = PAGE_BYTES }, out;
+    uint64_t sum = 0;
+
+    uint64_t t0 = rdtsc();
+    for (uint64_t i = 0; i < CHAN_PAGE_ITERS; i++) {
+        m.page = chan_page_alloc();
+        if (!m.page) {
+            serial_write("[CHAN] out of pages, skipping\n");
+            return;
+        }
+        *(volatile uint64_t*)m.page = i;
+        chan_send(&bench_chan, &m);
+        chan_recv(&bench_chan, &out);
+        sum += *(volatile uint64_t*)out.page;
+        chan_page_free(out.page);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report_rate("chan_page_handoff", CHAN_PAGE_ITERS, t1 - t0,
+                       CHAN_PAGE_ITERS * PAGE_BYTES, "bytes");
+
+    // what a byte stream would do: copy in, copy out
+    t0 = rdtsc();
+    for (uint64_t i = 0; i < CHAN_PAGE_ITERS; i++) {
+        *(volatile uint64_t*)copy_src = i;
+        memcpy(copy_ring, copy_src, PAGE_BYTES);
+        __asm__ volatile ("" : : "r"(copy_ring) : "memory");
+        memcpy(copy_dst, copy_ring, PAGE_BYTES);
+        sum += *(volatile uint64_t*)copy_dst;
+    }
+    t1 = rdtsc();
+    kbench_report_rate("chan_page_copy", CHAN_PAGE_ITERS, t1 - t0,
+                       CHAN_PAGE_ITERS * PAGE_BYTES, "bytes");
+
+    if (sum == 0) serial_write("[CHAN] no pages arrived\n");
+}
+
+// ===================== WAKEUP LATENCY =====================
+static int consumer_task(struct async_task* t) {
+    struct chan_msg m;
+    ASYNC_BEGIN(t);
+    for (;;) {
+        while (chan_recv(&bench_chan, &m) == 0) latency[received++] = rdtsc() - m.words[0];
+        if (received == CHAN_WAKES) break;
+        ASYNC_WAIT_RECV(t, &bench_chan, ASYNC_FOREVER);
+    }
+    ASYNC_END(t);
+}
+
+// The consumer sleeps on the channel; every send wakes it and the next
+// async_run() delivers the message
+static void bench_wake(void) {
+    struct chan_msg m = { .type = CHAN_MSG_BENCH };
+    received = 0;
+    async_task_init(&consumer, consumer_task, NULL);
+    async_spawn(&consumer);
+    async_run();                        // consumer parks in ASYNC_WAIT_RECV
+
+    for (uint32_t i = 0; i < CHAN_WAKES; i++) {
+        m.words[0] = rdtsc();
+        chan_send(&bench_chan, &m);
+        async_run();
+    }
+    while (async_run());
+
+    if (received != CHAN_WAKES) {
+        serial_write("[CHAN] consumer missed wakeups\n");
+        async_cancel(&consumer);
+        return;
+    }
+    sort_u64(latency, CHAN_WAKES);
+    kbench_report_percentile("chan_wake", "_p50", percentile_u64(latency, CHAN_WAKES, 500));
+    kbench_report_percentile("chan_wake", "_p99", percentile_u64(latency, CHAN_WAKES, 990));
+}
+
+// ===================== SUITE =====================
+void kbench_chan_run(void) {
+    bench_small();
+    bench_pages();
+    bench_wake();
+}
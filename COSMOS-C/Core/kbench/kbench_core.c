@@ -0,0 +1,277 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/RTC/rtc.h"
+#include "arch/x86_64/IDT/idt.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "HAL/console/print.h"
+#include "lib/sort.h"
+#include "lib/string.h"
+#include "param/param.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Benchmarks for the paths that run on every interrupt, key press and
+// console write, plus raw memory bandwidth/latency as a reference point.
+
+#define IRQ_ITERS        100000
+#define CALLBACK_ITERS   100000
+#define CLOCK_READS      100000
+#define RTC_READS        1000
+#define CONSOLE_CHARS    (80 * 24 * 64)
+#define CONSOLE_SCROLLS  4096
+#define CONSOLE_LINES    4096
+#define VT_SWITCHES      4096
+#define KBD_SCANCODES    200000
+#define MEM_BUF_SIZE     (4 * 1024 * 1024)
+#define MEM_COPY_TOTAL   (64 * 1024 * 1024)
+#define CHASE_LOADS      1000000
+#define CACHE_LINE       64
+
+extern void isr240();
+
+static uint8_t mem_src[MEM_BUF_SIZE] __attribute__((aligned(4096)));
+static uint8_t mem_dst[MEM_BUF_SIZE] __attribute__((aligned(4096)));
+
+// ===================== INTERRUPTS =====================
+// int -> isr stub -> isr_handler -> iretq, with an empty handler
+static void bench_irq_roundtrip(void) {
+    set_idt_gate(KBENCH_VECTOR, (uint64_t)isr240, 0x8E);
+
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < IRQ_ITERS; i++) {
+        __asm__ volatile ("int %0" : : "i"(KBENCH_VECTOR) : "memory");
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report("irq_roundtrip", IRQ_ITERS, t1 - t0);
+}
+
+// ===================== TIMER CALLBACKS =====================
+static void bench_noop_callback(void) {}
+
+// Cost of one timer_callbacks_update() call, i.e. the per-tick dispatch work
+static void bench_timer_callbacks(void) {
+    uint64_t t0, t1;
+
+    __asm__ volatile ("cli");
+    t0 = rdtsc();
+    for (int i = 0; i < CALLBACK_ITERS; i++) timer_callbacks_update();
+    t1 = rdtsc();
+    __asm__ volatile ("sti");
+    kbench_report("timer_dispatch_empty", CALLBACK_ITERS, t1 - t0);
+
+    // every slot armed far in the future: worst-case scan, nothing fires
+    for (uint32_t i = 0; i < param_get(PARAM_CALLBACKS_MAX); i++) set_timeout(bench_noop_callback, 1ull << 40);
+    __asm__ volatile ("cli");
+    t0 = rdtsc();
+    for (int i = 0; i < CALLBACK_ITERS; i++) timer_callbacks_update();
+    t1 = rdtsc();
+    __asm__ volatile ("sti");
+    cancel_timeout(bench_noop_callback);
+    kbench_report("timer_dispatch_full", CALLBACK_ITERS, t1 - t0);
+
+    t0 = rdtsc();
+    for (int i = 0; i < CALLBACK_ITERS; i++) {
+        set_timeout(bench_noop_callback, 1ull << 40);
+        cancel_timeout(bench_noop_callback);
+    }
+    t1 = rdtsc();
+    kbench_report("timer_arm_cancel", CALLBACK_ITERS, t1 - t0);
+}
+
+// ===================== CLOCK SOURCES =====================
+// read() of every registered source, a full timestamp through the selected
+// one (seqlock + read + scaling), the wall clock through the same snapshot,
+// and what reading the RTC itself would cost instead
+static void bench_clocksources(void) {
+    char name[32];
+    for (uint32_t i = 0; i < clocksource_count(); i++) {
+        const struct clocksource* cs = clocksource_at(i);
+        size_t len = strlen(cs->name);
+        memcpy(name, "clock_read_", 11);
+        memcpy(name + 11, cs->name, len + 1);
+
+        uint64_t sum = 0;
+        uint64_t t0 = rdtsc();
+        for (int n = 0; n < CLOCK_READS; n++) sum += cs->read();
+        uint64_t t1 = rdtsc();
+        __asm__ volatile ("" : : "r"(sum));
+        kbench_report(name, CLOCK_READS, t1 - t0);
+    }
+
+    uint64_t sum = 0;
+    uint64_t t0 = rdtsc();
+    for (int n = 0; n < CLOCK_READS; n++) sum += timer_uptime_ns();
+    uint64_t t1 = rdtsc();
+    __asm__ volatile ("" : : "r"(sum));
+    kbench_report("timer_uptime_ns", CLOCK_READS, t1 - t0);
+
+    struct timer_timespec ts;
+    t0 = rdtsc();
+    for (int n = 0; n < CLOCK_READS; n++) {
+        timer_clock_gettime(TIMER_CLOCK_REALTIME, &ts);
+        sum += (uint64_t)ts.tv_nsec;
+    }
+    t1 = rdtsc();
+    __asm__ volatile ("" : : "r"(sum));
+    kbench_report("clock_gettime_realtime", CLOCK_READS, t1 - t0);
+
+    struct rtc_time rt;
+    t0 = rdtsc();
+    for (int n = 0; n < RTC_READS; n++) rtc_read(&rt);
+    t1 = rdtsc();
+    kbench_report("rtc_read", RTC_READS, t1 - t0);
+}
+
+// ===================== CONSOLE =====================
+static void bench_console(void) {
+    uint64_t t0, t1;
+
+    // characters without scrolling: rewind before reaching the last row
+    print_clear();
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_CHARS; i++) {
+        if (i % (80 * 24) == 0) print_set_cursor(0, 0);
+        print_char('a' + (i % 26));
+    }
+    t1 = rdtsc();
+    kbench_report_rate("console_chars", CONSOLE_CHARS, t1 - t0, CONSOLE_CHARS, "chars");
+
+    print_set_cursor(0, 24);
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_SCROLLS; i++) print_newline();
+    t1 = rdtsc();
+    kbench_report_rate("console_scroll", CONSOLE_SCROLLS, t1 - t0, CONSOLE_SCROLLS, "scrolls");
+
+    // the same lines into the front terminal (VGA) and a background one (RAM)
+    static const char line[] = "[CLOCK] source tsc freq_hz=2995200000 read_cycles=24 stable\n";
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_LINES; i++) print_str((char*)line);
+    t1 = rdtsc();
+    kbench_report_rate("console_lines_front", CONSOLE_LINES, t1 - t0, CONSOLE_LINES, "lines");
+
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_LINES; i++) print_vt_str(1, line);
+    t1 = rdtsc();
+    kbench_report_rate("console_lines_background", CONSOLE_LINES, t1 - t0, CONSOLE_LINES, "lines");
+
+    // the boot log line: two colors as escapes in one call, against the
+    // print_set_color() + print_str() pairs it replaced
+    static const char ansi[] = "\033[92m[4/6] [PS/2 DRIVER] \033[97minitialized\n";
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_LINES; i++) console_write(ansi, sizeof(ansi) - 1);
+    t1 = rdtsc();
+    kbench_report_rate("console_write_ansi", CONSOLE_LINES, t1 - t0, CONSOLE_LINES, "lines");
+
+    t0 = rdtsc();
+    for (int i = 0; i < CONSOLE_LINES; i++) {
+        print_set_color(LIGHT_GREEN, BLACK);
+        print_str("[4/6] [PS/2 DRIVER] ");
+        print_set_color(WHITE, BLACK);
+        print_str("initialized\n");
+    }
+    t1 = rdtsc();
+    kbench_report_rate("console_print_colored", CONSOLE_LINES, t1 - t0, CONSOLE_LINES, "lines");
+
+    t0 = rdtsc();
+    for (int i = 0; i < VT_SWITCHES; i++) print_vt_switch((uint32_t)(i + 1) % 2);
+    t1 = rdtsc();
+    kbench_report("vt_switch", VT_SWITCHES, t1 - t0);
+
+    print_clear();
+}
+
+// ===================== KEYBOARD =====================
+// press/release pairs with shift toggles, no keys that print or touch LEDs
+static const uint8_t kbd_stream[] = {
+    0x1E, 0x9E, 0x30, 0xB0, 0x2E, 0xAE, 0x20, 0xA0,  // a b c d
+    0x2A, 0x12, 0x92, 0x21, 0xA1, 0xAA,              // shift+e f
+    0x02, 0x82, 0x03, 0x83, 0x39, 0xB9, 0x0E, 0x8E,  // 1 2 space backspace
+    0xE0, 0x4B, 0xE0, 0xCB, 0xE0, 0x4D, 0xE0, 0xCD,  // left right
+};
+
+static void bench_keyboard(void) {
+    const int stream_len = sizeof(kbd_stream);
+    while (keyboard_getchar() >= 0);
+
+    __asm__ volatile ("cli");
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < KBD_SCANCODES; i++) {
+        keyboard_handle_scancode(kbd_stream[i % stream_len]);
+        if ((i & 63) == 63) while (keyboard_getchar() >= 0);
+    }
+    uint64_t t1 = rdtsc();
+    __asm__ volatile ("sti");
+
+    while (keyboard_getchar() >= 0);
+    kbench_report_rate("kbd_decode", KBD_SCANCODES, t1 - t0, KBD_SCANCODES, "scancodes");
+}
+
+// ===================== MEMORY =====================
+static void bench_memcpy(void) {
+    static const struct { const char* name; size_t size; } sizes[] = {
+        { "memcpy_4k",  4096 },
+        { "memcpy_64k", 64 * 1024 },
+        { "memcpy_1m",  1024 * 1024 },
+        { "memcpy_4m",  MEM_BUF_SIZE },
+    };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s].size;
+        uint64_t iters = MEM_COPY_TOTAL / size;
+        memcpy(mem_dst, mem_src, size); // warm up
+
+        uint64_t t0 = rdtsc();
+        for (uint64_t i = 0; i < iters; i++) memcpy(mem_dst, mem_src, size);
+        uint64_t t1 = rdtsc();
+        kbench_report_rate(sizes[s].name, iters, t1 - t0, iters * size, "bytes");
+    }
+}
+
+// Dependent loads through a random single-cycle permutation of cache lines
+// (Sattolo's algorithm), so neither the prefetcher nor OoO can hide latency.
+static void bench_pointer_chase(void) {
+    static const struct { const char* name; size_t size; } sets[] = {
+        { "chase_16k",  16 * 1024 },
+        { "chase_256k", 256 * 1024 },
+        { "chase_4m",   MEM_BUF_SIZE },
+    };
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+        size_t lines = sets[s].size / CACHE_LINE;
+        uint32_t* order = (uint32_t*)mem_dst;
+
+        for (size_t i = 0; i < lines; i++) order[i] = (uint32_t)i;
+        for (size_t i = lines - 1; i > 0; i--) {
+            size_t j = xorshift64(&seed) % i;
+            uint32_t tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+        }
+        for (size_t i = 0; i < lines; i++) {
+            size_t next = order[i];
+            *(void**)(mem_src + i * CACHE_LINE) = mem_src + next * CACHE_LINE;
+        }
+
+        void* volatile* p = (void* volatile*)mem_src;
+        for (size_t i = 0; i < lines; i++) p = (void* volatile*)*p; // warm up
+
+        uint64_t t0 = rdtsc();
+        for (int i = 0; i < CHASE_LOADS; i++) p = (void* volatile*)*p;
+        uint64_t t1 = rdtsc();
+        __asm__ volatile ("" : : "r"(p));
+        kbench_report(sets[s].name, CHASE_LOADS, t1 - t0);
+    }
+}
+
+// ===================== SUITE =====================
+void kbench_core_run(void) {
+    bench_irq_roundtrip();
+    bench_timer_callbacks();
+    bench_clocksources();
+    bench_console();
+    bench_keyboard();
+    bench_memcpy();
+    bench_pointer_chase();
+}
@@ -0,0 +1,62 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "exec/exec.h"
+#include "Drivers/serial/serial.h"
+#include <stdint.h>
+
+// Process lifecycle of the "worker" module (user/worker.c): spawn, run to
+// SYS_EXIT and tear down, each timed on its own and then back to back.
+// Every instance maps the same text and rodata frames; the private pages
+// (copied .data, touched .bss, stack) are reported per instance.
+
+#define EXEC_SPAWNS   1000
+
+// ===================== SUITE =====================
+void kbench_exec_run(void) {
+    struct exec_image img;
+    struct exec_proc p;
+    if (exec_image_load("worker", &img) < 0) {
+        serial_write("[EXEC] worker module missing, skipping\n");
+        return;
+    }
+
+    uint64_t spawn = 0, run = 0, teardown = 0, private_pages = 0, bad = 0;
+    for (uint64_t i = 0; i < EXEC_SPAWNS; i++) {
+        uint64_t t0 = rdtsc();
+        if (exec_spawn(&img, &p) < 0) {
+            serial_write("[EXEC] exec_spawn failed, skipping\n");
+            return;
+        }
+        uint64_t t1 = rdtsc();
+        int64_t code = exec_run(&p, i);
+        uint64_t t2 = rdtsc();
+        private_pages = exec_resident_pages(&p);
+        exec_teardown(&p);
+        uint64_t t3 = rdtsc();
+
+        spawn += t1 - t0;
+        run += t2 - t1;
+        teardown += t3 - t2;
+        bad += code != (int64_t)i + 1;
+    }
+    kbench_report("exec_spawn", EXEC_SPAWNS, spawn);
+    kbench_report("exec_run", EXEC_SPAWNS, run);
+    kbench_report("exec_teardown", EXEC_SPAWNS, teardown);
+
+    uint64_t t0 = rdtsc();
+    for (uint64_t i = 0; i < EXEC_SPAWNS; i++) {
+        if (exec_spawn(&img, &p) < 0) break;
+        bad += exec_run(&p, i) != (int64_t)i + 1;
+        exec_teardown(&p);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report("exec_lifecycle", EXEC_SPAWNS, t1 - t0);
+
+    serial_write("[EXEC] per instance: shared_pages=");
+    serial_write_dec(img.shared_pages);
+    serial_write(" private_pages=");
+    serial_write_dec(private_pages);
+    serial_write(" bad_exits=");
+    serial_write_dec(bad);
+    serial_write("\n");
+}
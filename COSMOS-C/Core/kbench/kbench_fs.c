@@ -0,0 +1,128 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "fs/initrd.h"
+#include "fs/file.h"
+#include "Drivers/serial/serial.h"
+#include "lib/sort.h"
+#include "lib/string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// initrd lookup latency and read throughput. `make bench` boots with a
+// generated archive (scripts/mkinitrd-bench.sh): tens of thousands of small
+// files under data/ and big/blob.bin (16 MiB).
+
+#define LOOKUP_PATHS   4096
+#define LOOKUP_ITERS   1000000
+#define PATH_LEN       96
+#define READ_CHUNK     (64 * 1024)
+#define READ_PASSES    8
+#define BIG_FILE       "big/blob.bin"
+
+static char paths[LOOKUP_PATHS][PATH_LEN];
+static uint8_t read_buf[READ_CHUNK] __attribute__((aligned(4096)));
+
+// ===================== LOOKUP =====================
+static void bench_lookup(void) {
+    uint32_t count = initrd_file_count();
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < LOOKUP_PATHS; i++) {
+        const struct initrd_file* f = initrd_file_at((uint32_t)(xorshift64(&seed) % count));
+        if (initrd_path(f, paths[i], PATH_LEN - 2) < 0) paths[i][0] = '\0';
+    }
+
+    uintptr_t found = 0;
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < LOOKUP_ITERS; i++) found += (uintptr_t)initrd_lookup(paths[i % LOOKUP_PATHS]);
+    uint64_t t1 = rdtsc();
+    __asm__ volatile ("" : : "r"(found));
+    kbench_report("initrd_lookup_hit", LOOKUP_ITERS, t1 - t0);
+
+    // same paths with one more character: full hash + probe, no match
+    for (int i = 0; i < LOOKUP_PATHS; i++) {
+        size_t len = strlen(paths[i]);
+        paths[i][len] = 'x';
+        paths[i][len + 1] = '\0';
+    }
+    t0 = rdtsc();
+    for (int i = 0; i < LOOKUP_ITERS; i++) found += (uintptr_t)initrd_lookup(paths[i % LOOKUP_PATHS]);
+    t1 = rdtsc();
+    __asm__ volatile ("" : : "r"(found));
+    kbench_report("initrd_lookup_miss", LOOKUP_ITERS, t1 - t0);
+}
+
+// ===================== READ =====================
+// open + read the whole file + close, for every small file in the archive
+static void bench_read_small(void) {
+    uint32_t count = initrd_file_count();
+    char path[PATH_LEN];
+    uint64_t bytes = 0;
+
+    uint64_t t0 = rdtsc();
+    for (uint32_t i = 0; i < count; i++) {
+        const struct initrd_file* f = initrd_file_at(i);
+        if (f->size > READ_CHUNK || initrd_path(f, path, sizeof(path)) < 0) continue;
+        int fd = fs_open(path);
+        if (fd < 0) continue;
+        int64_t n;
+        while ((n = fs_read(fd, read_buf, READ_CHUNK)) > 0) bytes += n;
+        fs_close(fd);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report_rate("fs_open_read_small", count, t1 - t0, count, "files");
+    (void)bytes;
+}
+
+static uint64_t sum_words(const uint64_t* p, uint64_t bytes) {
+    uint64_t s = 0;
+    for (uint64_t i = 0; i < bytes / 8; i++) s += p[i];
+    return s;
+}
+
+// read() copies into a buffer, the mapping reads the module in place
+static void bench_read_big(void) {
+    int fd = fs_open(BIG_FILE);
+    if (fd < 0) {
+        serial_write("[FS] " BIG_FILE " missing, skipping read throughput\n");
+        return;
+    }
+    uint64_t size = (uint64_t)fs_size(fd);
+    uint64_t sum = 0;
+
+    uint64_t t0 = rdtsc();
+    for (int pass = 0; pass < READ_PASSES; pass++) {
+        fs_close(fd);
+        fd = fs_open(BIG_FILE);
+        int64_t n;
+        while ((n = fs_read(fd, read_buf, READ_CHUNK)) > 0) sum += sum_words((const uint64_t*)read_buf, n);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report_rate("fs_read_64k", READ_PASSES * (size / READ_CHUNK), t1 - t0, READ_PASSES * size, "bytes");
+
+    t0 = rdtsc();
+    for (int pass = 0; pass < READ_PASSES; pass++) sum += sum_words(fs_map(fd, 0), size);
+    t1 = rdtsc();
+    kbench_report_rate("fs_map_scan", READ_PASSES * (size / READ_CHUNK), t1 - t0, READ_PASSES * size, "bytes");
+    __asm__ volatile ("" : : "r"(sum));
+
+    // user mapping of the whole file: page table updates only, no data touched
+    t0 = rdtsc();
+    int64_t addr = fs_mmap_user(fd, 0, size);
+    t1 = rdtsc();
+    if (addr > 0) {
+        kbench_report_rate("fs_mmap_user_16m", 1, t1 - t0, size, "bytes");
+        fs_munmap_user((uint64_t)addr);
+    }
+    fs_close(fd);
+}
+
+// ===================== SUITE =====================
+void kbench_fs_run(void) {
+    if (!initrd_present()) {
+        serial_write("[FS] no initrd, skipping\n");
+        return;
+    }
+    bench_lookup();
+    bench_read_small();
+    bench_read_big();
+}
@@ -0,0 +1,55 @@
+#include "kbench/kbench.h"
+#include "Drivers/PS2/keyboard/kbd_replay.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "lib/errno.h"
+#include <stdint.h>
+
+// Key-to-echo latency (HAL/Drivers/PS2/keyboard/kbd_replay.h): scancodes go
+// in through the IRQ1 gate, kb_update() draws them, the probes time each
+// key in between. A synthetic editing burst at the recorded pace and
+// accelerated, then a recorded session if the initrd has one (make bench
+// copies BENCH_REPLAY to replay/keys.kbdrec).
+
+#define INPUT_KEYS_PER_SEC  10000
+#define INPUT_EVENTS        40000       // ~18000 keys, under 2 s at 1x
+#define INPUT_FAST          10
+#define INPUT_SEED          0x243F6A8885A308D3ull
+#define REPLAY_FILE         "replay/keys.kbdrec"
+
+static struct kbd_event* events;
+
+static void replay(const char* name, uint32_t n, uint32_t speed) {
+    struct kbd_latency l;
+    int err = kbd_replay(events, n, speed, &l);
+    if (err < 0) {
+        serial_write("[KBDREPLAY] ");
+        serial_write(name);
+        serial_write(" skipped, error ");
+        serial_write_dec((uint64_t)-err);
+        serial_putc('\n');
+        return;
+    }
+    kbd_latency_report(name, &l);
+    kbench_report_percentile(name, "_p50", l.p50);
+    kbench_report_percentile(name, "_p99", l.p99);
+    kbench_report_percentile(name, "_p999", l.p999);
+}
+
+// ===================== SUITE =====================
+void kbench_input_run(void) {
+    events = vm_reserve(KB_RECORD_MAX * sizeof(*events), VM_READ | VM_WRITE, "kbench input");
+    if (!events) {
+        serial_write("[KBDREPLAY] no memory, skipping\n");
+        return;
+    }
+
+    uint32_t n = kbd_replay_synth(events, INPUT_EVENTS, INPUT_KEYS_PER_SEC, INPUT_SEED);
+    replay("kbd_echo_1x", n, 1);
+    replay("kbd_echo_10x", n, INPUT_FAST);
+
+    int rec = kbd_replay_load(REPLAY_FILE, events, KB_RECORD_MAX);
+    if (rec > 0) replay("kbd_echo_recorded", (uint32_t)rec, 1);
+    else if (rec < 0 && rec != -ENOENT) serial_write("[KBDREPLAY] " REPLAY_FILE " unreadable\n");
+}
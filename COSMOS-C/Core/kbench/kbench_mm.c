@@ -0,0 +1,97 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/MM/page_fault.h"
+#include "Drivers/serial/serial.h"
+#include <stdint.h>
+
+// Page fault cost per resolution kind, measured as touch loops over fresh
+// regions (one fault per page), against the same loop over resident pages.
+
+#define MM_PAGES  1024  // 4 MiB per region
+
+static void touch_write(uint8_t* p, int pages) {
+    for (int i = 0; i < pages; i++) ((volatile uint8_t*)p)[i * PAGE_SIZE] = 1;
+}
+
+static void touch_read(uint8_t* p, int pages) {
+    for (int i = 0; i < pages; i++) (void)((volatile uint8_t*)p)[i * PAGE_SIZE];
+}
+
+static void report_rss(const char* when, uint64_t free_before) {
+    serial_write("[MM] ");
+    serial_write(when);
+    serial_write(": resident_pages=");
+    serial_write_dec(vm_resident_pages());
+    serial_write(" pmm_used_pages=");
+    serial_write_dec(free_before - pmm_free_pages());
+    serial_write("\n");
+}
+
+// ===================== FAULTS =====================
+static void bench_faults(void) {
+    const size_t size = MM_PAGES * PAGE_SIZE;
+    uint64_t free_before = pmm_free_pages();
+    uint64_t t0, t1;
+
+    uint8_t* a = vm_reserve(size, VM_READ | VM_WRITE, "kbench-a");
+    uint8_t* b = vm_reserve(size, VM_READ | VM_WRITE, "kbench-b");
+    if (!a || !b) {
+        serial_write("[MM] vm_reserve failed, skipping\n");
+        return;
+    }
+    report_rss("reserved", free_before);
+
+    // write to untouched memory: fresh zeroed frame per page
+    t0 = rdtsc();
+    touch_write(a, MM_PAGES);
+    t1 = rdtsc();
+    kbench_report("pf_demand_zero", MM_PAGES, t1 - t0);
+
+    // same loop, pages now resident: the fault-free reference
+    t0 = rdtsc();
+    touch_write(a, MM_PAGES);
+    t1 = rdtsc();
+    kbench_report("touch_resident", MM_PAGES, t1 - t0);
+
+    // read of untouched memory: zero page, no allocation
+    t0 = rdtsc();
+    touch_read(b, MM_PAGES);
+    t1 = rdtsc();
+    kbench_report("pf_zero_page", MM_PAGES, t1 - t0);
+    report_rss("read-only touch", free_before);
+
+    // write after read: copy-on-write off the zero page
+    t0 = rdtsc();
+    touch_write(b, MM_PAGES);
+    t1 = rdtsc();
+    kbench_report("pf_zero_page_cow", MM_PAGES, t1 - t0);
+    vm_release(b);
+
+    // shared frames: first write copies, the second sharer reuses in place
+    b = vm_reserve(size, VM_READ | VM_WRITE, "kbench-b");
+    if (b && vm_map_cow((uintptr_t)b, (uintptr_t)a, size) == 0) {
+        t0 = rdtsc();
+        touch_write(b, MM_PAGES);
+        t1 = rdtsc();
+        kbench_report("pf_cow_copy", MM_PAGES, t1 - t0);
+
+        t0 = rdtsc();
+        touch_write(a, MM_PAGES);
+        t1 = rdtsc();
+        kbench_report("pf_cow_reuse", MM_PAGES, t1 - t0);
+    }
+    report_rss("written", free_before);
+
+    if (b) vm_release(b);
+    vm_release(a);
+    report_rss("released", free_before);
+    pf_stats_report();
+}
+
+// ===================== SUITE =====================
+void kbench_mm_run(void) {
+    bench_faults();
+}
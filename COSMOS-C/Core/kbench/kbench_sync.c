@@ -0,0 +1,88 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "sync/atomic.h"
+#include "sync/spinlock.h"
+#include "sync/mcs.h"
+#include "sync/seqlock.h"
+#include <stdint.h>
+
+// Uncontended cost of the synchronization primitives (single CPU). The
+// numbers are the floor every locked path pays; contention behaviour is
+// measured by the host build (host/bench/bench_sync.c) with real threads.
+
+#define SYNC_ITERS 1000000
+
+static spinlock_t bench_spin = SPINLOCK_INIT("kbench_spin");
+static mcs_lock_t bench_mcs = MCS_LOCK_INIT("kbench_mcs");
+static seqlock_t bench_seq = SEQLOCK_INIT("kbench_seq");
+static uint64_t bench_counter;
+
+static void bench_spinlock(void) {
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) {
+        spin_lock(&bench_spin);
+        spin_unlock(&bench_spin);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report("spin_lock_unlock", SYNC_ITERS, t1 - t0);
+
+    t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) {
+        uint64_t flags = spin_lock_irqsave(&bench_spin);
+        spin_unlock_irqrestore(&bench_spin, flags);
+    }
+    t1 = rdtsc();
+    kbench_report("spin_lock_irqsave", SYNC_ITERS, t1 - t0);
+}
+
+static void bench_mcs_lock(void) {
+    mcs_node_t node;
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) {
+        mcs_lock(&bench_mcs, &node);
+        mcs_unlock(&bench_mcs, &node);
+    }
+    uint64_t t1 = rdtsc();
+    kbench_report("mcs_lock_unlock", SYNC_ITERS, t1 - t0);
+}
+
+static void bench_seqlock(void) {
+    uint64_t sum = 0;
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) {
+        uint32_t seq;
+        uint64_t v;
+        do {
+            seq = read_seqbegin(&bench_seq);
+            v = bench_counter;
+        } while (read_seqretry(&bench_seq, seq));
+        sum += v;
+    }
+    uint64_t t1 = rdtsc();
+    __asm__ volatile ("" : : "r"(sum));
+    kbench_report("seqlock_read", SYNC_ITERS, t1 - t0);
+
+    t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) {
+        write_seqlock(&bench_seq);
+        bench_counter++;
+        write_sequnlock(&bench_seq);
+    }
+    t1 = rdtsc();
+    kbench_report("seqlock_write", SYNC_ITERS, t1 - t0);
+}
+
+static void bench_atomics(void) {
+    uint64_t t0 = rdtsc();
+    for (int i = 0; i < SYNC_ITERS; i++) atomic_fetch_add(&bench_counter, 1, MO_RELAXED);
+    uint64_t t1 = rdtsc();
+    kbench_report("atomic_fetch_add", SYNC_ITERS, t1 - t0);
+}
+
+// ===================== SUITE =====================
+void kbench_sync_run(void) {
+    bench_spinlock();
+    bench_mcs_lock();
+    bench_seqlock();
+    bench_atomics();
+}
@@ -0,0 +1,51 @@
+#include "kbench/kbench.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include "arch/x86_64/boot/sections.h"
+#include <stdint.h>
+
+// Kernel entry/exit round trip from ring 3: SYSCALL/SYSRET vs the int 0x80
+// gate, both dispatching SYS_NOP through syscall_table. The loops run in
+// user mode and time themselves with rdtsc, the result comes back through
+// SYS_EXIT.
+
+#define SYSCALL_ITERS    1000000
+#define USER_STACK_SIZE  (4096 * 2)
+
+static uint8_t user_stack[USER_STACK_SIZE] __attribute__((aligned(16)));
+
+// ===================== RING 3 =====================
+static void user_syscall_loop(uint64_t iters) {
+    uint64_t t0 = rdtsc();
+    for (uint64_t i = 0; i < iters; i++) syscall0(SYS_NOP);
+    uint64_t t1 = rdtsc();
+    syscall1(SYS_EXIT, t1 - t0);
+    __builtin_unreachable();
+}
+
+static void user_int80_loop(uint64_t iters) {
+    uint64_t t0 = rdtsc();
+    for (uint64_t i = 0; i < iters; i++) int80_syscall0(SYS_NOP);
+    uint64_t t1 = rdtsc();
+    syscall1(SYS_EXIT, t1 - t0);
+    __builtin_unreachable();
+}
+
+// entered like a call: rsp + 8 must be 16-byte aligned
+static uint64_t run_user(void (*fn)(uint64_t), uint64_t arg) {
+    uint64_t rsp = (uint64_t)(user_stack + USER_STACK_SIZE) - 8;
+    return (uint64_t)user_enter((uint64_t)fn, rsp, arg);
+}
+
+// ===================== SUITE =====================
+void kbench_syscall_run(void) {
+    sections_user_access(1);
+
+    run_user(user_syscall_loop, 1000); // warm up
+    kbench_report("syscall_roundtrip", SYSCALL_ITERS, run_user(user_syscall_loop, SYSCALL_ITERS));
+
+    run_user(user_int80_loop, 1000);
+    kbench_report("int80_roundtrip", SYSCALL_ITERS, run_user(user_int80_loop, SYSCALL_ITERS));
+
+    sections_user_access(0);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Error numbers, returned negated (-ENOENT) by kernel calls and syscalls
+#define ENOENT           2
+#define ENOEXEC          8
+#define EBADF            9
+#define EAGAIN           11
+#define ENOMEM           12
+#define EFAULT           14
+#define EBUSY            16
+#define ENODEV           19
+#define EINVAL           22
+#define EMFILE           24
+#define ENOSPC           28
+#define ENOSYS           38
@@ -0,0 +1,30 @@
+#include "lib/sort.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Shell sort with Ciura's gaps, extended by 2.25x up to the 65536 samples
+// of a full keyboard recording
+void sort_u64(uint64_t* a, size_t n) {
+    static const size_t gaps[] = { 19930, 8858, 3937, 1750, 701, 301, 132, 57, 23, 10, 4, 1 };
+    for (size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++) {
+        size_t gap = gaps[g];
+        for (size_t i = gap; i < n; i++) {
+            uint64_t v = a[i];
+            size_t j = i;
+            for (; j >= gap && a[j - gap] > v; j -= gap) a[j] = a[j - gap];
+            a[j] = v;
+        }
+    }
+}
+
+uint64_t percentile_u64(const uint64_t* sorted, size_t n, uint32_t permille) {
+    return n ? sorted[(n - 1) * (uint64_t)permille / 1000] : 0;
+}
+
+uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
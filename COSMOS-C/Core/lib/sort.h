@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Latency samples: sort once, then read any number of percentiles.
+// In place, without recursion or allocation.
+void sort_u64(uint64_t* a, size_t n);
+
+// Value at `permille` (500 = p50, 999 = p99.9, 1000 = max) of `n` sorted
+// values, 0 for none
+uint64_t percentile_u64(const uint64_t* sorted, size_t n, uint32_t permille);
+
+// Marsaglia xorshift: benchmark inputs and synthetic key timing, nothing
+// that must be unpredictable. `*state` must start non-zero.
+uint64_t xorshift64(uint64_t* state);
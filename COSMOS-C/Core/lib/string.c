@@ -0,0 +1,74 @@
+#include "lib/string.h"
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/CPU/features.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================== MEMORY =====================
+// 8 bytes at a time, then the tail. With FSRM a single `rep movsb` is as
+// fast for every size, short copies included (patched at boot).
+void* memcpy(void* dst, const void* src, size_t n) {
+    void* ret = dst;
+    size_t count = n >> 3;
+    __asm__ volatile (ALTERNATIVE("rep movsq\n\tmovq %[tail], %%rcx\n\trep movsb",
+                                  "movq %[n], %%rcx\n\trep movsb", CPU_FEATURE_FSRM)
+                      : "+D"(dst), "+S"(src), "+c"(count)
+                      : [tail] "r"(n & 7), [n] "r"(n)
+                      : "memory");
+    return ret;
+}
+
+void* memmove(void* dst, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d == s || n == 0) return dst;
+    if (d < s || d >= s + n) return memcpy(dst, src, n);
+    // overlapping with dst above src: copy backwards (asm, so the compiler
+    // cannot turn the loop back into a call to memmove)
+    d += n - 1;
+    s += n - 1;
+    __asm__ volatile ("std; rep movsb; cld" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    return dst;
+}
+
+// Same split as memcpy with the byte spread over a qword; ERMS makes
+// `rep stosb` the fast form for the whole range.
+void* memset(void* dst, int value, size_t n) {
+    void* ret = dst;
+    size_t count = n >> 3;
+    uint64_t fill = (uint8_t)value * 0x0101010101010101ull;
+    __asm__ volatile (ALTERNATIVE("rep stosq\n\tmovq %[tail], %%rcx\n\trep stosb",
+                                  "movq %[n], %%rcx\n\trep stosb", CPU_FEATURE_ERMS)
+                      : "+D"(dst), "+c"(count)
+                      : "a"(fill), [tail] "r"(n & 7), [n] "r"(n)
+                      : "memory");
+    return ret;
+}
+
+int memcmp(const void* a, const void* b, size_t n) {
+    const uint8_t* pa = (const uint8_t*)a;
+    const uint8_t* pb = (const uint8_t*)b;
+    for (size_t i = 0; i < n; i++) {
+        if (pa[i] != pb[i]) return pa[i] - pb[i];
+    }
+    return 0;
+}
+
+// ===================== STRINGS =====================
+size_t strlen(const char* str) {
+    size_t len = 0;
+    while (str[len]) len++;
+    return len;
+}
+
+int strcmp(const char* a, const char* b) {
+    while (*a && *a == *b) { a++; b++; }
+    return (uint8_t)*a - (uint8_t)*b;
+}
+
+int strncmp(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i] || a[i] == '\0') return (uint8_t)a[i] - (uint8_t)b[i];
+    }
+    return 0;
+}
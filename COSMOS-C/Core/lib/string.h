@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Freestanding replacements for the libc memory/string routines.
+// GCC may also emit calls to memcpy/memset/memmove/memcmp on its own.
+void* memcpy(void* dst, const void* src, size_t n);
+void* memmove(void* dst, const void* src, size_t n);
+void* memset(void* dst, int value, size_t n);
+int memcmp(const void* a, const void* b, size_t n);
+size_t strlen(const char* str);
+int strcmp(const char* a, const char* b);
+int strncmp(const char* a, const char* b, size_t n);
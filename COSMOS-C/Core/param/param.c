@@ -0,0 +1,151 @@
+#include "param/param.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "Drivers/serial/serial.h"
+#include "HAL/console/print.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct param {
+    const char* name;
+    uint8_t type;                   // PARAM_UINT / PARAM_ENUM
+    uint8_t pow2;                   // UINT: round up to a power of two
+    uint32_t value;                 // the default until the command line sets it
+    uint32_t min, max;              // UINT
+    const char* const* choices;     // ENUM, NULL terminated
+};
+
+static const char* const console_choices[] = {
+    [CONSOLE_VGA]    = "vga",
+    [CONSOLE_SERIAL] = "serial",
+    [CONSOLE_FB]     = "fb",
+    NULL,
+};
+
+// Written only by param_parse() at boot, read-only after that
+static struct param params[PARAM_COUNT] = {
+    [PARAM_TIMER_HZ]      = { "timer.hz", PARAM_UINT, 0, TIMER_HZ, TIMER_HZ_MIN, TIMER_HZ_MAX, NULL },
+    [PARAM_CONSOLE]       = { "console", PARAM_ENUM, 0, CONSOLE_VGA, 0, 0, console_choices },
+    [PARAM_KBD_BUF]       = { "kbd.buf", PARAM_UINT, 1, KB_BUF_DEFAULT, 16, KB_BUF_MAX, NULL },
+    [PARAM_KBD_HISTORY]   = { "kbd.history", PARAM_UINT, 0, KB_HISTORY_DEFAULT, 1, KB_HISTORY_MAX, NULL },
+    [PARAM_KBD_BLINK]     = { "kbd.blink", PARAM_UINT, 0, KB_BLINK_DEFAULT, 1, UINT32_MAX / 2, NULL },
+    [PARAM_CALLBACKS_MAX] = { "callbacks.max", PARAM_UINT, 0, CALLBACKS_DEFAULT, 1, CALLBACKS_MAX, NULL },
+    [PARAM_KBD_RECORD]    = { "kbd.record", PARAM_UINT, 0, 0, 0, KB_RECORD_MAX, NULL },
+};
+
+uint32_t param_get(uint32_t id) {
+    return id < PARAM_COUNT ? params[id].value : 0;
+}
+
+const char* param_name(uint32_t id) {
+    return id < PARAM_COUNT ? params[id].name : "?";
+}
+
+const char* param_choice(uint32_t id) {
+    if (id >= PARAM_COUNT || params[id].type != PARAM_ENUM) return NULL;
+    return params[id].choices[params[id].value];
+}
+
+// ===================== PARSING =====================
+static inline int is_end(char c) {
+    return c == '\0' || c == ' ' || c == '\t';
+}
+
+// `s` up to a separator equals the NUL-terminated `word`
+static int word_eq(const char* s, uint32_t len, const char* word) {
+    uint32_t i = 0;
+    for (; i < len && word[i]; i++)
+        if (s[i] != word[i]) return 0;
+    return i == len && word[i] == '\0';
+}
+
+// decimal, or hex with 0x; no sign, no overflow past 32 bits
+static int parse_uint(const char* s, uint32_t* out) {
+    uint64_t v = 0;
+    uint32_t base = 10;
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) { base = 16; s += 2; }
+    if (is_end(*s)) return -EINVAL;
+    for (; !is_end(*s); s++) {
+        uint32_t d;
+        if (*s >= '0' && *s <= '9') d = (uint32_t)(*s - '0');
+        else if (base == 16 && *s >= 'a' && *s <= 'f') d = (uint32_t)(*s - 'a' + 10);
+        else if (base == 16 && *s >= 'A' && *s <= 'F') d = (uint32_t)(*s - 'A' + 10);
+        else return -EINVAL;
+        v = v * base + d;
+        if (v > UINT32_MAX) return -EINVAL;
+    }
+    *out = (uint32_t)v;
+    return 0;
+}
+
+static uint32_t round_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+int param_set(const char* key, uint32_t key_len, const char* value) {
+    struct param* p = NULL;
+    for (uint32_t i = 0; i < PARAM_COUNT; i++) {
+        if (word_eq(key, key_len, params[i].name)) { p = &params[i]; break; }
+    }
+    if (!p) return -ENOENT;
+
+    uint32_t len = 0;
+    while (!is_end(value[len])) len++;
+
+    if (p->type == PARAM_ENUM) {
+        for (uint32_t i = 0; p->choices[i]; i++) {
+            if (word_eq(value, len, p->choices[i])) { p->value = i; return 0; }
+        }
+        return -EINVAL;
+    }
+
+    uint32_t v;
+    if (parse_uint(value, &v) < 0 || v < p->min || v > p->max) return -EINVAL;
+    p->value = p->pow2 ? round_pow2(v) : v;   // max is a power of two for pow2 params
+    return 0;
+}
+
+static void write_token(const char* s) {
+    while (!is_end(*s)) serial_putc(*s++);
+}
+
+__init void param_parse(const char* cmdline) {
+    const char* s = cmdline;
+    while (s && *s) {
+        while (*s == ' ' || *s == '\t') s++;
+        if (!*s) break;
+
+        const char* token = s;
+        const char* eq = NULL;
+        while (!is_end(*s)) {
+            if (*s == '=' && !eq) eq = s;
+            s++;
+        }
+        if (!eq) continue;
+
+        int err = param_set(token, (uint32_t)(eq - token), eq + 1);
+        if (err == 0) continue;
+        serial_write("[PARAM] ");
+        write_token(token);
+        serial_write(err == -ENOENT ? ": unknown, ignored\n" : ": bad value, default kept\n");
+    }
+    param_report();
+}
+
+// ===================== REPORT =====================
+void param_report(void) {
+    serial_write("[PARAM]");
+    for (uint32_t i = 0; i < PARAM_COUNT; i++) {
+        serial_putc(' ');
+        serial_write(params[i].name);
+        serial_putc('=');
+        if (params[i].type == PARAM_ENUM) serial_write(param_choice(i));
+        else serial_write_dec(params[i].value);
+    }
+    serial_putc('\n');
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+// Boot parameters from the kernel command line, e.g. in grub.cfg
+//
+//   multiboot2 /boot/kernel.bin timer.hz=250 console=serial kbd.buf=1024
+//
+// Every parameter is declared once in param.c with its type, default and
+// limits. param_parse() runs right after multiboot2_init(); the modules read
+// their value when they initialize, so one image can be tuned per VM.
+// Without a command line (and on the host build) the defaults hold.
+
+#define PARAM_TIMER_HZ        0   // tick rate (TIMER_HZ)
+#define PARAM_CONSOLE         1   // console backend, CONSOLE_* (print.h)
+#define PARAM_KBD_BUF         2   // key ring slots, rounded up to a power of two
+#define PARAM_KBD_HISTORY     3   // line editor history entries
+#define PARAM_KBD_BLINK       4   // idle kb_update() polls per cursor blink
+#define PARAM_CALLBACKS_MAX   5   // set_timeout() slots
+#define PARAM_KBD_RECORD      6   // scancodes to record from boot, 0 = off
+#define PARAM_COUNT           7
+
+#define PARAM_UINT            0   // decimal or 0x hex, min..max
+#define PARAM_ENUM            1   // one of the names in `choices`, value = index
+
+// Splits `cmdline` at spaces into key=value pairs and sets the known keys.
+// Unknown keys, bad values and values out of range are logged and leave the
+// default in place. Tokens without '=' (the kernel path) are skipped.
+// Boot only, before the modules that read the parameters initialize.
+void param_parse(const char* cmdline);
+
+// Sets the parameter named by the first `key_len` bytes of `key`; `value`
+// ends at the first space or NUL. 0, -ENOENT for an unknown key, -EINVAL for
+// a value that doesn't parse or is out of range.
+int param_set(const char* key, uint32_t key_len, const char* value);
+
+// Current value. One load: fine on hot paths.
+uint32_t param_get(uint32_t id);
+const char* param_name(uint32_t id);
+// the ENUM choice name of the current value, NULL for UINT
+const char* param_choice(uint32_t id);
+
+// "[PARAM] timer.hz=1000 console=vga ..." on COM1
+void param_report(void);
@@ -0,0 +1,74 @@
+#include "prof/ksyms.h"
+#include "arch/x86_64/boot/sections.h"
+#include "Drivers/serial/serial.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// generated by scripts/mksyms.sh (build/ksyms.asm)
+extern const uint64_t ksyms_count;
+extern const uint64_t ksyms_addrs[];
+extern const uint32_t ksyms_name_offs[];
+extern const uint16_t ksyms_file_of[];     // UINT16_MAX: unknown
+extern const uint64_t ksyms_file_count;
+extern const uint32_t ksyms_file_offs[];
+extern const char ksyms_names[];           // symbol names, then file names
+
+uint32_t ksym_count(void) {
+    return (uint32_t)ksyms_count;
+}
+
+// Last symbol at or below addr. .boot and the data sections are left out:
+// there is nothing to attribute there, and the symbols before them would
+// claim the whole gap.
+uint32_t ksym_index(uint64_t addr) {
+    if (addr < (uint64_t)__init_start || addr >= (uint64_t)__text_end) return KSYM_NONE;
+    if (ksyms_count == 0 || addr < ksyms_addrs[0]) return KSYM_NONE;
+
+    uint32_t lo = 0, hi = (uint32_t)ksyms_count;   // ksyms_addrs[lo] <= addr < ksyms_addrs[hi]
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (ksyms_addrs[mid] <= addr) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+const char* ksym_name(uint32_t index) {
+    return ksyms_names + ksyms_name_offs[index];
+}
+
+uint64_t ksym_addr(uint32_t index) {
+    return ksyms_addrs[index];
+}
+
+const char* ksym_file(uint32_t index) {
+    uint16_t file = ksyms_file_of[index];
+    if (file >= ksyms_file_count) return NULL;
+    return ksyms_names + ksyms_file_offs[file];
+}
+
+const char* ksym_lookup(uint64_t addr, uint64_t* offset) {
+    uint32_t i = ksym_index(addr);
+    if (i == KSYM_NONE) return NULL;
+    if (offset) *offset = addr - ksyms_addrs[i];
+    return ksym_name(i);
+}
+
+void ksym_write(uint64_t addr) {
+    static const char digits[] = "0123456789abcdef";
+    uint64_t offset;
+    const char* name = ksym_lookup(addr, &offset);
+    if (!name) {
+        serial_write_hex(addr);
+        return;
+    }
+    char hex[17];
+    int n = 0;
+    do {
+        hex[n++] = digits[offset & 0xF];
+        offset >>= 4;
+    } while (offset);
+    serial_write(name);
+    serial_write("+0x");
+    while (n) serial_putc(hex[--n]);
+}
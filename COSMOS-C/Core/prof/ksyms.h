@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+// Kernel symbol table, embedded at link time: build-x86_64 links the kernel
+// once with an empty table, runs scripts/mksyms.sh on the result and links
+// again. Only .rodata grows, so no function moves between the two passes.
+//
+// Function start addresses sorted ascending; a symbol ends where the next
+// one starts. With the link map each function also knows its source file
+// (lost in LTO links, where objects are merged).
+
+#define KSYM_NONE  UINT32_MAX
+
+uint32_t ksym_count(void);
+
+// Index of the function containing `addr`, KSYM_NONE outside the kernel text
+uint32_t ksym_index(uint64_t addr);
+const char* ksym_name(uint32_t index);
+uint64_t ksym_addr(uint32_t index);
+
+// Source path below COSMOS-C/ ("HAL/console/print.c", "src/main.c"), NULL
+// when unknown
+const char* ksym_file(uint32_t index);
+
+// Name of the function containing `addr` and the offset into it, NULL
+// outside the kernel text
+const char* ksym_lookup(uint64_t addr, uint64_t* offset);
+
+// Writes `name+0xoff` to COM1, the bare address outside the kernel text.
+// No locks: usable from NMI and panic paths.
+void ksym_write(uint64_t addr);
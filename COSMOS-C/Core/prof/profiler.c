@@ -0,0 +1,249 @@
+#include "prof/profiler.h"
+#include "prof/ksyms.h"
+#include "Core/arch/x86_64/TIMER/clocksource.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "arch/x86_64/IRQ/isr.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/stack.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "lib/errno.h"
+#include "lib/string.h"
+#include "sync/atomic.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROF_RING_MASK   (PROF_RING_WORDS - 1)
+#define PROF_STACK_SPAN  (16 * 1024)   // kernel stacks (main.asm, syscall.c)
+
+// Samples are variable length: a header word, then `depth` pcs leaf first
+#define PROF_HDR_DEPTH   0xFFu
+#define PROF_HDR_USER    (1u << 8)     // interrupted in ring 3, pc is a user rip
+
+struct prof_ring {
+    uint64_t head;        // words written, only by the sampling interrupt
+    uint64_t tail;        // words consumed, only by profiler_report()
+    uint64_t samples;
+    uint64_t dropped;     // ring full
+    uint64_t words[PROF_RING_WORDS];
+};
+
+static struct clockevent* prof_event;
+static const char* prof_event_name = "none";
+static uint32_t prof_hz;
+static int prof_callchain;
+
+// ===================== SAMPLING =====================
+// Follows the saved rbp links of the interrupted code. Each link has to stay
+// on the interrupted stack and move towards its top, so a clobbered rbp
+// (code built without frame pointers) ends the walk instead of faulting.
+static uint32_t walk_frames(const struct interrupt_frame* frame, uint64_t* pc, uint32_t depth) {
+    uint64_t lo = frame->rsp;
+    const struct kstack* s = stack_find(lo);
+    uint64_t hi = s ? s->top : lo + PROF_STACK_SPAN;
+    if (!s && hi > IDENTITY_END) hi = IDENTITY_END;     // boot stack
+    uint64_t fp = frame->rbp;
+
+    while (depth < PROF_MAX_DEPTH) {
+        if (fp < lo || fp + 16 > hi || (fp & 7)) break;
+        const uint64_t* link = (const uint64_t*)fp;   // [0] caller rbp, [1] return address
+        if (ksym_index(link[1] - 1) == KSYM_NONE) break;
+        pc[depth++] = link[1];
+        lo = fp + 16;
+        fp = link[0];
+    }
+    return depth;
+}
+
+// clockevent handler, in interrupt context on the sampled CPU
+static void profiler_tick(void) {
+    struct interrupt_frame* frame = irq_frame();
+    struct prof_ring* ring = this_cpu()->prof_ring;
+    if (!frame || !ring) return;
+
+    uint64_t pc[PROF_MAX_DEPTH];
+    uint32_t depth = 0;
+    uint32_t user = (frame->cs & 3) ? PROF_HDR_USER : 0;
+    pc[depth++] = frame->rip;
+    if (prof_callchain && !user) depth = walk_frames(frame, pc, depth);
+
+    uint64_t head = ring->head;
+    if (head + 1 + depth - atomic_read(&ring->tail, MO_ACQUIRE) > PROF_RING_WORDS) {
+        ring->dropped++;
+        return;
+    }
+    ring->words[head++ & PROF_RING_MASK] = depth | user;
+    for (uint32_t i = 0; i < depth; i++) ring->words[head++ & PROF_RING_MASK] = pc[i];
+    ring->samples++;
+    atomic_write(&ring->head, head, MO_RELEASE);
+}
+
+// ===================== CONTROL =====================
+int profiler_start(uint32_t hz, int callchain) {
+    struct percpu* cpu = this_cpu();
+    if (prof_event) return -EBUSY;
+
+    if (!cpu->prof_ring) {
+        struct prof_ring* ring = vm_reserve(sizeof(*ring), VM_READ | VM_WRITE, "prof ring");
+        if (!ring) return -ENOMEM;
+        // backed now: a demand fault in the sampling interrupt would need vm_lock
+        memset(ring, 0, sizeof(*ring));
+        cpu->prof_ring = ring;
+    }
+
+    prof_callchain = callchain;
+    prof_event = clockevent_claim(hz, profiler_tick);
+    if (!prof_event) return -ENODEV;
+    prof_event_name = prof_event->name;
+    prof_hz = hz;
+    return 0;
+}
+
+void profiler_stop(void) {
+    if (!prof_event) return;
+    clockevent_release(prof_event);
+    prof_event = NULL;
+}
+
+// ===================== REPORT =====================
+// After symbolization every pc word holds a symbol index, plus these two
+#define SYM_UNKNOWN(nsyms)  (nsyms)
+#define SYM_USER(nsyms)     ((nsyms) + 1)
+
+static inline uint64_t ring_word(const struct prof_ring* ring, uint64_t pos) {
+    return ring->words[pos & PROF_RING_MASK];
+}
+
+static const char* sym_label(uint64_t sym, uint32_t nsyms) {
+    if (sym < nsyms) return ksym_name((uint32_t)sym);
+    return sym == SYM_USER(nsyms) ? "[user]" : "[unknown]";
+}
+
+// Orders stacks root first, so equal stacks end up next to each other
+static int stack_cmp(const struct prof_ring* ring, uint64_t a, uint64_t b) {
+    uint32_t da = ring_word(ring, a) & PROF_HDR_DEPTH;
+    uint32_t db = ring_word(ring, b) & PROF_HDR_DEPTH;
+    for (uint32_t k = 0; k < da && k < db; k++) {
+        uint64_t fa = ring_word(ring, a + da - k);
+        uint64_t fb = ring_word(ring, b + db - k);
+        if (fa != fb) return fa < fb ? -1 : 1;
+    }
+    return (int)da - (int)db;
+}
+
+static void sort_stacks(const struct prof_ring* ring, uint32_t* order, uint32_t n) {
+    // Shell sort (Ciura gaps, extended by 2.25x): no recursion, no scratch
+    static const uint32_t gaps[] = { 44842, 19930, 8858, 3937, 1750, 701, 301, 132, 57, 23, 10, 4, 1 };
+    for (size_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++) {
+        uint32_t gap = gaps[g];
+        for (uint32_t i = gap; i < n; i++) {
+            uint32_t v = order[i];
+            uint32_t j = i;
+            while (j >= gap && stack_cmp(ring, order[j - gap], v) > 0) {
+                order[j] = order[j - gap];
+                j -= gap;
+            }
+            order[j] = v;
+        }
+    }
+}
+
+static void report_flat(uint32_t* self, uint32_t nsyms, uint64_t total) {
+    for (int line = 0; line < PROF_FLAT_TOP; line++) {
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < nsyms + 2; i++)
+            if (self[i] > self[best]) best = i;
+        if (self[best] == 0) break;
+
+        uint64_t centi = (uint64_t)self[best] * 10000 / total;
+        serial_write("PROF flat ");
+        serial_write_dec(self[best]);
+        serial_putc(' ');
+        serial_write_dec(centi / 100);
+        serial_putc('.');
+        serial_putc('0' + (centi / 10) % 10);
+        serial_putc('0' + centi % 10);
+        serial_putc(' ');
+        serial_write(sym_label(best, nsyms));
+        serial_putc('\n');
+        self[best] = 0;
+    }
+}
+
+static void report_stacks(const struct prof_ring* ring, const uint32_t* order, uint32_t n) {
+    uint32_t nsyms = ksym_count();
+    for (uint32_t i = 0; i < n;) {
+        uint32_t run = 1;
+        while (i + run < n && stack_cmp(ring, order[i], order[i + run]) == 0) run++;
+
+        uint64_t pos = order[i];
+        uint32_t depth = ring_word(ring, pos) & PROF_HDR_DEPTH;
+        serial_write("PROF stack ");
+        for (uint32_t k = depth; k > 0; k--) {
+            serial_write(sym_label(ring_word(ring, pos + k), nsyms));
+            if (k > 1) serial_putc(';');
+        }
+        serial_putc(' ');
+        serial_write_dec(run);
+        serial_putc('\n');
+        i += run;
+    }
+}
+
+void profiler_report(void) {
+    profiler_stop();
+    struct prof_ring* ring = this_cpu()->prof_ring;
+    if (!ring) return;
+
+    uint64_t head = atomic_read(&ring->head, MO_ACQUIRE);
+    uint32_t nsyms = ksym_count();
+    uint64_t n = ring->samples;
+    uint32_t* self = vm_reserve((nsyms + 2) * sizeof(uint32_t), VM_READ | VM_WRITE, "prof self");
+    uint32_t* order = vm_reserve((n ? n : 1) * sizeof(uint32_t), VM_READ | VM_WRITE, "prof stacks");
+
+    serial_write("PROF begin hz=");
+    serial_write_dec(prof_hz);
+    serial_write(" event=");
+    serial_write(prof_event_name);
+    serial_write(" samples=");
+    serial_write_dec(n);
+    serial_write(" dropped=");
+    serial_write_dec(ring->dropped);
+    serial_write(" callchain=");
+    serial_write_dec(prof_callchain);
+    serial_putc('\n');
+
+    if (self && order && n) {
+        // symbolize in place; return addresses point after the call, so
+        // look up pc - 1 to stay inside the caller
+        uint32_t count = 0;
+        for (uint64_t pos = ring->tail; pos != head && count < n; count++) {
+            uint64_t hdr = ring_word(ring, pos);
+            uint32_t depth = hdr & PROF_HDR_DEPTH;
+            order[count] = (uint32_t)(pos & PROF_RING_MASK);
+            for (uint32_t k = 0; k < depth; k++) {
+                uint64_t* w = &ring->words[(pos + 1 + k) & PROF_RING_MASK];
+                uint32_t sym = SYM_USER(nsyms);
+                if (!(hdr & PROF_HDR_USER)) {
+                    sym = ksym_index(k ? *w - 1 : *w);
+                    if (sym == KSYM_NONE) sym = SYM_UNKNOWN(nsyms);
+                }
+                *w = sym;
+            }
+            self[ring_word(ring, pos + 1)]++;
+            pos += 1 + depth;
+        }
+
+        report_flat(self, nsyms, count);
+        sort_stacks(ring, order, count);
+        report_stacks(ring, order, count);
+    }
+    serial_write("PROF end\n");
+
+    atomic_write(&ring->tail, head, MO_RELEASE);
+    ring->samples = 0;
+    ring->dropped = 0;
+    if (self) vm_release(self);
+    if (order) vm_release(order);
+}
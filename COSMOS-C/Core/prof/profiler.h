@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+
+// Statistical sampling profiler. A second clockevent next to the tick (HPET
+// or PIT when the LAPIC timer ticks, see clockevent_claim()) interrupts at
+// its own rate; each expiry records the interrupted rip and, optionally,
+// the frame-pointer call chain into a per-CPU ring. profiler_report()
+// symbolizes the samples with the embedded table (ksyms.h) and writes them
+// to COM1:
+//
+//   PROF begin hz=997 event=hpet samples=9970 dropped=0 callchain=1
+//   PROF flat <samples> <percent> <function>     self time, hottest first
+//   PROF stack <root>;...;<leaf> <samples>       folded stacks
+//   PROF end
+//
+// The stack lines are flamegraph.pl / speedscope input as they are
+// (scripts/prof-extract.sh). Call chains need frame pointers, i.e. the
+// kernel built with PROFILE=profile.
+
+#define PROF_RING_WORDS  (256 * 1024)   // per CPU, 2 MiB, power of two
+#define PROF_MAX_DEPTH   16             // frames per sample, rip included
+#define PROF_FLAT_TOP    40             // flat profile lines
+
+// Allocates the ring and starts sampling at `hz`; 0, -ENODEV without a
+// free clockevent, -ENOMEM, -EBUSY when already running
+int profiler_start(uint32_t hz, int callchain);
+void profiler_stop(void);
+
+// Stops sampling and writes the profile, consuming the samples
+void profiler_report(void);
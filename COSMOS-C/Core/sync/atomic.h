@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+
+// Atomic operations with the memory order spelled out at every call site.
+// Thin wrappers over the GCC __atomic builtins; `p` points to a naturally
+// aligned 1/2/4/8-byte integer or pointer.
+
+// ===================== MEMORY ORDER =====================
+#define MO_RELAXED  __ATOMIC_RELAXED
+#define MO_ACQUIRE  __ATOMIC_ACQUIRE
+#define MO_RELEASE  __ATOMIC_RELEASE
+#define MO_ACQ_REL  __ATOMIC_ACQ_REL
+#define MO_SEQ_CST  __ATOMIC_SEQ_CST
+
+// ===================== LOAD / STORE =====================
+#define atomic_read(p, mo)            __atomic_load_n((p), (mo))
+#define atomic_write(p, v, mo)        __atomic_store_n((p), (v), (mo))
+
+// ===================== READ-MODIFY-WRITE =====================
+// fetch_* return the old value, *_fetch the new one
+#define atomic_fetch_add(p, v, mo)    __atomic_fetch_add((p), (v), (mo))
+#define atomic_fetch_sub(p, v, mo)    __atomic_fetch_sub((p), (v), (mo))
+#define atomic_fetch_or(p, v, mo)     __atomic_fetch_or((p), (v), (mo))
+#define atomic_fetch_and(p, v, mo)    __atomic_fetch_and((p), (v), (mo))
+#define atomic_add_fetch(p, v, mo)    __atomic_add_fetch((p), (v), (mo))
+#define atomic_sub_fetch(p, v, mo)    __atomic_sub_fetch((p), (v), (mo))
+#define atomic_xchg(p, v, mo)         __atomic_exchange_n((p), (v), (mo))
+
+// Strong compare-and-swap. On failure *expected is updated to the current
+// value and the load uses MO_RELAXED.
+#define atomic_cmpxchg(p, expected, desired, mo) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 0, (mo), MO_RELAXED)
+
+// ===================== FENCES =====================
+#define atomic_fence(mo)              __atomic_thread_fence(mo)
+// orders against interrupt handlers on the same CPU, emits no instruction
+#define compiler_barrier()            __atomic_signal_fence(MO_SEQ_CST)
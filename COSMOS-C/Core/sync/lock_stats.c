@@ -0,0 +1,65 @@
+#include "sync/lock_stats.h"
+
+#ifdef LOCK_STATS
+#include "sync/atomic.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "Drivers/serial/serial.h"
+#include <stdint.h>
+
+static struct lock_stats* stats_list;
+
+// Locks register themselves on first use, so nothing has to be declared
+// up front. Called with the lock held.
+static void lock_stats_register(struct lock_stats* s) {
+    if (atomic_xchg(&s->registered, 1, MO_RELAXED)) return;
+    struct lock_stats* head = atomic_read(&stats_list, MO_RELAXED);
+    do {
+        s->next = head;
+    } while (!atomic_cmpxchg(&stats_list, &head, s, MO_RELEASE));
+}
+
+// ===================== RECORDING =====================
+// Only the lock holder writes the counters, so plain updates are enough
+void lock_stats_acquired(struct lock_stats* s, uint64_t wait_start, int contended) {
+    uint64_t now = rdtsc();
+    uint64_t wait = now - wait_start;
+
+    if (!s->registered) lock_stats_register(s);
+    s->acquired++;
+    if (contended) {
+        s->contended++;
+        s->wait_cycles += wait;
+        if (wait > s->wait_max) s->wait_max = wait;
+    }
+    s->hold_start = now;
+}
+
+void lock_stats_released(struct lock_stats* s) {
+    uint64_t hold = rdtsc() - s->hold_start;
+    s->hold_cycles += hold;
+    if (hold > s->hold_max) s->hold_max = hold;
+}
+
+// ===================== REPORT =====================
+// One line per lock on COM1:
+//   LOCKSTAT name=<n> acquired=<n> contended=<n> wait_avg=<c> wait_max=<c> hold_avg=<c> hold_max=<c>
+void lock_stats_report(void) {
+    for (struct lock_stats* s = atomic_read(&stats_list, MO_ACQUIRE); s; s = s->next) {
+        serial_write("LOCKSTAT name=");
+        serial_write(s->name ? s->name : "?");
+        serial_write(" acquired=");
+        serial_write_dec(s->acquired);
+        serial_write(" contended=");
+        serial_write_dec(s->contended);
+        serial_write(" wait_avg=");
+        serial_write_dec(s->contended ? s->wait_cycles / s->contended : 0);
+        serial_write(" wait_max=");
+        serial_write_dec(s->wait_max);
+        serial_write(" hold_avg=");
+        serial_write_dec(s->acquired ? s->hold_cycles / s->acquired : 0);
+        serial_write(" hold_max=");
+        serial_write_dec(s->hold_max);
+        serial_write("\n");
+    }
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+// Optional per-lock contention statistics, compiled in with -DLOCK_STATS
+// (`make LOCK_STATS=1`). Times are TSC cycles.
+
+#ifdef LOCK_STATS
+struct lock_stats {
+    const char* name;
+    uint64_t acquired;      // successful acquisitions
+    uint64_t contended;     // acquisitions that had to wait
+    uint64_t wait_cycles;   // total / worst time spent waiting
+    uint64_t wait_max;
+    uint64_t hold_cycles;   // total / worst time between lock and unlock
+    uint64_t hold_max;
+    uint64_t hold_start;
+    struct lock_stats* next; // registration list for lock_stats_report()
+    uint32_t registered;
+};
+
+#define LOCK_STATS_INIT(n) .stats = { .name = (n) },
+
+void lock_stats_acquired(struct lock_stats* s, uint64_t wait_start, int contended);
+void lock_stats_released(struct lock_stats* s);
+void lock_stats_report(void);
+#else
+#define LOCK_STATS_INIT(n)
+#endif
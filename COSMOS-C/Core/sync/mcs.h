@@ -0,0 +1,76 @@
+#pragma once
+#include "sync/atomic.h"
+#include "sync/lock_stats.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#ifdef LOCK_STATS
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+// MCS queue lock: every waiter spins on its own node instead of the shared
+// lock word, so a contended handoff costs one cache line transfer no matter
+// how many CPUs wait. The caller provides the node (usually on its stack)
+// and passes the same node to unlock.
+//
+//   mcs_node_t node;
+//   mcs_lock(&lock, &node);
+//   ...
+//   mcs_unlock(&lock, &node);
+
+typedef struct mcs_node {
+    struct mcs_node* next;
+    uint32_t locked;
+} __attribute__((aligned(64))) mcs_node_t;
+
+typedef struct {
+    mcs_node_t* tail;
+#ifdef LOCK_STATS
+    struct lock_stats stats;
+#endif
+} mcs_lock_t;
+
+#define MCS_LOCK_INIT(n) { .tail = NULL, LOCK_STATS_INIT(n) }
+
+// ===================== LOCK / UNLOCK =====================
+static inline void mcs_lock(mcs_lock_t* l, mcs_node_t* node) {
+    node->next = NULL;
+    node->locked = 1;
+#ifdef LOCK_STATS
+    uint64_t t0 = rdtsc();
+#endif
+    mcs_node_t* prev = atomic_xchg(&l->tail, node, MO_ACQ_REL);
+    if (prev) {
+        atomic_write(&prev->next, node, MO_RELEASE);
+        while (atomic_read(&node->locked, MO_ACQUIRE)) cpu_relax();
+    }
+#ifdef LOCK_STATS
+    lock_stats_acquired(&l->stats, t0, prev != NULL);
+#endif
+}
+
+static inline void mcs_unlock(mcs_lock_t* l, mcs_node_t* node) {
+#ifdef LOCK_STATS
+    lock_stats_released(&l->stats);
+#endif
+    mcs_node_t* next = atomic_read(&node->next, MO_ACQUIRE);
+    if (!next) {
+        mcs_node_t* expected = node;
+        if (atomic_cmpxchg(&l->tail, &expected, NULL, MO_RELEASE)) return;
+        // a waiter swapped itself in but has not linked up yet
+        while (!(next = atomic_read(&node->next, MO_ACQUIRE))) cpu_relax();
+    }
+    atomic_write(&next->locked, 0, MO_RELEASE);
+}
+
+// ===================== IRQ SAFE =====================
+static inline uint64_t mcs_lock_irqsave(mcs_lock_t* l, mcs_node_t* node) {
+    uint64_t flags = cpu_irq_save();
+    mcs_lock(l, node);
+    return flags;
+}
+
+static inline void mcs_unlock_irqrestore(mcs_lock_t* l, mcs_node_t* node, uint64_t flags) {
+    mcs_unlock(l, node);
+    cpu_irq_restore(flags);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "sync/atomic.h"
+#include "sync/spinlock.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#include <stdint.h>
+
+// Sequence lock for small read-mostly data (clock state): readers never
+// block or write shared memory, they retry if a writer ran meanwhile.
+//
+//   uint32_t seq;
+//   do {
+//       seq = read_seqbegin(&lock);
+//       copy = data;
+//   } while (read_seqretry(&lock, seq));
+//
+// Readers must not follow pointers read inside the section, the data can be
+// half updated until read_seqretry() says otherwise.
+
+typedef struct {
+    uint32_t seq;       // odd while a write is in progress
+    spinlock_t lock;    // serializes writers
+} seqlock_t;
+
+#define SEQLOCK_INIT(n) { .seq = 0, .lock = SPINLOCK_INIT(n) }
+
+// ===================== READERS =====================
+static inline uint32_t read_seqbegin(const seqlock_t* s) {
+    uint32_t seq;
+    while ((seq = atomic_read(&s->seq, MO_ACQUIRE)) & 1) cpu_relax();
+    return seq;
+}
+
+static inline int read_seqretry(const seqlock_t* s, uint32_t seq) {
+    atomic_fence(MO_ACQUIRE); // data loads complete before the re-check
+    return atomic_read(&s->seq, MO_RELAXED) != seq;
+}
+
+// ===================== WRITERS =====================
+// An interrupt handler that reads while its own CPU is halfway through a
+// write spins forever in read_seqbegin(). If readers run in IRQ context,
+// writers outside of it use the _irqsave variant.
+static inline void write_seqlock(seqlock_t* s) {
+    spin_lock(&s->lock);
+    atomic_write(&s->seq, s->seq + 1, MO_RELAXED);
+    atomic_fence(MO_RELEASE); // odd count visible before the data stores
+}
+
+static inline void write_sequnlock(seqlock_t* s) {
+    atomic_write(&s->seq, s->seq + 1, MO_RELEASE);
+    spin_unlock(&s->lock);
+}
+
+static inline uint64_t write_seqlock_irqsave(seqlock_t* s) {
+    uint64_t flags = cpu_irq_save();
+    write_seqlock(s);
+    return flags;
+}
+
+static inline void write_sequnlock_irqrestore(seqlock_t* s, uint64_t flags) {
+    write_sequnlock(s);
+    cpu_irq_restore(flags);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "sync/atomic.h"
+#include "sync/lock_stats.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#ifdef LOCK_STATS
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#endif
+#include <stdint.h>
+
+// Ticket spinlock: FIFO, one cache line, fine for short critical sections.
+// Data that an interrupt handler also touches must be locked with the
+// _irqsave variants outside IRQ context, otherwise the handler spins
+// forever on a lock its own CPU holds.
+
+typedef struct {
+    union {
+        uint32_t val;
+        struct {
+            uint16_t owner;  // ticket being served
+            uint16_t next;   // ticket for the next locker
+        };
+    };
+#ifdef LOCK_STATS
+    struct lock_stats stats;
+#endif
+} spinlock_t;
+
+#define SPINLOCK_INIT(n) { .val = 0, LOCK_STATS_INIT(n) }
+
+static inline void spin_lock_init(spinlock_t* l) {
+    atomic_write(&l->val, 0, MO_RELAXED);
+}
+
+// ===================== LOCK / UNLOCK =====================
+static inline void spin_lock(spinlock_t* l) {
+    uint16_t ticket = atomic_fetch_add(&l->next, 1, MO_RELAXED);
+#ifdef LOCK_STATS
+    uint64_t t0 = rdtsc();
+    int contended = atomic_read(&l->owner, MO_RELAXED) != ticket;
+#endif
+    while (atomic_read(&l->owner, MO_ACQUIRE) != ticket) cpu_relax();
+#ifdef LOCK_STATS
+    lock_stats_acquired(&l->stats, t0, contended);
+#endif
+}
+
+// Takes the lock only if nobody holds or waits for it
+static inline int spin_trylock(spinlock_t* l) {
+    uint32_t old = atomic_read(&l->val, MO_RELAXED);
+    if ((old & 0xFFFF) != (old >> 16)) return 0;
+    if (!atomic_cmpxchg(&l->val, &old, old + 0x10000, MO_ACQUIRE)) return 0;
+#ifdef LOCK_STATS
+    lock_stats_acquired(&l->stats, rdtsc(), 0);
+#endif
+    return 1;
+}
+
+static inline void spin_unlock(spinlock_t* l) {
+#ifdef LOCK_STATS
+    lock_stats_released(&l->stats);
+#endif
+    // only the holder writes owner
+    atomic_write(&l->owner, (uint16_t)(l->owner + 1), MO_RELEASE);
+}
+
+static inline int spin_is_locked(spinlock_t* l) {
+    uint32_t v = atomic_read(&l->val, MO_RELAXED);
+    return (v & 0xFFFF) != (v >> 16);
+}
+
+// ===================== IRQ SAFE =====================
+static inline uint64_t spin_lock_irqsave(spinlock_t* l) {
+    uint64_t flags = cpu_irq_save();
+    spin_lock(l);
+    return flags;
+}
+
+static inline void spin_unlock_irqrestore(spinlock_t* l, uint64_t flags) {
+    spin_unlock(l);
+    cpu_irq_restore(flags);
+}
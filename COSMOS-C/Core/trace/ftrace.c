@@ -0,0 +1,267 @@
+#include "trace/ftrace.h"
+#include "prof/ksyms.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/boot/sections.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "sync/atomic.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// This file is built without -pg (Makefile): nothing here is traced, so
+// ftrace_entry() can't recurse.
+
+#define FTRACE_RING_MASK  (FTRACE_RING_EVENTS - 1)
+#define INSN_SIZE         5
+#define INSN_CALL         0xE8
+
+// nopl 0x0(%rax,%rax,1), emitted by -mnop-mcount
+static const uint8_t insn_nop[INSN_SIZE] = { 0x0F, 0x1F, 0x44, 0x00, 0x00 };
+
+// targets/x86_64/linker.ld: call site addresses from -mrecord-mcount
+extern const uint64_t __mcount_loc_start[], __mcount_loc_end[];
+extern void __fentry__(void);
+
+struct ftrace_event {
+    uint64_t tsc;
+    uint64_t ip;            // call site, the function start
+    uint64_t parent_ip;     // return address into the caller
+};
+
+struct ftrace_ring {
+    uint64_t head;          // events written, only by this CPU; wraps and overwrites
+    struct ftrace_event events[FTRACE_RING_EVENTS];
+};
+
+static uint32_t site_count;
+static uint32_t enabled_count;
+
+// ===================== RECORDING =====================
+// One non-locked xadd: atomic against interrupts on this CPU, and no other
+// CPU writes this ring, so no lock prefix and no cli
+static inline uint64_t ring_reserve(struct ftrace_ring* ring) {
+    uint64_t slot = 1;
+    __asm__ volatile ("xaddq %0, %1" : "+r"(slot), "+m"(ring->head) : : "memory");
+    return slot;
+}
+
+__hot void ftrace_entry(uint64_t ip, uint64_t parent_ip) {
+    struct ftrace_ring* ring = this_cpu()->ftrace_ring;
+    if (!ring) return;
+    struct ftrace_event* e = &ring->events[ring_reserve(ring) & FTRACE_RING_MASK];
+    e->tsc = rdtsc();
+    e->ip = ip;
+    e->parent_ip = parent_ip;
+}
+
+// ===================== PATCHING =====================
+static uint64_t call_target(const uint8_t* site) {
+    int32_t rel = (int32_t)((uint32_t)site[1] | (uint32_t)site[2] << 8 |
+                            (uint32_t)site[3] << 16 | (uint32_t)site[4] << 24);
+    return (uint64_t)site + INSN_SIZE + (int64_t)rel;
+}
+
+// 1 enabled, 0 disabled, -1 not a site we patch (outside .text or some
+// other instruction)
+static int site_state(uint64_t addr) {
+    if (addr < (uint64_t)__text_start || addr + INSN_SIZE > (uint64_t)__text_end) return -1;
+    const uint8_t* site = (const uint8_t*)addr;
+    if (site[0] == INSN_CALL && call_target(site) == (uint64_t)__fentry__) return 1;
+    return memcmp(site, insn_nop, INSN_SIZE) == 0 ? 0 : -1;
+}
+
+// .text is read-only after sections_protect(): write with CR0.WP off and
+// interrupts off, so nothing runs the half-written instruction. There is
+// one CPU and it notices stores to its own code, no cross-modifying sync.
+static void text_poke(uint64_t addr, const uint8_t insn[INSN_SIZE]) {
+    volatile uint8_t* site = (volatile uint8_t*)addr;
+    uint64_t flags = cpu_irq_save();
+    uint64_t cr0 = cpu_read_cr0();
+    cpu_write_cr0(cr0 & ~CR0_WP);
+    for (int i = 0; i < INSN_SIZE; i++) site[i] = insn[i];
+    cpu_write_cr0(cr0);
+    cpu_irq_restore(flags);
+}
+
+static void site_set(uint64_t addr, int enable) {
+    if (!enable) {
+        text_poke(addr, insn_nop);
+        return;
+    }
+    uint32_t rel = (uint32_t)((uint64_t)__fentry__ - (addr + INSN_SIZE));
+    uint8_t call[INSN_SIZE] = { INSN_CALL, rel & 0xFF, (rel >> 8) & 0xFF, (rel >> 16) & 0xFF, rel >> 24 };
+    text_poke(addr, call);
+}
+
+// ===================== FILTERS =====================
+// `*` and `?` over [p, pend)
+static int glob_match(const char* p, const char* pend, const char* s) {
+    const char* star = NULL;
+    const char* retry = NULL;
+    while (*s) {
+        if (p < pend && (*p == '?' || *p == *s)) {
+            p++;
+            s++;
+        } else if (p < pend && *p == '*') {
+            star = p++;
+            retry = s;
+        } else if (star) {
+            p = star + 1;
+            s = ++retry;
+        } else {
+            return 0;
+        }
+    }
+    while (p < pend && *p == '*') p++;
+    return p == pend;
+}
+
+// whole path or any tail after a '/': "Drivers/PS2/*" matches
+// "HAL/Drivers/PS2/keyboard/ps2.c"
+static int file_match(const char* p, const char* pend, const char* path) {
+    if (!path) return 0;
+    if (glob_match(p, pend, path)) return 1;
+    for (const char* s = path; *s; s++)
+        if (*s == '/' && glob_match(p, pend, s + 1)) return 1;
+    return 0;
+}
+
+static int filter_apply(const char* p, const char* pend, int enable) {
+    int is_file = 0;
+    for (const char* c = p; c < pend; c++)
+        if (*c == '/') is_file = 1;
+
+    int changed = 0;
+    for (const uint64_t* loc = __mcount_loc_start; loc < __mcount_loc_end; loc++) {
+        int state = site_state(*loc);
+        if (state < 0 || state == enable) continue;
+        uint32_t sym = ksym_index(*loc);
+        if (sym == KSYM_NONE) continue;
+        if (is_file ? !file_match(p, pend, ksym_file(sym)) : !glob_match(p, pend, ksym_name(sym)))
+            continue;
+        site_set(*loc, enable);
+        changed++;
+    }
+    if (enable) enabled_count += changed;
+    else enabled_count -= changed;
+    return changed;
+}
+
+int ftrace_set_filter(const char* filter) {
+    int changed = 0;
+    const char* p = filter;
+    while (*p) {
+        const char* end = p;
+        while (*end && *end != ',') end++;
+        int enable = 1;
+        const char* pat = p;
+        if (pat < end && *pat == '!') {
+            enable = 0;
+            pat++;
+        }
+        if (pat < end) changed += filter_apply(pat, end, enable);
+        p = *end ? end + 1 : end;
+    }
+    return changed;
+}
+
+void ftrace_disable_all(void) {
+    for (const uint64_t* loc = __mcount_loc_start; loc < __mcount_loc_end; loc++)
+        if (site_state(*loc) == 1) site_set(*loc, 0);
+    enabled_count = 0;
+}
+
+uint32_t ftrace_site_count(void) {
+    return site_count;
+}
+
+uint32_t ftrace_enabled_count(void) {
+    return enabled_count;
+}
+
+// ===================== INIT =====================
+__init void ftrace_init(void) {
+    uint32_t bad = 0;
+    for (const uint64_t* loc = __mcount_loc_start; loc < __mcount_loc_end; loc++) {
+        if (site_state(*loc) == 0) site_count++;
+        else bad++;
+    }
+
+    struct ftrace_ring* ring = vm_reserve(sizeof(*ring), VM_READ | VM_WRITE, "ftrace ring");
+    if (ring) {
+        // backed now: a demand fault inside a traced page fault path would recurse
+        memset(ring, 0, sizeof(*ring));
+        this_cpu()->ftrace_ring = ring;
+    }
+
+    serial_write("[FTRACE] ");
+    serial_write_dec(site_count);
+    serial_write(" call sites");
+    if (bad) {
+        serial_write(", ");
+        serial_write_dec(bad);
+        serial_write(" skipped (not a NOP)");
+    }
+    if (!ring) serial_write(", no memory for the ring");
+    serial_write("\n");
+}
+
+// ===================== DUMP =====================
+static void write_dec_width(uint64_t value, int width, char pad) {
+    char buf[21];
+    int i = 0;
+    do { buf[i++] = '0' + (value % 10); value /= 10; } while (value);
+    while (i < width) buf[i++] = pad;
+    while (i > 0) serial_putc(buf[--i]);
+}
+
+static void write_sym(uint64_t addr) {
+    const char* name = ksym_lookup(addr, NULL);
+    if (name) serial_write(name);
+    else serial_write_hex(addr);
+}
+
+// trace-cmd report layout: `task-pid [cpu] flags secs.usecs: event: args`
+void ftrace_dump(void) {
+    struct percpu* cpu = this_cpu();
+    struct ftrace_ring* ring = cpu->ftrace_ring;
+    if (!ring) return;
+    atomic_write(&cpu->ftrace_ring, NULL, MO_RELAXED);   // pause, serial_write() may be traced
+    compiler_barrier();
+
+    uint64_t written = ring->head;
+    uint64_t first = written > FTRACE_RING_EVENTS ? written - FTRACE_RING_EVENTS : 0;
+
+    serial_write("FTRACE begin\n");
+    serial_write("# tracer: function\n#\n# entries-in-buffer/entries-written: ");
+    serial_write_dec(written - first);
+    serial_putc('/');
+    serial_write_dec(written);
+    serial_write("   #P:1\n#\n");
+    serial_write("#           TASK-PID     CPU#  ||||   TIMESTAMP  FUNCTION\n");
+    serial_write("#              | |         |   ||||      |         |\n");
+
+    for (uint64_t i = first; i < written; i++) {
+        const struct ftrace_event* e = &ring->events[i & FTRACE_RING_MASK];
+        uint64_t us = tsc_cycles_to_ns(e->tsc) / 1000;
+        serial_write("          kernel-0     [");
+        write_dec_width(cpu->cpu_id, 3, '0');
+        serial_write("] .... ");
+        write_dec_width(us / 1000000, 5, ' ');
+        serial_putc('.');
+        write_dec_width(us % 1000000, 6, '0');
+        serial_write(": function: ");
+        write_sym(e->ip);
+        serial_write(" <-- ");
+        write_sym(e->parent_ip - 1);
+        serial_putc('\n');
+    }
+    serial_write("FTRACE end\n");
+
+    compiler_barrier();
+    atomic_write(&cpu->ftrace_ring, ring, MO_RELAXED);
+}
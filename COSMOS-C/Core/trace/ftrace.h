@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+
+// Function tracer. A trace build (make TRACE=1) compiles the kernel with
+// -pg -mfentry -mnop-mcount: each function starts with a 5-byte NOP whose
+// address the compiler records in __mcount_loc. Enabling a function
+// rewrites its NOP into `call __fentry__` (TRACE/fentry.asm), which
+// records function, caller and TSC into this CPU's ring. Functions that
+// are not enabled only pay for the NOP, so the trace build can ship.
+//
+// Filters are comma separated globs (`*`, `?`); `!` in front disables:
+//   print_*                      functions by name
+//   HAL/console/*,Drivers/PS2/*  files (anything with a '/'), matched
+//                                against the path below COSMOS-C/ or any
+//                                tail of it after a '/'
+// File filters need the link map (not available in LTO links, so trace
+// builds link without LTO).
+
+#define FTRACE_RING_EVENTS  (64 * 1024)   // per CPU, power of two, 1.5 MiB
+
+// Finds the call sites, checks they are NOPs, allocates the ring. Every
+// site stays disabled.
+void ftrace_init(void);
+
+// Patches the sites selected by `filter`; returns how many changed state
+int ftrace_set_filter(const char* filter);
+void ftrace_disable_all(void);
+uint32_t ftrace_site_count(void);
+uint32_t ftrace_enabled_count(void);
+
+// Writes the ring in the text format of /sys/kernel/tracing/trace (function
+// tracer), between "FTRACE begin" and "FTRACE end" lines on COM1. Perfetto
+// opens it as a systrace text file. Recording pauses while it runs.
+void ftrace_dump(void);
+
+// called from __fentry__
+void ftrace_entry(uint64_t ip, uint64_t parent_ip);
@@ -0,0 +1,165 @@
+#include "trace/irqsoff.h"
+#include "prof/ksyms.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "Drivers/serial/serial.h"
+#include "lib/string.h"
+#include "sync/atomic.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// The hooks run with interrupts off on their own CPU's block: no locks.
+// Built without -pg like the rest of Core/trace, and the hooks are never
+// inlined, so __builtin_return_address(0) is the site that saved/restored.
+
+static struct irqsoff_cpu boot_irqsoff;
+static uint64_t budget_cycles;
+static int tracing;     // locks are taken long before GS points at a per-CPU block
+
+// ===================== RECORDING =====================
+static inline uint32_t bucket_of(uint64_t cycles) {
+    uint32_t b = 63 - (uint32_t)__builtin_clzll(cycles | 1);
+    return b < IRQSOFF_BUCKETS ? b : IRQSOFF_BUCKETS - 1;
+}
+
+static void record(struct irqsoff_cpu* s, uint64_t now, uint64_t end_ip, uint32_t vector) {
+    uint64_t cycles = now - s->start;
+    s->sections++;
+    s->hist[bucket_of(cycles)]++;
+    if (budget_cycles && cycles > budget_cycles) s->over_budget++;
+
+    // top list, longest first, one entry per begin/end/vector
+    if (s->top_count == IRQSOFF_TOP && cycles <= s->top[IRQSOFF_TOP - 1].cycles) return;
+    uint32_t i;
+    for (i = 0; i < s->top_count; i++) {
+        struct irqsoff_section* t = &s->top[i];
+        if (t->begin_ip == s->begin_ip && t->end_ip == end_ip && t->vector == vector) break;
+    }
+    if (i < s->top_count) {
+        if (cycles <= s->top[i].cycles) return;
+    } else if (s->top_count < IRQSOFF_TOP) {
+        i = s->top_count++;
+    } else {
+        i = IRQSOFF_TOP - 1;    // replaces the shortest
+    }
+    while (i > 0 && s->top[i - 1].cycles < cycles) {
+        s->top[i] = s->top[i - 1];
+        i--;
+    }
+    s->top[i] = (struct irqsoff_section){
+        .start = s->start, .cycles = cycles,
+        .begin_ip = s->begin_ip, .end_ip = end_ip, .vector = vector,
+    };
+}
+
+static inline struct irqsoff_cpu* cpu_state(void) {
+    if (!atomic_read(&tracing, MO_RELAXED)) return NULL;
+    return this_cpu()->irqsoff;
+}
+
+__attribute__((noinline)) void irqsoff_begin(void) {
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s) return;
+    s->begin_ip = (uint64_t)__builtin_return_address(0);
+    s->start = rdtsc();
+}
+
+__attribute__((noinline)) void irqsoff_end(void) {
+    uint64_t now = rdtsc();
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s || !s->start) return;   // opened before tracing started
+    record(s, now, (uint64_t)__builtin_return_address(0), IRQSOFF_NO_VECTOR);
+    s->start = 0;
+}
+
+// The interrupted code had interrupts on, or the interrupt would not have
+// been taken: nothing is open here
+__hot void irqsoff_irq_enter(void) {
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s) return;
+    s->begin_ip = 0;
+    s->start = rdtsc();
+}
+
+__hot void irqsoff_irq_exit(uint32_t vector, const void* handler) {
+    uint64_t now = rdtsc();
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s || !s->start) return;
+    s->begin_ip = (uint64_t)handler;
+    record(s, now, 0, vector);
+    s->start = 0;
+}
+
+// ===================== CONTROL =====================
+// percpu.c keeps the boot CPU's block, so this runs after percpu_init()
+__init void irqsoff_init(uint32_t budget_us) {
+    budget_cycles = (uint64_t)budget_us * tsc_khz / 1000;
+    this_cpu()->irqsoff = &boot_irqsoff;
+    atomic_write(&tracing, 1, MO_RELEASE);
+}
+
+void irqsoff_reset(void) {
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s) return;
+    uint64_t flags = cpu_irq_save();
+    uint64_t start = s->start;
+    uint64_t begin_ip = s->begin_ip;
+    memset(s, 0, sizeof(*s));
+    s->start = start;
+    s->begin_ip = begin_ip;
+    cpu_irq_restore(flags);
+}
+
+// ===================== REPORT =====================
+static void write_ns(const char* label, uint64_t cycles) {
+    serial_write(label);
+    serial_write_dec(tsc_cycles_to_ns(cycles));
+}
+
+uint64_t irqsoff_report(void) {
+    struct irqsoff_cpu* s = cpu_state();
+    if (!s) return 0;
+
+    // a consistent copy; serial output is slow and runs with interrupts on
+    static struct irqsoff_cpu snap;
+    uint64_t flags = cpu_irq_save();
+    memcpy(&snap, s, sizeof(snap));
+    cpu_irq_restore(flags);
+
+    serial_write("IRQSOFF begin sections=");
+    serial_write_dec(snap.sections);
+    write_ns(" max_ns=", snap.top_count ? snap.top[0].cycles : 0);
+    write_ns(" budget_ns=", budget_cycles);
+    serial_write(" over=");
+    serial_write_dec(snap.over_budget);
+    serial_putc('\n');
+
+    for (uint32_t i = 0; i < snap.top_count; i++) {
+        const struct irqsoff_section* t = &snap.top[i];
+        write_ns("IRQSOFF top ", t->cycles);
+        serial_write(" tsc=");
+        serial_write_dec(t->start);
+        serial_write(" begin=");
+        ksym_write(t->begin_ip);
+        if (t->vector != IRQSOFF_NO_VECTOR) {
+            serial_write(" end=irq");
+            serial_write_dec(t->vector);
+        } else {
+            serial_write(" end=");
+            ksym_write(t->end_ip);
+        }
+        serial_putc('\n');
+    }
+
+    for (uint32_t b = 0; b < IRQSOFF_BUCKETS; b++) {
+        if (!snap.hist[b]) continue;
+        write_ns("IRQSOFF hist ", 1ull << b);
+        serial_putc(' ');
+        serial_write_dec(snap.hist[b]);
+        serial_putc('\n');
+    }
+    serial_write("IRQSOFF end\n");
+    return snap.over_budget;
+}
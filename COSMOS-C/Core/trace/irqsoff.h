@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+
+// Interrupts-off latency tracer (make IRQSOFF=1). Times every stretch with
+// IF clear on the TSC:
+//   cpu_irq_save() that turns interrupts off .. cpu_irq_restore() that turns
+//     them back on (spin_lock_irqsave() and every other user)
+//   the IRQ path, isr_handler() entry to exit (the interrupt gate clears IF)
+// Each CPU keeps the running maximum, the IRQSOFF_TOP longest sections with
+// distinct sites, a log2 histogram and the sections over the budget.
+// irqsoff_report() writes to COM1:
+//
+//   IRQSOFF begin sections=1234 max_ns=48211 budget_ns=100000 over=0
+//   IRQSOFF top <ns> tsc=<start> begin=<sym+off> end=<sym+off|irq>
+//   IRQSOFF hist <from_ns> <count>               [from, 2 * from)
+//   IRQSOFF end
+//
+// begin/end are the cpu_irq_save()/cpu_irq_restore() sites; IRQ sections
+// name the handler that ran and the vector (end=irq33). Raw cli/sti (boot,
+// benchmarks, syscall entry) is not seen.
+
+#define IRQSOFF_TOP        16
+#define IRQSOFF_BUCKETS    40          // log2(cycles): 1 .. 2^39
+#define IRQSOFF_NO_VECTOR  0
+
+struct irqsoff_section {
+    uint64_t start;                    // TSC
+    uint64_t cycles;
+    uint64_t begin_ip;
+    uint64_t end_ip;
+    uint32_t vector;                   // IRQ sections, else IRQSOFF_NO_VECTOR
+};
+
+struct irqsoff_cpu {
+    uint64_t start;                    // open section, 0 = none
+    uint64_t begin_ip;
+    uint64_t sections;
+    uint64_t over_budget;
+    uint32_t top_count;
+    struct irqsoff_section top[IRQSOFF_TOP];   // longest first
+    uint64_t hist[IRQSOFF_BUCKETS];
+};
+
+// Starts tracing on this CPU; sections longer than budget_us count as over
+// the budget (0: no budget). Needs the per-CPU block and the TSC rate.
+void irqsoff_init(uint32_t budget_us);
+void irqsoff_reset(void);
+// Writes the report; returns the number of sections over the budget
+uint64_t irqsoff_report(void);
+
+// hooks: cpu_irq_save()/cpu_irq_restore() (CPU/cpu.h) and isr_handler()
+void irqsoff_begin(void);
+void irqsoff_end(void);
+void irqsoff_irq_enter(void);
+void irqsoff_irq_exit(uint32_t vector, const void* handler);
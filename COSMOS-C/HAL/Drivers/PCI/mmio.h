@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+// Register access inside a mapped memory BAR (pci_bar_map()); `off` is a
+// byte offset from the start of the mapping
+static inline uint8_t mmio_read8(volatile uint8_t* base, uint32_t off) {
+    return *(volatile uint8_t*)(base + off);
+}
+static inline uint16_t mmio_read16(volatile uint8_t* base, uint32_t off) {
+    return *(volatile uint16_t*)(base + off);
+}
+static inline uint32_t mmio_read32(volatile uint8_t* base, uint32_t off) {
+    return *(volatile uint32_t*)(base + off);
+}
+static inline void mmio_write8(volatile uint8_t* base, uint32_t off, uint8_t v) {
+    *(volatile uint8_t*)(base + off) = v;
+}
+static inline void mmio_write16(volatile uint8_t* base, uint32_t off, uint16_t v) {
+    *(volatile uint16_t*)(base + off) = v;
+}
+static inline void mmio_write32(volatile uint8_t* base, uint32_t off, uint32_t v) {
+    *(volatile uint32_t*)(base + off) = v;
+}
+// Two 32-bit stores, low half first: the virtio common config only
+// guarantees 32-bit accesses
+static inline void mmio_write64(volatile uint8_t* base, uint32_t off, uint64_t v) {
+    mmio_write32(base, off, (uint32_t)v);
+    mmio_write32(base, off + 4, (uint32_t)(v >> 32));
+}
@@ -0,0 +1,440 @@
+#include "Drivers/PCI/pci.h"
+#include "Drivers/PCI/mmio.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "arch/x86_64/ACPI/acpi.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "sync/spinlock.h"
+#include "lib/errno.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Mapped up front in one region (vm_map_io() maps eagerly); buses past it
+// still work through the ports, without extended config space
+#define ECAM_MAX_BUSES      32
+
+// MCFG: the SDT header, 8 reserved bytes, then one entry per segment
+#define MCFG_ENTRIES        44
+
+struct mcfg_entry {
+    uint64_t base;          // address of bus 0, even when the window starts later
+    uint16_t segment;
+    uint8_t start_bus;
+    uint8_t end_bus;
+    uint32_t reserved;
+} __attribute__((packed));
+
+static struct pci_device devices[PCI_MAX_DEVICES];
+static int device_count;
+
+static volatile uint8_t* ecam;      // config space of bus ecam_start
+static uint32_t ecam_start, ecam_end;
+static uint8_t scanned[256];
+
+// The address/data port pair is one shared cursor
+static spinlock_t port_lock = SPINLOCK_INIT("pci");
+
+// ===================== CONFIG ACCESS =====================
+static uint32_t config_address(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset) {
+    return (1u << 31) | ((uint32_t)bus << 16) | ((uint32_t)slot << 11)
+         | ((uint32_t)func << 8) | (offset & 0xFC);
+}
+
+// NULL when the bus is outside the ECAM window
+static inline volatile uint8_t* ecam_addr(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset) {
+    if (!ecam || bus < ecam_start || bus > ecam_end) return NULL;
+    return ecam + ((uint32_t)(bus - ecam_start) << 20)
+                + ((uint32_t)slot << 15) + ((uint32_t)func << 12) + (offset & 0xFFF);
+}
+
+static uint32_t config_read32(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset) {
+    volatile uint32_t* reg = (volatile uint32_t*)ecam_addr(bus, slot, func, offset & 0xFFC);
+    if (reg) return offset < PCI_ECAM_CONFIG_SIZE ? *reg : 0xFFFFFFFFu;
+    if (offset >= PCI_CONFIG_SIZE) return 0xFFFFFFFFu;
+
+    uint64_t flags = spin_lock_irqsave(&port_lock);
+    outl(PCI_CONFIG_ADDRESS, config_address(bus, slot, func, offset));
+    uint32_t value = inl(PCI_CONFIG_DATA);
+    spin_unlock_irqrestore(&port_lock, flags);
+    return value;
+}
+
+static void config_write32(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset, uint32_t value) {
+    volatile uint32_t* reg = (volatile uint32_t*)ecam_addr(bus, slot, func, offset & 0xFFC);
+    if (reg) {
+        if (offset < PCI_ECAM_CONFIG_SIZE) *reg = value;
+        return;
+    }
+    if (offset >= PCI_CONFIG_SIZE) return;
+
+    uint64_t flags = spin_lock_irqsave(&port_lock);
+    outl(PCI_CONFIG_ADDRESS, config_address(bus, slot, func, offset));
+    outl(PCI_CONFIG_DATA, value);
+    spin_unlock_irqrestore(&port_lock, flags);
+}
+
+// A real 16-bit access: a dword read-modify-write of the command register
+// would write back the RW1C error bits of the status half and clear them
+static void config_write16(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset, uint16_t value) {
+    volatile uint16_t* reg = (volatile uint16_t*)ecam_addr(bus, slot, func, offset & 0xFFE);
+    if (reg) {
+        if (offset < PCI_ECAM_CONFIG_SIZE) *reg = value;
+        return;
+    }
+    if (offset >= PCI_CONFIG_SIZE) return;
+
+    uint64_t flags = spin_lock_irqsave(&port_lock);
+    outl(PCI_CONFIG_ADDRESS, config_address(bus, slot, func, offset));
+    outw(PCI_CONFIG_DATA + (offset & 2), value);
+    spin_unlock_irqrestore(&port_lock, flags);
+}
+
+uint32_t pci_read32(const struct pci_device* dev, uint16_t offset) {
+    return config_read32(dev->bus, dev->slot, dev->func, offset);
+}
+
+uint16_t pci_read16(const struct pci_device* dev, uint16_t offset) {
+    return (uint16_t)(pci_read32(dev, offset) >> ((offset & 2) * 8));
+}
+
+uint8_t pci_read8(const struct pci_device* dev, uint16_t offset) {
+    return (uint8_t)(pci_read32(dev, offset) >> ((offset & 3) * 8));
+}
+
+void pci_write32(const struct pci_device* dev, uint16_t offset, uint32_t value) {
+    config_write32(dev->bus, dev->slot, dev->func, offset, value);
+}
+
+void pci_write16(const struct pci_device* dev, uint16_t offset, uint16_t value) {
+    config_write16(dev->bus, dev->slot, dev->func, offset, value);
+}
+
+// ===================== ECAM =====================
+// Segment 0 only: struct pci_device has no segment, and PC chipsets put
+// everything there
+static __init void ecam_init(void) {
+    const struct acpi_sdt_header* mcfg = acpi_find_table("MCFG");
+    if (!mcfg) return;
+
+    const uint8_t* end = (const uint8_t*)mcfg + mcfg->length;
+    for (const uint8_t* p = (const uint8_t*)mcfg + MCFG_ENTRIES; p + sizeof(struct mcfg_entry) <= end;
+         p += sizeof(struct mcfg_entry)) {
+        const struct mcfg_entry* e = (const struct mcfg_entry*)p;
+        if (e->segment != 0 || e->end_bus < e->start_bus) continue;
+
+        uint32_t last = e->end_bus;
+        if (last - e->start_bus >= ECAM_MAX_BUSES) last = e->start_bus + ECAM_MAX_BUSES - 1;
+        uint64_t phys = e->base + ((uint64_t)e->start_bus << 20);
+        volatile uint8_t* virt = vm_map_io(phys, (size_t)(last - e->start_bus + 1) * PCI_ECAM_BUS_SIZE, "pci ecam");
+        if (!virt) return;
+        ecam_start = e->start_bus;
+        ecam_end = last;
+        ecam = virt;
+        return;
+    }
+}
+
+// ===================== BARS =====================
+// Writes all ones and reads back which address bits stick; decoding is
+// off meanwhile so the device doesn't claim that address
+static __init void size_bars(struct pci_device* dev) {
+    int count = dev->header_type == 0 ? PCI_MAX_BARS : dev->header_type == PCI_HEADER_BRIDGE ? 2 : 0;
+    uint16_t command = pci_read16(dev, PCI_COMMAND);
+    pci_write16(dev, PCI_COMMAND, command & ~(PCI_COMMAND_IO | PCI_COMMAND_MEMORY));
+
+    for (int i = 0; i < count; i++) {
+        uint16_t offset = PCI_BAR0 + i * 4;
+        uint32_t low = pci_read32(dev, offset);
+        pci_write32(dev, offset, 0xFFFFFFFFu);
+        uint32_t mask = pci_read32(dev, offset);
+        pci_write32(dev, offset, low);
+        if (!mask || mask == 0xFFFFFFFFu) continue;     // unimplemented / no device
+
+        struct pci_bar* b = &dev->bars[i];
+        if (low & PCI_BAR_IO) {
+            mask &= ~0x3u;
+            if (!(mask >> 16)) mask |= 0xFFFF0000u;     // 16-bit decoder
+            b->flags = PCI_BAR_IO;
+            b->base = low & ~0x3u;
+            b->size = (uint32_t)(~mask + 1);
+            continue;
+        }
+
+        uint64_t mask64 = mask & ~0xFu;
+        b->base = low & ~0xFu;
+        b->flags = (uint8_t)(low & (PCI_BAR_64BIT | PCI_BAR_PREFETCH));
+        if ((low & 0x6) == PCI_BAR_64BIT && i + 1 < count) {
+            uint16_t high_offset = offset + 4;
+            uint32_t high = pci_read32(dev, high_offset);
+            pci_write32(dev, high_offset, 0xFFFFFFFFu);
+            mask64 |= (uint64_t)pci_read32(dev, high_offset) << 32;
+            pci_write32(dev, high_offset, high);
+            b->base |= (uint64_t)high << 32;
+            i++;                                        // the upper half is no BAR of its own
+        } else {
+            mask64 |= 0xFFFFFFFF00000000ull;
+        }
+        b->size = ~mask64 + 1;
+    }
+    pci_write16(dev, PCI_COMMAND, command);
+}
+
+uint64_t pci_bar_address(const struct pci_device* dev, int bar, int* is_io) {
+    uint32_t low = pci_read32(dev, PCI_BAR0 + bar * 4);
+    *is_io = low & PCI_BAR_IO;
+    if (*is_io) return low & ~0x3u;
+
+    uint64_t addr = low & ~0xFu;
+    if ((low & 0x6) == PCI_BAR_64BIT && bar < 5)
+        addr |= (uint64_t)pci_read32(dev, PCI_BAR0 + (bar + 1) * 4) << 32;
+    return addr;
+}
+
+volatile void* pci_bar_map(struct pci_device* dev, int bar) {
+    if (bar < 0 || bar >= PCI_MAX_BARS) return NULL;
+    struct pci_bar* b = &dev->bars[bar];
+    if (b->virt) return b->virt;
+    if (!b->base || !b->size || (b->flags & PCI_BAR_IO)) return NULL;
+    b->virt = vm_map_io(b->base, b->size, "pci bar");
+    return b->virt;
+}
+
+// ===================== ENUMERATION =====================
+static __init void scan_bus(uint8_t bus);
+
+static __init void add_function(uint8_t bus, uint8_t slot, uint8_t func) {
+    if (device_count == PCI_MAX_DEVICES) return;
+    struct pci_device* dev = &devices[device_count++];
+    dev->bus = bus;
+    dev->slot = slot;
+    dev->func = func;
+
+    uint32_t id = pci_read32(dev, PCI_VENDOR_ID);
+    uint32_t class_rev = pci_read32(dev, PCI_CLASS_REVISION);
+    dev->vendor = (uint16_t)id;
+    dev->device = (uint16_t)(id >> 16);
+    dev->class_code = (uint8_t)(class_rev >> 24);
+    dev->subclass = (uint8_t)(class_rev >> 16);
+    dev->prog_if = (uint8_t)(class_rev >> 8);
+    dev->header_type = pci_read8(dev, PCI_HEADER_TYPE) & ~PCI_HEADER_MULTIFUNCTION;
+    dev->irq_line = pci_read8(dev, PCI_INTERRUPT_LINE);
+    size_bars(dev);
+
+    // behind a PCI-to-PCI bridge (PCIe root ports are ones too)
+    if (dev->header_type == PCI_HEADER_BRIDGE) scan_bus(pci_read8(dev, PCI_SECONDARY_BUS));
+}
+
+static __init void scan_slot(uint8_t bus, uint8_t slot) {
+    if ((config_read32(bus, slot, 0, PCI_VENDOR_ID) & 0xFFFF) == 0xFFFF) return;
+    int multifunction = config_read32(bus, slot, 0, PCI_HEADER_TYPE & 0xFC) & (PCI_HEADER_MULTIFUNCTION << 16);
+    for (int func = 0; func < (multifunction ? 8 : 1); func++) {
+        if ((config_read32(bus, slot, func, PCI_VENDOR_ID) & 0xFFFF) == 0xFFFF) continue;
+        add_function(bus, slot, func);
+    }
+}
+
+// Bus numbers come from the bridges the firmware configured; each bus is
+// visited once even if a broken bridge points back up
+static __init void scan_bus(uint8_t bus) {
+    if (scanned[bus]) return;
+    scanned[bus] = 1;
+    for (int slot = 0; slot < 32; slot++) scan_slot(bus, (uint8_t)slot);
+}
+
+// Walks the bridges from the host bridge down instead of probing all 8192
+// bus/slot pairs. Several host bridges show up as functions of 00:00.
+__init void pci_init(void) {
+    ecam_init();
+
+    int multifunction = config_read32(0, 0, 0, PCI_HEADER_TYPE & 0xFC) & (PCI_HEADER_MULTIFUNCTION << 16);
+    if (!multifunction) {
+        scan_bus(0);
+    } else {
+        for (int func = 0; func < 8; func++)
+            if ((config_read32(0, 0, func, PCI_VENDOR_ID) & 0xFFFF) != 0xFFFF) scan_bus((uint8_t)func);
+    }
+
+    serial_write("[PCI] ");
+    serial_write_dec(device_count);
+    serial_write(" functions, ");
+    if (ecam) {
+        serial_write("ECAM buses ");
+        serial_write_dec(ecam_start);
+        serial_putc('-');
+        serial_write_dec(ecam_end);
+        serial_putc('\n');
+    } else {
+        serial_write("port 0xCF8\n");
+    }
+}
+
+struct pci_device* pci_find(uint16_t vendor, uint16_t device, const struct pci_device* prev) {
+    int start = prev ? (int)(prev - devices) + 1 : 0;
+    for (int i = start; i < device_count; i++) {
+        if (devices[i].vendor == vendor && devices[i].device == device) return &devices[i];
+    }
+    return NULL;
+}
+
+// ===================== DRIVERS =====================
+static const struct pci_id* match(const struct pci_id* ids, const struct pci_device* dev) {
+    uint16_t class_sub = (uint16_t)(dev->class_code << 8 | dev->subclass);
+    for (; ids->vendor; ids++) {
+        if (ids->vendor != PCI_ANY_ID && ids->vendor != dev->vendor) continue;
+        if (ids->device != PCI_ANY_ID && ids->device != dev->device) continue;
+        if (ids->class_sub != PCI_ANY_ID && ids->class_sub != class_sub) continue;
+        return ids;
+    }
+    return NULL;
+}
+
+static void write_hex(uint32_t value, int digits) {
+    static const char hex[] = "0123456789abcdef";
+    for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) serial_putc(hex[(value >> shift) & 0xF]);
+}
+
+int pci_register_driver(const struct pci_driver* drv) {
+    int bound = 0;
+    for (int i = 0; i < device_count; i++) {
+        struct pci_device* dev = &devices[i];
+        if (dev->driver) continue;
+        const struct pci_id* id = match(drv->ids, dev);
+        if (!id || drv->probe(dev, id) != 0) continue;
+        dev->driver = drv;
+        bound++;
+
+        serial_write("[PCI] ");
+        write_hex(dev->bus, 2);
+        serial_putc(':');
+        write_hex(dev->slot, 2);
+        serial_putc('.');
+        write_hex(dev->func, 1);
+        serial_putc(' ');
+        write_hex(dev->vendor, 4);
+        serial_putc(':');
+        write_hex(dev->device, 4);
+        serial_write(" -> ");
+        serial_write(drv->name);
+        serial_putc('\n');
+    }
+    return bound;
+}
+
+// ===================== RESOURCES =====================
+void pci_enable(const struct pci_device* dev, uint16_t command) {
+    pci_write16(dev, PCI_COMMAND, pci_read16(dev, PCI_COMMAND) | command);
+}
+
+uint8_t pci_find_capability(const struct pci_device* dev, uint8_t id, uint8_t prev) {
+    if (!(pci_read16(dev, PCI_STATUS) & PCI_STATUS_CAP_LIST)) return 0;
+
+    uint8_t offset = prev ? pci_read8(dev, prev + 1) : pci_read8(dev, PCI_CAPABILITIES);
+    // at most 48 capabilities fit in the 256-byte space; bounds a broken list
+    for (int n = 0; n < 48 && offset >= 0x40; n++) {
+        offset &= 0xFC;
+        if (pci_read8(dev, offset) == id) return offset;
+        offset = pci_read8(dev, offset + 1);
+    }
+    return 0;
+}
+
+// ===================== MSI / MSI-X =====================
+// MSI-X: a table of address/data pairs in a memory BAR, one per
+// interrupt, each with its own mask bit
+static int setup_msix(struct pci_device* dev, uint8_t cap, uint32_t count) {
+    uint16_t control = pci_read16(dev, cap + PCI_MSIX_CONTROL);
+    uint32_t table = pci_read32(dev, cap + PCI_MSIX_TABLE);
+    uint32_t size = (control & 0x7FFu) + 1;
+    uint32_t bar = table & 0x7u;
+    uint64_t offset = table & ~0x7u;
+
+    volatile uint8_t* base = pci_bar_map(dev, (int)bar);
+    if (!base || offset + (uint64_t)size * PCI_MSIX_ENTRY_SIZE > dev->bars[bar].size) return -ENODEV;
+    dev->msix_table = base + offset;
+
+    // entries stay masked until pci_irq_route() fills them in
+    pci_write16(dev, cap + PCI_MSIX_CONTROL, control | PCI_MSIX_ENABLE | PCI_MSIX_MASK_ALL);
+    for (uint32_t i = 0; i < size; i++) {
+        uint32_t ctrl = i * PCI_MSIX_ENTRY_SIZE + 12;
+        mmio_write32(dev->msix_table, ctrl, mmio_read32(dev->msix_table, ctrl) | PCI_MSIX_ENTRY_MASKED);
+    }
+    // the message is a memory write by the device: bus mastering
+    pci_enable(dev, PCI_COMMAND_INTX_DISABLE | PCI_COMMAND_MASTER);
+    pci_write16(dev, cap + PCI_MSIX_CONTROL, (control | PCI_MSIX_ENABLE) & ~PCI_MSIX_MASK_ALL);
+
+    dev->irq_mode = PCI_IRQ_MSIX;
+    dev->irq_count = (uint16_t)(count < size ? count : size);
+    return dev->irq_count;
+}
+
+// MSI: one address for every message, the message number replaces the
+// low bits of the data, so the vectors are one aligned block
+static int setup_msi(struct pci_device* dev, uint8_t cap, uint32_t count, uint32_t cpu) {
+    uint16_t control = pci_read16(dev, cap + PCI_MSI_CONTROL);
+    uint32_t capable = (control >> 1) & 0x7u;
+    if (capable > 5) capable = 5;                       // 32, the rest is reserved
+    uint32_t order = 0;
+    while (order < capable && (2u << order) <= count) order++;
+
+    int vector = irq_vector_alloc(1u << order, cpu);
+    if (vector < 0) return vector;
+    uint64_t addr;
+    uint32_t data;
+    irq_vector_msi((uint8_t)vector, &addr, &data);
+
+    pci_write32(dev, cap + PCI_MSI_ADDR_LO, (uint32_t)addr);
+    if (control & PCI_MSI_64BIT) {
+        pci_write32(dev, cap + PCI_MSI_ADDR_HI, (uint32_t)(addr >> 32));
+        pci_write16(dev, cap + PCI_MSI_DATA_64, (uint16_t)data);
+    } else {
+        pci_write16(dev, cap + PCI_MSI_DATA_32, (uint16_t)data);
+    }
+    pci_enable(dev, PCI_COMMAND_INTX_DISABLE | PCI_COMMAND_MASTER);
+    control = (uint16_t)((control & ~(0x7u << 4)) | (order << 4) | PCI_MSI_ENABLE);
+    pci_write16(dev, cap + PCI_MSI_CONTROL, control);
+
+    dev->irq_mode = PCI_IRQ_MSI;
+    dev->msi_vector = (uint8_t)vector;
+    dev->msi_cpu = cpu;
+    dev->irq_count = (uint16_t)(1u << order);
+    return dev->irq_count;
+}
+
+int pci_irq_setup(struct pci_device* dev, uint32_t count, uint32_t cpu) {
+    if (!count) return -EINVAL;
+    if (dev->irq_mode != PCI_IRQ_INTX) return -EBUSY;
+    uint8_t cap = pci_find_capability(dev, PCI_CAP_MSIX, 0);
+    if (cap) return setup_msix(dev, cap, count);
+    cap = pci_find_capability(dev, PCI_CAP_MSI, 0);
+    if (cap) return setup_msi(dev, cap, count, cpu);
+    return -ENODEV;
+}
+
+// Once per interrupt: the handler is in place before the entry is unmasked
+int pci_irq_route(struct pci_device* dev, uint32_t index, uint32_t cpu, irq_handler_t handler, void* ctx) {
+    if (dev->irq_mode == PCI_IRQ_INTX || index >= dev->irq_count) return -EINVAL;
+
+    if (dev->irq_mode == PCI_IRQ_MSI) {
+        if (cpu != dev->msi_cpu) return -EINVAL;
+        uint8_t vector = (uint8_t)(dev->msi_vector + index);
+        irq_vector_set_handler(vector, handler, ctx);
+        return vector;
+    }
+
+    int vector = irq_vector_alloc(1, cpu);
+    if (vector < 0) return vector;
+    irq_vector_set_handler((uint8_t)vector, handler, ctx);
+
+    uint64_t addr;
+    uint32_t data;
+    irq_vector_msi((uint8_t)vector, &addr, &data);
+    uint32_t entry = index * PCI_MSIX_ENTRY_SIZE;
+    mmio_write32(dev->msix_table, entry, (uint32_t)addr);
+    mmio_write32(dev->msix_table, entry + 4, (uint32_t)(addr >> 32));
+    mmio_write32(dev->msix_table, entry + 8, data);
+    mmio_write32(dev->msix_table, entry + 12,
+                 mmio_read32(dev->msix_table, entry + 12) & ~PCI_MSIX_ENTRY_MASKED);
+    return vector;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "arch/x86_64/IRQ/irq.h"
+#include <stdint.h>
+
+// PCI configuration mechanism #1 (ports 0xCF8/0xCFC)
+#define PCI_CONFIG_ADDRESS  0xCF8
+#define PCI_CONFIG_DATA     0xCFC
+
+// ECAM (PCIe memory mapped configuration, ACPI MCFG): 4 KiB per function
+#define PCI_ECAM_BUS_SIZE   (1u << 20)
+#define PCI_CONFIG_SIZE     256     // through the ports
+#define PCI_ECAM_CONFIG_SIZE 4096   // through ECAM, extended capabilities included
+
+// ===================== CONFIG SPACE =====================
+#define PCI_VENDOR_ID       0x00
+#define PCI_DEVICE_ID       0x02
+#define PCI_COMMAND         0x04
+#define PCI_STATUS          0x06
+#define PCI_CLASS_REVISION  0x08
+#define PCI_HEADER_TYPE     0x0E
+#define PCI_BAR0            0x10
+#define PCI_SECONDARY_BUS   0x19    // bridges (header type 1)
+#define PCI_CAPABILITIES    0x34
+#define PCI_INTERRUPT_LINE  0x3C
+
+#define PCI_COMMAND_IO      (1u << 0)
+#define PCI_COMMAND_MEMORY  (1u << 1)
+#define PCI_COMMAND_MASTER  (1u << 2)  // bus mastering (DMA)
+#define PCI_COMMAND_INTX_DISABLE (1u << 10)
+#define PCI_STATUS_CAP_LIST (1u << 4)
+
+#define PCI_HEADER_BRIDGE   0x01
+#define PCI_HEADER_MULTIFUNCTION 0x80
+
+#define PCI_BAR_IO          (1u << 0)
+#define PCI_BAR_64BIT       (2u << 1)
+#define PCI_BAR_PREFETCH    (1u << 3)
+
+// ===================== CAPABILITIES =====================
+#define PCI_CAP_MSI         0x05
+#define PCI_CAP_VENDOR      0x09
+#define PCI_CAP_MSIX        0x11
+
+// MSI: control, then a 32- or 64-bit address and the data
+#define PCI_MSI_CONTROL     0x02
+#define PCI_MSI_ADDR_LO     0x04
+#define PCI_MSI_ADDR_HI     0x08
+#define PCI_MSI_DATA_32     0x08
+#define PCI_MSI_DATA_64     0x0C
+#define PCI_MSI_ENABLE      (1u << 0)
+#define PCI_MSI_64BIT       (1u << 7)
+
+// MSI-X: control, then BIR + offset of the vector table
+#define PCI_MSIX_CONTROL    0x02
+#define PCI_MSIX_TABLE      0x04
+#define PCI_MSIX_ENABLE     (1u << 15)
+#define PCI_MSIX_MASK_ALL   (1u << 14)
+#define PCI_MSIX_ENTRY_SIZE 16
+#define PCI_MSIX_ENTRY_MASKED (1u << 0)
+
+#define PCI_MAX_DEVICES     64
+#define PCI_MAX_BARS        6
+
+#define PCI_IRQ_INTX        0       // legacy line (irq_register())
+#define PCI_IRQ_MSI         1
+#define PCI_IRQ_MSIX        2
+
+// Sized at enumeration, mapped on first pci_bar_map()
+struct pci_bar {
+    uint64_t base;          // bus address, 0 = unimplemented
+    uint64_t size;
+    uint8_t flags;          // PCI_BAR_IO / PCI_BAR_64BIT / PCI_BAR_PREFETCH
+    volatile void* virt;    // memory BARs only
+};
+
+struct pci_driver;
+
+struct pci_device {
+    uint8_t bus;
+    uint8_t slot;
+    uint8_t func;
+    uint8_t irq_line;       // legacy INTx line as routed by the firmware
+    uint16_t vendor;
+    uint16_t device;
+    uint8_t class_code;
+    uint8_t subclass;
+    uint8_t prog_if;
+    uint8_t header_type;    // without the multifunction bit
+    struct pci_bar bars[PCI_MAX_BARS];
+    const struct pci_driver* driver;    // bound by pci_register_driver()
+
+    // message signalled interrupts (pci_irq_setup())
+    uint8_t irq_mode;       // PCI_IRQ_*
+    uint8_t msi_vector;     // MSI: first vector of the block
+    uint16_t irq_count;     // interrupts the device got
+    uint32_t msi_cpu;       // MSI: every message goes to this CPU
+    volatile uint8_t* msix_table;
+};
+
+// ===================== DRIVERS =====================
+#define PCI_ANY_ID          0xFFFF
+
+// One line of a driver's match table, the table ends with a zero vendor
+struct pci_id {
+    uint16_t vendor;        // PCI_ANY_ID matches every value
+    uint16_t device;
+    uint16_t class_sub;     // class << 8 | subclass
+};
+
+struct pci_driver {
+    const char* name;
+    const struct pci_id* ids;
+    // 0 binds the device to the driver, anything else leaves it free
+    int (*probe)(struct pci_device* dev, const struct pci_id* id);
+};
+
+// ===================== API =====================
+// Enumerates through ECAM when the MCFG table has a window for segment 0,
+// through the ports otherwise
+void pci_init(void);
+
+// Next device with `vendor`/`device` after `prev` (NULL = first), NULL when done
+struct pci_device* pci_find(uint16_t vendor, uint16_t device, const struct pci_device* prev);
+
+// Runs the probe for every unbound device its table matches, in bus order.
+// Returns how many devices it bound.
+int pci_register_driver(const struct pci_driver* drv);
+
+// Offsets up to PCI_ECAM_CONFIG_SIZE with ECAM, PCI_CONFIG_SIZE without;
+// reads past that return all ones
+uint32_t pci_read32(const struct pci_device* dev, uint16_t offset);
+uint16_t pci_read16(const struct pci_device* dev, uint16_t offset);
+uint8_t pci_read8(const struct pci_device* dev, uint16_t offset);
+void pci_write32(const struct pci_device* dev, uint16_t offset, uint32_t value);
+void pci_write16(const struct pci_device* dev, uint16_t offset, uint16_t value);
+
+// Sets bits in the command register (PCI_COMMAND_*)
+void pci_enable(const struct pci_device* dev, uint16_t command);
+
+// Base address of BAR `bar` (both halves of a 64-bit BAR), 0 if unset.
+// `is_io` is set for I/O port BARs.
+uint64_t pci_bar_address(const struct pci_device* dev, int bar, int* is_io);
+// Memory BAR mapped uncached (vm_map_io()), the whole size, once per BAR.
+// NULL for I/O and unimplemented BARs.
+volatile void* pci_bar_map(struct pci_device* dev, int bar);
+
+// Offset of the next capability `id` after offset `prev` (0 = first), 0 when none
+uint8_t pci_find_capability(const struct pci_device* dev, uint8_t id, uint8_t prev);
+
+// ===================== INTERRUPTS =====================
+// Switches the device from its INTx line to MSI-X, or MSI without it, with
+// up to `count` interrupts. MSI gets a power of two, all on `cpu`. Returns
+// how many the device got, -ENODEV when it has neither capability.
+int pci_irq_setup(struct pci_device* dev, uint32_t count, uint32_t cpu);
+// Interrupt `index` (a queue) to `handler` on a vector of its own,
+// delivered to `cpu`. MSI-X picks the CPU per interrupt; under MSI it has
+// to be the one given to pci_irq_setup(). Returns the vector.
+int pci_irq_route(struct pci_device* dev, uint32_t index, uint32_t cpu, irq_handler_t handler, void* ctx);
@@ -0,0 +1,281 @@
+#include "Drivers/PS2/keyboard/kbd_replay.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "Core/arch/x86_64/TIMER/TSC/tsc.h"
+#include "arch/x86_64/MM/vm.h"
+#include "Drivers/serial/serial.h"
+#include "param/param.h"
+#include "fs/file.h"
+#include "sync/atomic.h"
+#include "lib/errno.h"
+#include "lib/string.h"
+#include "lib/sort.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define KEYBOARD_VECTOR   0x21          // IRQ1 after pic_remap(0x20, 0x28)
+#define SC_EXTENDED       0xE0
+#define SC_RELEASE        0x80
+#define DRAIN_POLLS       KB_BUF_MAX    // kb_update() calls after the last event
+
+void kb_update(void);
+
+// Reserved on the first recording or replay. rec[] is backed by
+// kbd_record_start() before IRQ1 writes to it: a demand fault in the
+// interrupt would need vm_lock. lat[] is only written from kb_update().
+static struct kbd_event* rec;
+static uint32_t rec_max;
+static uint32_t rec_count;              // written by IRQ1 only
+static int recording;
+static int replaying;
+
+static uint64_t* lat;                   // echo latencies of the running replay
+static uint32_t lat_count;
+
+// ===================== PROBES =====================
+// IRQ1, every scancode: the tag is the entry timestamp
+static __hot uint64_t raw_probe(uint8_t sc) {
+    uint64_t now = rdtsc();
+    if (atomic_read(&recording, MO_RELAXED)) {
+        uint32_t i = rec_count;
+        if (i < rec_max) {
+            rec[i].t = now;
+            rec[i].sc = sc;
+            atomic_write(&rec_count, i + 1, MO_RELEASE);
+        }
+    }
+    return now;
+}
+
+// kb_update(), the key is on screen. Keys typed before the replay started
+// carry no tag.
+static __hot void echo_probe(uint8_t key, uint64_t tag) {
+    (void)key;
+    if (tag && lat_count < KB_RECORD_MAX) lat[lat_count++] = rdtsc() - tag;
+}
+
+static int reserve_buffers(void) {
+    if (!rec) rec = vm_reserve(KB_RECORD_MAX * sizeof(*rec), VM_READ | VM_WRITE, "kbd record");
+    if (!lat) lat = vm_reserve(KB_RECORD_MAX * sizeof(*lat), VM_READ | VM_WRITE, "kbd latency");
+    return rec && lat ? 0 : -ENOMEM;
+}
+
+// ===================== RECORDER =====================
+int kbd_record_start(uint32_t max) {
+    if (recording || replaying) return -EBUSY;
+    if (max == 0 || max > KB_RECORD_MAX) return -EINVAL;
+    if (reserve_buffers() < 0) return -ENOMEM;
+    memset(rec, 0, max * sizeof(*rec));     // fault the pages in before IRQ1 writes them
+    rec_max = max;
+    rec_count = 0;
+    atomic_write(&recording, 1, MO_RELEASE);
+    keyboard_set_probes(raw_probe, NULL);
+    return 0;
+}
+
+uint32_t kbd_record_stop(void) {
+    if (!recording) return 0;
+    keyboard_set_probes(NULL, NULL);
+    atomic_write(&recording, 0, MO_RELEASE);
+    uint32_t n = atomic_read(&rec_count, MO_ACQUIRE);
+
+    // TSC -> ns since the first scancode: the file replays on any machine
+    uint64_t first = n ? rec[0].t : 0;
+    for (uint32_t i = 0; i < n; i++) rec[i].t = tsc_cycles_to_ns(rec[i].t - first);
+    return n;
+}
+
+const struct kbd_event* kbd_record_events(void) {
+    return rec;
+}
+
+void kbd_record_export(void) {
+    static const char digits[] = "0123456789abcdef";
+    uint32_t n = rec_count;
+    serial_write("KBDREC begin events=");
+    serial_write_dec(n);
+    serial_putc('\n');
+    for (uint32_t i = 0; i < n; i++) {
+        serial_write("KBDREC ");
+        serial_write_dec(rec[i].t);
+        serial_putc(' ');
+        serial_putc(digits[rec[i].sc >> 4]);
+        serial_putc(digits[rec[i].sc & 0xF]);
+        serial_putc('\n');
+    }
+    serial_write("KBDREC end\n");
+}
+
+__init void kbd_record_init(void) {
+    uint32_t max = param_get(PARAM_KBD_RECORD);
+    if (!max) return;
+    int err = kbd_record_start(max);
+    if (err < 0) {
+        serial_write("[KBDREC] cannot record, error ");
+        serial_write_dec((uint64_t)-err);
+        serial_putc('\n');
+        return;
+    }
+    serial_write("[KBDREC] recording ");
+    serial_write_dec(max);
+    serial_write(" scancodes\n");
+}
+
+// Main loop: one load until the recording is full
+void kbd_record_poll(void) {
+    if (!atomic_read(&recording, MO_RELAXED)) return;
+    if (atomic_read(&rec_count, MO_ACQUIRE) < rec_max) return;
+    kbd_record_stop();
+    kbd_record_export();
+}
+
+// ===================== PARSER =====================
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// "KBDREC <dec> <hex>", begin/end and any other line are skipped
+int kbd_replay_parse(const char* text, uint64_t len, struct kbd_event* out, uint32_t max) {
+    static const char tag[] = "KBDREC ";
+    uint32_t n = 0;
+    uint64_t pos = 0;
+
+    while (pos < len && n < max) {
+        uint64_t end = pos;
+        while (end < len && text[end] != '\n') end++;
+        uint64_t line_end = end;
+        if (line_end > pos && text[line_end - 1] == '\r') line_end--;
+
+        uint64_t p = pos;
+        uint64_t k = 0;
+        while (tag[k] && p < line_end && text[p] == tag[k]) p++, k++;
+        if (!tag[k] && p < line_end && text[p] >= '0' && text[p] <= '9') {
+            uint64_t t = 0;
+            while (p < line_end && text[p] >= '0' && text[p] <= '9') t = t * 10 + (uint64_t)(text[p++] - '0');
+            if (p + 3 != line_end || text[p] != ' ') return -EINVAL;
+            int hi = hex_digit(text[p + 1]), lo = hex_digit(text[p + 2]);
+            if (hi < 0 || lo < 0) return -EINVAL;
+            if (n && t < out[n - 1].t) return -EINVAL;
+            out[n].t = t;
+            out[n].sc = (uint8_t)(hi << 4 | lo);
+            n++;
+        }
+        pos = end + 1;
+    }
+    return (int)n;
+}
+
+int kbd_replay_load(const char* path, struct kbd_event* out, uint32_t max) {
+    int fd = fs_open(path);
+    if (fd < 0) return fd;
+    int64_t size = fs_size(fd);
+    const char* text = fs_map(fd, 0);
+    int n = size < 0 ? (int)size : text ? kbd_replay_parse(text, (uint64_t)size, out, max) : -EINVAL;
+    fs_close(fd);
+    return n;
+}
+
+// ===================== SYNTHETIC INPUT =====================
+static const uint8_t letters[] = {
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,     // q..p
+    0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,           // a..l
+    0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,                       // z..m
+};
+
+// E0 prefixed: left, right, home, end, delete, up, down
+static const uint8_t extended[] = { 0x4B, 0x4D, 0x47, 0x4F, 0x53, 0x48, 0x50 };
+
+// Make code at t, break code `hold` later
+static uint32_t put_key(struct kbd_event* out, uint32_t n, uint32_t max,
+                        uint8_t sc, int ext, uint64_t t, uint64_t hold) {
+    if (n + (ext ? 4u : 2u) > max) return n;
+    if (ext) out[n++] = (struct kbd_event){ .t = t, .sc = SC_EXTENDED };
+    out[n++] = (struct kbd_event){ .t = t, .sc = sc };
+    if (ext) out[n++] = (struct kbd_event){ .t = t + hold, .sc = SC_EXTENDED };
+    out[n++] = (struct kbd_event){ .t = t + hold, .sc = (uint8_t)(sc | SC_RELEASE) };
+    return n;
+}
+
+uint32_t kbd_replay_synth(struct kbd_event* out, uint32_t max, uint32_t keys_per_sec, uint64_t seed) {
+    if (!keys_per_sec) return 0;
+    uint64_t step = 1000000000ull / keys_per_sec;
+    uint64_t state = seed ? seed : 0x9E3779B97F4A7C15ull;
+    uint32_t n = 0;
+
+    for (uint64_t t = 0;; t += step) {
+        uint64_t r = xorshift64(&state);
+        uint32_t pick = (uint32_t)(r % 100);
+        // up to half a key late: uneven, but still in order
+        uint64_t at = t + (r >> 32) % (step / 2 + 1);
+        uint32_t next;
+        if (pick < 70)      next = put_key(out, n, max, letters[(r >> 8) % sizeof(letters)], 0, at, step / 4);
+        else if (pick < 80) next = put_key(out, n, max, 0x39, 0, at, step / 4);    // space
+        else if (pick < 88) next = put_key(out, n, max, 0x0E, 0, at, step / 4);    // backspace
+        else if (pick < 98) next = put_key(out, n, max, extended[(r >> 8) % sizeof(extended)], 1, at, step / 4);
+        else                next = put_key(out, n, max, 0x1C, 0, at, step / 4);    // enter
+        if (next == n) return n;
+        n = next;
+    }
+}
+
+// ===================== REPLAY =====================
+int kbd_replay(const struct kbd_event* ev, uint32_t n, uint32_t speed, struct kbd_latency* out) {
+    if (!speed) return -EINVAL;
+    if (!tsc_khz) return -ENODEV;
+    if (recording || replaying) return -EBUSY;
+    if (reserve_buffers() < 0) return -ENOMEM;
+
+    replaying = 1;
+    lat_count = 0;
+    keyboard_set_probes(raw_probe, echo_probe);
+
+    // ns / speed -> cycles: ns * khz / 1e6
+    uint64_t per_ms = tsc_khz * 1000ull / speed;    // cycles per ms of recording
+    uint64_t t0 = rdtsc();
+    for (uint32_t i = 0; i < n;) {
+        uint64_t now = rdtsc();
+        for (; i < n; i++) {
+            uint64_t due = t0 + ev[i].t / 1000000ull * per_ms + ev[i].t % 1000000ull * per_ms / 1000000ull;
+            if (now < due) break;
+            keyboard_inject(ev[i].sc);
+            __asm__ volatile ("int %0" : : "i"(KEYBOARD_VECTOR) : "memory");
+        }
+        kb_update();
+    }
+    for (int i = 0; i < DRAIN_POLLS; i++) kb_update();
+    uint64_t t1 = rdtsc();
+
+    keyboard_set_probes(NULL, NULL);
+    replaying = 0;
+
+    sort_u64(lat, lat_count);
+    out->keys = lat_count;
+    out->cycles = t1 - t0;
+    out->p50 = percentile_u64(lat, lat_count, 500);
+    out->p90 = percentile_u64(lat, lat_count, 900);
+    out->p99 = percentile_u64(lat, lat_count, 990);
+    out->p999 = percentile_u64(lat, lat_count, 999);
+    out->max = percentile_u64(lat, lat_count, 1000);
+    return 0;
+}
+
+void kbd_latency_report(const char* name, const struct kbd_latency* l) {
+    serial_write("[KBDREPLAY] ");
+    serial_write(name);
+    serial_write(" keys=");
+    serial_write_dec(l->keys);
+    serial_write(" p50=");
+    serial_write_dec(tsc_cycles_to_ns(l->p50));
+    serial_write(" p90=");
+    serial_write_dec(tsc_cycles_to_ns(l->p90));
+    serial_write(" p99=");
+    serial_write_dec(tsc_cycles_to_ns(l->p99));
+    serial_write(" p999=");
+    serial_write_dec(tsc_cycles_to_ns(l->p999));
+    serial_write(" max=");
+    serial_write_dec(tsc_cycles_to_ns(l->max));
+    serial_write(" ns\n");
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+// Keyboard record and replay: scancodes captured at IRQ entry with their
+// timing, played back through the real IRQ1 path at the recorded pace (or
+// faster), and the time from each scancode to its echo on the console.
+//
+//   boot with kbd.record=N, type   ->  KBDREC lines on COM1
+//   scripts/kbdrec-extract.sh      ->  a .kbdrec file for the initrd
+//   kbd_replay_load() + kbd_replay()  ->  p50/p99/p999 key-to-echo latency
+//
+// A replay file is the exported text itself, one event per line:
+//   KBDREC <ns since the first event> <scancode, 2 hex digits>
+
+struct kbd_event {
+    uint64_t t;                 // TSC while recording, then ns since the first event
+    uint8_t sc;                 // raw set 1 scancode, E0 prefixes included
+    uint8_t pad[7];
+};
+
+// Key-to-echo latency of one replay, in TSC cycles
+struct kbd_latency {
+    uint64_t keys;              // keys echoed (releases and prefixes are no keys)
+    uint64_t cycles;            // first injection to the last echo
+    uint64_t p50, p90, p99, p999, max;
+};
+
+// ===================== RECORDER =====================
+// kbd.record= (Core/param): records that many scancodes from boot, then
+// exports them once from kbd_record_poll() in the main loop
+void kbd_record_init(void);
+void kbd_record_poll(void);
+
+// Up to `max` scancodes, KB_RECORD_MAX at most. -ENOMEM, -EBUSY while a
+// recording or replay runs.
+int kbd_record_start(uint32_t max);
+// Ends the recording and converts the timestamps, returns the event count
+uint32_t kbd_record_stop(void);
+const struct kbd_event* kbd_record_events(void);
+// KBDREC begin / one line per event / KBDREC end, on COM1
+void kbd_record_export(void);
+
+// ===================== REPLAY =====================
+// KBDREC lines from `text` into `out`, other lines skipped; returns the
+// number of events, -EINVAL for a malformed or out-of-order event line
+int kbd_replay_parse(const char* text, uint64_t len, struct kbd_event* out, uint32_t max);
+// Same from an initrd file, -ENOENT when it is not there
+int kbd_replay_load(const char* path, struct kbd_event* out, uint32_t max);
+// Press/release pairs at `keys_per_sec`, an editing mix: mostly letters,
+// with spaces, backspace, cursor keys, home/end, delete and enter
+uint32_t kbd_replay_synth(struct kbd_event* out, uint32_t max, uint32_t keys_per_sec, uint64_t seed);
+
+// Injects every event through `int 0x21` once it is due (the recorded time
+// divided by `speed`), runs kb_update() in between like the main loop does
+// and measures each key from injection to echo. Owns the keyboard probes
+// while it runs. 0, -ENODEV without a calibrated TSC, -EBUSY while
+// recording, -EINVAL for speed 0.
+int kbd_replay(const struct kbd_event* ev, uint32_t n, uint32_t speed, struct kbd_latency* out);
+// [KBDREPLAY] name keys= p50= p99= p999= max= (ns)
+void kbd_latency_report(const char* name, const struct kbd_latency* l);
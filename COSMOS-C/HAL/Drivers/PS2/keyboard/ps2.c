@@ -1,14 +1,18 @@
 #include "Drivers/PS2/keyboard/ps2.h"
 #include "arch/x86_64/IRQ/port.h"
 #include "console/print.h"
+#include "param/param.h"
+#include "arch/x86_64/MM/vm.h"
+#include "lib/string.h"
+#include "compiler.h"
+#include "sync/atomic.h"
 #include <stdbool.h>
 #include <stdint.h>
 
 // ===================== CONSTANTS =====================
-// PS/2 ports and buffer size
+// PS/2 ports
 #define PS2_DATA_PORT 0x60
 #define PS2_CMD_PORT  0x64
-#define KB_BUF_SIZE 256
 
 // ===================== MODIFIER STATES =====================
 static bool shift_pressed     = false;  // Shift key state
@@ -25,28 +29,69 @@ static uint8_t ps_seq[4];  // Stores multi-byte key sequences
 static int ps_index = 0;
 
 // ===================== BUFFER =====================
-static uint8_t kb_buf[KB_BUF_SIZE];       // Circular buffer for key presses
-static volatile int kb_head = 0;          // Head index
-static volatile int kb_tail = 0;          // Tail index
+// Single producer (IRQ1) / single consumer (kb_update): no lock needed, the
+// release/acquire pairs publish the slot before the index that covers it.
+// kbd.buf slots from keyboard_init(); until then the mask of 0 keeps the
+// ring full and keys are dropped.
+static uint8_t* kb_buf;                   // Circular buffer for key presses
+static int kb_mask = 0;                   // kbd.buf - 1, set before IRQ1 is on
+static int kb_head = 0;                   // Head index, written by the producer
+static int kb_tail = 0;                   // Tail index, written by the consumer
+static void (*kb_listener)(uint8_t key);  // Observer of every decoded key
+
+// ===================== PROBES =====================
+// Input record/replay (kbd_replay.c): the raw probe tags each scancode at
+// IRQ entry, the tag rides along with the keys in the ring and the echo
+// probe gets it back once kb_update() has drawn the key.
+static uint64_t* kb_tag;                  // Tag of the key in the same kb_buf slot
+static uint64_t kb_irq_tag;               // Tag of the scancode being decoded
+static int kb_inject = -1;                // Scancode to take instead of port 0x60
+static uint64_t (*kb_raw_probe)(uint8_t sc);
+static void (*kb_echo_probe)(uint8_t key, uint64_t tag);
 
 // Put character into buffer
-static inline void kb_put(uint8_t c) {
-    int next = (kb_head + 1) % KB_BUF_SIZE;
-    if (next == kb_tail) return;  // Buffer full
-    kb_buf[kb_head] = c;
-    kb_head = next;
+static inline __hot void kb_put(uint8_t c) {
+    int head = atomic_read(&kb_head, MO_RELAXED);
+    int next = (head + 1) & kb_mask;
+    if (next != atomic_read(&kb_tail, MO_ACQUIRE)) {  // else buffer full
+        kb_buf[head] = c;
+        kb_tag[head] = kb_irq_tag;
+        atomic_write(&kb_head, next, MO_RELEASE);
+    }
+    void (*listener)(uint8_t) = atomic_read(&kb_listener, MO_ACQUIRE);
+    if (listener) listener(c);
 }
 
-// Get character from buffer
-static int kb_get(void) {
-    if (kb_head == kb_tail) return -1;  
-    int c = kb_buf[kb_tail];
-    kb_tail = (kb_tail + 1) % KB_BUF_SIZE;
+// Get character from buffer, and its probe tag
+static int kb_get(uint64_t* tag) {
+    int tail = atomic_read(&kb_tail, MO_RELAXED);
+    if (tail == atomic_read(&kb_head, MO_ACQUIRE)) return -1;
+    int c = kb_buf[tail];
+    *tag = kb_tag[tail];
+    atomic_write(&kb_tail, (tail + 1) & kb_mask, MO_RELEASE);
     return c;
 }
 
 // API function: get next key press
-int keyboard_getchar(void) { return kb_get(); }
+int keyboard_getchar(void) {
+    uint64_t tag;
+    return kb_get(&tag);
+}
+
+// API function: observe keys without consuming them (async_key_event)
+void keyboard_set_listener(void (*fn)(uint8_t key)) {
+    atomic_write(&kb_listener, fn, MO_RELEASE);
+}
+
+void keyboard_set_probes(uint64_t (*raw)(uint8_t sc), void (*echo)(uint8_t key, uint64_t tag)) {
+    atomic_write(&kb_echo_probe, echo, MO_RELEASE);
+    atomic_write(&kb_raw_probe, raw, MO_RELEASE);
+}
+
+// Taken by the next IRQ1, which the caller raises with `int`
+void keyboard_inject(uint8_t sc) {
+    atomic_write(&kb_inject, sc, MO_RELAXED);
+}
 
 // ===================== LED UPDATE =====================
 // Update keyboard LEDs based on lock states
@@ -90,11 +135,18 @@ static unsigned char scancode2ascii_shift[128] = {
 };
 
 static void handle_extended(uint8_t code, bool released);
+
+// F1..F12 -> 0..11, -1 for anything else
+static inline int fkey_index(uint8_t code) {
+    if (code >= 0x3B && code <= 0x44) return code - 0x3B;
+    if (code == 0x57 || code == 0x58) return code - 0x57 + 10;
+    return -1;
+}
 static bool handle_printscreen(uint8_t code); 
 
 // ===================== TRANSLATOR =====================
 // Translate PS/2 scancode to ASCII or special key
-static char translate_scancode(uint8_t code) {
+static __hot char translate_scancode(uint8_t code) {
     if (pause_seq) { pause_seq = false; kb_put(KEY_PAUSE); return 0; }
     if (code == 0xE1) { pause_seq = true; return 0; }
     if (handle_printscreen(code)) return 0;
@@ -120,6 +172,12 @@ static char translate_scancode(uint8_t code) {
     // Handle extended keys
     if (extended) { handle_extended(code, released); extended = false; return 0; }
 
+    // Alt+F1..F12: bring that virtual terminal to the front
+    if (alt_pressed && !released) {
+        int vt = fkey_index(code);
+        if (vt >= 0 && vt < VT_COUNT) { print_vt_switch((uint32_t)vt); return 0; }
+    }
+
     if (!released) {
         switch (code) {
             case 0x01: print_str("[Esc]"); return 0;
@@ -178,7 +236,7 @@ static char translate_scancode(uint8_t code) {
 // ===================== SPECIAL HANDLERS =====================
 // Handle extended keys (E0 prefix)
 
-static void handle_extended(uint8_t code, bool released) {
+static __hot void handle_extended(uint8_t code, bool released) {
     if (released) return;  // Only handle key press
     switch (code) {
         case 0x1C: kb_put('\n'); break;
@@ -215,7 +273,7 @@ static void handle_extended(uint8_t code, bool released) {
 }
 
 // Handle PrintScreen sequence
-static bool handle_printscreen(uint8_t code) {
+static __hot bool handle_printscreen(uint8_t code) {
     ps_seq[ps_index++] = code;
     if (ps_index >= 4) {
         if (ps_seq[0]==0xE0 && ps_seq[1]==0x2A &&
@@ -233,8 +291,19 @@ static bool handle_printscreen(uint8_t code) {
 
 // ===================== IRQ HANDLER =====================
 // Called on PS/2 interrupt
-void keyboard_irq_handler(void) {
-    uint8_t sc = inb(PS2_DATA_PORT);
+__hot void keyboard_irq_handler(void) {
+    int injected = atomic_read(&kb_inject, MO_RELAXED);
+    if (injected >= 0) atomic_write(&kb_inject, -1, MO_RELAXED);
+    uint8_t sc = injected >= 0 ? (uint8_t)injected : inb(PS2_DATA_PORT);
+
+    uint64_t (*raw)(uint8_t) = atomic_read(&kb_raw_probe, MO_ACQUIRE);
+    kb_irq_tag = raw ? raw(sc) : 0;
+    keyboard_handle_scancode(sc);
+    kb_irq_tag = 0;
+}
+
+// Decode one raw scancode into the key buffer (IRQ path, also used by benchmarks)
+__hot void keyboard_handle_scancode(uint8_t sc) {
     char c = translate_scancode(sc);
 
     if (c) { 
@@ -245,267 +314,308 @@ void keyboard_irq_handler(void) {
 // ================ UPDATE PER FRAME ==================
 
 extern void enable_irq(void);
-extern size_t row; 
-extern size_t col;   
 
 #define LINE_BUF_SIZE 128
-#define HISTORY_SIZE 16
 #define TAB_SIZE 4
-#define BLINK_THRESHOLD 20000
 
-static char buffer[LINE_BUF_SIZE];
-static int line_len = 0;
-static int cursor_pos = 0;
-static int start_col;
+// One editor per virtual terminal; keys go to the one in front
+struct line_editor {
+    char buf[LINE_BUF_SIZE];
+    int len;
+    int cursor;
+    int start_col;
+    char (*history)[LINE_BUF_SIZE];     // kbd.history lines, from keyboard_init()
+    int history_len;          // History Total Length
+    int history_pos;          // Current Position in History
+};
 
-static char history[HISTORY_SIZE][LINE_BUF_SIZE];
-static int history_len = 0;   // History Total Length
-static int history_pos = -1;  // Current Position in History
+static struct line_editor editors[VT_COUNT] = {
+    [0 ... VT_COUNT - 1] = { .history_pos = -1 },
+};
+static int history_size = 0;                      // kbd.history, 0 until keyboard_init()
 
+static int blink_threshold = KB_BLINK_DEFAULT;    // kbd.blink
 static int blink_state = 0;   // Blinker State
 static int blink_counter = 0; // "Ticks" counter
 
-static inline void sanitize_cursor() {
-    if (line_len < 0) line_len = 0;
-    if (line_len > LINE_BUF_SIZE - 1) line_len = LINE_BUF_SIZE - 1;
-    if (cursor_pos < 0) cursor_pos = 0;
-    if (cursor_pos > line_len) cursor_pos = line_len;
+static inline void sanitize_cursor(struct line_editor* e) {
+    if (e->len < 0) e->len = 0;
+    if (e->len > LINE_BUF_SIZE - 1) e->len = LINE_BUF_SIZE - 1;
+    if (e->cursor < 0) e->cursor = 0;
+    if (e->cursor > e->len) e->cursor = e->len;
 }
 
-void kb_update() {
-    print_set_color(WHITE, BLACK);
-
-    int ci = keyboard_getchar();
-    if (ci < 0) {
-        blink_counter++;
-        if (blink_counter > BLINK_THRESHOLD) {
-            blink_counter = 0;
-            blink_state = !blink_state;
-            draw_cursor(start_col, cursor_pos, row, blink_state);
-        }
-        return;
-    }
-
+// Applies one key to the line editor and redraws what changed. False for
+// the keys that leave the blink counter alone (TAB, DELETE at the end).
+static bool kb_edit(struct line_editor* e, int ci) {
     int c = ci & 0xFF;
 
     // ENTER
     if (c == '\n') {
-        buffer[line_len] = '\0';
+        e->buf[e->len] = '\0';
 
         // Dodaj do historii
-        if (line_len > 0) {
-            if (history_len < HISTORY_SIZE) {
-                for (int i = 0; i <= line_len; i++)
-                    history[history_len][i] = buffer[i];
-                history_len++;
+        if (e->len > 0 && history_size > 0) {
+            if (e->history_len < history_size) {
+                for (int i = 0; i <= e->len; i++)
+                    e->history[e->history_len][i] = e->buf[i];
+                e->history_len++;
             } else {
                 // Przesuń historię w górę
-                for (int h = 1; h < HISTORY_SIZE; h++)
-                    for (int i = 0; i <= LINE_BUF_SIZE; i++)
-                        history[h-1][i] = history[h][i];
-                for (int i = 0; i <= line_len; i++)
-                    history[HISTORY_SIZE-1][i] = buffer[i];
+                for (int h = 1; h < history_size; h++)
+                    for (int i = 0; i < LINE_BUF_SIZE; i++)
+                        e->history[h-1][i] = e->history[h][i];
+                for (int i = 0; i <= e->len; i++)
+                    e->history[history_size-1][i] = e->buf[i];
             }
         }
-        history_pos = -1;
-
-        col = 0;
-        row++;
-        start_col = 0;
-        line_len = 0;
-        cursor_pos = 0;
-        buffer[0] = '\0';
-        sanitize_cursor();
+        e->history_pos = -1;
+
+        print_newline(); // scrolls instead of running row past the screen
+        e->start_col = 0;
+        e->len = 0;
+        e->cursor = 0;
+        e->buf[0] = '\0';
+        sanitize_cursor(e);
     }
 
     // BACKSPACE
     else if (c == '\b') {
-        if (cursor_pos > 0) {
-            for (int i = cursor_pos - 1; i < line_len - 1; i++)
-                buffer[i] = buffer[i + 1];
-
-            cursor_pos--;
-            line_len--;
-            buffer[line_len] = '\0';
-            sanitize_cursor();
-
-            print_set_cursor(start_col + cursor_pos, row);
-            for (int i = cursor_pos; i < line_len; i++)
-                print_char(buffer[i]);
+        if (e->cursor > 0) {
+            for (int i = e->cursor - 1; i < e->len - 1; i++)
+                e->buf[i] = e->buf[i + 1];
+
+            e->cursor--;
+            e->len--;
+            e->buf[e->len] = '\0';
+            sanitize_cursor(e);
+
+            print_set_cursor(e->start_col + e->cursor, print_get_row());
+            for (int i = e->cursor; i < e->len; i++)
+                print_char(e->buf[i]);
             print_char(' ');
-            print_set_cursor(start_col + cursor_pos, row);
-            draw_cursor(start_col, cursor_pos, row, blink_state);
+            print_set_cursor(e->start_col + e->cursor, print_get_row());
+            draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
         }
     }
 
     // LEFT ARROW
     else if (ci == KEY_LEFT) {
-        cursor_pos--;
-        sanitize_cursor();
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        e->cursor--;
+        sanitize_cursor(e);
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 
     // RIGHT ARROW
     else if (ci == KEY_RIGHT) {
-        cursor_pos++;
-        sanitize_cursor();
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        e->cursor++;
+        sanitize_cursor(e);
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 
     // UP ARROW (historia)
     else if (ci == KEY_UP) {
-        if (history_len > 0) {
-            if (history_pos == -1)
-                history_pos = history_len - 1;
-            else if (history_pos > 0)
-                history_pos--;
-
-            int old_len = line_len;
-
-            for (int i = 0; i <= LINE_BUF_SIZE; i++)
-                buffer[i] = history[history_pos][i];
-            line_len = 0;
-            while (buffer[line_len] != '\0') line_len++;
-            cursor_pos = line_len;
-            sanitize_cursor();
-
-            print_set_cursor(start_col, row);
+        if (e->history_len > 0) {
+            if (e->history_pos == -1)
+                e->history_pos = e->history_len - 1;
+            else if (e->history_pos > 0)
+                e->history_pos--;
+
+            int old_len = e->len;
+
+            for (int i = 0; i < LINE_BUF_SIZE; i++)
+                e->buf[i] = e->history[e->history_pos][i];
+            e->len = 0;
+            while (e->buf[e->len] != '\0') e->len++;
+            e->cursor = e->len;
+            sanitize_cursor(e);
+
+            print_set_cursor(e->start_col, print_get_row());
             for (int i = 0; i < old_len; i++) print_char(' ');
-            print_set_cursor(start_col, row);
-            for (int i = 0; i < line_len; i++) print_char(buffer[i]);
-            print_set_cursor(start_col + cursor_pos, row);
-            draw_cursor(start_col, cursor_pos, row, blink_state);
+            print_set_cursor(e->start_col, print_get_row());
+            for (int i = 0; i < e->len; i++) print_char(e->buf[i]);
+            print_set_cursor(e->start_col + e->cursor, print_get_row());
+            draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
         }
     }
 
     // DOWN ARROW (historia)
     else if (ci == KEY_DOWN) {
-        if (history_pos != -1) {
-            int old_len = line_len;
+        if (e->history_pos != -1) {
+            int old_len = e->len;
 
-            if (history_pos < history_len - 1)
-                history_pos++;
+            if (e->history_pos < e->history_len - 1)
+                e->history_pos++;
             else
-                history_pos = -1;
+                e->history_pos = -1;
 
-            if (history_pos == -1) {
-                line_len = 0;
-                cursor_pos = 0;
-                buffer[0] = '\0';
+            if (e->history_pos == -1) {
+                e->len = 0;
+                e->cursor = 0;
+                e->buf[0] = '\0';
             } else {
-                for (int i = 0; i <= LINE_BUF_SIZE; i++)
-                    buffer[i] = history[history_pos][i];
-                line_len = 0;
-                while (buffer[line_len] != '\0') line_len++;
-                cursor_pos = line_len;
+                for (int i = 0; i < LINE_BUF_SIZE; i++)
+                    e->buf[i] = e->history[e->history_pos][i];
+                e->len = 0;
+                while (e->buf[e->len] != '\0') e->len++;
+                e->cursor = e->len;
             }
-            sanitize_cursor();
+            sanitize_cursor(e);
 
-            print_set_cursor(start_col, row);
+            print_set_cursor(e->start_col, print_get_row());
             for (int i = 0; i < old_len; i++) print_char(' ');
-            print_set_cursor(start_col, row);
-            for (int i = 0; i < line_len; i++) print_char(buffer[i]);
-            print_set_cursor(start_col + cursor_pos, row);
-            draw_cursor(start_col, cursor_pos, row, blink_state);
+            print_set_cursor(e->start_col, print_get_row());
+            for (int i = 0; i < e->len; i++) print_char(e->buf[i]);
+            print_set_cursor(e->start_col + e->cursor, print_get_row());
+            draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
         }
     }
 
     // DELETE
     else if (ci == KEY_DELETE) {
-        if (cursor_pos >= line_len) return;  // nic do usunięcia
-        for (int i = cursor_pos; i < line_len - 1; i++)
-            buffer[i] = buffer[i + 1];
-        line_len--;
-        buffer[line_len] = '\0';
-        sanitize_cursor();
-
-        print_set_cursor(start_col + cursor_pos, row);
-        for (int i = cursor_pos; i < line_len; i++)
-            print_char(buffer[i]);
+        if (e->cursor >= e->len) return false;  // nic do usunięcia
+        for (int i = e->cursor; i < e->len - 1; i++)
+            e->buf[i] = e->buf[i + 1];
+        e->len--;
+        e->buf[e->len] = '\0';
+        sanitize_cursor(e);
+
+        print_set_cursor(e->start_col + e->cursor, print_get_row());
+        for (int i = e->cursor; i < e->len; i++)
+            print_char(e->buf[i]);
         print_char(' ');
-        print_set_cursor(start_col + cursor_pos, row);
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        print_set_cursor(e->start_col + e->cursor, print_get_row());
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 
     // HOME
     else if (ci == KEY_HOME) {
-        cursor_pos = 0;
-        sanitize_cursor();
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        e->cursor = 0;
+        sanitize_cursor(e);
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 
     // END
     else if (ci == KEY_END) {
-        cursor_pos = line_len;
-        sanitize_cursor();
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        e->cursor = e->len;
+        sanitize_cursor(e);
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 
     // TAB 
     else if (c == '\t') {
     int spaces = TAB_SIZE;
-    if (line_len + spaces >= LINE_BUF_SIZE)
-        spaces = LINE_BUF_SIZE - 1 - line_len;
+    if (e->len + spaces >= LINE_BUF_SIZE)
+        spaces = LINE_BUF_SIZE - 1 - e->len;
 
-    if (spaces <= 0) return;
+    if (spaces <= 0) return false;
 
     // text ->
-    for (int i = line_len - 1; i >= cursor_pos; i--)
-        buffer[i + spaces] = buffer[i];
+    for (int i = e->len - 1; i >= e->cursor; i--)
+        e->buf[i + spaces] = e->buf[i];
 
     // Spaces
     for (int s = 0; s < spaces; s++)
-        buffer[cursor_pos + s] = ' ';
+        e->buf[e->cursor + s] = ' ';
 
-    line_len += spaces;
-    cursor_pos += spaces;
-    buffer[line_len] = '\0';
-    sanitize_cursor();
+    e->len += spaces;
+    e->cursor += spaces;
+    e->buf[e->len] = '\0';
+    sanitize_cursor(e);
 
     // Refresh line
-    print_set_cursor(start_col, row);
-    for (int i = 0; i < line_len; i++)
-        print_char(buffer[i]);
+    print_set_cursor(e->start_col, print_get_row());
+    for (int i = 0; i < e->len; i++)
+        print_char(e->buf[i]);
     print_char(' ');
-    print_set_cursor(start_col + cursor_pos, row);
-    draw_cursor(start_col, cursor_pos, row, blink_state);
-    return;
+    print_set_cursor(e->start_col + e->cursor, print_get_row());
+    draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
+    return false;
 }
 
 
 // NORMAL CHARACTERS
 else {     
-    if (line_len < LINE_BUF_SIZE - 1) {
-        for (int i = line_len; i > cursor_pos; i--)
-            buffer[i] = buffer[i - 1];
+    if (e->len < LINE_BUF_SIZE - 1) {
+        for (int i = e->len; i > e->cursor; i--)
+            e->buf[i] = e->buf[i - 1];
 
-        buffer[cursor_pos] = (char)c;
-        line_len++;
-        cursor_pos++;
-        sanitize_cursor();
+        e->buf[e->cursor] = (char)c;
+        e->len++;
+        e->cursor++;
+        sanitize_cursor(e);
 
-        print_set_cursor(start_col + cursor_pos - 1, row);
-        for (int i = cursor_pos - 1; i < line_len; i++)
-            print_char(buffer[i]);
+        print_set_cursor(e->start_col + e->cursor - 1, print_get_row());
+        for (int i = e->cursor - 1; i < e->len; i++)
+            print_char(e->buf[i]);
 
-        print_set_cursor(start_col + cursor_pos, row);
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        print_set_cursor(e->start_col + e->cursor, print_get_row());
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 }
 
+    return true;
+}
+
+void kb_update() {
+    struct line_editor* e = &editors[print_vt_active()];
+    print_set_color(WHITE, BLACK);
+
+    uint64_t tag;
+    int ci = kb_get(&tag);
+    if (ci < 0) {
+        blink_counter++;
+        if (blink_counter > blink_threshold) {
+            blink_counter = 0;
+            blink_state = !blink_state;
+            draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
+        }
+        return;
+    }
+
+    bool counts = kb_edit(e, ci);
+    void (*echo)(uint8_t, uint64_t) = atomic_read(&kb_echo_probe, MO_ACQUIRE);
+    if (echo) echo((uint8_t)ci, tag);   // the key is on screen
+    if (!counts) return;
+
     // BLINK
     blink_counter++;
-    if (blink_counter > BLINK_THRESHOLD) {
+    if (blink_counter > blink_threshold) {
         blink_counter = 0;
         blink_state = !blink_state;
-        draw_cursor(start_col, cursor_pos, row, blink_state);
+        draw_cursor(e->start_col, e->cursor, print_get_row(), blink_state);
     }
 }
 
 // ===================== INIT =====================
+// Tags, ring and every terminal's history in one region, sized from the
+// parameters. Backed now: IRQ1 writes the ring, and a demand fault there
+// would need vm_lock.
+static __init int keyboard_alloc(void) {
+    if (kb_buf) return 0;   // parameters are read once
+    size_t slots = param_get(PARAM_KBD_BUF);
+    size_t lines = param_get(PARAM_KBD_HISTORY);
+    size_t size = slots * (sizeof(*kb_tag) + sizeof(*kb_buf)) + VT_COUNT * lines * LINE_BUF_SIZE;
+    uint8_t* mem = vm_reserve(size, VM_READ | VM_WRITE, "keyboard");
+    if (!mem) return -1;
+    memset(mem, 0, size);
+
+    kb_tag = (uint64_t*)mem;
+    kb_buf = mem + slots * sizeof(*kb_tag);
+    char* history = (char*)kb_buf + slots;
+    for (int i = 0; i < VT_COUNT; i++)
+        editors[i].history = (char (*)[LINE_BUF_SIZE])(history + i * lines * LINE_BUF_SIZE);
+    kb_mask = (int)slots - 1;
+    history_size = (int)lines;
+    return 0;
+}
+
 // Initialize keyboard driver
-void keyboard_init(void) {
-    kb_head = kb_tail = 0;
+__init void keyboard_init(void) {
+    if (keyboard_alloc() < 0) print_str("PS/2 KEYBOARD: no memory for the key ring\n");
+    blink_threshold = (int)param_get(PARAM_KBD_BLINK);
+    atomic_write(&kb_head, 0, MO_RELAXED);
+    atomic_write(&kb_tail, 0, MO_RELAXED);
     ps_index = 0;
     kb_update_leds();
     print_str("PS/2 KEYBOARD DRIVER INITIALIZED\n");
@@ -98,7 +98,28 @@
 #define KEY_MAIL      0xCF
 #define KEY_WWW       0xD0
 
+// ===================== BOOT PARAMETERS =====================
+// kbd.buf=, kbd.history=, kbd.blink= (Core/param); keyboard_init()
+// allocates the ring and the history at the configured size
+#define KB_BUF_DEFAULT      256     // key ring slots, a power of two
+#define KB_BUF_MAX          4096
+#define KB_HISTORY_DEFAULT  16      // line editor history entries
+#define KB_HISTORY_MAX      64
+#define KB_BLINK_DEFAULT    20000   // idle polls per cursor blink
+#define KB_RECORD_MAX       65536   // kbd.record= scancodes (kbd_replay.h), 0 = off
+
 // ===================== DRIVER API =====================
 void keyboard_init(void);
 int  keyboard_getchar(void);
 void keyboard_irq_handler(void);
+void keyboard_handle_scancode(uint8_t scancode);
+// Called in IRQ context with every decoded key, also when the buffer is
+// full; NULL removes it
+void keyboard_set_listener(void (*fn)(uint8_t key));
+
+// Input probes for record/replay (kbd_replay.h). `raw` runs in IRQ1 with
+// every scancode and returns a tag that travels with the keys it decodes
+// to; `echo` gets key and tag once kb_update() has drawn it. NULL removes.
+void keyboard_set_probes(uint64_t (*raw)(uint8_t sc), void (*echo)(uint8_t key, uint64_t tag));
+// The next keyboard_irq_handler() takes `sc` instead of reading port 0x60
+void keyboard_inject(uint8_t sc);
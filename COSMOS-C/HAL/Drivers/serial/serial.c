@@ -0,0 +1,51 @@
+#include "Drivers/serial/serial.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "compiler.h"
+#include <stdint.h>
+
+// ===================== REGISTERS =====================
+#define UART_DATA      0  // Data register (DLAB=0) / divisor low (DLAB=1)
+#define UART_IER       1  // Interrupt enable (DLAB=0) / divisor high (DLAB=1)
+#define UART_FCR       2  // FIFO control
+#define UART_LCR       3  // Line control
+#define UART_MCR       4  // Modem control
+#define UART_LSR       5  // Line status
+
+#define UART_LSR_THRE  0x20 // Transmit holding register empty
+
+// ===================== INIT =====================
+// 115200 baud, 8N1, FIFOs enabled, no interrupts (polled output)
+__init void serial_init(void) {
+    outb(SERIAL_COM1 + UART_IER, 0x00);  // Disable interrupts
+    outb(SERIAL_COM1 + UART_LCR, 0x80);  // Enable DLAB
+    outb(SERIAL_COM1 + UART_DATA, 0x01); // Divisor 1 -> 115200 baud
+    outb(SERIAL_COM1 + UART_IER, 0x00);
+    outb(SERIAL_COM1 + UART_LCR, 0x03);  // 8 bits, no parity, 1 stop bit
+    outb(SERIAL_COM1 + UART_FCR, 0xC7);  // Enable + clear FIFOs, 14-byte threshold
+    outb(SERIAL_COM1 + UART_MCR, 0x03);  // DTR + RTS
+}
+
+// ===================== OUTPUT =====================
+void serial_putc(char c) {
+    if (c == '\n') serial_putc('\r');
+    while (!(inb(SERIAL_COM1 + UART_LSR) & UART_LSR_THRE));
+    outb(SERIAL_COM1 + UART_DATA, (uint8_t)c);
+}
+
+void serial_write(const char* str) {
+    while (*str) serial_putc(*str++);
+}
+
+void serial_write_dec(uint64_t value) {
+    char buf[21];
+    int i = 0;
+    do { buf[i++] = '0' + (value % 10); value /= 10; } while (value);
+    while (i > 0) serial_putc(buf[--i]);
+}
+
+void serial_write_hex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    serial_write("0x");
+    for (int shift = 60; shift >= 0; shift -= 4)
+        serial_putc(digits[(value >> shift) & 0xF]);
+}
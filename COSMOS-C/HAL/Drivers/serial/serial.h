@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+// COM1 base port (16550 UART)
+#define SERIAL_COM1 0x3F8
+
+// ===================== DRIVER API =====================
+void serial_init(void);
+void serial_putc(char c);
+void serial_write(const char* str);
+void serial_write_dec(uint64_t value);
+void serial_write_hex(uint64_t value);
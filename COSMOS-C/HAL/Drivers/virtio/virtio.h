@@ -0,0 +1,84 @@
+#pragma once
+#include "Drivers/PCI/pci.h"
+#include <stdint.h>
+
+// virtio over PCI, both transports QEMU offers:
+//   legacy (0.9.5)  registers in I/O BAR 0, ring at a fixed layout
+//   modern (1.0+)   registers in memory BARs located through vendor capabilities
+// Transitional devices have both; the modern interface is preferred.
+
+#define VIRTIO_PCI_VENDOR          0x1AF4
+
+// ===================== STATUS =====================
+#define VIRTIO_STATUS_ACKNOWLEDGE  1
+#define VIRTIO_STATUS_DRIVER       2
+#define VIRTIO_STATUS_DRIVER_OK    4
+#define VIRTIO_STATUS_FEATURES_OK  8
+#define VIRTIO_STATUS_FAILED       128
+
+// ===================== FEATURES =====================
+#define VIRTIO_F_INDIRECT_DESC     (1ull << 28)
+#define VIRTIO_F_EVENT_IDX         (1ull << 29)  // notification suppression by index
+#define VIRTIO_F_VERSION_1         (1ull << 32)  // modern device
+
+// ===================== PCI CAPABILITIES (modern) =====================
+#define VIRTIO_PCI_CAP_COMMON_CFG  1
+#define VIRTIO_PCI_CAP_NOTIFY_CFG  2
+#define VIRTIO_PCI_CAP_ISR_CFG     3
+#define VIRTIO_PCI_CAP_DEVICE_CFG  4
+
+#define VIRTIO_ISR_QUEUE           1  // used ring updated
+#define VIRTIO_ISR_CONFIG          2  // device configuration changed
+
+#define VIRTIO_MSI_NO_VECTOR       0xFFFF
+
+#define VIRTIO_MAX_QUEUES          4
+
+struct virtio_pci {
+    struct pci_device* pci;
+    int modern;
+    // legacy
+    uint16_t io_base;
+    // modern
+    volatile uint8_t* common;
+    volatile uint8_t* isr;
+    volatile uint8_t* device_cfg;
+    volatile uint8_t* notify_base;
+    uint32_t notify_multiplier;
+    volatile uint16_t* queue_notify[VIRTIO_MAX_QUEUES]; // resolved at queue setup
+};
+
+// ===================== TRANSPORT =====================
+// Maps the registers and resets the device (status ACKNOWLEDGE | DRIVER)
+int virtio_pci_init(struct virtio_pci* vdev, struct pci_device* pci);
+
+// Accepts `wanted` & offered and stores the result in `features`.
+// -1 (device marked FAILED) if a modern device rejects the set.
+int virtio_pci_negotiate(struct virtio_pci* vdev, uint64_t wanted, uint64_t* features);
+
+uint8_t virtio_pci_get_status(struct virtio_pci* vdev);
+void virtio_pci_set_status(struct virtio_pci* vdev, uint8_t status);
+
+// Queue size offered by the device for queue `index`, 0 if it doesn't exist
+uint16_t virtio_pci_queue_max(struct virtio_pci* vdev, uint16_t index);
+
+// Hands the ring (physical addresses) to the device. The legacy interface
+// only takes one page-aligned block laid out by vring_size() and the
+// device's own queue size.
+int virtio_pci_queue_setup(struct virtio_pci* vdev, uint16_t index, uint16_t size,
+                           uint64_t desc, uint64_t avail, uint64_t used);
+
+// Modern devices under MSI-X: queue `index` raises MSI-X table entry
+// `entry` (pci_irq_route()), configuration changes raise nothing. Before
+// virtio_pci_queue_setup(); -1 for legacy devices, whose registers move
+// with MSI-X on, and when the device refuses.
+int virtio_pci_queue_vector(struct virtio_pci* vdev, uint16_t index, uint16_t entry);
+
+// Doorbell for queue `index`: the one register write that exits to the host
+void virtio_pci_notify(struct virtio_pci* vdev, uint16_t index);
+
+// Reads (and thereby acknowledges) the interrupt status, VIRTIO_ISR_*
+uint8_t virtio_pci_isr(struct virtio_pci* vdev);
+
+uint32_t virtio_pci_config32(struct virtio_pci* vdev, uint32_t offset);
+uint64_t virtio_pci_config64(struct virtio_pci* vdev, uint32_t offset);
@@ -0,0 +1,359 @@
+#include "Drivers/virtio/virtio_blk.h"
+#include "Drivers/virtio/virtio.h"
+#include "Drivers/virtio/virtqueue.h"
+#include "Drivers/PCI/pci.h"
+#include "Drivers/serial/serial.h"
+#include "arch/x86_64/IRQ/irq.h"
+#include "arch/x86_64/MM/paging.h"
+#include "arch/x86_64/MM/vmm.h"
+#include "sync/spinlock.h"
+#include "compiler.h"
+#include "lib/errno.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define VIRTIO_BLK_DEVICE_LEGACY  0x1001
+#define VIRTIO_BLK_DEVICE_MODERN  0x1042
+
+// ===================== FEATURES / CONFIG =====================
+#define VIRTIO_BLK_F_SEG_MAX      (1ull << 2)
+#define VIRTIO_BLK_F_RO           (1ull << 5)
+#define VIRTIO_BLK_F_FLUSH        (1ull << 9)
+
+#define VIRTIO_BLK_CFG_CAPACITY   0
+#define VIRTIO_BLK_CFG_SEG_MAX    12
+
+// device-readable request header, first descriptor of every chain
+struct virtio_blk_req_hdr {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t sector;
+};
+
+// One descriptor chain in flight: header, data of one or more merged
+// requests, status byte. Lives in .bss, so virtual == physical.
+struct blk_chain {
+    struct virtio_blk_req_hdr hdr;
+    uint8_t status;
+    struct blk_request* first;      // merged requests, linked through next
+    struct blk_chain* next_free;
+};
+
+static struct {
+    struct virtio_pci vdev;
+    struct virtqueue vq;
+    uint64_t features;
+    uint64_t capacity;
+    uint16_t max_data_descs;        // per chain, without header and status
+    int ready;
+    struct blk_request* pending;    // submitted, not yet in the ring
+    struct blk_request* pending_tail;
+    struct blk_chain* free_chains;
+} blk;
+
+static uint8_t vq_mem[VQ_MEM_SIZE] __attribute__((aligned(4096)));
+static struct blk_chain chains[VQ_MAX_SIZE];
+static struct vq_buf chain_bufs[VQ_MAX_SIZE]; // scratch for virtio_blk_kick()
+
+// submit/kick run in threads and in the completion interrupt
+static spinlock_t blk_lock = SPINLOCK_INIT("virtio-blk");
+
+struct virtio_blk_stats virtio_blk_stats;
+
+// ===================== DMA =====================
+// The identity map is physically contiguous; anything else (vm regions) is
+// split into one descriptor per page. A 4 GiB segment is a million pages,
+// so the count stays 64-bit until it has been checked against the chain.
+static uint64_t segment_descs(const struct blk_segment* s) {
+    uintptr_t start = (uintptr_t)s->buf, end = start + s->len;
+    if (end <= IDENTITY_END) return 1;
+    return (PAGE_ALIGN_UP(end) - PAGE_ALIGN_DOWN(start)) / PAGE_SIZE;
+}
+
+// The device can't take a page fault: make demand-paged buffers resident
+// (and private, for reads into them) before they are handed over
+static void segment_prefault(const struct blk_segment* s, int device_writes) {
+    uintptr_t start = (uintptr_t)s->buf, end = start + s->len;
+    if (end <= IDENTITY_END) return;
+    for (uintptr_t p = PAGE_ALIGN_DOWN(start); p < end; p += PAGE_SIZE) {
+        volatile uint8_t* b = (volatile uint8_t*)(p < start ? start : p);
+        if (device_writes) *b = *b;
+        else (void)*b;
+    }
+}
+
+static int segment_add(struct vq_buf* bufs, int n, const struct blk_segment* s, uint16_t flags) {
+    uintptr_t addr = (uintptr_t)s->buf, end = addr + s->len;
+    if (end <= IDENTITY_END) {
+        bufs[n++] = (struct vq_buf){ addr, s->len, flags };
+        return n;
+    }
+    while (addr < end) {
+        uintptr_t next = PAGE_ALIGN_DOWN(addr) + PAGE_SIZE;
+        if (next > end) next = end;
+        bufs[n++] = (struct vq_buf){ vmm_translate(addr), (uint32_t)(next - addr), flags };
+        addr = next;
+    }
+    return n;
+}
+
+// ===================== SUBMIT =====================
+int virtio_blk_submit(struct blk_request* req) {
+    if (!blk.ready || !req->done) return -1;
+
+    uint64_t bytes = 0;
+    uint64_t descs = 0;
+    if (req->op == BLK_FLUSH) {
+        if (req->seg_count || !(blk.features & VIRTIO_BLK_F_FLUSH)) return -1;
+    } else if (req->op == BLK_READ || req->op == BLK_WRITE) {
+        if (req->seg_count == 0 || req->seg_count > BLK_MAX_SEGMENTS) return -1;
+        if (req->op == BLK_WRITE && (blk.features & VIRTIO_BLK_F_RO)) return -1;
+        for (int i = 0; i < req->seg_count; i++) {
+            const struct blk_segment* s = &req->segs[i];
+            if ((uintptr_t)s->buf + s->len < (uintptr_t)s->buf) return -1;
+            uint64_t n = segment_descs(s);
+            if (n > blk.max_data_descs) return -1;     // before the sum, so it can't wrap
+            bytes += s->len;
+            descs += n;
+        }
+        if (bytes % BLK_SECTOR_SIZE || descs > blk.max_data_descs) return -1;
+        uint64_t sectors = bytes / BLK_SECTOR_SIZE;
+        if (req->sector > blk.capacity || sectors > blk.capacity - req->sector) return -1;
+        for (int i = 0; i < req->seg_count; i++) segment_prefault(&req->segs[i], req->op == BLK_READ);
+    } else {
+        return -1;
+    }
+
+    req->sectors = (uint32_t)(bytes / BLK_SECTOR_SIZE);
+    req->descs = (uint16_t)descs;
+    req->next = NULL;
+
+    uint64_t flags = spin_lock_irqsave(&blk_lock);
+    if (blk.pending_tail) blk.pending_tail->next = req;
+    else blk.pending = req;
+    blk.pending_tail = req;
+    spin_unlock_irqrestore(&blk_lock, flags);
+    return 0;
+}
+
+// Takes the longest run of pending requests that continue each other on
+// disk (same direction, next sector == end of the previous one) and fits
+// into one chain. Only back merges in submission order, so overlapping
+// writes are never reordered.
+static struct blk_request* take_merged_locked(uint16_t* descs_out, int* merged_out) {
+    struct blk_request* first = blk.pending;
+    struct blk_request* last = first;
+    uint32_t descs = first->descs;
+    int merged = 0;
+
+    if (first->op != BLK_FLUSH) {
+        uint64_t end = first->sector + first->sectors;
+        for (struct blk_request* r = first->next;
+             r && r->op == first->op && r->sector == end && descs + r->descs <= blk.max_data_descs;
+             r = r->next) {
+            descs += r->descs;
+            end += r->sectors;
+            last = r;
+            merged++;
+        }
+    }
+    if (descs + 2 > blk.vq.num_free) return NULL; // ring full, completions will kick again
+
+    blk.pending = last->next;
+    if (!blk.pending) blk.pending_tail = NULL;
+    last->next = NULL;
+    *descs_out = (uint16_t)descs;
+    *merged_out = merged;
+    return first;
+}
+
+__hot void virtio_blk_kick(void) {
+    if (!blk.ready) return;
+    uint64_t flags = spin_lock_irqsave(&blk_lock);
+    int added = 0;
+
+    while (blk.pending && blk.free_chains) {
+        uint16_t descs;
+        int merged;
+        struct blk_request* first = take_merged_locked(&descs, &merged);
+        if (!first) break;
+
+        struct blk_chain* c = blk.free_chains;
+        blk.free_chains = c->next_free;
+        c->hdr.type = first->op;
+        c->hdr.reserved = 0;
+        c->hdr.sector = first->op == BLK_FLUSH ? 0 : first->sector;
+        c->status = 0xFF;
+        c->first = first;
+
+        uint16_t data_flags = first->op == BLK_READ ? VRING_DESC_F_WRITE : 0;
+        int n = 0;
+        chain_bufs[n++] = (struct vq_buf){ (uintptr_t)&c->hdr, sizeof(c->hdr), 0 };
+        for (struct blk_request* r = first; r; r = r->next) {
+            for (int i = 0; i < r->seg_count; i++) n = segment_add(chain_bufs, n, &r->segs[i], data_flags);
+        }
+        chain_bufs[n++] = (struct vq_buf){ (uintptr_t)&c->status, 1, VRING_DESC_F_WRITE };
+        vq_add(&blk.vq, chain_bufs, n, c);
+
+        virtio_blk_stats.chains++;
+        virtio_blk_stats.merged += merged;
+        added = 1;
+    }
+
+    if (added) {
+        virtio_blk_stats.kicks++;
+        if (vq_kick(&blk.vq)) virtio_blk_stats.notifies++;
+    }
+    spin_unlock_irqrestore(&blk_lock, flags);
+}
+
+// ===================== COMPLETION =====================
+// Collects every finished chain under the lock, then runs the callbacks
+// unlocked and pushes out whatever they submitted with a single kick.
+// The MSI-X vector of the queue lands here directly.
+static __hot void virtio_blk_complete(void* ctx) {
+    (void)ctx;
+    virtio_blk_stats.irqs++;
+
+    struct blk_request* done = NULL;
+    struct blk_request* done_tail = NULL;
+
+    spin_lock(&blk_lock);
+    do {
+        struct blk_chain* c;
+        while ((c = vq_get_used(&blk.vq, NULL))) {
+            struct blk_request* r = c->first;
+            if (done_tail) done_tail->next = r;
+            else done = r;
+            for (; r; r = r->next) {
+                r->status = c->status;
+                done_tail = r;
+            }
+            c->next_free = blk.free_chains;
+            blk.free_chains = c;
+        }
+    } while (vq_enable_irq(&blk.vq));
+    spin_unlock(&blk_lock);
+
+    while (done) {
+        struct blk_request* r = done;
+        done = r->next;
+        r->next = NULL;
+        virtio_blk_stats.requests++;
+        r->done(r, r->status);
+    }
+    virtio_blk_kick();
+}
+
+// INTx: the line may be shared, the ISR register says whether it was us
+static __hot void virtio_blk_irq(void* ctx) {
+    if (!(virtio_pci_isr(&blk.vdev) & VIRTIO_ISR_QUEUE)) return;
+    virtio_blk_complete(ctx);
+}
+
+// ===================== INIT =====================
+// Legacy devices stay on INTx: with MSI-X enabled their device config moves
+// by 4 bytes, and the legacy config accessors don't know about that. The
+// queue vector goes in first, a device ignores it while MSI-X is off, so a
+// refusal still leaves INTx working.
+static __init int want_msix(struct pci_device* pci) {
+    return blk.vdev.modern && pci_find_capability(pci, PCI_CAP_MSIX, 0)
+        && virtio_pci_queue_vector(&blk.vdev, 0, 0) == 0
+        && pci_irq_setup(pci, 1, 0) > 0;
+}
+
+static __init int virtio_blk_probe(struct pci_device* pci, const struct pci_id* id) {
+    (void)id;
+    if (blk.ready) return -EBUSY;   // one disk
+
+    if (virtio_pci_init(&blk.vdev, pci) < 0) return -ENODEV;
+    uint64_t wanted = VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_RO | VIRTIO_BLK_F_FLUSH | VIRTIO_F_EVENT_IDX;
+    if (virtio_pci_negotiate(&blk.vdev, wanted, &blk.features) < 0) return -ENODEV;
+
+    int msix = want_msix(pci);
+    if (!msix && pci->irq_line >= IRQ_LINES) {
+        virtio_pci_set_status(&blk.vdev, VIRTIO_STATUS_FAILED);
+        return -ENODEV;
+    }
+
+    blk.capacity = virtio_pci_config64(&blk.vdev, VIRTIO_BLK_CFG_CAPACITY);
+    if (vq_init(&blk.vq, &blk.vdev, 0, vq_mem, (blk.features & VIRTIO_F_EVENT_IDX) != 0) < 0) {
+        virtio_pci_set_status(&blk.vdev, VIRTIO_STATUS_FAILED);
+        return -ENODEV;
+    }
+
+    blk.max_data_descs = blk.vq.size - 2;
+    if (blk.features & VIRTIO_BLK_F_SEG_MAX) {
+        uint32_t seg_max = virtio_pci_config32(&blk.vdev, VIRTIO_BLK_CFG_SEG_MAX);
+        if (seg_max && seg_max < blk.max_data_descs) blk.max_data_descs = (uint16_t)seg_max;
+    }
+
+    for (int i = VQ_MAX_SIZE - 1; i >= 0; i--) {
+        chains[i].next_free = blk.free_chains;
+        blk.free_chains = &chains[i];
+    }
+
+    int vector = msix ? pci_irq_route(pci, 0, 0, virtio_blk_complete, NULL)
+                      : irq_register(pci->irq_line, virtio_blk_irq, NULL);
+    if (vector < 0) {
+        virtio_pci_set_status(&blk.vdev, VIRTIO_STATUS_FAILED);
+        return vector;
+    }
+    virtio_pci_set_status(&blk.vdev, virtio_pci_get_status(&blk.vdev) | VIRTIO_STATUS_DRIVER_OK);
+    blk.ready = 1;
+
+    serial_write("[VIRTIO-BLK] ");
+    serial_write(blk.vdev.modern ? "modern" : "legacy");
+    serial_write(" sectors=");
+    serial_write_dec(blk.capacity);
+    serial_write(" queue=");
+    serial_write_dec(blk.vq.size);
+    serial_write(" seg_max=");
+    serial_write_dec(blk.max_data_descs);
+    serial_write(" event_idx=");
+    serial_write_dec(blk.vq.event_idx);
+    serial_write(msix ? " msix vector=" : " irq=");
+    serial_write_dec(msix ? (uint64_t)vector : pci->irq_line);
+    serial_write("\n");
+    return 0;
+}
+
+static const struct pci_id virtio_blk_ids[] = {
+    { VIRTIO_PCI_VENDOR, VIRTIO_BLK_DEVICE_MODERN, PCI_ANY_ID },
+    { VIRTIO_PCI_VENDOR, VIRTIO_BLK_DEVICE_LEGACY, PCI_ANY_ID },   // also transitional devices
+    { 0 }
+};
+
+static const struct pci_driver virtio_blk_driver = {
+    .name = "virtio-blk",
+    .ids = virtio_blk_ids,
+    .probe = virtio_blk_probe,
+};
+
+__init int virtio_blk_init(void) {
+    return pci_register_driver(&virtio_blk_driver) > 0 ? 0 : -1;
+}
+
+int virtio_blk_present(void) {
+    return blk.ready;
+}
+
+uint64_t virtio_blk_capacity(void) {
+    return blk.capacity;
+}
+
+void virtio_blk_report(void) {
+    serial_write("[VIRTIO-BLK] requests=");
+    serial_write_dec(virtio_blk_stats.requests);
+    serial_write(" chains=");
+    serial_write_dec(virtio_blk_stats.chains);
+    serial_write(" merged=");
+    serial_write_dec(virtio_blk_stats.merged);
+    serial_write(" kicks=");
+    serial_write_dec(virtio_blk_stats.kicks);
+    serial_write(" notifies=");
+    serial_write_dec(virtio_blk_stats.notifies);
+    serial_write(" irqs=");
+    serial_write_dec(virtio_blk_stats.irqs);
+    serial_write("\n");
+}
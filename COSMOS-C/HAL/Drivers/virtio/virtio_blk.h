@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+
+// virtio-blk with an asynchronous request interface:
+//   virtio_blk_submit()  queues a request, nothing reaches the device yet
+//   virtio_blk_kick()    merges the queued requests into descriptor chains,
+//                        publishes them together and rings the doorbell once
+// Completions arrive on the device interrupt; `done` runs in IRQ context
+// without the driver lock held, so it may submit again. Every completion
+// batch ends with a kick, so requests queued from `done` go out together.
+
+#define BLK_SECTOR_SIZE      512
+#define BLK_MAX_SEGMENTS     16
+
+// request types (virtio_blk_req.type)
+#define BLK_READ             0
+#define BLK_WRITE            1
+#define BLK_FLUSH            4
+
+// completion status (virtio_blk_req.status)
+#define BLK_STATUS_OK        0
+#define BLK_STATUS_IOERR     1
+#define BLK_STATUS_UNSUPP    2
+
+struct blk_segment {
+    void* buf;
+    uint32_t len;
+};
+
+struct blk_request;
+typedef void (*blk_done_t)(struct blk_request* req, int status);
+
+struct blk_request {
+    uint32_t op;                    // BLK_READ, BLK_WRITE, BLK_FLUSH
+    uint64_t sector;
+    struct blk_segment segs[BLK_MAX_SEGMENTS];
+    uint16_t seg_count;
+    blk_done_t done;
+    void* ctx;
+    // driver private
+    uint32_t sectors;
+    uint16_t descs;                 // data descriptors after page splitting
+    uint8_t status;
+    struct blk_request* next;
+};
+
+struct virtio_blk_stats {
+    uint64_t requests;              // completed requests
+    uint64_t chains;                // descriptor chains, i.e. device requests
+    uint64_t merged;                // requests merged into an earlier chain
+    uint64_t kicks;                 // virtio_blk_kick() calls that published work
+    uint64_t notifies;              // doorbells rung (host exits)
+    uint64_t irqs;
+};
+
+extern struct virtio_blk_stats virtio_blk_stats;
+
+// 0 if a device was found and brought up
+int virtio_blk_init(void);
+int virtio_blk_present(void);
+uint64_t virtio_blk_capacity(void);   // in BLK_SECTOR_SIZE sectors
+
+// -1 if the request is malformed, out of range or the device is read-only
+int virtio_blk_submit(struct blk_request* req);
+void virtio_blk_kick(void);
+
+void virtio_blk_report(void);
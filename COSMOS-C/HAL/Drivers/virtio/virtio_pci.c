@@ -0,0 +1,212 @@
+#include "Drivers/virtio/virtio.h"
+#include "Drivers/PCI/pci.h"
+#include "Drivers/PCI/mmio.h"
+#include "arch/x86_64/IRQ/port.h"
+#include "arch/x86_64/CPU/cpu.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================== LEGACY REGISTERS (I/O BAR 0) =====================
+#define LEGACY_DEVICE_FEATURES  0
+#define LEGACY_DRIVER_FEATURES  4
+#define LEGACY_QUEUE_PFN        8
+#define LEGACY_QUEUE_SIZE       12
+#define LEGACY_QUEUE_SELECT     14
+#define LEGACY_QUEUE_NOTIFY     16
+#define LEGACY_STATUS           18
+#define LEGACY_ISR              19
+#define LEGACY_DEVICE_CFG       20   // without MSI-X
+
+// ===================== MODERN COMMON CONFIG =====================
+#define COMMON_DFSELECT         0
+#define COMMON_DF               4
+#define COMMON_GFSELECT         8
+#define COMMON_GF               12
+#define COMMON_MSIX_CONFIG      16
+#define COMMON_NUM_QUEUES       18
+#define COMMON_STATUS           20
+#define COMMON_Q_SELECT         22
+#define COMMON_Q_SIZE           24
+#define COMMON_Q_MSIX           26
+#define COMMON_Q_ENABLE         28
+#define COMMON_Q_NOFF           30
+#define COMMON_Q_DESC           32
+#define COMMON_Q_AVAIL          40
+#define COMMON_Q_USED           48
+
+// struct virtio_pci_cap field offsets
+#define CAP_CFG_TYPE            3
+#define CAP_BAR                 4
+#define CAP_OFFSET              8
+#define CAP_LENGTH              12
+#define CAP_NOTIFY_MULTIPLIER   16
+
+// ===================== INIT =====================
+// The structure a vendor capability points at, inside its BAR (mapped once
+// for all of them)
+static volatile uint8_t* map_cap(struct pci_device* pci, uint8_t cap) {
+    uint8_t bar = pci_read8(pci, cap + CAP_BAR);
+    if (bar >= PCI_MAX_BARS) return NULL;
+    volatile uint8_t* base = pci_bar_map(pci, bar);
+    uint64_t offset = pci_read32(pci, cap + CAP_OFFSET);
+    uint64_t length = pci_read32(pci, cap + CAP_LENGTH);
+    if (!base || offset + length > pci->bars[bar].size) return NULL;
+    return base + offset;
+}
+
+static int init_modern(struct virtio_pci* vdev) {
+    struct pci_device* pci = vdev->pci;
+    for (uint8_t cap = pci_find_capability(pci, PCI_CAP_VENDOR, 0); cap;
+         cap = pci_find_capability(pci, PCI_CAP_VENDOR, cap)) {
+        switch (pci_read8(pci, cap + CAP_CFG_TYPE)) {
+            case VIRTIO_PCI_CAP_COMMON_CFG:
+                if (!vdev->common) vdev->common = map_cap(pci, cap);
+                break;
+            case VIRTIO_PCI_CAP_NOTIFY_CFG:
+                if (!vdev->notify_base) {
+                    vdev->notify_base = map_cap(pci, cap);
+                    vdev->notify_multiplier = pci_read32(pci, cap + CAP_NOTIFY_MULTIPLIER);
+                }
+                break;
+            case VIRTIO_PCI_CAP_ISR_CFG:
+                if (!vdev->isr) vdev->isr = map_cap(pci, cap);
+                break;
+            case VIRTIO_PCI_CAP_DEVICE_CFG:
+                if (!vdev->device_cfg) vdev->device_cfg = map_cap(pci, cap);
+                break;
+        }
+    }
+    return vdev->common && vdev->notify_base && vdev->isr && vdev->device_cfg ? 0 : -1;
+}
+
+static int init_legacy(struct virtio_pci* vdev) {
+    int is_io;
+    uint64_t base = pci_bar_address(vdev->pci, 0, &is_io);
+    if (!base || !is_io) return -1;
+    vdev->io_base = (uint16_t)base;
+    return 0;
+}
+
+__init int virtio_pci_init(struct virtio_pci* vdev, struct pci_device* pci) {
+    vdev->pci = pci;
+    pci_enable(pci, PCI_COMMAND_IO | PCI_COMMAND_MEMORY | PCI_COMMAND_MASTER);
+
+    vdev->modern = init_modern(vdev) == 0;
+    if (!vdev->modern && init_legacy(vdev) < 0) return -1;
+
+    virtio_pci_set_status(vdev, 0); // reset
+    while (virtio_pci_get_status(vdev) != 0) cpu_relax();
+    virtio_pci_set_status(vdev, VIRTIO_STATUS_ACKNOWLEDGE);
+    virtio_pci_set_status(vdev, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+    return 0;
+}
+
+// ===================== STATUS / FEATURES =====================
+uint8_t virtio_pci_get_status(struct virtio_pci* vdev) {
+    if (vdev->modern) return mmio_read8(vdev->common, COMMON_STATUS);
+    return inb(vdev->io_base + LEGACY_STATUS);
+}
+
+void virtio_pci_set_status(struct virtio_pci* vdev, uint8_t status) {
+    if (vdev->modern) mmio_write8(vdev->common, COMMON_STATUS, status);
+    else outb(vdev->io_base + LEGACY_STATUS, status);
+}
+
+__init int virtio_pci_negotiate(struct virtio_pci* vdev, uint64_t wanted, uint64_t* features_out) {
+    uint64_t offered;
+    if (vdev->modern) {
+        mmio_write32(vdev->common, COMMON_DFSELECT, 0);
+        offered = mmio_read32(vdev->common, COMMON_DF);
+        mmio_write32(vdev->common, COMMON_DFSELECT, 1);
+        offered |= (uint64_t)mmio_read32(vdev->common, COMMON_DF) << 32;
+    } else {
+        offered = inl(vdev->io_base + LEGACY_DEVICE_FEATURES);
+    }
+
+    uint64_t features = offered & wanted;
+    if (vdev->modern) {
+        features |= VIRTIO_F_VERSION_1; // offered by every modern device, required
+        mmio_write32(vdev->common, COMMON_GFSELECT, 0);
+        mmio_write32(vdev->common, COMMON_GF, (uint32_t)features);
+        mmio_write32(vdev->common, COMMON_GFSELECT, 1);
+        mmio_write32(vdev->common, COMMON_GF, (uint32_t)(features >> 32));
+
+        uint8_t status = virtio_pci_get_status(vdev);
+        virtio_pci_set_status(vdev, status | VIRTIO_STATUS_FEATURES_OK);
+        if (!(virtio_pci_get_status(vdev) & VIRTIO_STATUS_FEATURES_OK)) {
+            virtio_pci_set_status(vdev, VIRTIO_STATUS_FAILED);
+            return -1;
+        }
+    } else {
+        // legacy has no FEATURES_OK handshake
+        outl(vdev->io_base + LEGACY_DRIVER_FEATURES, (uint32_t)features);
+    }
+    *features_out = features;
+    return 0;
+}
+
+// ===================== QUEUES =====================
+uint16_t virtio_pci_queue_max(struct virtio_pci* vdev, uint16_t index) {
+    if (vdev->modern) {
+        if (index >= mmio_read16(vdev->common, COMMON_NUM_QUEUES)) return 0;
+        mmio_write16(vdev->common, COMMON_Q_SELECT, index);
+        return mmio_read16(vdev->common, COMMON_Q_SIZE);
+    }
+    outw(vdev->io_base + LEGACY_QUEUE_SELECT, index);
+    return inw(vdev->io_base + LEGACY_QUEUE_SIZE);
+}
+
+__init int virtio_pci_queue_setup(struct virtio_pci* vdev, uint16_t index, uint16_t size,
+                                  uint64_t desc, uint64_t avail, uint64_t used) {
+    if (index >= VIRTIO_MAX_QUEUES) return -1;
+
+    if (!vdev->modern) {
+        outw(vdev->io_base + LEGACY_QUEUE_SELECT, index);
+        if (inw(vdev->io_base + LEGACY_QUEUE_SIZE) != size) return -1;
+        outl(vdev->io_base + LEGACY_QUEUE_PFN, (uint32_t)(desc >> 12));
+        return 0;
+    }
+
+    mmio_write16(vdev->common, COMMON_Q_SELECT, index);
+    mmio_write16(vdev->common, COMMON_Q_SIZE, size);
+    mmio_write64(vdev->common, COMMON_Q_DESC, desc);
+    mmio_write64(vdev->common, COMMON_Q_AVAIL, avail);
+    mmio_write64(vdev->common, COMMON_Q_USED, used);
+    uint16_t off = mmio_read16(vdev->common, COMMON_Q_NOFF);
+    vdev->queue_notify[index] =
+        (volatile uint16_t*)(vdev->notify_base + (uint32_t)off * vdev->notify_multiplier);
+    mmio_write16(vdev->common, COMMON_Q_ENABLE, 1);
+    return 0;
+}
+
+// Before the queue is set up; the device answers VIRTIO_MSI_NO_VECTOR when
+// it has no room for one more
+__init int virtio_pci_queue_vector(struct virtio_pci* vdev, uint16_t index, uint16_t entry) {
+    if (!vdev->modern) return -1;
+    mmio_write16(vdev->common, COMMON_MSIX_CONFIG, VIRTIO_MSI_NO_VECTOR);
+    mmio_write16(vdev->common, COMMON_Q_SELECT, index);
+    mmio_write16(vdev->common, COMMON_Q_MSIX, entry);
+    return mmio_read16(vdev->common, COMMON_Q_MSIX) == entry ? 0 : -1;
+}
+
+__hot void virtio_pci_notify(struct virtio_pci* vdev, uint16_t index) {
+    if (vdev->modern) *vdev->queue_notify[index] = index;
+    else outw(vdev->io_base + LEGACY_QUEUE_NOTIFY, index);
+}
+
+__hot uint8_t virtio_pci_isr(struct virtio_pci* vdev) {
+    if (vdev->modern) return mmio_read8(vdev->isr, 0);
+    return inb(vdev->io_base + LEGACY_ISR);
+}
+
+// ===================== DEVICE CONFIG =====================
+uint32_t virtio_pci_config32(struct virtio_pci* vdev, uint32_t offset) {
+    if (vdev->modern) return mmio_read32(vdev->device_cfg, offset);
+    return inl(vdev->io_base + LEGACY_DEVICE_CFG + offset);
+}
+
+uint64_t virtio_pci_config64(struct virtio_pci* vdev, uint32_t offset) {
+    return virtio_pci_config32(vdev, offset)
+         | (uint64_t)virtio_pci_config32(vdev, offset + 4) << 32;
+}
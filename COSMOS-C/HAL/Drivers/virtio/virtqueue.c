@@ -0,0 +1,126 @@
+#include "Drivers/virtio/virtqueue.h"
+#include "Drivers/virtio/virtio.h"
+#include "sync/atomic.h"
+#include "lib/string.h"
+#include "compiler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define VRING_ALIGN 4096
+
+// ===================== LAYOUT =====================
+static uint64_t avail_offset(uint16_t size) {
+    return sizeof(struct vring_desc) * size;
+}
+
+static uint64_t used_offset(uint16_t size) {
+    uint64_t avail_end = avail_offset(size) + sizeof(struct vring_avail) + sizeof(uint16_t) * (size + 1);
+    return (avail_end + VRING_ALIGN - 1) & ~(uint64_t)(VRING_ALIGN - 1);
+}
+
+__init int vq_init(struct virtqueue* vq, struct virtio_pci* vdev, uint16_t index,
+                   void* mem, int event_idx) {
+    uint16_t size = virtio_pci_queue_max(vdev, index);
+    if (size == 0) return -1;
+    if (size > VQ_MAX_SIZE) {
+        if (!vdev->modern) return -1;
+        size = VQ_MAX_SIZE;
+    }
+
+    uint8_t* base = mem;
+    memset(base, 0, VQ_MEM_SIZE);
+    vq->vdev = vdev;
+    vq->index = index;
+    vq->size = size;
+    vq->event_idx = event_idx;
+    vq->desc = (struct vring_desc*)base;
+    vq->avail = (struct vring_avail*)(base + avail_offset(size));
+    vq->used = (struct vring_used*)(base + used_offset(size));
+    vq->used_event = &vq->avail->ring[size];
+    vq->avail_event = (volatile uint16_t*)&vq->used->ring[size];
+    vq->avail_idx = vq->kicked_idx = vq->last_used = 0;
+
+    // free descriptors form a list through `next`
+    for (uint16_t i = 0; i < size; i++) vq->desc[i].next = (uint16_t)(i + 1);
+    vq->free_head = 0;
+    vq->num_free = size;
+
+    return virtio_pci_queue_setup(vdev, index, size, (uint64_t)(uintptr_t)vq->desc,
+                                  (uint64_t)(uintptr_t)vq->avail, (uint64_t)(uintptr_t)vq->used);
+}
+
+// ===================== SUBMIT =====================
+__hot int vq_add(struct virtqueue* vq, const struct vq_buf* bufs, int count, void* cookie) {
+    if (count <= 0 || count > vq->num_free) return -1;
+
+    uint16_t head = vq->free_head;
+    uint16_t i = head, last = head;
+    for (int n = 0; n < count; n++) {
+        struct vring_desc* d = &vq->desc[i];
+        d->addr = bufs[n].phys;
+        d->len = bufs[n].len;
+        d->flags = bufs[n].flags | (n + 1 < count ? VRING_DESC_F_NEXT : 0);
+        last = i;
+        i = d->next;
+    }
+    vq->free_head = vq->desc[last].next;
+    vq->num_free -= count;
+    vq->cookie[head] = cookie;
+
+    vq->avail->ring[vq->avail_idx % vq->size] = head;
+    vq->avail_idx++;
+    return 0;
+}
+
+// true if `event` lies in (old, new]: the device wants a notification
+static inline int need_event(uint16_t event, uint16_t new_idx, uint16_t old_idx) {
+    return (uint16_t)(new_idx - event - 1) < (uint16_t)(new_idx - old_idx);
+}
+
+__hot int vq_kick(struct virtqueue* vq) {
+    uint16_t old_idx = vq->kicked_idx;
+    uint16_t new_idx = vq->avail_idx;
+    if (old_idx == new_idx) return 0;
+
+    // ring entries before the index, index before reading the device's hint
+    atomic_write(&vq->avail->idx, new_idx, MO_RELEASE);
+    atomic_fence(MO_SEQ_CST);
+    vq->kicked_idx = new_idx;
+
+    int notify;
+    if (vq->event_idx) notify = need_event(*vq->avail_event, new_idx, old_idx);
+    else notify = !(atomic_read(&vq->used->flags, MO_RELAXED) & VRING_USED_F_NO_NOTIFY);
+    if (notify) virtio_pci_notify(vq->vdev, vq->index);
+    return notify;
+}
+
+// ===================== COMPLETE =====================
+__hot void* vq_get_used(struct virtqueue* vq, uint32_t* len) {
+    if (vq->last_used == atomic_read(&vq->used->idx, MO_ACQUIRE)) return NULL;
+
+    struct vring_used_elem* e = &vq->used->ring[vq->last_used % vq->size];
+    uint16_t head = (uint16_t)e->id;
+    if (len) *len = e->len;
+    vq->last_used++;
+
+    // return the chain to the free list
+    uint16_t i = head, count = 1;
+    while (vq->desc[i].flags & VRING_DESC_F_NEXT) {
+        i = vq->desc[i].next;
+        count++;
+    }
+    vq->desc[i].next = vq->free_head;
+    vq->free_head = head;
+    vq->num_free += count;
+
+    void* cookie = vq->cookie[head];
+    vq->cookie[head] = NULL;
+    return cookie;
+}
+
+__hot int vq_enable_irq(struct virtqueue* vq) {
+    if (vq->event_idx) *vq->used_event = vq->last_used;
+    else atomic_write(&vq->avail->flags, 0, MO_RELAXED);
+    atomic_fence(MO_SEQ_CST);
+    return vq->last_used != atomic_read(&vq->used->idx, MO_ACQUIRE);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Drivers/virtio/virtio.h"
+#include <stdint.h>
+
+// Split virtqueue: descriptor table, driver (avail) ring, device (used) ring,
+// in the legacy layout (used ring page aligned after the avail ring) that
+// the modern interface accepts as well. The caller provides VQ_MEM_SIZE
+// bytes of page-aligned, physically contiguous memory.
+
+#define VQ_MAX_SIZE          256
+#define VQ_MEM_SIZE          (3 * 4096)   // vring_size(VQ_MAX_SIZE)
+
+#define VRING_DESC_F_NEXT    1
+#define VRING_DESC_F_WRITE   2   // device writes this buffer
+
+#define VRING_USED_F_NO_NOTIFY      1
+#define VRING_AVAIL_F_NO_INTERRUPT  1
+
+struct vring_desc {
+    uint64_t addr;
+    uint32_t len;
+    uint16_t flags;
+    uint16_t next;
+};
+
+// followed by uint16_t used_event (VIRTIO_F_EVENT_IDX)
+struct vring_avail {
+    uint16_t flags;
+    uint16_t idx;
+    uint16_t ring[];
+};
+
+struct vring_used_elem {
+    uint32_t id;
+    uint32_t len;
+};
+
+// followed by uint16_t avail_event (VIRTIO_F_EVENT_IDX)
+struct vring_used {
+    uint16_t flags;
+    uint16_t idx;
+    struct vring_used_elem ring[];
+};
+
+struct virtqueue {
+    struct virtio_pci* vdev;
+    uint16_t index;
+    uint16_t size;
+    uint16_t num_free;
+    uint16_t free_head;
+    uint16_t avail_idx;         // shadow of avail->idx, published by vq_kick()
+    uint16_t kicked_idx;        // avail->idx the device was last told about
+    uint16_t last_used;         // next used entry to consume
+    int event_idx;
+    struct vring_desc* desc;
+    struct vring_avail* avail;
+    struct vring_used* used;
+    volatile uint16_t* used_event;
+    volatile uint16_t* avail_event;
+    void* cookie[VQ_MAX_SIZE];  // per chain head, returned by vq_get_used()
+};
+
+struct vq_buf {
+    uint64_t phys;
+    uint32_t len;
+    uint16_t flags;             // VRING_DESC_F_WRITE for device-writable buffers
+};
+
+// Sets up queue `index` in `mem` and hands it to the device. The size is
+// the device's maximum capped at VQ_MAX_SIZE (legacy devices can't be capped).
+int vq_init(struct virtqueue* vq, struct virtio_pci* vdev, uint16_t index,
+            void* mem, int event_idx);
+
+// Adds one descriptor chain without publishing it to the device.
+// Returns -1 when fewer than `count` descriptors are free.
+int vq_add(struct virtqueue* vq, const struct vq_buf* bufs, int count, void* cookie);
+
+// Publishes every chain added since the last kick with one avail->idx
+// update and rings the doorbell, unless the device has suppressed
+// notifications. Returns 1 if the doorbell was rung.
+int vq_kick(struct virtqueue* vq);
+
+// Next completed chain (its cookie) and the bytes written, NULL when none.
+// Frees the chain's descriptors.
+void* vq_get_used(struct virtqueue* vq, uint32_t* len);
+
+// Re-arms the completion interrupt for everything consumed so far.
+// Returns 1 if more completions arrived meanwhile (poll again).
+int vq_enable_irq(struct virtqueue* vq);
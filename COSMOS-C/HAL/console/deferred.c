@@ -0,0 +1,37 @@
+#include "HAL/console/deferred.h"
+#include "HAL/console/print.h"
+#include "ipc/chan.h"
+#include "async/async.h"
+#include "arch/x86_64/MM/paging.h"
+#include "lib/errno.h"
+#include <stdint.h>
+
+static struct chan_slot post_slots[1u << CONSOLE_POST_ORDER];
+static struct chan post_chan = CHAN_INIT("console", post_slots, CONSOLE_POST_ORDER, CHAN_MSG_CONSOLE);
+static struct async_task writer;
+
+// Drains the channel every time it is woken; each page is written in one
+// console_write() and goes back to the PMM
+static int writer_task(struct async_task* t) {
+    struct chan_msg m;
+    ASYNC_BEGIN(t);
+    for (;;) {
+        while (chan_recv(&post_chan, &m) == 0) {
+            console_write(m.page, m.len);
+            chan_page_free(m.page);
+        }
+        ASYNC_WAIT_RECV(t, &post_chan, ASYNC_FOREVER);
+    }
+    ASYNC_END(t);
+}
+
+void console_deferred_init(void) {
+    async_task_init(&writer, writer_task, NULL);
+    async_spawn(&writer);
+}
+
+int console_post(void* page, uint32_t len) {
+    if (!page || len > PAGE_SIZE) return -EINVAL;
+    struct chan_msg m = { .type = CHAN_MSG_CONSOLE, .len = len, .page = page };
+    return chan_send(&post_chan, &m);
+}
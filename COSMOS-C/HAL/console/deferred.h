@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+
+// Console output from contexts that must not write the screen themselves
+// (interrupt handlers, anything that must not wait for the console lock):
+// the text goes into a page from chan_page_alloc() and through a channel
+// to a task that console_write()s it from the main loop. The page is handed
+// over, not copied.
+
+#define CONSOLE_POST_ORDER  6          // 64 pages in flight
+
+// Starts the writer task, after async_init()
+void console_deferred_init(void);
+
+// `page` holds `len` bytes of text (ANSI escapes allowed). Any context. On
+// success the console owns the page and frees it once written; -EAGAIN
+// (queue full) and -EINVAL leave it with the caller.
+int console_post(void* page, uint32_t len);
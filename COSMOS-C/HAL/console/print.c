@@ -1,111 +1,553 @@
 #include "arch/x86_64/IRQ/port.h"
 #include "HAL/console/print.h"
+#include "HAL/console/vga.h"
+#include "Drivers/serial/serial.h"
+#include "param/param.h"
+#include "sync/spinlock.h"
+#include "lib/string.h"
+#include "compiler.h"
 #include <stddef.h>
 #include <stdint.h>
 
-const static size_t NUM_COLS = 80;
-const static size_t NUM_ROWS = 25;
+const static size_t NUM_COLS = VGA_COLS;
+const static size_t NUM_ROWS = VGA_ROWS;
 
 struct Char {
     uint8_t character;
     uint8_t color;
 };
 
-struct Char* buffer = (struct Char*) 0xb8000;
-size_t col = 0;
-size_t row = 0;
-uint8_t color = WHITE | BLACK << 4;
+#define VT_CELLS (VGA_COLS * VGA_ROWS)
+#define DEFAULT_COLOR (WHITE | BLACK << 4)
+#define CSI_MAX_PARAMS 8
 
-void clear_row(size_t row) {
-    struct Char empty = { .character = ' ', .color = color };
-    for (size_t c = 0; c < NUM_COLS; c++) {
-        buffer[c + NUM_COLS * row] = empty;
+// One virtual terminal: screen, cursor and color. The one in front writes
+// straight into the VGA buffer; the others write into their shadow at RAM
+// speed, no VGA access. Switching swaps the two with one copy each way.
+struct vt {
+    size_t col;
+    size_t row;
+    uint8_t color;
+    uint8_t esc;                    // console_write() parser state, ESC_*
+    uint8_t nparams;
+    uint16_t params[CSI_MAX_PARAMS];
+    struct Char shadow[VT_CELLS];   // the screen while not in front
+};
+
+// Every terminal's state is shared between the main loop and IRQ handlers
+// that print (keyboard): every public function takes console_lock with
+// interrupts off, the *_locked helpers expect it held.
+static struct vt vts[VT_COUNT] = {
+    [0 ... VT_COUNT - 1] = { .color = DEFAULT_COLOR },
+};
+static struct vt* front = &vts[0];
+static uint32_t backend = CONSOLE_VGA;
+
+static spinlock_t console_lock = SPINLOCK_INIT("console");
+
+// ===================== SERIAL BACKEND =====================
+// A terminal on COM1 has its own screen: only the column is tracked, and a
+// cursor move within the line (the line editor) becomes CR + cursor forward.
+// Rows only grow, so print_get_row() stays 0. Only the terminal in front
+// goes to COM1, the others fill their shadow as with VGA.
+static inline int on_serial(const struct vt* v) {
+    return backend == CONSOLE_SERIAL && v == front;
+}
+
+static void serial_cursor_locked(struct vt* v, size_t col_) {
+    if (col_ == v->col) return;
+    serial_putc('\r');
+    if (col_) {
+        serial_write("\033[");
+        serial_write_dec(col_);
+        serial_putc('C');
     }
+    v->col = col_;
 }
 
-void print_clear() {
-    for (size_t r = 0; r < NUM_ROWS; r++) clear_row(r);
-    col = 0;
-    row = 0;
-    print_update_cursor();
+static void serial_putc_locked(struct vt* v, char character) {
+    if (character == '\n') {
+        serial_putc('\n');
+        v->col = 0;
+    } else if (character == '\b') {
+        if (v->col == 0) return;
+        serial_write("\b \b");
+        v->col--;
+    } else {
+        serial_putc(character);
+        v->col++;
+    }
 }
 
-void print_newline() {
-    col = 0;
-    if (row < NUM_ROWS - 1) {
-        row++;
+// ===================== LOCKED HELPERS =====================
+static inline struct Char* vt_cells(struct vt* v) {
+    return v == front ? (struct Char*) VGA_TEXT_BUFFER : v->shadow;
+}
+
+static void hw_cursor(size_t col, size_t row) {
+    uint16_t pos = row * NUM_COLS + col;
+    outb(0x3D4, 0x0F);
+    outb(0x3D5, (uint8_t)(pos & 0xFF));
+    outb(0x3D4, 0x0E);
+    outb(0x3D5, (uint8_t)((pos >> 8) & 0xFF));
+}
+
+static void set_cursor_locked(struct vt* v, size_t col_, size_t row_) {
+    if (on_serial(v)) {
+        serial_cursor_locked(v, col_);
+        return;
+    }
+    // Ustawiamy globalne col/row tak, żeby print_char() pisał we właściwe miejsce
+    v->col = col_;
+    v->row = row_;
+    if (v == front) hw_cursor(v->col, v->row);
+}
+
+static void clear_row(struct vt* v, size_t row) {
+    struct Char* cells = vt_cells(v);
+    struct Char empty = { .character = ' ', .color = v->color };
+    for (size_t c = 0; c < NUM_COLS; c++) {
+        cells[c + NUM_COLS * row] = empty;
+    }
+}
+
+// next row, scrolling on the last one; the hardware cursor is left alone
+static void line_feed(struct vt* v) {
+    v->col = 0;
+    if (v->row < NUM_ROWS - 1) {
+        v->row++;
     } else {
         // scroll
+        struct Char* cells = vt_cells(v);
         for (size_t r = 1; r < NUM_ROWS; r++) {
             for (size_t c = 0; c < NUM_COLS; c++) {
-                buffer[c + NUM_COLS * (r - 1)] = buffer[c + NUM_COLS * r];
+                cells[c + NUM_COLS * (r - 1)] = cells[c + NUM_COLS * r];
             }
         }
-        clear_row(NUM_ROWS - 1);
+        clear_row(v, NUM_ROWS - 1);
     }
-    print_update_cursor();
 }
 
-void print_char(char character) {
+static void newline_locked(struct vt* v) {
+    if (on_serial(v)) {
+        serial_putc_locked(v, '\n');
+        return;
+    }
+    line_feed(v);
+    set_cursor_locked(v, v->col, v->row);
+}
+
+static void putc_locked(struct vt* v, char character) {
+    if (on_serial(v)) {
+        serial_putc_locked(v, character);
+        return;
+    }
     if (character == '\n') {
-        print_newline();
+        newline_locked(v);
         return;
     }
+    struct Char* cells = vt_cells(v);
     if (character == '\b') {
-        if (col == 0) {
-            if (row == 0) return;
-            row--;
-            col = NUM_COLS - 1;
+        if (v->col == 0) {
+            if (v->row == 0) return;
+            v->row--;
+            v->col = NUM_COLS - 1;
         } else {
-            col--;
+            v->col--;
         }
-        buffer[col + NUM_COLS * row] = (struct Char){ .character = ' ', .color = color };
-        print_update_cursor();
+        cells[v->col + NUM_COLS * v->row] = (struct Char){ .character = ' ', .color = v->color };
+        set_cursor_locked(v, v->col, v->row);
         return;
     }
-    if (col >= NUM_COLS) print_newline();
-    buffer[col + NUM_COLS * row] = (struct Char){ .character = (uint8_t)character, .color = color };
-    col++;
-    print_update_cursor();
+    if (v->col >= NUM_COLS) newline_locked(v);
+    cells[v->col + NUM_COLS * v->row] = (struct Char){ .character = (uint8_t)character, .color = v->color };
+    v->col++;
+    set_cursor_locked(v, v->col, v->row);
 }
 
+static void clear_locked(struct vt* v) {
+    if (on_serial(v)) {
+        serial_write("\033[2J\033[H");   // clear screen, cursor home
+        v->col = 0;
+        return;
+    }
+    for (size_t r = 0; r < NUM_ROWS; r++) clear_row(v, r);
+    set_cursor_locked(v, 0, 0);
+}
+
+// ===================== API =====================
+// fb has no driver yet; the choice is logged so a VM config can be checked
+__init void print_init(void) {
+    uint32_t want = param_get(PARAM_CONSOLE);
+    if (want == CONSOLE_FB) serial_write("[CONSOLE] no framebuffer driver, using vga\n");
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    backend = want == CONSOLE_SERIAL ? CONSOLE_SERIAL : CONSOLE_VGA;
+    front->col = front->row = 0;
+    for (uint32_t i = 0; i < VT_COUNT; i++)
+        if (&vts[i] != front) clear_locked(&vts[i]);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+uint32_t print_backend(void) { return backend; }
+
+void print_clear() {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    clear_locked(front);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+void print_newline() {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    newline_locked(front);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+void print_char(char character) {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    putc_locked(front, character);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+// the whole string is written under one lock hold, so IRQ output can't split it
 void print_str(char* str) {
-    for (size_t i = 0;; i++) {
-        if (str[i] == '\0') return;
-        print_char(str[i]);
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    for (size_t i = 0; str[i] != '\0'; i++) putc_locked(front, str[i]);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+// Panics come with interrupts off and possibly from inside a console_lock
+// section (a fault in this file): the message is dropped rather than waited
+// for. White on red from here on. 0 if it was written.
+int print_panic(const char* str) {
+    if (!spin_trylock(&console_lock)) return -1;
+    front->color = WHITE | (RED << 4);
+    for (size_t i = 0; str[i] != '\0'; i++) putc_locked(front, str[i]);
+    spin_unlock(&console_lock);
+    return 0;
+}
+
+// ===================== VIRTUAL TERMINALS =====================
+// O(screen) no matter what was printed meanwhile: the leaving terminal's
+// cells go to its shadow, the new one's come back, the cursor follows.
+// On COM1 there is one screen; the switch only moves where output goes.
+void print_vt_switch(uint32_t vt) {
+    if (vt >= VT_COUNT) return;
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    struct vt* next = &vts[vt];
+    if (next != front) {
+        if (backend == CONSOLE_VGA) {
+            memcpy(front->shadow, VGA_TEXT_BUFFER, sizeof(front->shadow));
+            memcpy(VGA_TEXT_BUFFER, next->shadow, sizeof(next->shadow));
+        }
+        front = next;
+        if (backend == CONSOLE_VGA) hw_cursor(front->col, front->row);
     }
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+uint32_t print_vt_active(void) {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    uint32_t vt = (uint32_t)(front - vts);
+    spin_unlock_irqrestore(&console_lock, flags);
+    return vt;
+}
+
+void print_vt_str(uint32_t vt, const char* str) {
+    if (vt >= VT_COUNT) return;
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    for (size_t i = 0; str[i] != '\0'; i++) putc_locked(&vts[vt], str[i]);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+void print_vt_set_color(uint32_t vt, uint8_t fg, uint8_t bg) {
+    if (vt >= VT_COUNT) return;
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    vts[vt].color = fg | (bg << 4);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+// ===================== ANSI WRITER =====================
+// console_write() runs every byte through one table lookup: the byte's
+// class and the parser state give the action and the next state. Runs of
+// printable bytes are copied into the cells in one pass, the hardware
+// cursor is written once per call. The state lives in the terminal, so an
+// escape sequence may be split across calls.
+
+#define ESC_GROUND  0
+#define ESC_ESCAPE  1       // after ESC
+#define ESC_CSI     2       // after ESC [
+#define ESC_STATES  3
+
+#define CL_PRINT    0       // text, and intermediates / private markers in a CSI
+#define CL_DIGIT    1
+#define CL_SEMI     2
+#define CL_FINAL    3       // 0x40..0x7E except '['
+#define CL_BRACKET  4
+#define CL_ESC      5
+#define CL_EXEC     6       // \n \r \b \t
+#define CL_IGNORE   7       // other C0 controls, DEL
+#define CL_COUNT    8
+
+#define ACT_NONE     0
+#define ACT_PRINT    1
+#define ACT_EXEC     2
+#define ACT_CSI      3      // start collecting parameters
+#define ACT_PARAM    4
+#define ACT_SEP      5
+#define ACT_DISPATCH 6
+
+struct esc_step {
+    uint8_t action;
+    uint8_t next;
+};
+
+static const struct esc_step esc_table[ESC_STATES][CL_COUNT] = {
+    [ESC_GROUND] = {
+        [CL_PRINT]   = { ACT_PRINT, ESC_GROUND },
+        [CL_DIGIT]   = { ACT_PRINT, ESC_GROUND },
+        [CL_SEMI]    = { ACT_PRINT, ESC_GROUND },
+        [CL_FINAL]   = { ACT_PRINT, ESC_GROUND },
+        [CL_BRACKET] = { ACT_PRINT, ESC_GROUND },
+        [CL_ESC]     = { ACT_NONE, ESC_ESCAPE },
+        [CL_EXEC]    = { ACT_EXEC, ESC_GROUND },
+        [CL_IGNORE]  = { ACT_NONE, ESC_GROUND },
+    },
+    // only CSI is supported, any other escape is dropped
+    [ESC_ESCAPE] = {
+        [CL_PRINT]   = { ACT_NONE, ESC_GROUND },
+        [CL_DIGIT]   = { ACT_NONE, ESC_GROUND },
+        [CL_SEMI]    = { ACT_NONE, ESC_GROUND },
+        [CL_FINAL]   = { ACT_NONE, ESC_GROUND },
+        [CL_BRACKET] = { ACT_CSI, ESC_CSI },
+        [CL_ESC]     = { ACT_NONE, ESC_ESCAPE },
+        [CL_EXEC]    = { ACT_EXEC, ESC_ESCAPE },
+        [CL_IGNORE]  = { ACT_NONE, ESC_ESCAPE },
+    },
+    [ESC_CSI] = {
+        [CL_PRINT]   = { ACT_NONE, ESC_CSI },
+        [CL_DIGIT]   = { ACT_PARAM, ESC_CSI },
+        [CL_SEMI]    = { ACT_SEP, ESC_CSI },
+        [CL_FINAL]   = { ACT_DISPATCH, ESC_GROUND },
+        [CL_BRACKET] = { ACT_NONE, ESC_GROUND },
+        [CL_ESC]     = { ACT_NONE, ESC_ESCAPE },
+        [CL_EXEC]    = { ACT_EXEC, ESC_CSI },
+        [CL_IGNORE]  = { ACT_NONE, ESC_CSI },
+    },
+};
+
+static uint8_t byte_class(uint8_t c) {
+    if (c >= '0' && c <= '9') return CL_DIGIT;
+    if (c == ';') return CL_SEMI;
+    if (c == '[') return CL_BRACKET;
+    if (c >= 0x40 && c <= 0x7E) return CL_FINAL;
+    if (c >= 0x20 && c != 0x7F) return CL_PRINT;   // 0x80.. are CP437 glyphs
+    if (c == 0x1B) return CL_ESC;
+    if (c == '\n' || c == '\r' || c == '\b' || c == '\t') return CL_EXEC;
+    return CL_IGNORE;
+}
+
+// ANSI color number -> VGA palette index
+static const uint8_t ansi_to_vga[8] = {
+    BLACK, RED, GREEN, BROWN, BLUE, MAGENTA, CYAN, LIGHT_GRAY,
+};
+
+static inline uint32_t csi_arg(const struct vt* v, uint32_t i, uint32_t def) {
+    return i < v->nparams && v->params[i] ? v->params[i] : def;
+}
+
+static void sgr(struct vt* v) {
+    uint8_t fg = v->color & 0x0F, bg = v->color >> 4;
+    if (v->nparams == 0) v->params[v->nparams++] = 0;   // ESC[m is ESC[0m
+    for (uint32_t i = 0; i < v->nparams; i++) {
+        uint32_t p = v->params[i];
+        if (p == 0) { fg = DEFAULT_COLOR & 0x0F; bg = DEFAULT_COLOR >> 4; }
+        else if (p == 1) fg |= 0x08;                    // bold as bright
+        else if (p == 22) fg &= 0x07;
+        else if (p >= 30 && p <= 37) fg = (fg & 0x08) | ansi_to_vga[p - 30];
+        else if (p == 39) fg = DEFAULT_COLOR & 0x0F;
+        else if (p >= 40 && p <= 47) bg = ansi_to_vga[p - 40];
+        else if (p == 49) bg = DEFAULT_COLOR >> 4;
+        else if (p >= 90 && p <= 97) fg = ansi_to_vga[p - 90] | 0x08;
+        else if (p >= 100 && p <= 107) bg = ansi_to_vga[p - 100] | 0x08;
+    }
+    v->color = (uint8_t)(fg | (bg << 4));
+}
+
+static void erase(struct vt* v, size_t from, size_t to) {
+    struct Char* cells = vt_cells(v);
+    struct Char empty = { .character = ' ', .color = v->color };
+    for (size_t i = from; i < to; i++) cells[i] = empty;
+}
+
+static void csi_dispatch(struct vt* v, uint8_t final) {
+    uint32_t n = csi_arg(v, 0, 1);
+    size_t pos = v->row * NUM_COLS + (v->col < NUM_COLS ? v->col : NUM_COLS - 1);
+    switch (final) {
+        case 'm': sgr(v); break;
+        case 'A': v->row = n > v->row ? 0 : v->row - n; break;
+        case 'B': v->row = v->row + n >= NUM_ROWS ? NUM_ROWS - 1 : v->row + n; break;
+        case 'C': v->col = v->col + n >= NUM_COLS ? NUM_COLS - 1 : v->col + n; break;
+        case 'D': v->col = n > v->col ? 0 : v->col - n; break;
+        case 'H': case 'f': {
+            uint32_t r = csi_arg(v, 0, 1), c = csi_arg(v, 1, 1);
+            v->row = (r > NUM_ROWS ? NUM_ROWS : r) - 1;
+            v->col = (c > NUM_COLS ? NUM_COLS : c) - 1;
+            break;
+        }
+        case 'J':
+            switch (csi_arg(v, 0, 0)) {
+                case 0: erase(v, pos, VT_CELLS); break;
+                case 1: erase(v, 0, pos + 1); break;
+                case 2: erase(v, 0, VT_CELLS); break;
+            }
+            break;
+        case 'K': {
+            size_t line = v->row * NUM_COLS;
+            switch (csi_arg(v, 0, 0)) {
+                case 0: erase(v, pos, line + NUM_COLS); break;
+                case 1: erase(v, line, pos + 1); break;
+                case 2: erase(v, line, line + NUM_COLS); break;
+            }
+            break;
+        }
+        default: break;     // unsupported, dropped
+    }
+}
+
+static void exec(struct vt* v, uint8_t c) {
+    switch (c) {
+        case '\n': line_feed(v); break;
+        case '\r': v->col = 0; break;
+        case '\b': if (v->col) v->col--; break;     // moves only, as on a terminal
+        case '\t':
+            v->col = (v->col + 8) & ~(size_t)7;
+            if (v->col > NUM_COLS) v->col = NUM_COLS;
+            break;
+    }
+}
+
+// Printable bytes from buf[i] on, up to the end of the line: one pass
+static size_t print_run(struct vt* v, const uint8_t* buf, size_t i, size_t len) {
+    if (v->col >= NUM_COLS) line_feed(v);
+    struct Char* cells = vt_cells(v) + v->row * NUM_COLS;
+    size_t col = v->col;
+    uint8_t color = v->color;
+    while (i < len && col < NUM_COLS && byte_class(buf[i]) <= CL_BRACKET) {
+        cells[col++] = (struct Char){ .character = buf[i++], .color = color };
+    }
+    v->col = col;
+    return i;
+}
+
+static void vt_write_locked(struct vt* v, const uint8_t* buf, size_t len) {
+    // COM1: the terminal on the other end parses the escapes itself
+    if (on_serial(v)) {
+        for (size_t i = 0; i < len; i++) {
+            const struct esc_step* st = &esc_table[v->esc][byte_class(buf[i])];
+            serial_putc((char)buf[i]);
+            if (st->action == ACT_PRINT) v->col++;
+            else if (buf[i] == '\n' || buf[i] == '\r') v->col = 0;
+            v->esc = st->next;
+        }
+        return;
+    }
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t c = buf[i];
+        const struct esc_step* st = &esc_table[v->esc][byte_class(c)];
+        v->esc = st->next;
+        switch (st->action) {
+            case ACT_PRINT:
+                i = print_run(v, buf, i, len);
+                continue;
+            case ACT_EXEC:
+                exec(v, c);
+                break;
+            case ACT_CSI:
+                v->nparams = 0;
+                break;
+            case ACT_PARAM:
+                if (v->nparams == 0) v->params[v->nparams++] = 0;
+                {
+                    uint16_t* p = &v->params[v->nparams - 1];
+                    *p = *p >= 1000 ? 9999 : (uint16_t)(*p * 10 + (c - '0'));
+                }
+                break;
+            case ACT_SEP:
+                if (v->nparams == 0) v->params[v->nparams++] = 0;
+                if (v->nparams < CSI_MAX_PARAMS) v->params[v->nparams++] = 0;   // extras fold into the last
+                break;
+            case ACT_DISPATCH:
+                csi_dispatch(v, c);
+                break;
+        }
+        i++;
+    }
+    if (v == front) hw_cursor(v->col, v->row);
+}
+
+// One lock hold per call, like print_str()
+void console_write(const char* buf, size_t len) {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    vt_write_locked(front, (const uint8_t*)buf, len);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+void console_vt_write(uint32_t vt, const char* buf, size_t len) {
+    if (vt >= VT_COUNT) return;
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    vt_write_locked(&vts[vt], (const uint8_t*)buf, len);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+void console_puts(const char* str) {
+    size_t len = 0;
+    while (str[len]) len++;
+    console_write(str, len);
 }
 
 void print_int(int integer) {
     char buf[12];
     int i = 0;
     int neg = 0;
+    // magnitude as unsigned, so INT_MIN does not overflow
+    unsigned int value = (unsigned int)integer;
     if (integer == 0) { print_char('0'); return; }
-    if (integer < 0) { neg = 1; integer = -integer; }
-    while (integer > 0) { buf[i++] = '0' + (integer % 10); integer /= 10; }
+    if (integer < 0) { neg = 1; value = 0u - value; }
+    while (value > 0) { buf[i++] = '0' + (value % 10); value /= 10; }
     if (neg) buf[i++] = '-';
-    for (int j = i - 1; j >= 0; j--) print_char(buf[j]);
+
+    char out[12];
+    int n = 0;
+    for (int j = i - 1; j >= 0; j--) out[n++] = buf[j];
+    out[n] = '\0';
+    print_str(out);
 }
 
 void print_set_color(uint8_t fg, uint8_t bg) {
-    color = fg | (bg << 4);
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    front->color = fg | (bg << 4);
+    spin_unlock_irqrestore(&console_lock, flags);
 }
 
 void print_set_cursor(size_t col_, size_t row_) {
-    // Ustawiamy globalne col/row tak, żeby print_char() pisał we właściwe miejsce
-    col = col_;
-    row = row_;
-
-    uint16_t pos = row * NUM_COLS + col;
-    outb(0x3D4, 0x0F);
-    outb(0x3D5, (uint8_t)(pos & 0xFF));
-    outb(0x3D4, 0x0E);
-    outb(0x3D5, (uint8_t)((pos >> 8) & 0xFF));
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    set_cursor_locked(front, col_, row_);
+    spin_unlock_irqrestore(&console_lock, flags);
 }
 
-
 void print_update_cursor() {
-    print_set_cursor(col, row);
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    set_cursor_locked(front, front->col, front->row);
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+size_t print_get_row(void) {
+    uint64_t flags = spin_lock_irqsave(&console_lock);
+    size_t r = front->row;
+    spin_unlock_irqrestore(&console_lock, flags);
+    return r;
 }
 
 void draw_cursor(int start_col, int cursor_pos, int row, int blink_state){
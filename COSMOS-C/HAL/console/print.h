@@ -23,6 +23,35 @@ enum Colors {
 	WHITE = 15,
 };
 
+// Console backends, `console=` on the command line (Core/param)
+#define CONSOLE_VGA     0   // text mode at 0xb8000
+#define CONSOLE_SERIAL  1   // COM1, cursor moves as ANSI escapes (headless VMs)
+#define CONSOLE_FB      2   // no framebuffer driver yet: falls back to vga
+
+// Picks the backend from the console= parameter. Boot, after param_parse().
+void print_init(void);
+uint32_t print_backend(void);
+
+// Virtual terminals: print_* write to the one in front, print_vt_* to any.
+// The rest keep their screen in RAM until Alt+F<n+1> (ps2.c) brings them up.
+#define VT_COUNT        4
+
+void print_vt_switch(uint32_t vt);
+uint32_t print_vt_active(void);
+void print_vt_str(uint32_t vt, const char* str);
+void print_vt_set_color(uint32_t vt, uint8_t foreground, uint8_t background);
+
+// Bulk writes with ANSI/VT100 escapes: SGR colors (ESC[...m, 30-37/90-97,
+// 40-47/100-107, 0, 1, 22, 39, 49), cursor moves (A B C D H f) and erases
+// (J K). Printable runs go into the cells in one pass, the cursor is set
+// once per call. Other escapes are dropped; a sequence may span calls.
+void console_write(const char* buf, size_t len);
+void console_vt_write(uint32_t vt, const char* buf, size_t len);
+void console_puts(const char* str);
+
+// isr_panic(): never waits for the console lock, -1 if the message was dropped
+int print_panic(const char* str);
+
 void print_clear();
 void print_char(char symbol);
 void print_str(char* str);
@@ -31,4 +60,5 @@ void print_set_color(uint8_t foreground, uint8_t background);
 void print_newline(void);
 void print_set_cursor(size_t col, size_t row);
 void print_update_cursor(void);
+size_t print_get_row(void);
 void draw_cursor(int start_col, int cursor_pos, int row, int blink_state);
\ No newline at end of file
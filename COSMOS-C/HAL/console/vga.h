@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// VGA text mode: 80x25 cells, each one (character, color) byte pair
+#define VGA_COLS 80
+#define VGA_ROWS 25
+
+#ifdef COSMOS_HOSTED
+// Native (Linux) build: a plain array in host/hal_stub.c stands in for 0xb8000
+extern uint16_t hal_vga_text[VGA_COLS * VGA_ROWS];
+#define VGA_TEXT_BUFFER ((void*)hal_vga_text)
+#else
+#define VGA_TEXT_BUFFER ((void*)0xb8000)
+#endif
@@ -0,0 +1,78 @@
+#include "microbench.h"
+#include "HAL/console/print.h"
+
+static void BM_print_char(bench_state_t* state) {
+    uint64_t i = 0;
+    print_clear();
+    while (bench_keep_running(state)) {
+        if (i % (80 * 24) == 0) print_set_cursor(0, 0);
+        print_char('a' + (i++ % 26));
+    }
+    state->items = state->iterations;
+}
+BENCHMARK(BM_print_char);
+
+static void BM_print_str_line(bench_state_t* state) {
+    char line[] = "[4/6] [PS/2 DRIVER] initialized";
+    print_clear();
+    while (bench_keep_running(state)) {
+        print_set_cursor(0, 0);
+        print_str(line);
+    }
+    state->bytes = state->iterations * (sizeof(line) - 1);
+}
+BENCHMARK(BM_print_str_line);
+
+static void BM_console_write_ansi(bench_state_t* state) {
+    const char line[] = "\033[H\033[92m[4/6] [PS/2 DRIVER] \033[97minitialized";
+    print_clear();
+    while (bench_keep_running(state)) console_write(line, sizeof(line) - 1);
+    state->bytes = state->iterations * (sizeof(line) - 1);
+}
+BENCHMARK(BM_console_write_ansi);
+
+static void BM_print_str_colored(bench_state_t* state) {
+    char tag[] = "[4/6] [PS/2 DRIVER] ";
+    char text[] = "initialized";
+    print_clear();
+    while (bench_keep_running(state)) {
+        print_set_cursor(0, 0);
+        print_set_color(LIGHT_GREEN, BLACK);
+        print_str(tag);
+        print_set_color(WHITE, BLACK);
+        print_str(text);
+    }
+    state->bytes = state->iterations * (sizeof(tag) + sizeof(text) - 2);
+}
+BENCHMARK(BM_print_str_colored);
+
+static void BM_print_int(bench_state_t* state) {
+    unsigned value = 0;
+    print_clear();
+    while (bench_keep_running(state)) {
+        print_set_cursor(0, 0);
+        print_int((int)value);
+        value = value * 1103515245u + 12345u;
+    }
+}
+BENCHMARK(BM_print_int);
+
+static void BM_scroll(bench_state_t* state) {
+    print_set_cursor(0, 24);
+    while (bench_keep_running(state)) print_newline();
+}
+BENCHMARK(BM_scroll);
+
+static void BM_print_str_background(bench_state_t* state) {
+    const char line[] = "[4/6] [PS/2 DRIVER] initialized";
+    while (bench_keep_running(state)) print_vt_str(1, line);
+    state->bytes = state->iterations * (sizeof(line) - 1);
+}
+BENCHMARK(BM_print_str_background);
+
+static void BM_vt_switch(bench_state_t* state) {
+    uint32_t vt = 0;
+    while (bench_keep_running(state)) print_vt_switch(vt ^= 1);
+    print_vt_switch(0);
+}
+BENCHMARK(BM_vt_switch);
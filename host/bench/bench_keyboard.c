@@ -0,0 +1,67 @@
+#include "microbench.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include <stddef.h>
+
+void kb_update(void);
+
+// press/release pairs with a shift toggle, same mix as the in-kernel kbench
+static const uint8_t stream[] = {
+    0x1E, 0x9E, 0x30, 0xB0, 0x2E, 0xAE, 0x20, 0xA0,
+    0x2A, 0x12, 0x92, 0x21, 0xA1, 0xAA,
+    0x02, 0x82, 0x03, 0x83, 0x39, 0xB9, 0x0E, 0x8E,
+    0xE0, 0x4B, 0xE0, 0xCB, 0xE0, 0x4D, 0xE0, 0xCD,
+};
+
+// IRQ1 decode path: translate_scancode() + ring buffer put, drained every 64
+static void BM_keyboard_decode(bench_state_t* state) {
+    size_t i = 0;
+    while (bench_keep_running(state)) {
+        keyboard_handle_scancode(stream[i % sizeof(stream)]);
+        if ((++i & 63) == 0) while (keyboard_getchar() >= 0);
+    }
+    while (keyboard_getchar() >= 0);
+    state->items = state->iterations;
+}
+BENCHMARK(BM_keyboard_decode);
+
+// Ring buffer alone: one put through the decoder, one get
+static void BM_keyboard_ring(bench_state_t* state) {
+    while (bench_keep_running(state)) {
+        keyboard_handle_scancode(0x1E);
+        keyboard_handle_scancode(0x9E);
+        bench_do_not_optimize(keyboard_getchar());
+    }
+}
+BENCHMARK(BM_keyboard_ring);
+
+// Line editor: one typed character echoed, with a newline every 60 keys
+static void BM_line_editor_type(bench_state_t* state) {
+    size_t i = 0;
+    while (bench_keep_running(state)) {
+        if (++i % 60 == 0) {
+            keyboard_handle_scancode(0x1C); // Enter
+            keyboard_handle_scancode(0x9C);
+        } else {
+            keyboard_handle_scancode(0x1E); // 'a'
+            keyboard_handle_scancode(0x9E);
+        }
+        kb_update();
+    }
+}
+BENCHMARK(BM_line_editor_type);
+
+// Line editor: insert in the middle of a long line (redraws the tail)
+static void BM_line_editor_insert_mid(bench_state_t* state) {
+    size_t i = 0;
+    while (bench_keep_running(state)) {
+        switch (i++ % 64) {
+            case 0:  keyboard_handle_scancode(0x1C); break;               // Enter
+            case 40: keyboard_handle_scancode(0xE0);                      // Home
+                     keyboard_handle_scancode(0x47); break;
+            default: keyboard_handle_scancode(0x1E);                      // 'a'
+                     keyboard_handle_scancode(0x9E); break;
+        }
+        kb_update();
+    }
+}
+BENCHMARK(BM_line_editor_insert_mid);
@@ -0,0 +1,120 @@
+#include "microbench.h"
+#include "sync/atomic.h"
+#include "sync/spinlock.h"
+#include "sync/mcs.h"
+#include "sync/seqlock.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// Lock handoff under contention: `arg` threads split the iterations, each
+// one increments a shared counter inside the critical section. Reported
+// time is per critical section, so a lock that scales stays flat as the
+// thread count grows. The thread count is capped at the number of online
+// CPUs: spinning on a preempted lock holder only measures the scheduler.
+
+#define MAX_THREADS 16
+
+typedef struct {
+    void (*body)(uint64_t iters);
+    uint64_t iters;
+} worker_t;
+
+static void* worker_main(void* p) {
+    worker_t* w = p;
+    w->body(w->iters);
+    return NULL;
+}
+
+static void run_threads(bench_state_t* state, void (*body)(uint64_t)) {
+    int n = state->arg > 0 ? (int)state->arg : 1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0 && n > cpus) n = (int)cpus;
+    if (n > MAX_THREADS) n = MAX_THREADS;
+    pthread_t threads[MAX_THREADS];
+    worker_t work[MAX_THREADS];
+
+    uint64_t per_thread = state->iterations / n;
+    for (int i = 0; i < n; i++) {
+        work[i] = (worker_t){ body, per_thread };
+        pthread_create(&threads[i], NULL, worker_main, &work[i]);
+    }
+    for (int i = 0; i < n; i++) pthread_join(threads[i], NULL);
+    state->remaining = 0;
+    state->items = per_thread * n;
+}
+
+static spinlock_t ticket = SPINLOCK_INIT("bench_ticket");
+static mcs_lock_t mcs = MCS_LOCK_INIT("bench_mcs");
+static seqlock_t seq = SEQLOCK_INIT("bench_seq");
+static volatile uint64_t shared_counter;
+
+// ===================== TICKET =====================
+static void ticket_body(uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        spin_lock(&ticket);
+        shared_counter++;
+        spin_unlock(&ticket);
+    }
+}
+
+static void BM_ticket_contended(bench_state_t* state) {
+    run_threads(state, ticket_body);
+}
+BENCHMARK_ARG(BM_ticket_contended, 1);
+BENCHMARK_ARG(BM_ticket_contended, 2);
+BENCHMARK_ARG(BM_ticket_contended, 4);
+BENCHMARK_ARG(BM_ticket_contended, 8);
+
+// ===================== MCS =====================
+static void mcs_body(uint64_t iters) {
+    mcs_node_t node;
+    for (uint64_t i = 0; i < iters; i++) {
+        mcs_lock(&mcs, &node);
+        shared_counter++;
+        mcs_unlock(&mcs, &node);
+    }
+}
+
+static void BM_mcs_contended(bench_state_t* state) {
+    run_threads(state, mcs_body);
+}
+BENCHMARK_ARG(BM_mcs_contended, 1);
+BENCHMARK_ARG(BM_mcs_contended, 2);
+BENCHMARK_ARG(BM_mcs_contended, 4);
+BENCHMARK_ARG(BM_mcs_contended, 8);
+
+// ===================== SEQLOCK =====================
+static void BM_seqlock_read(bench_state_t* state) {
+    while (bench_keep_running(state)) {
+        uint32_t s;
+        uint64_t v;
+        do {
+            s = read_seqbegin(&seq);
+            v = shared_counter;
+        } while (read_seqretry(&seq, s));
+        bench_do_not_optimize(v);
+    }
+}
+BENCHMARK(BM_seqlock_read);
+
+static void BM_seqlock_write(bench_state_t* state) {
+    while (bench_keep_running(state)) {
+        write_seqlock(&seq);
+        shared_counter++;
+        write_sequnlock(&seq);
+    }
+}
+BENCHMARK(BM_seqlock_write);
+
+// ===================== ATOMICS =====================
+static void atomic_body(uint64_t iters) {
+    static uint64_t counter;
+    for (uint64_t i = 0; i < iters; i++) atomic_fetch_add(&counter, 1, MO_RELAXED);
+}
+
+static void BM_atomic_add_contended(bench_state_t* state) {
+    run_threads(state, atomic_body);
+}
+BENCHMARK_ARG(BM_atomic_add_contended, 1);
+BENCHMARK_ARG(BM_atomic_add_contended, 4);
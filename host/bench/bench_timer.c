@@ -0,0 +1,40 @@
+#include "microbench.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+
+static void BM_timer_convert_ms(bench_state_t* state) {
+    uint64_t ms = 123456789;
+    while (bench_keep_running(state)) {
+        timer_time_t t = timer_convert_ms(ms++);
+        bench_do_not_optimize(t.hours);
+        bench_do_not_optimize(t.milliseconds);
+    }
+    state->items = state->iterations;
+}
+BENCHMARK(BM_timer_convert_ms);
+
+static void noop_callback(void) {}
+
+// Per-tick dispatch with `arg` armed timers that never fire
+static void BM_timer_callbacks_update(bench_state_t* state) {
+    for (int64_t i = 0; i < state->arg; i++) set_timeout(noop_callback, 1ull << 40);
+    while (bench_keep_running(state)) timer_callbacks_update();
+    cancel_timeout(noop_callback);
+}
+BENCHMARK_ARG(BM_timer_callbacks_update, 0);
+BENCHMARK_ARG(BM_timer_callbacks_update, 8);
+BENCHMARK_ARG(BM_timer_callbacks_update, 16);
+
+static void BM_timer_arm_cancel(bench_state_t* state) {
+    while (bench_keep_running(state)) {
+        set_timeout(noop_callback, 1000);
+        cancel_timeout(noop_callback);
+    }
+}
+BENCHMARK(BM_timer_arm_cancel);
+
+// One full tick: counter increment plus callback scan
+static void BM_timer_tick(bench_state_t* state) {
+    while (bench_keep_running(state)) timer_tick();
+}
+BENCHMARK(BM_timer_tick);
@@ -0,0 +1,80 @@
+#include "microbench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BENCHMARKS 128
+
+typedef struct {
+    const char* name;
+    bench_fn_t fn;
+    int64_t arg;
+} bench_entry_t;
+
+static bench_entry_t benchmarks[MAX_BENCHMARKS];
+static int bench_count = 0;
+
+void bench_register(const char* name, bench_fn_t fn, int64_t arg) {
+    if (bench_count == MAX_BENCHMARKS) {
+        fprintf(stderr, "microbench: too many benchmarks\n");
+        exit(1);
+    }
+    benchmarks[bench_count++] = (bench_entry_t){ name, fn, arg };
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_one(const bench_entry_t* b, double min_time) {
+    bench_state_t state;
+    uint64_t iters = 1;
+    double elapsed;
+
+    for (;;) {
+        memset(&state, 0, sizeof(state));
+        state.iterations = state.remaining = iters;
+        state.arg = b->arg;
+
+        double t0 = now_seconds();
+        b->fn(&state);
+        elapsed = now_seconds() - t0;
+
+        if (elapsed >= min_time || iters >= (1ull << 40)) break;
+        // aim a bit past min_time, but never grow more than 10x per step
+        double scale = elapsed > 0 ? (min_time * 1.4) / elapsed : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        if (scale < 2.0) scale = 2.0;
+        iters = (uint64_t)(iters * scale);
+    }
+
+    printf("%-40s %12.2f ns %14llu", b->name, elapsed * 1e9 / iters,
+           (unsigned long long)iters);
+    if (state.items) printf(" %12.3fM items/s", state.items / elapsed / 1e6);
+    if (state.bytes) printf(" %12.3f MB/s", state.bytes / elapsed / 1e6);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    double min_time = 0.5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--benchmark_filter=", 19) == 0) filter = argv[i] + 19;
+        else if (strncmp(argv[i], "--min_time=", 11) == 0) min_time = atof(argv[i] + 11);
+        else {
+            fprintf(stderr, "usage: %s [--benchmark_filter=substr] [--min_time=seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("%-40s %15s %14s\n", "Benchmark", "Time", "Iterations");
+    for (int i = 0; i < bench_count; i++) {
+        if (filter && !strstr(benchmarks[i].name, filter)) continue;
+        run_one(&benchmarks[i], min_time);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+// Minimal Google-Benchmark-style harness for the host build.
+//
+//   static void BM_thing(bench_state_t* state) {
+//       while (bench_keep_running(state)) { ... }
+//   }
+//   BENCHMARK(BM_thing);
+//
+// The runner grows the iteration count until one run takes at least
+// --min_time seconds and prints ns per iteration.
+#include <stdint.h>
+
+typedef struct {
+    uint64_t iterations;   // requested for this run
+    uint64_t remaining;
+    int64_t arg;           // from BENCHMARK_ARG(), 0 otherwise
+    uint64_t items;        // optional, set by the benchmark for items/s
+    uint64_t bytes;        // optional, set by the benchmark for bytes/s
+} bench_state_t;
+
+typedef void (*bench_fn_t)(bench_state_t* state);
+
+void bench_register(const char* name, bench_fn_t fn, int64_t arg);
+
+static inline int bench_keep_running(bench_state_t* state) {
+    if (state->remaining == 0) return 0;
+    state->remaining--;
+    return 1;
+}
+
+// Keep the compiler from deleting a computation whose result is unused
+#define bench_do_not_optimize(value) __asm__ volatile ("" : : "r,m"(value) : "memory")
+#define bench_clobber_memory() __asm__ volatile ("" : : : "memory")
+
+#define BENCHMARK_ARG(fn, a)                                                   \
+    __attribute__((constructor)) static void bench_reg_##fn##_##a(void) {     \
+        bench_register(#fn "/" #a, fn, a);                                     \
+    }
+
+#define BENCHMARK(fn)                                                          \
+    __attribute__((constructor)) static void bench_reg_##fn(void) {           \
+        bench_register(#fn, fn, 0);                                            \
+    }
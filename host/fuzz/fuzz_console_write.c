@@ -0,0 +1,32 @@
+// libFuzzer entry: console_write() on arbitrary bytes, split in two calls so
+// escapes cross the boundary. The cursor must stay on screen, and text
+// without escapes or controls must land in the cells unchanged.
+#include "HAL/console/print.h"
+#include "HAL/console/vga.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) return 0;
+    size_t split = data[0] % size;
+
+    print_clear();
+    console_write((const char*)data + 1, split);
+    console_write((const char*)data + 1 + split, size - 1 - split);
+    if (print_get_row() >= VGA_ROWS) abort();
+
+    // a reset, then printable bytes from the top left
+    console_write("\033[0m\033[H", 7);
+    size_t n = 0;
+    char text[VGA_COLS];
+    for (size_t i = 1; i < size && n < sizeof(text); i++) {
+        if (data[i] >= 0x20 && data[i] != 0x7F) text[n++] = (char)data[i];
+    }
+    console_write(text, n);
+    for (size_t i = 0; i < n; i++) {
+        if ((char)(hal_vga_text[i] & 0xFF) != text[i]) abort();
+        if ((hal_vga_text[i] >> 8) != (WHITE | BLACK << 4)) abort();
+    }
+    return 0;
+}
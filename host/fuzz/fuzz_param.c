@@ -0,0 +1,30 @@
+// libFuzzer entry: arbitrary kernel command lines through param_parse().
+// Whatever the input, every parameter stays inside its limits and kbd.buf
+// stays a power of two (the key ring masks with it).
+#include "param/param.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include "HAL/console/print.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    char* cmdline = malloc(size + 1);
+    if (!cmdline) return 0;
+    memcpy(cmdline, data, size);
+    cmdline[size] = '\0';
+    param_parse(cmdline);
+    free(cmdline);
+
+    uint32_t hz = param_get(PARAM_TIMER_HZ);
+    uint32_t buf = param_get(PARAM_KBD_BUF);
+    if (hz < TIMER_HZ_MIN || hz > TIMER_HZ_MAX) abort();
+    if (param_get(PARAM_CONSOLE) > CONSOLE_FB || !param_choice(PARAM_CONSOLE)) abort();
+    if (buf < 16 || buf > KB_BUF_MAX || (buf & (buf - 1))) abort();
+    if (param_get(PARAM_KBD_HISTORY) < 1 || param_get(PARAM_KBD_HISTORY) > KB_HISTORY_MAX) abort();
+    if (param_get(PARAM_CALLBACKS_MAX) < 1 || param_get(PARAM_CALLBACKS_MAX) > CALLBACKS_MAX) abort();
+    return 0;
+}
@@ -0,0 +1,26 @@
+// libFuzzer entry: print_int() must render exactly what printf("%d") does
+#include "HAL/console/print.h"
+#include "HAL/console/vga.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    int value;
+    char expected[16];
+
+    if (size < sizeof(value)) return 0;
+    memcpy(&value, data, sizeof(value));
+    int len = snprintf(expected, sizeof(expected), "%d", value);
+
+    print_clear();
+    print_int(value);
+
+    for (int i = 0; i < len; i++) {
+        if ((char)(hal_vga_text[i] & 0xFF) != expected[i]) abort();
+    }
+    if ((char)(hal_vga_text[len] & 0xFF) != ' ') abort();
+    return 0;
+}
@@ -0,0 +1,18 @@
+// libFuzzer entry: arbitrary scancode streams through the IRQ1 decoder and
+// the line editor. Memory errors show up through ASan on hal_vga_text and
+// the driver's static buffers.
+#include "Drivers/PS2/keyboard/ps2.h"
+#include <stddef.h>
+#include <stdint.h>
+
+void kb_update(void);
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        keyboard_handle_scancode(data[i]);
+        // let the editor consume keys at an input-dependent pace
+        if (data[i] & 1) kb_update();
+    }
+    for (int i = 0; i < 512; i++) kb_update();
+    return 0;
+}
@@ -0,0 +1,18 @@
+// libFuzzer entry: timer_convert_ms() fields are in range and add back up
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    uint64_t ms;
+
+    if (size < sizeof(ms)) return 0;
+    memcpy(&ms, data, sizeof(ms));
+
+    timer_time_t t = timer_convert_ms(ms);
+    if (t.milliseconds >= 1000 || t.seconds >= 60 || t.minutes >= 60) abort();
+    if (((t.hours * 60 + t.minutes) * 60 + t.seconds) * 1000 + t.milliseconds != ms) abort();
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Driver for toolchains without libFuzzer (e.g. gcc + -fsanitize=address):
+// replays the files given on the command line, or runs random inputs when
+// called without arguments.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RANDOM_RUNS 100000
+#define RANDOM_MAX_LEN 4096
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static int run_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return 1; }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = malloc(len ? len : 1);
+    if (fread(data, 1, len, f) != (size_t)len) { perror(path); fclose(f); free(data); return 1; }
+    fclose(f);
+    LLVMFuzzerTestOneInput(data, len);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        int failed = 0;
+        for (int i = 1; i < argc; i++) failed |= run_file(argv[i]);
+        return failed;
+    }
+
+    static uint8_t data[RANDOM_MAX_LEN];
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    for (int run = 0; run < RANDOM_RUNS; run++) {
+        size_t len = (x >> 33) % RANDOM_MAX_LEN;
+        for (size_t i = 0; i < len; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            data[i] = (uint8_t)x;
+        }
+        LLVMFuzzerTestOneInput(data, len);
+    }
+    printf("%d random inputs OK\n", RANDOM_RUNS);
+    return 0;
+}
@@ -0,0 +1,51 @@
+// Stub hardware for the native (Linux) build of the portable kernel modules.
+// Ports read back what was last written, except for the status registers
+// the drivers poll, which always report "ready".
+#include "arch/x86_64/IRQ/port.h"
+#include "Core/arch/x86_64/CPU/cpu.h"
+#include "Core/arch/x86_64/TIMER/timer.h"
+#include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Core/arch/x86_64/MM/vm.h"
+#include "HAL/console/vga.h"
+#include "Drivers/PS2/keyboard/ps2.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define PS2_CMD_PORT  0x64
+#define COM1_LSR      0x3FD
+
+uint16_t hal_vga_text[VGA_COLS * VGA_ROWS];
+
+static uint32_t port_latch[0x10000];
+
+uint8_t hal_inb(uint16_t port) {
+    switch (port) {
+        case PS2_CMD_PORT: return 0x00;  // input buffer empty
+        case COM1_LSR:     return 0x60;  // transmitter empty
+        default:           return (uint8_t)port_latch[port];
+    }
+}
+
+void hal_outb(uint16_t port, uint8_t val) { port_latch[port] = val; }
+uint16_t hal_inw(uint16_t port) { return (uint16_t)port_latch[port]; }
+void hal_outw(uint16_t port, uint16_t val) { port_latch[port] = val; }
+uint32_t hal_inl(uint16_t port) { return port_latch[port]; }
+void hal_outl(uint16_t port, uint32_t val) { port_latch[port] = val; }
+
+// Every "hlt" is one PIT tick, so sleep_ms() and friends terminate
+void hal_halt(void) {
+    timer_tick();
+}
+
+// Boot-time buffers (key ring, timeout slots) come from the heap
+void* vm_reserve(size_t size, uint32_t flags, const char* name) {
+    (void)flags;
+    (void)name;
+    return calloc(1, size);
+}
+
+// The allocating init steps of src/main.c, at their default parameters
+__attribute__((constructor)) static void hal_boot(void) {
+    keyboard_init();
+    timer_callbacks_init();
+}
@@ -0,0 +1,16 @@
+#!/bin/sh
+# Copies the function trace (Core/trace/ftrace.h) out of a serial log, in
+# the text format Perfetto (ui.perfetto.dev) and catapult's systrace open.
+# usage: scripts/ftrace-extract.sh <serial log> <trace file>
+set -eu
+
+log=$1
+out=$2
+
+tr -d '\r' < "$log" | sed -n '/^FTRACE begin/,/^FTRACE end/{/^FTRACE /d;p;}' > "$out"
+if [ ! -s "$out" ]; then
+    echo "ftrace: no trace in $log" >&2
+    exit 1
+fi
+grep '^# entries' "$out"
+echo "trace: $out"
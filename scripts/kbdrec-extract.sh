@@ -0,0 +1,24 @@
+#!/bin/sh
+# Cuts the last keyboard recording (kbd.record=, HAL/Drivers/PS2/keyboard/
+# kbd_replay.h) out of a serial log into a replay file, e.g. for
+# `make bench BENCH_REPLAY=<file>` (default bench/keys.kbdrec).
+# usage: scripts/kbdrec-extract.sh <serial log> <output file>
+set -eu
+
+log=$1
+out=$2
+
+if ! tr -d '\r' < "$log" | grep -q '^KBDREC end'; then
+    echo "kbdrec: no complete recording in $log" >&2
+    exit 1
+fi
+
+mkdir -p "$(dirname "$out")"
+# keep only the last recording in the log
+tr -d '\r' < "$log" | awk '/^KBDREC begin/ { rec = $0 "\n" }
+     /^KBDREC [0-9]/  { rec = rec $0 "\n" }
+     /^KBDREC end/    { done = rec $0 "\n" }
+     END { printf "%s", done }' > "$out"
+
+head -n 1 "$out"
+echo "replay file: $out"
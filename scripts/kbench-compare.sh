@@ -0,0 +1,49 @@
+#!/bin/sh
+# Compares the per-op ns of a kbench run against a stored baseline.
+# usage: scripts/kbench-compare.sh <baseline> <results>
+# Exits 1 when any benchmark is slower than the baseline by more than
+# KBENCH_THRESHOLD percent (default 10).
+
+base=$1
+cur=$2
+KBENCH_THRESHOLD=${KBENCH_THRESHOLD:-10}
+
+if [ ! -f "$base" ]; then
+    echo "kbench: no baseline at $base, run 'make bench-baseline' to record one"
+    exit 0
+fi
+
+awk -v threshold="$KBENCH_THRESHOLD" '
+function field(line, key,    n, i, kv) {
+    n = split(line, kv, " ")
+    for (i = 1; i <= n; i++)
+        if (index(kv[i], key "=") == 1) return substr(kv[i], length(key) + 2)
+    return ""
+}
+FNR == 1 { file++ }
+/^KBENCH begin/ { profile[file] = field($0, "profile") }
+/^KBENCH name=/ {
+    name = field($0, "name")
+    if (file == 1) base[name] = field($0, "ns")
+    else { cur[name] = field($0, "ns"); order[++n] = name }
+}
+END {
+    printf "baseline profile: %s, current profile: %s\n\n", profile[1], profile[2]
+    printf "%-24s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "delta"
+    for (i = 1; i <= n; i++) {
+        name = order[i]
+        if (!(name in base)) {
+            printf "%-24s %14s %14s %9s\n", name, "-", cur[name], "new"
+            continue
+        }
+        delta = base[name] > 0 ? (cur[name] - base[name]) * 100 / base[name] : 0
+        flag = ""
+        if (delta > threshold) { flag = "  REGRESSION"; bad++ }
+        else if (delta < -threshold) flag = "  improved"
+        printf "%-24s %14s %14s %+8.1f%%%s\n", name, base[name], cur[name], delta, flag
+    }
+    if (bad) {
+        printf "\n%d benchmark(s) regressed by more than %s%%\n", bad, threshold
+        exit 1
+    }
+}' "$base" "$cur"
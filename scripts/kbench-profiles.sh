@@ -0,0 +1,39 @@
+#!/bin/sh
+# Side-by-side comparison of bench kernels built with different profiles.
+# usage: scripts/kbench-profiles.sh <bench dir>...
+# Each directory holds dist/kernel.bin and results.kbench (see `make bench-profiles`).
+
+SIZE=${SIZE:-x86_64-elf-size}
+
+echo "image size (bytes)"
+printf "%-10s %10s %10s %10s\n" "profile" "text" "data" "bss"
+for dir in "$@"; do
+    profile=$(sed -n 's/^KBENCH begin profile=\([^ ]*\).*/\1/p' "$dir/results.kbench")
+    $SIZE "$dir/dist/kernel.bin" | awk -v p="$profile" 'NR == 2 { printf "%-10s %10s %10s %10s\n", p, $1, $2, $3 }'
+done
+echo
+
+awk '
+function field(line, key,    n, i, kv) {
+    n = split(line, kv, " ")
+    for (i = 1; i <= n; i++)
+        if (index(kv[i], key "=") == 1) return substr(kv[i], length(key) + 2)
+    return ""
+}
+FNR == 1 { file++ }
+/^KBENCH begin/ { profile[file] = field($0, "profile") }
+/^KBENCH name=/ {
+    name = field($0, "name")
+    if (!(name in seen)) { seen[name] = 1; order[++n] = name }
+    ns[name, file] = field($0, "ns")
+}
+END {
+    printf "%-24s", "ns per op"
+    for (f = 1; f <= file; f++) printf " %12s", profile[f]
+    printf "\n"
+    for (i = 1; i <= n; i++) {
+        printf "%-24s", order[i]
+        for (f = 1; f <= file; f++) printf " %12s", ((order[i], f) in ns) ? ns[order[i], f] : "-"
+        printf "\n"
+    }
+}' $(for dir in "$@"; do echo "$dir/results.kbench"; done)
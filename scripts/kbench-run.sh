@@ -0,0 +1,49 @@
+#!/bin/sh
+# Boots a bench kernel ISO headless and collects its KBENCH lines from COM1.
+# usage: scripts/kbench-run.sh <kernel.iso> <results file>
+set -u
+
+iso=$1
+out=$2
+log="$out.log"
+
+QEMU=${QEMU:-qemu-system-x86_64}
+# hpet.msi lets an HPET timer deliver the NMI watchdog's NMIs (NMI/nmi.h)
+QEMU_BENCH_FLAGS=${QEMU_BENCH_FLAGS:-"-accel kvm -accel tcg -cpu max -m 512M -display none -no-reboot -global hpet.msi=on"}
+KBENCH_TIMEOUT=${KBENCH_TIMEOUT:-600}
+# scratch disk for the virtio-blk jobs; disable-modern=on tests the legacy interface
+KBENCH_DISK_SIZE=${KBENCH_DISK_SIZE:-64M}
+KBENCH_BLK_DEVICE=${KBENCH_BLK_DEVICE:-virtio-blk-pci}
+disk="$out.disk"
+
+rm -f "$log" "$disk"
+truncate -s "$KBENCH_DISK_SIZE" "$disk" || exit 1
+timeout "$KBENCH_TIMEOUT" $QEMU $QEMU_BENCH_FLAGS \
+    -device isa-debug-exit,iobase=0xf4,iosize=0x04 \
+    -drive file="$disk",if=none,id=kbench-disk,format=raw \
+    -device "$KBENCH_BLK_DEVICE",drive=kbench-disk \
+    -serial file:"$log" -cdrom "$iso"
+status=$?
+rm -f "$disk"
+
+# kbench_exit(0) writes 0 to isa-debug-exit, which QEMU turns into status 1
+if [ "$status" -ne 1 ]; then
+    echo "kbench: QEMU exited with status $status (expected 1)" >&2
+    [ -f "$log" ] && cat "$log" >&2
+    exit 1
+fi
+
+grep '^KBENCH ' "$log" | tr -d '\r' > "$out"
+if ! grep -q '^KBENCH end' "$out"; then
+    echo "kbench: run did not complete, see $log" >&2
+    exit 1
+fi
+cat "$out"
+
+# IRQSOFF kernels: sections over IRQSOFF_BUDGET_US fail the run
+over=$(sed -n 's/^IRQSOFF begin .* over=\([0-9]*\).*/\1/p' "$log" | tail -n 1)
+if [ -n "$over" ] && [ "$over" -ne 0 ]; then
+    echo "kbench: $over interrupts-off sections over the budget:" >&2
+    grep '^IRQSOFF top ' "$log" >&2
+    exit 1
+fi
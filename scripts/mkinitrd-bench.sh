@@ -0,0 +1,35 @@
+#!/bin/sh
+# Generates the bench initrd tree: <count> small files spread over 256
+# directories (path lookup) plus one 16 MiB file (read throughput).
+# usage: scripts/mkinitrd-bench.sh <dir> <count>
+set -eu
+
+dir=$1
+count=$2
+stamp="$dir/.count"
+
+# regenerating tens of thousands of files takes a while, skip if unchanged
+if [ -f "$stamp" ] && [ "$(cat "$stamp")" = "$count" ]; then
+    exit 0
+fi
+
+rm -rf "$dir"
+mkdir -p "$dir/big"
+awk -v dir="$dir" -v count="$count" 'BEGIN {
+    for (d = 0; d < 256; d++) system("mkdir -p " dir "/data/d" sprintf("%03d", d))
+    seed = 1
+    for (i = 0; i < count; i++) {
+        seed = (seed * 1103515245 + 12345) % 2147483648
+        size = 32 + seed % 480
+        path = sprintf("%s/data/d%03d/file%06d.txt", dir, i % 256, i)
+        line = sprintf("%06d", i)
+        body = ""
+        while (length(body) < size) body = body line
+        printf "%s", substr(body, 1, size) > path
+        close(path)
+    }
+}'
+dd if=/dev/zero of="$dir/big/blob.bin" bs=1048576 count=16 2>/dev/null
+mkdir -p "$dir/etc"
+cp targets/x86_64/initrd/etc/motd "$dir/etc/motd"
+echo "$count" > "$stamp"
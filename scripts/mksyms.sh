@@ -0,0 +1,93 @@
+#!/bin/sh
+# Writes the kernel symbol table (Core/prof/ksyms.h) as NASM source: the
+# text symbols of a linked kernel, sorted by address, and with the link map
+# the source file of each one (the object's first prerequisite in its .d
+# file). Without a kernel the table is empty (first link pass, see
+# build-x86_64 in the Makefile).
+# usage: scripts/mksyms.sh [kernel ELF [link map]] > ksyms.asm
+set -eu
+
+NM=${NM:-x86_64-elf-nm}
+
+# code symbols only; the linker script's __*_start/__*_end markers would
+# shadow the first function of every section
+syms() {
+    [ $# -gt 0 ] || return 0
+    $NM -n --defined-only "$1" |
+        awk 'NF == 3 && $2 ~ /^[tTwW]$/ && $3 !~ /^__.*_(start|end)$/ { print $1, $3 }'
+}
+
+syms "$@" | awk -v map="${2:-}" '
+function hex(s,    v, i) {
+    s = tolower(s); sub(/^0x/, "", s)
+    v = 0
+    for (i = 1; i <= length(s); i++) v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    return v
+}
+
+# input section of the map: [start, start + size) comes from obj
+function add_range(start, size, obj) {
+    if (hex(size) == 0 || obj !~ /\.o$/) return
+    rstart[nr] = hex(start); rend[nr] = hex(start) + hex(size); robj[nr] = obj; nr++
+}
+
+function source_of(obj,    d, line, src) {
+    if (obj in src_of) return src_of[obj]
+    src = ""
+    d = obj; sub(/\.o$/, ".d", d)
+    if ((getline line < d) > 0) {
+        sub(/^[^:]*: */, "", line); sub(/[ \\].*$/, "", line)
+        src = line; sub(/^COSMOS-C\//, "", src)
+        close(d)
+    }
+    src_of[obj] = src
+    return src
+}
+
+BEGIN {
+    n = 0; off = 0; nr = 0; nfiles = 0
+    # `.text.name  0xaddr  0xsize  obj`, split over two lines for long names
+    while (map != "" && (getline line < map) > 0) {
+        k = split(line, f, " ")
+        if (k == 1 && f[1] ~ /^\.text/) { pending = 1; continue }
+        if (pending && k == 3 && f[1] ~ /^0x/) add_range(f[1], f[2], f[3])
+        else if (k == 4 && f[1] ~ /^\.text/ && f[2] ~ /^0x/) add_range(f[2], f[3], f[4])
+        pending = 0
+    }
+    r = 0
+}
+
+{
+    addr[n] = $1; name[n] = $2; file[n] = 65535
+    a = hex($1)
+    while (r < nr && rend[r] <= a) r++   # map and symbols are both in address order
+    if (r < nr && rstart[r] <= a) {
+        src = source_of(robj[r])
+        if (src != "") {
+            if (!(src in file_idx)) { file_idx[src] = nfiles; files[nfiles++] = src }
+            file[n] = file_idx[src]
+        }
+    }
+    n++
+}
+
+END {
+    print "; generated by scripts/mksyms.sh"
+    print "section .rodata"
+    print "global ksyms_count, ksyms_addrs, ksyms_name_offs, ksyms_file_of"
+    print "global ksyms_file_count, ksyms_file_offs, ksyms_names"
+    print "align 8"
+    printf "ksyms_count: dq %d\n", n
+    printf "ksyms_file_count: dq %d\n", nfiles
+    print "ksyms_addrs:"
+    for (i = 0; i < n; i++) printf "    dq 0x%s\n", addr[i]
+    print "ksyms_name_offs:"
+    for (i = 0; i < n; i++) { printf "    dd %d\n", off; off += length(name[i]) + 1 }
+    print "ksyms_file_offs:"
+    for (i = 0; i < nfiles; i++) { printf "    dd %d\n", off; off += length(files[i]) + 1 }
+    print "ksyms_file_of:"
+    for (i = 0; i < n; i++) printf "    dw %d\n", file[i]
+    print "ksyms_names:"
+    for (i = 0; i < n; i++) printf "    db \"%s\", 0\n", name[i]
+    for (i = 0; i < nfiles; i++) printf "    db \"%s\", 0\n", files[i]
+}'
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Splits the PROF lines of a serial log (Core/prof/profiler.h) into a flat
+# profile and folded stacks, e.g. for flamegraph.pl <dir>/prof.folded.
+# usage: scripts/prof-extract.sh <serial log> <output dir>
+set -eu
+
+log=$1
+dir=$2
+mkdir -p "$dir"
+
+tr -d '\r' < "$log" > "$dir/prof.log"
+if ! grep -q '^PROF end' "$dir/prof.log"; then
+    echo "prof: no complete profile in $log" >&2
+    exit 1
+fi
+
+grep '^PROF begin' "$dir/prof.log" | tail -n 1
+# keep only the last profile in the log
+awk '/^PROF begin/ { flat = ""; folded = "" }
+     /^PROF flat /  { flat = flat substr($0, 11) "\n" }
+     /^PROF stack / { folded = folded substr($0, 12) "\n" }
+     END { printf "%s", flat > "'"$dir"'/prof.flat"; printf "%s", folded > "'"$dir"'/prof.folded" }' \
+    "$dir/prof.log"
+rm -f "$dir/prof.log"
+
+echo "samples  percent  function"
+head -n 20 "$dir/prof.flat"
+echo "folded stacks: $dir/prof.folded"
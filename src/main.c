@@ -1,12 +1,49 @@
 #include "arch/x86_64/TIMER/timer.h"
 #include "arch/x86_64/IDT/idt.h"
+#include "arch/x86_64/GDT/gdt.h"
+#include "arch/x86_64/CPU/percpu.h"
+#include "arch/x86_64/CPU/features.h"
+#include "arch/x86_64/CPU/alternative.h"
+#include "arch/x86_64/SYSCALL/syscall.h"
 #include "arch/x86_64/PIC/pic.h"
+#include "arch/x86_64/APIC/lapic.h"
+#include "arch/x86_64/ACPI/acpi.h"
 #include "Drivers/PS2/keyboard/ps2.h"
+#include "Drivers/PS2/keyboard/kbd_replay.h"
 #include "HAL/console/print.h"
+#include "HAL/console/deferred.h"
 #include "Core/arch/x86_64/TIMER/callback/callback.h"
+#include "Drivers/serial/serial.h"
+#include "Drivers/PCI/pci.h"
+#include "Drivers/virtio/virtio_blk.h"
+#include "arch/x86_64/boot/sections.h"
+#include "arch/x86_64/boot/multiboot2.h"
+#include "param/param.h"
+#include "arch/x86_64/MM/pmm.h"
+#include "arch/x86_64/MM/vmm.h"
+#include "arch/x86_64/MM/vm.h"
+#include "arch/x86_64/MM/stack.h"
+#include "fs/initrd.h"
+#include "exec/exec.h"
+#include "async/async.h"
+#include "arch/x86_64/NMI/nmi.h"
+#include "compiler.h"
+#ifdef KBENCH
+#include "kbench/kbench.h"
+#endif
+#ifdef PROF_HZ
+#include "prof/profiler.h"
+#endif
+#ifdef FTRACE
+#include "trace/ftrace.h"
+#endif
+#ifdef IRQSOFF
+#include "trace/irqsoff.h"
+#endif
 #include <stdint.h>
 
 void kernel_init(void);
+void kernel_start(void);
 void hardwaresetup(void);
 void kernel_update(void);
 void enable_irq(void);
@@ -14,40 +51,112 @@ void kb_update(void);
 void load_logs(void);
 
 // This function loads logs
-void load_logs(void){
-    /* IDT */        print_set_color(LIGHT_GREEN, BLACK); print_str("[1/6] [IDT] ");          print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(500);   print_str("\n");
-    /* */            print_set_color(LIGHT_GREEN, BLACK); print_str("[2/6] [PIT] ");          print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(700);   print_str("\n");
-    /* PIC */        print_set_color(LIGHT_GREEN, BLACK); print_str("[3/6] [PIC] ");          print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(900);   print_str("\n");
-    /* KEYBOARD */   print_set_color(LIGHT_GREEN, BLACK); print_str("[4/6] [PS/2 DRIVER] ");  print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(1000);  print_str("\n");
-    /* TIMER */      print_set_color(LIGHT_GREEN, BLACK); print_str("[5/6] [PIT] ");          print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(1500);  print_str("\n");
-    /* INTERRUPTS */ print_set_color(LIGHT_GREEN, BLACK); print_str("[6/6] [INTERRUPTS] ");   print_set_color(WHITE, BLACK);  print_str("initialized");  sleep_ms(2000);  print_str("\n");
+__init void load_logs(void){
+    /* IDT */        console_puts("\033[92m[1/6] [IDT] \033[97minitialized");          sleep_ms(500);  print_str("\n");
+    /* */            console_puts("\033[92m[2/6] [PIT] \033[97minitialized");          sleep_ms(700);  print_str("\n");
+    /* PIC */        console_puts("\033[92m[3/6] [PIC] \033[97minitialized");          sleep_ms(900);  print_str("\n");
+    /* KEYBOARD */   console_puts("\033[92m[4/6] [PS/2 DRIVER] \033[97minitialized");  sleep_ms(1000); print_str("\n");
+    /* TIMER */      console_puts("\033[92m[5/6] [PIT] \033[97minitialized");          sleep_ms(1500); print_str("\n");
+    /* INTERRUPTS */ console_puts("\033[92m[6/6] [INTERRUPTS] \033[97minitialized");   sleep_ms(2000); print_str("\n");
 }
 // Main kernel function
 void kernel_main() {    
     hardwaresetup(); // set IDT, remap PIC, init keyboard, init timer, enable interrupts   
+    stack_switch(this_cpu()->main_rsp, kernel_start); // off the boot stack (main.asm) for good
+}
+
+// Rest of the boot and the main loop, on the guarded main stack
+void kernel_start(void) {
+    nmi_watchdog_start(NMI_WATCHDOG_MS); // needs the tick running, no-op without an NMI source
+#ifdef IRQSOFF
+    irqsoff_init(IRQSOFF_BUDGET_US);     // reported after IRQSOFF_SECONDS (kernel_update)
+#endif
+#ifdef FTRACE
+    ftrace_init();   // call sites are NOPs until a filter enables them
+#ifdef FTRACE_FILTER
+    ftrace_set_filter(FTRACE_FILTER);        // dumped after FTRACE_SECONDS (kernel_update)
+#endif
+#endif
+#ifdef PROF_HZ
+    profiler_start(PROF_HZ, PROF_CALLCHAIN); // reported after PROF_SECONDS (kernel_update)
+#endif
     kernel_init();   // Init 
+#ifdef KBENCH
+    kbench_run();    // bench kernel: run the suite and leave QEMU
+    kbench_exit(0);
+#endif
     load_logs();
+    exec_module("init", 0); // user/hello.c, when grub.cfg loads it
+    free_init_memory(); // everything marked __init is gone after this
+    sections_protect(); // W^X page permissions per section
+    sections_report();
+    pmm_report();       // free memory after the init sections went back
+    stack_report();     // peak use of every stack so far
     while (1) {
         kernel_update();
     }
 }
 
 // Init
-void kernel_init() {
+__init void kernel_init() {
     print_clear();
     print_set_color(WHITE, BLACK);
     print_str("COSMOS-C booted successfully!\n");
 }
 
 // Called once to set up interrupts + devices
-void hardwaresetup(void) {    
-    idt_init();            // 1) initialize IDT (sets up interrupt gates)    
-    pic_remap(0x20, 0x28); // 2) remap PIC so IRQs 0..15 map to vectors 0x20..0x2F   
-    keyboard_init();       // 3) initialize keyboard driver (buffers, state)
-    timer_init();          // 4) initialize timer
-    enable_irq();          // 5) enable interrupts globally   
+__init void hardwaresetup(void) {    
+    serial_init();         // 0) COM1 for logs and benchmark output
+    cpu_features_init();   // 1) CPUID + XCR0 feature flags
+    alternatives_apply();  // 2) patch hot paths for those features (.text still writable)
+    multiboot2_init();     // 3) boot information (memory map, modules)
+    param_parse(multiboot2_cmdline()); // 4) kernel command line -> boot parameters
+    print_init();          // 5) console backend (console=)
+    pmm_init();            // 6) physical frames from the memory map
+    vmm_init();            // 7) NX + write protect, page table allocation
+    vm_init();             // 8) zero page, demand paged regions
+    gdt_init();            // 9) kernel/user segments + TSS
+    percpu_init();         // 10) GS base -> per-CPU block
+    idt_init();            // 11) initialize IDT (sets up interrupt gates)    
+    stack_init();          // 12) guarded main/IRQ/IST stacks, painted for high-water marks
+    initrd_init();         // 13) index the initrd module (demand paged, needs #PF)
+    syscall_init();        // 14) SYSCALL MSRs + int 0x80 gate
+    acpi_init();           // 15) RSDP and root table (HPET, ...)
+    pic_remap(0x20, 0x28); // 16) remap PIC so IRQs 0..15 map to vectors 0x20..0x2F   
+    lapic_init();          // 17) local APIC, PIC stays the legacy IRQ path
+    keyboard_init();       // 18) initialize keyboard driver (buffers, state)
+    timer_init();          // 19) pick clock sources + tick device, start the tick
+    pci_init();            // 20) enumerate PCI functions
+    virtio_blk_init();     // 21) virtio disk, if QEMU provides one
+    async_init();          // 22) task executor: timer heap, key events
+    console_deferred_init(); // 23) writer task for console_post() (Core/ipc channel)
+    kbd_record_init();     // 24) kbd.record=: scancodes with timing, for replay
+    enable_irq();          // 25) enable interrupts globally   
 }
 
 void kernel_update(void) {
     kb_update();
+    async_run();     // tasks woken by timeouts, keys and I/O completions
+    kbd_record_poll(); // KBDREC export once kbd.record= scancodes are in
+#ifdef PROF_HZ
+    static int prof_reported;
+    if (!prof_reported && timer_uptime_ms() >= PROF_SECONDS * 1000ull) {
+        profiler_report();
+        prof_reported = 1;
+    }
+#endif
+#ifdef IRQSOFF
+    static int irqsoff_reported;
+    if (!irqsoff_reported && timer_uptime_ms() >= IRQSOFF_SECONDS * 1000ull) {
+        irqsoff_report();
+        irqsoff_reported = 1;
+    }
+#endif
+#if defined(FTRACE) && defined(FTRACE_FILTER)
+    static int trace_dumped;
+    if (!trace_dumped && timer_uptime_ms() >= FTRACE_SECONDS * 1000ull) {
+        ftrace_dump();
+        trace_dumped = 1;
+    }
+#endif
 }
\ No newline at end of file
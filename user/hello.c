@@ -0,0 +1,10 @@
+#include "arch/x86_64/SYSCALL/syscall.h"
+#include <stdint.h>
+
+// The "init" module (grub.cfg): one line on the console and exit 0
+static const char msg[] = "Hello from user space\n";
+
+int64_t main(uint64_t arg) {
+    (void)arg;
+    return syscall2(SYS_WRITE, (uint64_t)msg, sizeof(msg) - 1) == sizeof(msg) - 1 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+; Entry point of every user program (user/*.c). exec_run() enters with the
+; argument in rdi and a 16-byte aligned stack; main's return value is the
+; exit code.
+global _start
+extern main
+
+section .text
+bits 64
+_start:
+    xor ebp, ebp            ; outermost frame for stack walks
+    call main               ; main(arg), rdi untouched
+    mov rdi, rax
+    mov eax, 1              ; SYS_EXIT
+    syscall
+    ud2                     ; SYS_EXIT does not return
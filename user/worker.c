@@ -0,0 +1,12 @@
+#include <stdint.h>
+
+// The "worker" module spawned by kbench_exec: writes one .data and one .bss
+// page and exits with arg + 1, so the bench can check it ran
+static volatile uint64_t runs = 1;
+static volatile uint64_t scratch[512];
+
+int64_t main(uint64_t arg) {
+    runs++;
+    scratch[arg % 512] = arg;
+    return (int64_t)scratch[arg % 512] + 1;
+}